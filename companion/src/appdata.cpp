@@ -507,6 +507,7 @@ void Profile::flush()
 
 // Get declarations
 QStringList AppData::recentFiles() { return _recentFiles;     }
+QStringList AppData::modelLibraryDirs() { return _modelLibraryDirs; }
 QByteArray AppData::mainWinGeo()   { return _mainWinGeo;      }
 QByteArray AppData::mainWinState() { return _mainWinState;    }
 QByteArray AppData::modelEditGeo() { return _modelEditGeo;    }
@@ -556,6 +557,7 @@ int AppData::warningId()           { return _warningId;       }
 
 // Set declarations
 void AppData::recentFiles     (const QStringList x) { store(x, _recentFiles,     "recentFileList"          );}
+void AppData::modelLibraryDirs(const QStringList x) { store(x, _modelLibraryDirs, "modelLibraryDirs"       );}
 void AppData::mainWinGeo      (const QByteArray  x) { store(x, _mainWinGeo,      "mainWindowGeometry"      );}
 void AppData::mainWinState    (const QByteArray  x) { store(x, _mainWinState,    "mainWindowState"         );}
 void AppData::modelEditGeo    (const QByteArray  x) { store(x, _modelEditGeo,    "modelEditGeometry"       );}
@@ -719,6 +721,7 @@ AppData::AppData()
     getset( _tempString,      "settings_version"        ,"210" ); // This is a version marker. Will be used to upgrade the settings later on.
 
     getset( _recentFiles,     "recentFileList"          ,"" );
+    getset( _modelLibraryDirs, "modelLibraryDirs"       ,"" );
     getset( _mainWinGeo,      "mainWindowGeometry"      ,"" );
     getset( _mainWinState,    "mainWindowState"         ,"" );
     getset( _modelEditGeo,    "modelEditGeometry"       ,"" );
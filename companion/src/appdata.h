@@ -233,6 +233,7 @@ class AppData: protected CompStoreObj
 
   private:
     QStringList _recentFiles;
+    QStringList _modelLibraryDirs;
     QByteArray _mainWinGeo;
     QByteArray _mainWinState;
     QByteArray _modelEditGeo;
@@ -283,6 +284,7 @@ class AppData: protected CompStoreObj
   public:
     // All the get definitions
     QStringList recentFiles();
+    QStringList modelLibraryDirs();
     QByteArray mainWinGeo();
     QByteArray mainWinState();
     QByteArray modelEditGeo();
@@ -333,6 +335,7 @@ class AppData: protected CompStoreObj
 
     // All the set definitions
     void recentFiles     (const QStringList x);
+    void modelLibraryDirs(const QStringList x);
     void mainWinGeo      (const QByteArray);
     void mainWinState    (const QByteArray);
     void modelEditGeo    (const QByteArray);
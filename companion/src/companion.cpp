@@ -47,6 +47,7 @@
 #include <QFileInfo>
 #include <QSplashScreen>
 #include <QThread>
+#include <QElapsedTimer>
 #include <iostream>
 #if defined(JOYSTICKS) || defined(SIMU_AUDIO)
   #include <SDL.h>
@@ -55,6 +56,8 @@
 #include "mainwindow.h"
 #include "version.h"
 #include "eeprominterface.h"
+#include "modeldiff.h"
+#include "modellibrary.h"
 #include "appdata.h"
 
 #if defined WIN32 || !defined __GNUC__
@@ -79,6 +82,181 @@ class MyProxyStyle : public QProxyStyle
  };
 #endif
 
+// companion --diff <file1> <file2>, prints the structural diff of two radio files
+static int diffRadioFiles(const QString & fileName1, const QString & fileName2)
+{
+  RadioData * radio1 = new RadioData();
+  RadioData * radio2 = new RadioData();
+  int result = 2;
+
+  if (!loadRadioFile(fileName1, *radio1)) {
+    fprintf(stderr, "ERROR: couldn't load %s\n", fileName1.toLocal8Bit().constData());
+  }
+  else if (!loadRadioFile(fileName2, *radio2)) {
+    fprintf(stderr, "ERROR: couldn't load %s\n", fileName2.toLocal8Bit().constData());
+  }
+  else {
+    RadioDiff diff = diffRadios(*radio1, *radio2, GetCurrentFirmware());
+    printf("%s", diff.toString().toLocal8Bit().constData());
+    fflush(stdout);
+    result = (diff.count() > 0 ? 1 : 0);
+  }
+
+  delete radio1;
+  delete radio2;
+  return result;
+}
+
+static bool checkChanges(const char * what, const FieldChanges & changes, const QString & section)
+{
+  bool result = (section.isEmpty() ? changes.isEmpty() : !changes.isEmpty());
+  foreach(const FieldChange & change, changes) {
+    if (change.section() != section)
+      result = false;
+  }
+  printf("%s %s\n", result ? "OK  " : "FAIL", what);
+  if (!result)
+    printf("%s", printChanges(changes, "      ").toLocal8Bit().constData());
+  return result;
+}
+
+// companion --diff-test <folder>, writes radio files which differ by known fields in <folder>,
+// loads them back and checks that the diff reports those fields and nothing else
+static int testRadioDiff(const QString & folder)
+{
+  RadioData * radio = new RadioData();
+  RadioData * radio1 = new RadioData();
+  RadioData * radio2 = new RadioData();
+  QByteArray eeprom(GetEepromInterface()->getEEpromSize(), 0);
+  QString fileNames[2] = { folder + "/diff1.bin", folder + "/diff2.bin" };
+  bool result = true;
+
+  QDir().mkpath(folder);
+  for (int i=0; i<4; i++) {
+    radio->models[i].setDefaultValues(i, radio->generalSettings);
+  }
+  for (int file=0; file<2 && result; file++) {
+    if (file == 1) {
+      radio->models[0].mixData[0].weight = 50;
+      radio->models[2].limitData[1].max = -100;
+    }
+    int size = GetEepromInterface()->save((uint8_t *)eeprom.data(), *radio, GetCurrentFirmware()->getVariantNumber(), 0/*last version*/);
+    QFile output(fileNames[file]);
+    if (!size || !output.open(QIODevice::WriteOnly) || output.write(eeprom.constData(), size) != size) {
+      fprintf(stderr, "ERROR: couldn't write %s\n", fileNames[file].toLocal8Bit().constData());
+      result = false;
+    }
+  }
+
+  if (result && (!loadRadioFile(fileNames[0], *radio1) || !loadRadioFile(fileNames[1], *radio2))) {
+    fprintf(stderr, "ERROR: couldn't load the radio files back\n");
+    result = false;
+  }
+
+  if (result) {
+    RadioDiff same = diffRadios(*radio1, *radio1, GetCurrentFirmware());
+    printf("%s same file\n", same.count() == 0 ? "OK  " : "FAIL");
+    result = (same.count() == 0);
+
+    RadioDiff diff = diffRadios(*radio1, *radio2, GetCurrentFirmware());
+    result &= checkChanges("general settings unchanged", diff.generalSettings, "");
+    for (int i=0; i<diff.models.size(); i++) {
+      QString what = QString("model %1").arg(i+1);
+      if (i == 0)
+        result &= checkChanges(qPrintable(what + " mix weight"), diff.models[i], "Mix");
+      else if (i == 2)
+        result &= checkChanges(qPrintable(what + " limit max"), diff.models[i], "Limit");
+      else
+        result &= checkChanges(qPrintable(what + " unchanged"), diff.models[i], "");
+    }
+  }
+
+  delete radio;
+  delete radio1;
+  delete radio2;
+  return result ? 0 : 1;
+}
+
+// companion --library-benchmark <folder>, generates an archive of 1000 radio files in <folder>,
+// then measures the model library indexing and search times
+static int benchmarkModelLibrary(const QString & folder)
+{
+  static const char * names[] = { "Extra", "Cub", "Glider", "Heli", "Quad", "Wing", "Trainer", "Scale" };
+  static const char * queries[] = { "cub", "glider 42", "ppm", "xjt quad", "nothing" };
+  const int filesCount = 1000;
+  const int modelsCount = 8;
+
+  QDir().mkpath(folder);
+  RadioData * radioData = new RadioData();
+  QByteArray eeprom(GetEepromInterface()->getEEpromSize(), 0);
+  QElapsedTimer timer;
+
+  timer.start();
+  for (int file=0; file<filesCount; file++) {
+    for (int i=0; i<modelsCount; i++) {
+      ModelData & model = radioData->models[i];
+      model.setDefaultValues(i, radioData->generalSettings);
+      sprintf(model.name, "%s%d", names[(file+i) % (sizeof(names)/sizeof(names[0]))], file);
+      model.moduleData[0].protocol = ((file+i) % 3 == 0 ? PULSES_PPM : PULSES_PXX_XJT_X16);
+      for (int fm=1; fm<=(file+i)%4; fm++) {
+        model.flightModeData[fm].swtch = RawSwitch(SWITCH_TYPE_SWITCH, fm);
+      }
+    }
+    int size = GetEepromInterface()->save((uint8_t *)eeprom.data(), *radioData, GetCurrentFirmware()->getVariantNumber(), 0/*last version*/);
+    QFile output(QString("%1/radio%2.bin").arg(folder).arg(file, 4, 10, QChar('0')));
+    if (!size || !output.open(QIODevice::WriteOnly)) {
+      fprintf(stderr, "ERROR: couldn't write %s\n", output.fileName().toLocal8Bit().constData());
+      delete radioData;
+      return 2;
+    }
+    output.write(eeprom.constData(), size);
+  }
+  delete radioData;
+  printf("Archive: %d files generated in %lldms\n", filesCount, timer.elapsed());
+
+  ModelLibraryIndex index;
+  timer.restart();
+  int updated = index.update(QStringList() << folder);
+  printf("Full index: %d files, %d models in %lldms\n", updated, index.modelsCount(), timer.elapsed());
+
+  QString indexFile = folder + "/modellibrary.idx";
+  timer.restart();
+  index.save(indexFile);
+  ModelLibraryIndex loaded;
+  loaded.load(indexFile);
+  printf("Index save + load: %lldms\n", timer.elapsed());
+
+  timer.restart();
+  updated = loaded.update(QStringList() << folder);
+  printf("Incremental update: %d files loaded in %lldms\n", updated, timer.elapsed());
+
+  // the files are written again with the same contents, only their date changes
+  for (int file=0; file<filesCount; file+=10) {
+    QFile output(QString("%1/radio%2.bin").arg(folder).arg(file, 4, 10, QChar('0')));
+    if (output.open(QIODevice::ReadWrite)) {
+      QByteArray data = output.readAll();
+      output.seek(0);
+      output.write(data);
+    }
+  }
+  timer.restart();
+  updated = loaded.update(QStringList() << folder);
+  printf("Touched files update: %d files checked in %lldms\n", updated, timer.elapsed());
+
+  for (unsigned int i=0; i<sizeof(queries)/sizeof(queries[0]); i++) {
+    const int count = 100;
+    int found = 0;
+    timer.restart();
+    for (int j=0; j<count; j++) {
+      found = loaded.search(queries[i]).size();
+    }
+    printf("Search \"%s\": %d models in %.3fms\n", queries[i], found, timer.nsecsElapsed() / 1000000.0 / count);
+  }
+
+  fflush(stdout);
+  return 0;
+}
+
 int main(int argc, char *argv[])
 {
   Q_INIT_RESOURCE(companion);
@@ -130,6 +308,33 @@ int main(int argc, char *argv[])
     g.profile[g.id()].fwName("");
   }
 
+  int diffIndex = strl.indexOf("--diff");
+  if (diffIndex >= 0) {
+    if (diffIndex+2 >= strl.size()) {
+      fprintf(stderr, "Usage: companion --diff <file1> <file2>\n");
+      return 2;
+    }
+    return diffRadioFiles(strl[diffIndex+1], strl[diffIndex+2]);
+  }
+
+  int diffTestIndex = strl.indexOf("--diff-test");
+  if (diffTestIndex >= 0) {
+    if (diffTestIndex+1 >= strl.size()) {
+      fprintf(stderr, "Usage: companion --diff-test <folder>\n");
+      return 2;
+    }
+    return testRadioDiff(strl[diffTestIndex+1]);
+  }
+
+  int benchmarkIndex = strl.indexOf("--library-benchmark");
+  if (benchmarkIndex >= 0) {
+    if (benchmarkIndex+1 >= strl.size()) {
+      fprintf(stderr, "Usage: companion --library-benchmark <folder>\n");
+      return 2;
+    }
+    return benchmarkModelLibrary(strl[benchmarkIndex+1]);
+  }
+
   QString splashScreen;
   if ( g.profile[g.id()].fwType().contains("taranis"))     splashScreen = ":/images/splash-taranis.png";
   else if ( g.profile[g.id()].fwType().contains("9xrpro")) splashScreen = ":/images/splash-9xrpro.png";
@@ -21,6 +21,17 @@
 
 #define DIM(arr) (sizeof((arr))/sizeof((arr)[0]))
 
+class DataField;
+
+// Visits the leaves of a field tree in export order, used for the structural diff
+class DataFieldWalker {
+  public:
+    virtual ~DataFieldWalker() { }
+    virtual void enter(DataField * field) = 0;
+    virtual void leave(DataField * field) = 0;
+    virtual void visit(DataField * field) = 0;
+};
+
 class DataField {
   public:
     DataField(const char *name=""):
@@ -33,6 +44,28 @@ class DataField {
     virtual void ImportBits(QBitArray & input) = 0;
     virtual unsigned int size() = 0;
 
+    virtual void Walk(DataFieldWalker & walker)
+    {
+      walker.visit(this);
+    }
+
+    virtual QString getValue()
+    {
+      QBitArray bits;
+      ExportBits(bits);
+      if (bits.count() <= 32) {
+        unsigned int value = 0;
+        for (int i=0; i<bits.count(); i++) {
+          if (bits[i])
+            value |= (1u<<i);
+        }
+        return QString::number(value);
+      }
+      else {
+        return QString(bitsToBytes(bits).toHex());
+      }
+    }
+
     QBitArray bytesToBits(QByteArray bytes)
     {
       QBitArray bits(bytes.count()*8);
@@ -193,8 +226,8 @@ class UnsignedField : public BaseUnsignedField<unsigned int, N>
 template<int N>
 class BoolField: public DataField {
   public:
-    explicit BoolField(bool & field):
-      DataField("Bool"),
+    explicit BoolField(bool & field, const char *name="Bool"):
+      DataField(name),
       field(field)
     {
     }
@@ -218,6 +251,11 @@ class BoolField: public DataField {
       return N;
     }
 
+    virtual QString getValue()
+    {
+      return field ? "1" : "0";
+    }
+
   protected:
     bool & field;
 
@@ -288,6 +326,11 @@ class SignedField: public DataField {
       return N;
     }
 
+    virtual QString getValue()
+    {
+      return QString::number(field < min ? min : (field > max ? max : field));
+    }
+
   protected:
     int & field;
     int min;
@@ -349,6 +392,11 @@ class CharField: public DataField {
       return 8*N;
     }
 
+    virtual QString getValue()
+    {
+      return QString("\"%1\"").arg(QString::fromLatin1(field, qstrnlen(field, N)));
+    }
+
   protected:
     char * field;
     bool truncate;
@@ -360,8 +408,8 @@ char idx2char(int8_t idx);
 template<int N>
 class ZCharField: public DataField {
   public:
-    ZCharField(char *field):
-      DataField("ZChar"),
+    ZCharField(char *field, const char *name="ZChar"):
+      DataField(name),
       field(field)
     {
     }
@@ -407,6 +455,11 @@ class ZCharField: public DataField {
       return 8*N;
     }
 
+    virtual QString getValue()
+    {
+      return QString("\"%1\"").arg(QString::fromLatin1(field, qstrnlen(field, N)));
+    }
+
   protected:
     char * field;
 };
@@ -474,6 +527,15 @@ class StructField: public DataField {
       return offset;
     }
 
+    virtual void Walk(DataFieldWalker & walker)
+    {
+      walker.enter(this);
+      foreach(DataField *field, fields) {
+        field->Walk(walker);
+      }
+      walker.leave(this);
+    }
+
   protected:
     QList<DataField *> fields;
 };
@@ -524,6 +586,12 @@ class TransformedField: public DataField {
       return field.Dump(level, offset);
     }
 
+    virtual void Walk(DataFieldWalker & walker)
+    {
+      beforeExport();
+      field.Walk(walker);
+    }
+
   protected:
     DataField & field;
 };
@@ -691,7 +759,7 @@ class ConversionField: public TransformedField {
         if (table->exportValue(_field, _field))
           return;
         if (!error.isEmpty())
-          EEPROMWarnings.push_back(error);
+          addEEPROMWarning(error);
       }
 
       if (shift) {
@@ -728,6 +796,18 @@ class ConversionField: public TransformedField {
       eepromImportDebug() << QString("\timported ConversionField<%1>:").arg(internalField.getName()) << QString(" before: %1, after: %2").arg(_field).arg(field);
     }
 
+    // the diff reports the value as seen by the user, not the converted one
+    virtual void Walk(DataFieldWalker & walker)
+    {
+      beforeExport();
+      walker.visit(this);
+    }
+
+    virtual QString getValue()
+    {
+      return QString::number(field);
+    }
+
   protected:
     T internalField;
     int & field;
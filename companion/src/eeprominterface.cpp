@@ -13,7 +13,29 @@
 #include "wizarddata.h"
 #include "firmwareinterface.h"
 
-std::list<QString> EEPROMWarnings;
+static std::list<QString> EEPROMWarnings;
+static QMutex EEPROMWarningsMutex;
+QMutex EEPROMInterfaceMutex(QMutex::Recursive);
+
+void addEEPROMWarning(const QString & warning)
+{
+  QMutexLocker locker(&EEPROMWarningsMutex);
+  EEPROMWarnings.push_back(warning);
+}
+
+void clearEEPROMWarnings()
+{
+  QMutexLocker locker(&EEPROMWarningsMutex);
+  EEPROMWarnings.clear();
+}
+
+std::list<QString> takeEEPROMWarnings()
+{
+  QMutexLocker locker(&EEPROMWarningsMutex);
+  std::list<QString> result;
+  result.swap(EEPROMWarnings);
+  return result;
+}
 
 const char * switches9X[] = { "3POS", "THR", "RUD", "ELE", "AIL", "GEA", "TRN" };
 const char * switchesX9D[] = { "SA", "SB", "SC", "SD", "SE", "SF", "SG", "SH", "SI", "SJ", "SK", "SL", "SM", "SN", "SO", "SP", "SQ", "SR" };
@@ -1734,6 +1756,7 @@ void ShowEepromWarnings(QWidget *parent, const QString &title, unsigned long err
 
 unsigned long LoadEeprom(RadioData &radioData, const uint8_t *eeprom, const int size)
 {
+  QMutexLocker locker(&EEPROMInterfaceMutex);
   std::bitset<NUM_ERRORS> errors;
 
   foreach(EEPROMInterface *eepromInterface, eepromInterfaces) {
@@ -1754,6 +1777,7 @@ unsigned long LoadEeprom(RadioData &radioData, const uint8_t *eeprom, const int
 
 unsigned long LoadBackup(RadioData & radioData, uint8_t * eeprom, int size, int index)
 {
+  QMutexLocker locker(&EEPROMInterfaceMutex);
   std::bitset<NUM_ERRORS> errors;
 
   foreach(EEPROMInterface *eepromInterface, eepromInterfaces) {
@@ -1775,6 +1799,7 @@ unsigned long LoadBackup(RadioData & radioData, uint8_t * eeprom, int size, int
 
 unsigned long LoadEepromXml(RadioData & radioData, QDomDocument & doc)
 {
+  QMutexLocker locker(&EEPROMInterfaceMutex);
   std::bitset<NUM_ERRORS> errors;
 
   foreach(EEPROMInterface *eepromInterface, eepromInterfaces) {
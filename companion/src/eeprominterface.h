@@ -21,6 +21,7 @@
 #include <QString>
 #include <QStringList>
 #include <QList>
+#include <QMutex>
 #include <QtXml>
 #include <QComboBox>
 #include <iostream>
@@ -1177,6 +1178,7 @@ class GeneralSettings {
     int       timezone;
     bool      adjustRTC;
     bool      optrexDisplay;
+    unsigned int analogFilter;
     unsigned int    inactivityTimer;
     bool      minuteBeep;
     bool      preBeep;
@@ -1394,8 +1396,26 @@ class EEPROMInterface
 
     virtual int save(uint8_t *eeprom, RadioData &radioData, uint32_t variant=0, uint8_t version=0) = 0;
 
+    // the general settings and a single model saved as model 0, the image given to the simulator
+    virtual int saveSimulation(uint8_t *eeprom, const GeneralSettings &generalSettings, const ModelData &model, uint32_t variant=0)
+    {
+      RadioData * radioData = new RadioData();
+      radioData->generalSettings = generalSettings;
+      radioData->generalSettings.currModel = 0;
+      radioData->models[0] = model;
+      int result = save(eeprom, *radioData, variant);
+      delete radioData;
+      return result;
+    }
+
     virtual int getSize(const ModelData &) = 0;
 
+    // the model as the firmware stores it, empty when the interface can't export it
+    virtual QByteArray exportModel(const ModelData &)
+    {
+      return QByteArray();
+    }
+
     virtual int getSize(const GeneralSettings &) = 0;
 
     virtual const int getEEpromSize() = 0;
@@ -1412,7 +1432,15 @@ class EEPROMInterface
 
 };
 
-extern std::list<QString> EEPROMWarnings;
+// thread safe, the models export may run in parallel (see modeldiff.cpp) and the
+// model library indexer loads files from another thread
+void addEEPROMWarning(const QString & warning);
+void clearEEPROMWarnings();
+// returns the warnings added since the last clear, and clears them
+std::list<QString> takeEEPROMWarnings();
+// the EEPROMInterface objects keep a state between calls (the eeprom file system),
+// the model library indexer loads files from another thread
+extern QMutex EEPROMInterfaceMutex;
 
 /* EEPROM string conversion functions */
 void setEEPROMString(char *dst, const char *src, int size);
@@ -316,10 +316,14 @@ unsigned int RleFile::openRd(unsigned int i_fileId)
     m_zeroes   = 0;
     m_bRlc     = 0;
     m_err      = ERR_NONE;       //error reasons
-    if (IS_ARM(board))
+    if (IS_ARM(board)) {
+      m_lz     = (eeFsArm->files[m_fileId].typ & FILE_TYP_LZ);
       return eeFsArm->files[m_fileId].typ;
-    else
+    }
+    else {
+      m_lz     = false;
       return eeFs->files[m_fileId].typ;
+    }
   }
 }
 
@@ -363,6 +367,15 @@ unsigned int RleFile::readRlc12(uint8_t *buf, unsigned int i_len, bool rlc2)
     }
     return len;
   }
+  else if (m_lz) {
+    // the whole file is decoded at once, the matches refer to what is before
+    QByteArray src(size(m_fileId) - m_pos, 0);
+    src.resize(read((uint8_t *)src.data(), src.size()));
+    QByteArray dst;
+    importLz(dst, src, i_len);
+    memcpy(buf, dst.constData(), dst.size());
+    return dst.size();
+  }
   else {
     unsigned int i=0;
     for( ; 1; ) {
@@ -458,6 +471,124 @@ unsigned int importRlc(QByteArray & dst, QByteArray & src, unsigned int rlcVersi
   return dst.size();
 }
 
+unsigned int importLz(QByteArray & dst, const QByteArray & src, unsigned int maxSize)
+{
+  const uint8_t * buf = (const uint8_t *)src.constData();
+  unsigned int len = src.size();
+  unsigned int pos = 0;
+
+  dst.resize(0);
+
+  while (pos < len && (unsigned int)dst.size() < maxSize) {
+    uint8_t token = buf[pos++];
+    if (!(token & LZ_ZEROES)) {
+      unsigned int count = std::min<unsigned int>(token+1, len-pos);
+      dst.append((const char *)&buf[pos], count);
+      pos += count;
+    }
+    else if ((token & LZ_MATCH) == LZ_ZEROES) {
+      unsigned int count = (token & 0x3F) + 1;
+      if (token == LZ_ZEROES_LONG) {
+        if (pos == len)
+          break;
+        count = 64 + buf[pos++];
+      }
+      dst.append(QByteArray(count, 0));
+    }
+    else {
+      if (pos == len || buf[pos] >= (unsigned int)dst.size()) {
+        qDebug() << "LZ decoding error!";
+        break;
+      }
+      unsigned int from = dst.size() - buf[pos++] - 1;
+      unsigned int count = (token & 0x3F) + LZ_MATCH_MIN;
+      // byte per byte, the match may overlap what it writes
+      for (unsigned int i=0; i<count; i++) {
+        dst.append(dst.at(from+i));
+      }
+    }
+  }
+
+  if ((unsigned int)dst.size() > maxSize)
+    dst.resize(maxSize);
+  return dst.size();
+}
+
+static unsigned int lzCountZeroes(const uint8_t * src, unsigned int len)
+{
+  unsigned int max = std::min<unsigned int>(len, LZ_ZEROES_MAX);
+  unsigned int count = 0;
+  while (count < max && src[count] == 0)
+    count++;
+  return count;
+}
+
+static unsigned int lzFindMatch(const uint8_t * start, const uint8_t * src, unsigned int len, unsigned int & distance)
+{
+  unsigned int window = std::min<unsigned int>(src - start, LZ_WINDOW);
+  unsigned int max = std::min<unsigned int>(len, LZ_MATCH_MAX);
+  unsigned int best = 0;
+  for (unsigned int d=1; d<=window; d++) {
+    const uint8_t * ref = src - d;
+    if (ref[best] != src[best])
+      continue;
+    unsigned int count = 0;
+    while (count < max && ref[count] == src[count])
+      count++;
+    if (count > best) {
+      best = count;
+      distance = d - 1;
+      if (best == max)
+        break;
+    }
+  }
+  return best;
+}
+
+// Same greedy choices as the radio, both produce the same files
+QByteArray exportLz(const uint8_t * buf, unsigned int len)
+{
+  QByteArray result;
+  const uint8_t * src = buf;
+
+  while (len > 0) {
+    unsigned int distance = 0;
+    unsigned int zeroes = lzCountZeroes(src, len);
+    unsigned int match = lzFindMatch(buf, src, len, distance);
+    if (zeroes >= 2 && zeroes >= match) {
+      if (zeroes < 64) {
+        result.append((char)(LZ_ZEROES | (zeroes-1)));
+      }
+      else {
+        result.append((char)LZ_ZEROES_LONG);
+        result.append((char)(zeroes - 64));
+      }
+      src += zeroes;
+      len -= zeroes;
+    }
+    else if (match >= LZ_MATCH_MIN) {
+      result.append((char)(LZ_MATCH | (match-LZ_MATCH_MIN)));
+      result.append((char)distance);
+      src += match;
+      len -= match;
+    }
+    else {
+      unsigned int count = 1;
+      while (count < LZ_LITERAL_MAX && count < len) {
+        if (lzCountZeroes(src+count, len-count) >= 2 || lzFindMatch(buf, src+count, len-count, distance) >= LZ_MATCH_MIN)
+          break;
+        count++;
+      }
+      result.append((char)(count-1));
+      result.append((const char *)src, count);
+      src += count;
+      len -= count;
+    }
+  }
+
+  return result;
+}
+
 unsigned int RleFile::write1(uint8_t b)
 {
   return write(&b, 1);
@@ -595,6 +726,9 @@ unsigned int RleFile::writeRlc2(unsigned int i_fileId, unsigned int typ, const u
     }
     return i_len;
   }
+  else if (typ & FILE_TYP_LZ) {
+    return writeLz(i_fileId, typ, buf, i_len);
+  }
   else {
     create(i_fileId, typ);
     bool    run0   = buf[0] == 0;
@@ -646,6 +780,18 @@ unsigned int RleFile::writeRlc2(unsigned int i_fileId, unsigned int typ, const u
   }
 }
 
+/*
+ * Write LZ compressed bytes, only on ARM boards
+ */
+unsigned int RleFile::writeLz(unsigned int i_fileId, unsigned int typ, const uint8_t *buf, unsigned int i_len)
+{
+  create(i_fileId, typ);
+  QByteArray data = exportLz(buf, i_len);
+  unsigned int written = write((const uint8_t *)data.constData(), data.size());
+  closeTrunc();
+  return (written == (unsigned int)data.size()) ? i_len : 0;
+}
+
 uint8_t RleFile::byte_checksum( uint8_t *p, unsigned int size )
 {
         uint32_t csum ;
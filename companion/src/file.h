@@ -24,6 +24,18 @@
 #define ERR_FULL 1
 #define ERR_TMO  2
 
+#define FILE_TYP_LZ      0x08 // flag, the file is LZ encoded instead of RLC encoded
+
+// LZ encoding, same as the radio one (see radio/src/eeprom_rlc.h)
+#define LZ_LITERAL_MAX   128
+#define LZ_ZEROES        0x80
+#define LZ_ZEROES_LONG   0xBF
+#define LZ_ZEROES_MAX    (64+255)
+#define LZ_MATCH         0xC0
+#define LZ_MATCH_MIN     3
+#define LZ_MATCH_MAX     (LZ_MATCH_MIN+0x3F)
+#define LZ_WINDOW        256
+
 PACK(struct DirEnt {
   uint8_t  startBlk;
   uint16_t size:12;
@@ -82,6 +94,7 @@ class RleFile
   unsigned int  m_ofs;       //offset inside of the current block
   uint8_t       m_zeroes;    //control byte for run length decoder
   uint8_t       m_bRlc;      //control byte for run length decoder
+  bool          m_lz;        //LZ encoded file
   unsigned int  m_err;       //error reasons
   uint16_t      m_size;
 
@@ -140,6 +153,7 @@ public:
   ///If file was larger before, then unused blocks are freed
   unsigned int writeRlc1(unsigned int i_fileId, unsigned int typ, const uint8_t *buf, unsigned int i_len);
   unsigned int writeRlc2(unsigned int i_fileId, unsigned int typ, const uint8_t *buf, unsigned int i_len);
+  unsigned int writeLz(unsigned int i_fileId, unsigned int typ, const uint8_t *buf, unsigned int i_len);
 
   unsigned int read(uint8_t *buf, unsigned int i_len);
   unsigned int write1(uint8_t b);
@@ -164,5 +178,7 @@ public:
 };
 
 unsigned int importRlc(QByteArray & dst, QByteArray & src, unsigned int rlcVersion=2);
+unsigned int importLz(QByteArray & dst, const QByteArray & src, unsigned int maxSize);
+QByteArray exportLz(const uint8_t * buf, unsigned int len);
 
 #endif
@@ -415,6 +415,11 @@ class SwitchField: public ConversionField< SignedField<N> > {
       eepromImportDebug() << QString("imported %1: %2").arg(ConversionField< SignedField<N> >::internalField.getName()).arg(sw.toString());
     }    
     
+    virtual QString getValue()
+    {
+      return sw.toString();
+    }
+
   protected:
     RawSwitch & sw;
     int _switch;
@@ -540,6 +545,11 @@ class TelemetrySourceField: public ConversionField< UnsignedField<N> > {
       eepromImportDebug() << QString("imported %1: %2").arg(ConversionField< UnsignedField<N> >::internalField.getName()).arg(source.toString());
     }
 
+    virtual QString getValue()
+    {
+      return source.toString();
+    }
+
   protected:
     TelemetrySourcesConversionTable conversionTable;
     RawSource & source;
@@ -576,6 +586,11 @@ class SourceField: public ConversionField< UnsignedField<N> > {
       eepromImportDebug() << QString("imported %1: %2").arg(ConversionField< UnsignedField<N> >::internalField.getName()).arg(source.toString());
     }    
 
+    virtual QString getValue()
+    {
+      return source.toString();
+    }
+
   protected:
     RawSource & source;
     unsigned int _source;
@@ -1456,14 +1471,14 @@ class CurvesField: public TransformedField {
         if (IS_TARANIS(board) && version >= 216) {
           offset += (curve->type == CurveData::CURVE_TYPE_CUSTOM ? curve->count * 2 - 2 : curve->count);
           if (offset > maxPoints) {
-            EEPROMWarnings.push_back(::QObject::tr("OpenTX only accepts %1 points in all curves").arg(maxPoints));
+            addEEPROMWarning(::QObject::tr("OpenTX only accepts %1 points in all curves").arg(maxPoints));
             break;
           }
         }
         else {
           offset += (curve->type == CurveData::CURVE_TYPE_CUSTOM ? curve->count * 2 - 2 : curve->count) - 5;
           if (offset > maxPoints - 5 * maxCurves) {
-            EEPROMWarnings.push_back(::QObject::tr("OpenTx only accepts %1 points in all curves").arg(maxPoints));
+            addEEPROMWarning(::QObject::tr("OpenTx only accepts %1 points in all curves").arg(maxPoints));
             break;
           }
           _curves[i] = offset;
@@ -2960,7 +2975,7 @@ OpenTxModelData::OpenTxModelData(ModelData & modelData, BoardEnum board, unsigne
   if (IS_ARM(board) && version >= 217) {
     internalField.Append(new BoolField<1>(modelData.noGlobalFunctions));
     internalField.Append(new UnsignedField<2>(modelData.trimsDisplay));
-    internalField.Append(new BoolField<1>(modelData.frsky.ignoreSensorIds));
+    internalField.Append(new BoolField<1>(modelData.frsky.ignoreSensorIds, "IgnoreSensorIds"));
   }
   else if (IS_TARANIS(board) || (IS_ARM(board) && version >= 216)) {
     internalField.Append(new SpareBitsField<4>());
@@ -3045,9 +3060,9 @@ OpenTxModelData::OpenTxModelData(ModelData & modelData, BoardEnum board, unsigne
 
   if (board != BOARD_STOCK && (board != BOARD_M128 || version < 215)) {
     for (int i=0; i<MAX_GVARS(board, version); i++) {
-      internalField.Append(new ZCharField<6>(modelData.gvars_names[i]));
+      internalField.Append(new ZCharField<6>(modelData.gvars_names[i], "GVarName"));
       if (version >= 216) {
-        internalField.Append(new BoolField<1>(modelData.gvars_popups[i]));
+        internalField.Append(new BoolField<1>(modelData.gvars_popups[i], "GVarPopup"));
         internalField.Append(new SpareBitsField<7>());
       }
     }
@@ -3124,7 +3139,7 @@ OpenTxModelData::OpenTxModelData(ModelData & modelData, BoardEnum board, unsigne
 
   if (IS_TARANIS(board)) {
     for (int i=0; i<MAX_CURVES(board, version); i++) {
-      internalField.Append(new ZCharField<6>(modelData.curves[i].name));
+      internalField.Append(new ZCharField<6>(modelData.curves[i].name, "CurveName"));
     }
   }
 
@@ -3153,7 +3168,7 @@ OpenTxModelData::OpenTxModelData(ModelData & modelData, BoardEnum board, unsigne
   
   if (IS_TARANIS(board) && version >= 216) {
     for (int i=0; i<32; i++) {
-      internalField.Append(new ZCharField<4>(modelData.inputNames[i]));
+      internalField.Append(new ZCharField<4>(modelData.inputNames[i], "InputName"));
     }
   }
   
@@ -3387,7 +3402,10 @@ OpenTxGeneralData::OpenTxGeneralData(GeneralSettings & generalData, BoardEnum bo
       internalField.Append(new UnsignedField<32>(generalData.globalTimer));
       internalField.Append(new SignedField<8>(generalData.temperatureCalib)); // TODO
       internalField.Append(new UnsignedField<8>(generalData.btBaudrate)); // TODO
-      internalField.Append(new BoolField<8>(generalData.optrexDisplay)); //TODO
+      internalField.Append(new BoolField<1>(generalData.optrexDisplay)); //TODO
+      internalField.Append(new SpareBitsField<1>()); // jitterFilter TODO
+      internalField.Append(new UnsignedField<2>(generalData.analogFilter));
+      internalField.Append(new SpareBitsField<4>());
       internalField.Append(new UnsignedField<8>(generalData.sticksGain)); // TODO
     }
     if (version >= 214) {
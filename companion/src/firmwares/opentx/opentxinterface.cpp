@@ -29,6 +29,9 @@
 #define FILE_TYP_GENERAL 1
 #define FILE_TYP_MODEL   2
 
+// the Taranis firmware writes its files LZ encoded since the EEPROM v218, it reads both encodings
+#define FILE_TYP_ENCODING(board, version) ((IS_TARANIS(board) && version >= 218) ? FILE_TYP_LZ : 0)
+
 /// fileId of general file
 #define FILE_GENERAL   0
 /// convert model number 0..MAX_MODELS-1  int fileId
@@ -292,7 +295,7 @@ bool OpenTxEepromInterface::saveGeneral(GeneralSettings &settings, BoardEnum boa
   // open9xSettings.Dump();
   QByteArray eeprom;
   open9xSettings.Export(eeprom);
-  int sz = efile->writeRlc2(FILE_GENERAL, FILE_TYP_GENERAL, (const uint8_t*)eeprom.constData(), eeprom.size());
+  int sz = efile->writeRlc2(FILE_GENERAL, FILE_TYP_GENERAL|FILE_TYP_ENCODING(board, version), (const uint8_t*)eeprom.constData(), eeprom.size());
   return (sz == eeprom.size());
 }
 
@@ -303,7 +306,7 @@ bool OpenTxEepromInterface::saveModel(unsigned int index, ModelData &model, unsi
   // open9xModel.Dump();
   QByteArray eeprom;
   open9xModel.Export(eeprom);
-  int sz = efile->writeRlc2(FILE_MODEL(index), FILE_TYP_MODEL, (const uint8_t*)eeprom.constData(), eeprom.size());
+  int sz = efile->writeRlc2(FILE_MODEL(index), FILE_TYP_MODEL|FILE_TYP_ENCODING(board, version), (const uint8_t*)eeprom.constData(), eeprom.size());
   return (sz == eeprom.size());
 }
 
@@ -393,13 +396,31 @@ unsigned long OpenTxEepromInterface::load(RadioData &radioData, const uint8_t *e
 
 int OpenTxEepromInterface::save(uint8_t *eeprom, RadioData &radioData, uint32_t variant, uint8_t version)
 {
-  EEPROMWarnings.clear();
+  return save(eeprom, radioData.generalSettings, radioData.models, getMaxModels(), variant, version);
+}
+
+// only the general settings and this model are built, not the other model slots
+int OpenTxEepromInterface::saveSimulation(uint8_t *eeprom, const GeneralSettings &generalSettings, const ModelData &model, uint32_t variant)
+{
+  GeneralSettings settings = generalSettings;
+  settings.currModel = 0;
+  ModelData simulated = model;
+  return save(eeprom, settings, &simulated, 1, variant, 0);
+}
+
+int OpenTxEepromInterface::save(uint8_t *eeprom, GeneralSettings &generalSettings, ModelData *models, int count, uint32_t variant, uint8_t version)
+{
+  QMutexLocker locker(&EEPROMInterfaceMutex);
+
+  clearEEPROMWarnings();
 
   if (!version) {
     switch(board) {
       case BOARD_TARANIS:
       case BOARD_TARANIS_PLUS:
       case BOARD_TARANIS_X9E:
+        version = 218;
+        break;
       case BOARD_SKY9X:
       case BOARD_AR9X:
       case BOARD_9XRPRO:
@@ -429,31 +450,31 @@ int OpenTxEepromInterface::save(uint8_t *eeprom, RadioData &radioData, uint32_t
     variant |= TARANIS_X9E_VARIANT;
   }
 
-  int result = saveGeneral<OpenTxGeneralData>(radioData.generalSettings, board, version, variant);
+  int result = saveGeneral<OpenTxGeneralData>(generalSettings, board, version, variant);
   if (!result) {
     return 0;
   }
 
-  for (int i=0; i<getMaxModels(); i++) {
-    if (!radioData.models[i].isEmpty()) {
-      result = saveModel<OpenTxModelData>(i, radioData.models[i], version, variant);
+  for (int i=0; i<count; i++) {
+    if (!models[i].isEmpty()) {
+      result = saveModel<OpenTxModelData>(i, models[i], version, variant);
       if (!result) {
         return 0;
       }
     }
   }
 
-  if (!EEPROMWarnings.empty()) {
+  std::list<QString> warnings = takeEEPROMWarnings();
+  if (!warnings.empty()) {
     QString msg;
-    int noErrorsToDisplay = std::min((int)EEPROMWarnings.size(),10);
+    int noErrorsToDisplay = std::min((int)warnings.size(),10);
     for (int n = 0; n < noErrorsToDisplay; n++) {
-      msg += "-" + EEPROMWarnings.front() + "\n";
-      EEPROMWarnings.pop_front();
+      msg += "-" + warnings.front() + "\n";
+      warnings.pop_front();
     }
-    if (!EEPROMWarnings.empty()) {
+    if (!warnings.empty()) {
       msg = QObject::tr("(displaying only first 10 warnings)") + "\n" + msg;
     }
-    EEPROMWarnings.clear();
     QMessageBox::warning(NULL,
         QObject::tr("Warning"),
         QObject::tr("EEPROM saved with these warnings:") + "\n" + msg);
@@ -464,6 +485,8 @@ int OpenTxEepromInterface::save(uint8_t *eeprom, RadioData &radioData, uint32_t
 
 int OpenTxEepromInterface::getSize(const ModelData & model)
 {
+  QMutexLocker locker(&EEPROMInterfaceMutex);
+
   if (IS_SKY9X(board))
     return 0;
 
@@ -477,15 +500,29 @@ int OpenTxEepromInterface::getSize(const ModelData & model)
 
   QByteArray eeprom;
   open9xModel.Export(eeprom);
-  int sz = efile->writeRlc2(0, FILE_TYP_MODEL, (const uint8_t*)eeprom.constData(), eeprom.size());
+  int sz = efile->writeRlc2(0, FILE_TYP_MODEL|FILE_TYP_ENCODING(board, 255/*version max*/), (const uint8_t*)eeprom.constData(), eeprom.size());
   if (sz != eeprom.size()) {
     return -1;
   }
   return efile->size(0);
 }
 
+QByteArray OpenTxEepromInterface::exportModel(const ModelData & model)
+{
+  QMutexLocker locker(&EEPROMInterfaceMutex);
+
+  QByteArray result;
+  if (!IS_SKY9X(board) && !model.isEmpty()) {
+    OpenTxModelData open9xModel((ModelData &)model, board, 255/*version max*/, GetCurrentFirmware()->getVariantNumber());
+    open9xModel.Export(result);
+  }
+  return result;
+}
+
 int OpenTxEepromInterface::getSize(const GeneralSettings & settings)
 {
+  QMutexLocker locker(&EEPROMInterfaceMutex);
+
   if (IS_SKY9X(board))
     return 0;
 
@@ -497,7 +534,7 @@ int OpenTxEepromInterface::getSize(const GeneralSettings & settings)
 
   QByteArray eeprom;
   open9xGeneral.Export(eeprom);
-  int sz = efile->writeRlc2(0, FILE_TYP_GENERAL, (const uint8_t*)eeprom.constData(), eeprom.size());
+  int sz = efile->writeRlc2(0, FILE_TYP_GENERAL|FILE_TYP_ENCODING(board, 255/*version max*/), (const uint8_t*)eeprom.constData(), eeprom.size());
   if (sz != eeprom.size()) {
     return -1;
   }
@@ -970,6 +1007,10 @@ EepromLoadErrors OpenTxEepromInterface::checkVersion(unsigned int version)
       break;
     case 217:
       // 3 logical switches removed on M128 / gruvin9x boards
+    case 218:
+      // Taranis files LZ encoded
+      if (!IS_TARANIS(board))
+        return NOT_OPENTX;
       break;
     default:
       return NOT_OPENTX;
@@ -1076,6 +1117,19 @@ unsigned long OpenTxEepromInterface::loadBackup(RadioData &radioData, uint8_t *e
       return errors.to_ulong();
     }
   }
+  else if (bcktype=='L' && IS_TARANIS(board) && version >= 218) {
+    // LZ encoded model, only written by the Taranis firmware
+    QByteArray modelData;
+    ModelData & model = radioData.models[index];
+    OpenTxModelData open9xModel(model, board, version, variant);
+    if (!importLz(modelData, QByteArray((char *)&eeprom[8], size), sizeof(ModelData))) {
+      std::cout << " ko\n";
+      errors.set(UNKNOWN_ERROR);
+      return errors.to_ulong();
+    }
+    open9xModel.Import(modelData);
+    model.used = true;
+  }
   else {
     std::cout << " backup type not supported\n";
     errors.set(BACKUP_NOT_SUPPORTED);
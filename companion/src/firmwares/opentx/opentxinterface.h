@@ -41,8 +41,12 @@ class OpenTxEepromInterface : public EEPROMInterface
 
     virtual int save(uint8_t *eeprom, RadioData &radioData, uint32_t variant=0, uint8_t version=0);
 
+    virtual int saveSimulation(uint8_t *eeprom, const GeneralSettings &generalSettings, const ModelData &model, uint32_t variant=0);
+
     virtual int getSize(const ModelData &);
 
+    virtual QByteArray exportModel(const ModelData &);
+
     virtual int getSize(const GeneralSettings &);
 
   protected:
@@ -53,6 +57,8 @@ class OpenTxEepromInterface : public EEPROMInterface
 
     bool checkVariant(unsigned int version, unsigned int variant);
 
+    int save(uint8_t *eeprom, GeneralSettings &generalSettings, ModelData *models, int count, uint32_t variant, uint8_t version);
+
     template <class T>
     bool loadModel(ModelData &model, uint8_t *data, int index, unsigned int stickMode=0);
 
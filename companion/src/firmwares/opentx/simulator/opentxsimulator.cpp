@@ -79,6 +79,7 @@
 
 // some C++ headers must be included outside the custom namespace (fails to compile in gcc-6)
 #include <math.h>
+#include <chrono>
 
 namespace NAMESPACE {
 
@@ -93,6 +94,8 @@ namespace NAMESPACE {
 #include "radio/src/telemetry/telemetry.cpp"
 #include "radio/src/telemetry/frsky_sport.cpp"
 #include "radio/src/sbus.cpp"
+#include "radio/src/profiler.cpp"
+#include "radio/src/analogs.cpp"
 #include "radio/src/crc16.cpp"
 #else
 #include "radio/src/main_avr.cpp"
@@ -265,6 +268,7 @@ namespace NAMESPACE {
 #include "radio/src/telemetry/frsky.cpp"
 #if defined(CPUARM)
   #include "radio/src/telemetry/frsky_d_arm.cpp"
+  #include "radio/src/telemetry/stream.cpp"
 #else
   #include "radio/src/telemetry/frsky_d.cpp"
 #endif
@@ -362,7 +366,8 @@ void delay_01us(::uint16_t nb)
 {
 }
 
-OpenTxSimulator::OpenTxSimulator()
+OpenTxSimulator::OpenTxSimulator():
+  changesEnabled(true)
 {
 }
 
@@ -383,6 +388,8 @@ bool OpenTxSimulator::timer10ms()
 {
 #define TIMER10MS_IMPORT
 #include "simulatorimport.h"
+  publishChanges();
+  return true;
 }
 
 ::uint8_t * OpenTxSimulator::getLcd()
@@ -412,6 +419,10 @@ void OpenTxSimulator::start(const char * filename, bool tests)
   g_rotenc[1] = 0;
 #endif
 
+  changes.clear();
+  changesTimer = 0;
+  changesValid = false;
+
   StartEepromThread(filename);
   StartAudioThread(volumeGain);
   StartMainThread(tests);
@@ -466,6 +477,86 @@ void OpenTxSimulator::getTrims(Trims & trims)
   }
 }
 
+#define CHANGES_PERIOD 5 // 50ms, the LCD is checked every 10ms
+
+void OpenTxSimulator::publishChanges()
+{
+  if (!changesEnabled)
+    return;
+
+  bool lightEnable;
+  if (lcdChanged(lightEnable)) {
+    changes.push(SIMULATOR_CHANGE_LCD, 0, lightEnable);
+  }
+
+  if (changesTimer++ % CHANGES_PERIOD)
+    return;
+
+  TxOutputs outputs;
+  getValues(outputs);
+  for (int i=0; i<NUM_CHNOUT && i<C9X_NUM_CHNOUT; i++) {
+    if (!changesValid || outputs.chans[i] != lastOutputs.chans[i])
+      changes.push(SIMULATOR_CHANGE_CHANNEL, i, outputs.chans[i]);
+  }
+  for (int i=0; i<NUM_LOGICAL_SWITCH && i<C9X_NUM_CSW; i++) {
+    if (!changesValid || outputs.vsw[i] != lastOutputs.vsw[i])
+      changes.push(SIMULATOR_CHANGE_LOGICAL_SWITCH, i, outputs.vsw[i]);
+  }
+  for (int fm=0; fm<C9X_MAX_FLIGHT_MODES; fm++) {
+    for (int gv=0; gv<C9X_MAX_GVARS; gv++) {
+      if (!changesValid || outputs.gvars[fm][gv] != lastOutputs.gvars[fm][gv])
+        changes.push(SIMULATOR_CHANGE_GVAR, fm*C9X_MAX_GVARS+gv, outputs.gvars[fm][gv]);
+    }
+  }
+  if (outputs.beep) {
+    changes.push(SIMULATOR_CHANGE_BEEP, 0, outputs.beep);
+  }
+  lastOutputs = outputs;
+
+  Trims trims;
+  getTrims(trims);
+  // the range first, the values would be clamped to the previous one
+  if (!changesValid || trims.extended != lastTrims.extended) {
+    changes.push(SIMULATOR_CHANGE_TRIMS_RANGE, 0, trims.extended);
+  }
+  for (int i=0; i<NUM_STICKS; i++) {
+    if (!changesValid || trims.values[i] != lastTrims.values[i])
+      changes.push(SIMULATOR_CHANGE_TRIM, i, trims.values[i]);
+  }
+  lastTrims = trims;
+
+  unsigned int phase = getPhase();
+  if (!changesValid || phase != lastPhase) {
+    changes.push(SIMULATOR_CHANGE_PHASE, 0, phase);
+    lastPhase = phase;
+  }
+
+#if defined(CPUARM) && defined(FRSKY)
+  for (int i=0; i<MAX_SENSORS && i<SIMULATOR_CHANGE_INDEXES; i++) {
+    int value = telemetryItems[i].value;
+    if (!changesValid || value != lastTelemetry[i])
+      changes.push(SIMULATOR_CHANGE_TELEMETRY, i, value);
+    lastTelemetry[i] = value;
+  }
+#endif
+
+  changesValid = true;
+}
+
+unsigned int OpenTxSimulator::getChanges(SimulatorChange * result, unsigned int max)
+{
+  return changes.pop(result, max);
+}
+
+void OpenTxSimulator::setChangesEnabled(bool enabled)
+{
+  if (enabled && !changesEnabled) {
+    // everything is published again
+    changesValid = false;
+  }
+  changesEnabled = enabled;
+}
+
 void OpenTxSimulator::wheelEvent(int steps)
 {
 #if defined(REV9E)
@@ -543,6 +634,66 @@ void OpenTxSimulator::setLuaStateReloadPermanentScripts()
 }
 
 
+void OpenTxSimulator::getMixerProfile(MixerProfile & profile)
+{
+  profile.cycles = 0;
+  profile.count = 0;
+#if defined(CPUARM)
+  profile.cycles = mixerProfiler.getCycles();
+  for (int i=0; i<PROFILE_STAGES_COUNT && i<SIMULATOR_PROFILER_MAX_STAGES; i++) {
+    profile.stages[i].name = MixerProfiler::getStageName(i);
+    profile.stages[i].p50 = mixerProfiler.getPercentile(i, 50) / 2;
+    profile.stages[i].p99 = mixerProfiler.getPercentile(i, 99) / 2;
+    profile.stages[i].max = mixerProfiler.getMax(i) / 2;
+    profile.count++;
+  }
+#endif
+}
+
+bool OpenTxSimulator::startTelemetryStream(const char * capture, unsigned int speed)
+{
+  bool result = false;
+#if defined(CPUARM)
+  CoEnterMutexSection(telemetryStreamMutex);
+  telemetryStream.stop();
+  telemetryStream.init(MODEL_TELEMETRY_PROTOCOL());
+  if (telemetryStream.loadCapture(capture, true)) {
+    telemetryStream.start(speed);
+    result = true;
+  }
+  CoLeaveMutexSection(telemetryStreamMutex);
+#endif
+  return result;
+}
+
+void OpenTxSimulator::stopTelemetryStream()
+{
+#if defined(CPUARM)
+  CoEnterMutexSection(telemetryStreamMutex);
+  telemetryStream.stop();
+  CoLeaveMutexSection(telemetryStreamMutex);
+#endif
+}
+
+void OpenTxSimulator::getTelemetryStreamStatus(TelemetryStreamStatus & status)
+{
+  memset(&status, 0, sizeof(status));
+#if defined(CPUARM)
+  CoEnterMutexSection(telemetryStreamMutex);
+  const TelemetryStreamStats & stats = telemetryStream.getStats();
+  status.running = telemetryStream.isRunning();
+  status.packets = stats.packets;
+  status.lost = stats.lost + stats.saturated;
+  status.bytes = stats.bytes;
+  status.overruns = stats.overruns;
+  status.updates = stats.updates;
+  status.parserTime = telemetryStream.getParserTime();
+  status.latency = telemetryStream.getAverageLatency();
+  status.latencyMax = stats.latencyMax;
+  CoLeaveMutexSection(telemetryStreamMutex);
+#endif
+}
+
 void OpenTxSimulator::setTrainerInput(unsigned int inputNumber, ::int16_t value)
 {
 #define SETTRAINER_IMPORT
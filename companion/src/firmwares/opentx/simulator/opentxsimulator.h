@@ -83,6 +83,16 @@ class DLLEXPORT OpenTxSimulator : public SimulatorInterface {
 
   private:
     int volumeGain;
+    SimulatorChangeQueue changes;
+    unsigned int changesTimer;
+    bool changesEnabled;
+    bool changesValid;
+    TxOutputs lastOutputs;
+    Trims lastTrims;
+    unsigned int lastPhase;
+    int lastTelemetry[SIMULATOR_CHANGE_INDEXES];
+
+    void publishChanges();
 
   public:
 
@@ -112,6 +122,10 @@ class DLLEXPORT OpenTxSimulator : public SimulatorInterface {
 
     virtual void getTrims(Trims & trims);
 
+    virtual unsigned int getChanges(SimulatorChange * changes, unsigned int max);
+
+    virtual void setChangesEnabled(bool enabled);
+
     virtual unsigned int getPhase();
 
     virtual const char * getPhaseName(unsigned int phase);
@@ -132,6 +146,14 @@ class DLLEXPORT OpenTxSimulator : public SimulatorInterface {
 
     virtual void setLuaStateReloadPermanentScripts();
 
+    virtual void getMixerProfile(MixerProfile & profile);
+
+    virtual bool startTelemetryStream(const char * capture, unsigned int speed);
+
+    virtual void stopTelemetryStream();
+
+    virtual void getTelemetryStreamStatus(TelemetryStreamStatus & status);
+
 };
 
 }
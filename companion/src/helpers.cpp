@@ -787,15 +787,29 @@ CompanionIcon::CompanionIcon(const QString &baseimage)
   addFile(":/themes/"+theme+"/48/"+baseimage, QSize(48,48));
 }
 
+// Builds the EEPROM image given to the simulator. When a single model is
+// simulated, only the general settings and this model are built and
+// serialised (as model 0), so neither Companion nor the simulator firmware
+// have to process the 59 other models.
+void prepareSimulationImage(QByteArray & eeprom, RadioData & radioData, int modelIdx)
+{
+  eeprom.fill(0, GetEepromInterface()->getEEpromSize());
+
+  if (modelIdx >= 0) {
+    GetEepromInterface()->saveSimulation((uint8_t *)eeprom.data(), radioData.generalSettings, radioData.models[modelIdx], GetCurrentFirmware()->getCapability(SimulatorVariant));
+  }
+  else {
+    GetEepromInterface()->save((uint8_t *)eeprom.data(), radioData, GetCurrentFirmware()->getCapability(SimulatorVariant));
+  }
+}
+
 void startSimulation(QWidget * parent, RadioData & radioData, int modelIdx)
 {
   SimulatorInterface * si = GetCurrentFirmwareSimulator();
   if (si) {
-    RadioData * simuData = new RadioData(radioData);
     unsigned int flags = 0;
     if (modelIdx >= 0) {
       flags |= SIMULATOR_FLAGS_NOTX;
-      simuData->generalSettings.currModel = modelIdx;
     }
     if (radioData.generalSettings.stickMode & 1) {
       flags |= SIMULATOR_FLAGS_STICK_MODE_LEFT;
@@ -816,9 +830,8 @@ void startSimulation(QWidget * parent, RadioData & radioData, int modelIdx)
     else {
       sd = new SimulatorDialog9X(parent, si, flags);
     }
-    QByteArray eeprom(GetEepromInterface()->getEEpromSize(), 0);
-    GetEepromInterface()->save((uint8_t *)eeprom.data(), *simuData, GetCurrentFirmware()->getCapability(SimulatorVariant));
-    delete simuData;
+    QByteArray eeprom;
+    prepareSimulationImage(eeprom, radioData, modelIdx);
     sd->start(eeprom);
     sd->exec();
     delete sd;
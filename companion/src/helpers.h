@@ -132,6 +132,7 @@ QString getFrSkyProtocol(int protocol);
 QString getFrSkyMeasure(int units);
 QString getFrSkySrc(int index);
 
+void prepareSimulationImage(QByteArray & eeprom, RadioData & radioData, int modelIdx);
 void startSimulation(QWidget * parent, RadioData & radioData, int modelIdx);
 
 template <class T>
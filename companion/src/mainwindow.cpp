@@ -47,6 +47,7 @@
 #include "mdichild.h"
 #include "burnconfigdialog.h"
 #include "comparedialog.h"
+#include "modellibrarydialog.h"
 #include "logsdialog.h"
 #include "apppreferencesdialog.h"
 #include "fwpreferencesdialog.h"
@@ -882,6 +883,29 @@ void MainWindow::compare()
   fd->show();
 }
 
+void MainWindow::modelLibrary()
+{
+  ModelLibraryDialog *fd = new ModelLibraryDialog(this);
+  fd->setAttribute(Qt::WA_DeleteOnClose, true);
+  connect(fd, SIGNAL(openFile(const QString &)), this, SLOT(openLibraryFile(const QString &)));
+  fd->show();
+}
+
+void MainWindow::openLibraryFile(const QString & fileName)
+{
+    QMdiSubWindow *existing = findMdiChild(fileName);
+    if (existing) {
+      mdiArea->setActiveSubWindow(existing);
+      return;
+    }
+
+    MdiChild *child = createMdiChild();
+    if (child->loadFile(fileName)) {
+      statusBar()->showMessage(tr("File loaded"), 2000);
+      child->show();
+    }
+}
+
 void MainWindow::logFile()
 {
   LogsDialog *fd = new LogsDialog(this);
@@ -1055,6 +1079,7 @@ void MainWindow::createActions()
     changelogAct =       addAct("changelog.png",     tr("Companion Changes..."),    tr("Show Companion change log"),          SLOT(changelog()));
     fwchangelogAct =     addAct("changelog.png",     tr("Firmware Changes..."),     tr("Show firmware change log"),           SLOT(fwchangelog()));
     compareAct =         addAct("compare.png",       tr("Compare Models..."),       tr("Compare models"),                     SLOT(compare()));
+    modelLibraryAct =    addAct("open.png",          tr("Model Library..."),        tr("Search the models in the radio files archive"), SLOT(modelLibrary()));
     editSplashAct =      addAct("paintbrush.png",    tr("Edit Radio Splash Image..."), tr("Edit the splash image of your Radio"),   SLOT(customizeSplash()));
     burnListAct =        addAct("list.png",          tr("List programmers..."),     tr("List available programmers"),         SLOT(burnList()));
     burnFusesAct =       addAct("fuses.png",         tr("Fuses..."),                tr("Show fuses dialog"),                  SLOT(burnFuses()));
@@ -1098,6 +1123,7 @@ void MainWindow::createMenus()
     fileMenu->addAction(simulateAct);
     fileMenu->addAction(printAct);
     fileMenu->addAction(compareAct);
+    fileMenu->addAction(modelLibraryAct);
     fileMenu->addAction(sdsyncAct);
     fileMenu->addSeparator();
     fileMenu->addAction(exitAct);
@@ -153,6 +153,8 @@ class MainWindow : public QMainWindow
     void customizeSplash();
     void about();
     void compare();
+    void modelLibrary();
+    void openLibraryFile(const QString & fileName);
     void print();
     void loadBackup();
     void appPrefs();
@@ -231,6 +233,7 @@ class MainWindow : public QMainWindow
     QAction *changelogAct;
     QAction *fwchangelogAct;
     QAction *compareAct;
+    QAction *modelLibraryAct;
     QAction *editSplashAct;
     QAction *cutAct;
     QAction *copyAct;
@@ -0,0 +1,249 @@
+#include <QHash>
+#include <QtConcurrentMap>
+#include "modeldiff.h"
+#include "eepromimportexport.h"
+#include "firmwares/opentx/opentxeeprom.h"
+
+#define DIFF_EEPROM_VERSION 255 /*version max*/
+
+// the names stored apart from their elements, at the top level of the model
+static const char * const ownedFields[][2] = {
+  { "InputName", "Input" },
+  { "CurveName", "Curves" },
+  { "GVarName", "Phase" },
+  { "GVarPopup", "Phase" },
+  { "IgnoreSensorIds", "FrSky" },
+};
+
+QString FieldChange::section() const
+{
+  QString result = path.section('/', 0, 0).section('[', 0, 0);
+  for (unsigned int i=0; i<sizeof(ownedFields)/sizeof(ownedFields[0]); i++) {
+    if (result == ownedFields[i][0])
+      return ownedFields[i][1];
+  }
+  return result;
+}
+
+// Flattens a field tree into its leaves, the paths are only built for the changed ones
+class FieldFlattener: public DataFieldWalker
+{
+  public:
+    class Node {
+      public:
+        int parent;
+        const char * name;
+        int index;
+    };
+
+    class Leaf {
+      public:
+        int node;
+        QString value;
+    };
+
+    QVector<Node> nodes;
+    QVector<Leaf> leaves;
+
+    virtual void enter(DataField * field)
+    {
+      int node = addNode(field);
+      stack.append(node);
+      counters.append(QHash<QByteArray, int>());
+    }
+
+    virtual void leave(DataField * field)
+    {
+      stack.pop_back();
+      counters.pop_back();
+    }
+
+    virtual void visit(DataField * field)
+    {
+      Leaf leaf;
+      leaf.node = addNode(field);
+      leaf.value = field->getValue();
+      leaves.append(leaf);
+    }
+
+    QString path(int node) const
+    {
+      QStringList result;
+      // the root node (the model or the general settings) is not part of the path
+      for (; node >= 0 && nodes[node].parent >= 0; node = nodes[node].parent) {
+        result.prepend(QString("%1[%2]").arg(nodes[node].name).arg(nodes[node].index));
+      }
+      return result.join("/");
+    }
+
+  protected:
+    QVector<int> stack;
+    QVector< QHash<QByteArray, int> > counters;
+
+    int addNode(DataField * field)
+    {
+      Node node;
+      node.parent = stack.isEmpty() ? -1 : stack.last();
+      node.name = field->getName();
+      // siblings of the same kind are numbered ("Mix[0]", "Mix[1]", ...)
+      node.index = counters.isEmpty() ? 0 : counters.last()[node.name]++;
+      nodes.append(node);
+      return nodes.size() - 1;
+    }
+};
+
+FieldChanges diffFields(DataField & field1, DataField & field2)
+{
+  FieldChanges result;
+  FieldFlattener flat1, flat2;
+  field1.Walk(flat1);
+  field2.Walk(flat2);
+
+  if (flat1.leaves.size() == flat2.leaves.size()) {
+    for (int i=0; i<flat1.leaves.size(); i++) {
+      const FieldFlattener::Leaf & leaf1 = flat1.leaves[i];
+      const FieldFlattener::Leaf & leaf2 = flat2.leaves[i];
+      if (leaf1.value != leaf2.value) {
+        result.append(FieldChange(flat1.path(leaf1.node), leaf1.value, leaf2.value));
+      }
+    }
+  }
+  else {
+    // both trees don't have the same layout, match the leaves by their path
+    QHash<QString, QString> values;
+    for (int i=0; i<flat1.leaves.size(); i++) {
+      values.insert(flat1.path(flat1.leaves[i].node), flat1.leaves[i].value);
+    }
+    for (int i=0; i<flat2.leaves.size(); i++) {
+      QString path = flat2.path(flat2.leaves[i].node);
+      QHash<QString, QString>::iterator it = values.find(path);
+      if (it == values.end()) {
+        result.append(FieldChange(path, "", flat2.leaves[i].value));
+      }
+      else {
+        if (it.value() != flat2.leaves[i].value)
+          result.append(FieldChange(path, it.value(), flat2.leaves[i].value));
+        values.erase(it);
+      }
+    }
+    for (QHash<QString, QString>::iterator it=values.begin(); it!=values.end(); ++it) {
+      result.append(FieldChange(it.key(), it.value(), ""));
+    }
+  }
+
+  return result;
+}
+
+static QString modelName(const ModelData & model)
+{
+  return model.used ? QString("\"%1\"").arg(model.name) : QString("-");
+}
+
+static FieldChanges diffModels(const ModelData & model1, const ModelData & model2, BoardEnum board, unsigned int variant)
+{
+  if (!model1.used && !model2.used)
+    return FieldChanges();
+
+  if (!model1.used || !model2.used) {
+    FieldChanges result;
+    result.append(FieldChange("Model", modelName(model1), modelName(model2)));
+    return result;
+  }
+
+  OpenTxModelData field1((ModelData &)model1, board, DIFF_EEPROM_VERSION, variant);
+  OpenTxModelData field2((ModelData &)model2, board, DIFF_EEPROM_VERSION, variant);
+  return diffFields(field1, field2);
+}
+
+FieldChanges diffModels(const ModelData & model1, const ModelData & model2, Firmware * firmware)
+{
+  return diffModels(model1, model2, firmware->getBoard(), firmware->getVariantNumber());
+}
+
+FieldChanges diffGeneralSettings(const GeneralSettings & settings1, const GeneralSettings & settings2, Firmware * firmware)
+{
+  OpenTxGeneralData field1((GeneralSettings &)settings1, firmware->getBoard(), DIFF_EEPROM_VERSION, firmware->getVariantNumber());
+  OpenTxGeneralData field2((GeneralSettings &)settings2, firmware->getBoard(), DIFF_EEPROM_VERSION, firmware->getVariantNumber());
+  return diffFields(field1, field2);
+}
+
+class ModelDiffJob
+{
+  public:
+    const ModelData * model1;
+    const ModelData * model2;
+    BoardEnum board;
+    unsigned int variant;
+    FieldChanges changes;
+};
+
+static void runModelDiffJob(ModelDiffJob & job)
+{
+  job.changes = diffModels(*job.model1, *job.model2, job.board, job.variant);
+}
+
+RadioDiff diffRadios(const RadioData & radio1, const RadioData & radio2, Firmware * firmware)
+{
+  RadioDiff result;
+  BoardEnum board = firmware->getBoard();
+  unsigned int variant = firmware->getVariantNumber();
+
+  result.generalSettings = diffGeneralSettings(radio1.generalSettings, radio2.generalSettings, firmware);
+
+  {
+    // the conversion tables are created (and cached) when the field trees are built, this
+    // first model tree is built in this thread so that the workers only read the caches
+    ModelData model;
+    OpenTxModelData warmup(model, board, DIFF_EEPROM_VERSION, variant);
+  }
+
+  QVector<ModelDiffJob> jobs(C9X_MAX_MODELS);
+  for (int i=0; i<C9X_MAX_MODELS; i++) {
+    jobs[i].model1 = &radio1.models[i];
+    jobs[i].model2 = &radio2.models[i];
+    jobs[i].board = board;
+    jobs[i].variant = variant;
+  }
+  QtConcurrent::blockingMap(jobs, runModelDiffJob);
+
+  result.models.resize(C9X_MAX_MODELS);
+  for (int i=0; i<C9X_MAX_MODELS; i++) {
+    result.models[i] = jobs[i].changes;
+  }
+
+  return result;
+}
+
+int RadioDiff::count() const
+{
+  int result = generalSettings.size();
+  for (int i=0; i<models.size(); i++) {
+    result += models[i].size();
+  }
+  return result;
+}
+
+QString RadioDiff::toString() const
+{
+  QString result;
+  if (!generalSettings.isEmpty()) {
+    result += "General Settings\n";
+    result += printChanges(generalSettings, "  ");
+  }
+  for (int i=0; i<models.size(); i++) {
+    if (!models[i].isEmpty()) {
+      result += QString("Model %1\n").arg(i+1, 2, 10, QChar('0'));
+      result += printChanges(models[i], "  ");
+    }
+  }
+  return result;
+}
+
+QString printChanges(const FieldChanges & changes, const QString & prefix)
+{
+  QString result;
+  foreach(const FieldChange & change, changes) {
+    result += QString("%1%2: %3 -> %4\n").arg(prefix).arg(change.path).arg(change.oldValue).arg(change.newValue);
+  }
+  return result;
+}
@@ -0,0 +1,52 @@
+#ifndef _MODELDIFF_H_
+#define _MODELDIFF_H_
+
+#include <QString>
+#include <QList>
+#include <QVector>
+#include "eeprominterface.h"
+
+class DataField;
+
+class FieldChange
+{
+  public:
+    FieldChange(const QString & path, const QString & oldValue, const QString & newValue):
+      path(path),
+      oldValue(oldValue),
+      newValue(newValue)
+    {
+    }
+
+    // top level element of the path ("Mix", "Limit", "FrSky", ...), or the element owning
+    // a top level field ("InputName" is in the "Input" section)
+    QString section() const;
+
+    QString path;
+    QString oldValue;
+    QString newValue;
+};
+
+typedef QList<FieldChange> FieldChanges;
+
+class RadioDiff
+{
+  public:
+    FieldChanges generalSettings;
+    QVector<FieldChanges> models;
+
+    int count() const;
+    QString toString() const;
+};
+
+// The diff walks the eeprom field trees of both sides, the leaves come in the same
+// order as long as both sides are exported for the same firmware, which makes it linear
+FieldChanges diffFields(DataField & field1, DataField & field2);
+FieldChanges diffModels(const ModelData & model1, const ModelData & model2, Firmware * firmware);
+FieldChanges diffGeneralSettings(const GeneralSettings & settings1, const GeneralSettings & settings2, Firmware * firmware);
+// the models are compared in parallel
+RadioDiff diffRadios(const RadioData & radio1, const RadioData & radio2, Firmware * firmware);
+
+QString printChanges(const FieldChanges & changes, const QString & prefix = "");
+
+#endif // _MODELDIFF_H_
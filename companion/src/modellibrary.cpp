@@ -0,0 +1,305 @@
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDirIterator>
+#include <QDateTime>
+#include <QDataStream>
+#include <QTextStream>
+#include <QDesktopServices>
+#include <QCryptographicHash>
+#include "modellibrary.h"
+#include "firmwareinterface.h"
+#include "hexinterface.h"
+#include "modelprinter.h"
+
+#define MODEL_LIBRARY_INDEX_MAGIC 0x4C58544F // "OTXL"
+
+int readRadioFile(const QString & fileName, QByteArray & eeprom)
+{
+  QFile file(fileName);
+  int fileType = getFileType(fileName);
+  int eeprom_size = 0;
+
+  eeprom.fill(0, EESIZE_MAX);
+
+  if (fileType==FILE_TYPE_HEX || fileType==FILE_TYPE_EEPE) {
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+      return false;
+    QTextStream inputStream(&file);
+    if (fileType==FILE_TYPE_EEPE && inputStream.readLine()!="EEPE EEPROM FILE")
+      return false;
+    eeprom_size = HexInterface(inputStream).load((uint8_t *)eeprom.data(), EESIZE_MAX);
+  }
+  else if (fileType==FILE_TYPE_BIN) {
+    if (!file.open(QFile::ReadOnly))
+      return false;
+    eeprom = file.readAll();
+    eeprom_size = eeprom.size();
+  }
+
+  return eeprom_size;
+}
+
+static bool loadRadioImage(QByteArray & eeprom, int eeprom_size, RadioData & radioData)
+{
+  std::bitset<NUM_ERRORS> errors((unsigned long long)LoadEeprom(radioData, (const uint8_t *)eeprom.constData(), eeprom_size));
+  if (!errors.test(NO_ERROR))
+    errors = std::bitset<NUM_ERRORS>((unsigned long long)LoadBackup(radioData, (uint8_t *)eeprom.data(), eeprom_size, 0));
+  return errors.test(NO_ERROR);
+}
+
+bool loadRadioFile(const QString & fileName, RadioData & radioData)
+{
+  QByteArray eeprom;
+  int eeprom_size = readRadioFile(fileName, eeprom);
+  return eeprom_size && loadRadioImage(eeprom, eeprom_size, radioData);
+}
+
+static void addSwitch(QStringList & switches, const RawSwitch & swtch)
+{
+  if (swtch.type >= SWITCH_TYPE_SWITCH && swtch.type <= SWITCH_TYPE_ROTARY_ENCODER) {
+    QString str = swtch.toString();
+    if (!switches.contains(str))
+      switches.append(str);
+  }
+}
+
+void ModelLibraryEntry::extract(const ModelData & model, int slot)
+{
+  this->slot = slot;
+  name = model.name;
+
+  QStringList protocols;
+  for (int i=0; i<C9X_NUM_MODULES; i++) {
+    if (model.moduleData[i].protocol != PULSES_OFF)
+      protocols.append(ModelPrinter::printModuleProtocol(model.moduleData[i].protocol));
+  }
+  modules = protocols.join(", ");
+
+  flightModes = 1;
+  for (int i=1; i<C9X_MAX_FLIGHT_MODES; i++) {
+    if (model.flightModeData[i].swtch.type != SWITCH_TYPE_NONE)
+      flightModes++;
+  }
+
+  QStringList used;
+  for (int i=0; i<C9X_MAX_TIMERS; i++)
+    addSwitch(used, model.timers[i].mode);
+  for (int i=1; i<C9X_MAX_FLIGHT_MODES; i++)
+    addSwitch(used, model.flightModeData[i].swtch);
+  for (int i=0; i<C9X_MAX_EXPOS; i++) {
+    if (model.expoData[i].mode)
+      addSwitch(used, model.expoData[i].swtch);
+  }
+  for (int i=0; i<C9X_MAX_MIXERS; i++) {
+    if (model.mixData[i].destCh)
+      addSwitch(used, model.mixData[i].swtch);
+  }
+  for (int i=0; i<C9X_MAX_CUSTOM_FUNCTIONS; i++)
+    addSwitch(used, model.customFn[i].swtch);
+  used.sort();
+  switches = used.join(" ");
+
+  // the checksum is computed on the model as the firmware stores it, not on the ModelData struct
+  // (padding and QString members)
+  QByteArray data = GetEepromInterface()->exportModel(model);
+  if (data.isEmpty())
+    data = QString("%1 %2 %3 %4").arg(name).arg(modules).arg(flightModes).arg(switches).toUtf8();
+  checksum = qChecksum(data.constData(), data.size());
+  key = QString("%1 %2 %3").arg(name).arg(modules).arg(switches).toLower();
+}
+
+QDataStream & operator << (QDataStream & out, const ModelLibraryEntry & entry)
+{
+  return out << (qint32)entry.slot << entry.name << entry.modules << (qint32)entry.flightModes << entry.switches << entry.checksum << entry.key;
+}
+
+QDataStream & operator >> (QDataStream & in, ModelLibraryEntry & entry)
+{
+  qint32 slot, flightModes;
+  in >> slot >> entry.name >> entry.modules >> flightModes >> entry.switches >> entry.checksum >> entry.key;
+  entry.slot = slot;
+  entry.flightModes = flightModes;
+  return in;
+}
+
+QDataStream & operator << (QDataStream & out, const ModelLibraryFile & file)
+{
+  return out << file.path << file.lastModified << file.size << file.hash << file.models;
+}
+
+QDataStream & operator >> (QDataStream & in, ModelLibraryFile & file)
+{
+  return in >> file.path >> file.lastModified >> file.size >> file.hash >> file.models;
+}
+
+QString ModelLibraryIndex::defaultIndexFile()
+{
+  return QDesktopServices::storageLocation(QDesktopServices::DataLocation) + "/modellibrary.idx";
+}
+
+QStringList ModelLibraryIndex::supportedFiles()
+{
+  return QStringList() << "*.eepe" << "*.bin" << "*.hex";
+}
+
+bool ModelLibraryIndex::load(const QString & fileName)
+{
+  QFile file(fileName);
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+
+  QDataStream in(&file);
+  quint32 magic, version;
+  in >> magic >> version;
+  if (magic != MODEL_LIBRARY_INDEX_MAGIC || version != MODEL_LIBRARY_INDEX_VERSION)
+    return false;
+
+  QMap<QString, ModelLibraryFile> result;
+  in >> result;
+  if (in.status() != QDataStream::Ok)
+    return false;
+
+  files = result;
+  return true;
+}
+
+bool ModelLibraryIndex::save(const QString & fileName) const
+{
+  QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+  QFile file(fileName);
+  if (!file.open(QIODevice::WriteOnly))
+    return false;
+
+  QDataStream out(&file);
+  out << (quint32)MODEL_LIBRARY_INDEX_MAGIC << (quint32)MODEL_LIBRARY_INDEX_VERSION << files;
+  return out.status() == QDataStream::Ok;
+}
+
+bool ModelLibraryIndex::indexFile(ModelLibraryFile & file)
+{
+  QByteArray eeprom;
+  int eeprom_size = readRadioFile(file.path, eeprom);
+  QByteArray hash = QCryptographicHash::hash(eeprom.left(eeprom_size), QCryptographicHash::Md5);
+  if (eeprom_size && hash == file.hash) {
+    // only the file date changed, the models are kept without loading the file
+    return true;
+  }
+
+  file.models.clear();
+  file.hash = hash;
+  if (!eeprom_size)
+    return false;
+
+  RadioData * radioData = new RadioData();
+  bool result = loadRadioImage(eeprom, eeprom_size, *radioData);
+  if (result) {
+    QString fileName = QFileInfo(file.path).fileName().toLower();
+    for (int i=0; i<C9X_MAX_MODELS; i++) {
+      const ModelData & model = radioData->models[i];
+      if (model.used) {
+        ModelLibraryEntry entry;
+        entry.extract(model, i);
+        entry.key += " " + fileName;
+        file.models.append(entry);
+      }
+    }
+  }
+  delete radioData;
+  return result;
+}
+
+int ModelLibraryIndex::update(const QStringList & folders, volatile bool * abort)
+{
+  QMap<QString, ModelLibraryFile> result;
+  int updated = 0;
+
+  foreach(QString folder, folders) {
+    QDirIterator it(folder, supportedFiles(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+      QFileInfo info(it.next());
+      QString path = info.absoluteFilePath();
+      if (result.contains(path))
+        continue;
+
+      if (abort && *abort) {
+        // keep what was not visited, it will be checked by the next update
+        for (QMap<QString, ModelLibraryFile>::const_iterator old=files.constBegin(); old!=files.constEnd(); ++old) {
+          if (!result.contains(old.key()))
+            result.insert(old.key(), old.value());
+        }
+        files = result;
+        return updated;
+      }
+
+      ModelLibraryFile file = files.value(path);
+      qint64 lastModified = info.lastModified().toMSecsSinceEpoch();
+      if (file.path.isEmpty() || file.lastModified != lastModified || file.size != info.size()) {
+        // the files which can't be loaded are kept (without models) to avoid loading them again
+        file.path = path;
+        file.lastModified = lastModified;
+        file.size = info.size();
+        indexFile(file);
+        updated++;
+      }
+      result.insert(path, file);
+    }
+  }
+
+  files = result;
+  return updated;
+}
+
+QList<ModelLibraryMatch> ModelLibraryIndex::search(const QString & text, int maxResults) const
+{
+  QList<ModelLibraryMatch> result;
+  QStringList words = text.toLower().split(' ', QString::SkipEmptyParts);
+
+  for (QMap<QString, ModelLibraryFile>::const_iterator it=files.constBegin(); it!=files.constEnd(); ++it) {
+    const ModelLibraryFile & file = it.value();
+    for (int i=0; i<file.models.size(); i++) {
+      const ModelLibraryEntry & model = file.models[i];
+      bool found = true;
+      foreach(const QString & word, words) {
+        if (!model.key.contains(word)) {
+          found = false;
+          break;
+        }
+      }
+      if (found) {
+        result.append(ModelLibraryMatch(&file, &model));
+        if (result.size() >= maxResults)
+          return result;
+      }
+    }
+  }
+
+  return result;
+}
+
+int ModelLibraryIndex::modelsCount() const
+{
+  int result = 0;
+  for (QMap<QString, ModelLibraryFile>::const_iterator it=files.constBegin(); it!=files.constEnd(); ++it) {
+    result += it.value().models.size();
+  }
+  return result;
+}
+
+ModelLibraryIndexer::ModelLibraryIndexer(const ModelLibraryIndex & index, const QStringList & folders, const QString & indexFile, QObject * parent):
+  QThread(parent),
+  index(index),
+  folders(folders),
+  indexFile(indexFile),
+  updated(0),
+  aborted(false)
+{
+}
+
+void ModelLibraryIndexer::run()
+{
+  updated = index.update(folders, &aborted);
+  if (!indexFile.isEmpty())
+    index.save(indexFile);
+}
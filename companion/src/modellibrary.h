@@ -0,0 +1,113 @@
+#ifndef _MODELLIBRARY_H_
+#define _MODELLIBRARY_H_
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QList>
+#include <QThread>
+#include "eeprominterface.h"
+
+#define MODEL_LIBRARY_INDEX_VERSION 2
+
+int readRadioFile(const QString & fileName, QByteArray & eeprom);
+bool loadRadioFile(const QString & fileName, RadioData & radioData);
+
+// What the library remembers from each model, the file is only loaded again when it changes
+class ModelLibraryEntry
+{
+  public:
+    ModelLibraryEntry():
+      slot(0),
+      flightModes(0),
+      checksum(0)
+    {
+    }
+
+    void extract(const ModelData & model, int slot);
+
+    int slot;
+    QString name;
+    QString modules;
+    int flightModes;
+    QString switches;
+    quint16 checksum;
+    QString key; // lower case text used by the search
+};
+
+class ModelLibraryFile
+{
+  public:
+    ModelLibraryFile():
+      lastModified(0),
+      size(0)
+    {
+    }
+
+    QString path;
+    qint64 lastModified;
+    qint64 size;
+    QByteArray hash; // MD5 of the eeprom image, a file which is only touched is not loaded again
+    QList<ModelLibraryEntry> models;
+};
+
+class ModelLibraryMatch
+{
+  public:
+    ModelLibraryMatch(const ModelLibraryFile * file, const ModelLibraryEntry * model):
+      file(file),
+      model(model)
+    {
+    }
+
+    const ModelLibraryFile * file;
+    const ModelLibraryEntry * model;
+};
+
+class ModelLibraryIndex
+{
+  public:
+    static QString defaultIndexFile();
+    static QStringList supportedFiles();
+
+    bool load(const QString & fileName);
+    bool save(const QString & fileName) const;
+
+    // rescans the folders, only the new files and the ones whose contents changed are loaded
+    int update(const QStringList & folders, volatile bool * abort = NULL);
+
+    // all the words must be found in the model name, file name, modules or switches
+    QList<ModelLibraryMatch> search(const QString & text, int maxResults = 1000) const;
+
+    int filesCount() const { return files.size(); }
+    int modelsCount() const;
+
+  protected:
+    QMap<QString, ModelLibraryFile> files;
+
+    static bool indexFile(ModelLibraryFile & file);
+};
+
+class ModelLibraryIndexer: public QThread
+{
+  Q_OBJECT
+
+  public:
+    ModelLibraryIndexer(const ModelLibraryIndex & index, const QStringList & folders, const QString & indexFile, QObject * parent = 0);
+
+    // only valid once the thread is finished
+    const ModelLibraryIndex & result() const { return index; }
+    int updatedFiles() const { return updated; }
+    void abort() { aborted = true; }
+
+  protected:
+    virtual void run();
+
+    ModelLibraryIndex index;
+    QStringList folders;
+    QString indexFile;
+    int updated;
+    volatile bool aborted;
+};
+
+#endif // _MODELLIBRARY_H_
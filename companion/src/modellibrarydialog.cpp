@@ -0,0 +1,150 @@
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QFileDialog>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include "modellibrarydialog.h"
+#include "helpers.h"
+#include "appdata.h"
+
+#define MODEL_LIBRARY_MAX_RESULTS 1000
+
+ModelLibraryDialog::ModelLibraryDialog(QWidget * parent):
+  QDialog(parent),
+  indexer(NULL)
+{
+  setWindowTitle(tr("Model Library"));
+  setWindowIcon(CompanionIcon("open.png"));
+  resize(800, 500);
+
+  searchEdit = new QLineEdit(this);
+  searchEdit->setPlaceholderText(tr("Search models by name, file, module or switch"));
+
+  resultsTree = new QTreeWidget(this);
+  resultsTree->setRootIsDecorated(false);
+  resultsTree->setUniformRowHeights(true);
+  resultsTree->setHeaderLabels(QStringList() << tr("Model") << tr("Modules") << tr("Flight modes") << tr("Switches") << tr("File") << tr("Slot"));
+
+  statusLabel = new QLabel(this);
+
+  QPushButton * addFolderButton = new QPushButton(tr("Add Folder..."), this);
+  QPushButton * rescanButton = new QPushButton(tr("Rescan"), this);
+  QPushButton * closeButton = new QPushButton(tr("Close"), this);
+
+  QHBoxLayout * buttonsLayout = new QHBoxLayout();
+  buttonsLayout->addWidget(statusLabel, 1);
+  buttonsLayout->addWidget(addFolderButton);
+  buttonsLayout->addWidget(rescanButton);
+  buttonsLayout->addWidget(closeButton);
+
+  QVBoxLayout * layout = new QVBoxLayout(this);
+  layout->addWidget(searchEdit);
+  layout->addWidget(resultsTree);
+  layout->addLayout(buttonsLayout);
+
+  connect(searchEdit, SIGNAL(textChanged(const QString &)), this, SLOT(search()));
+  connect(resultsTree, SIGNAL(itemActivated(QTreeWidgetItem *, int)), this, SLOT(itemActivated(QTreeWidgetItem *, int)));
+  connect(addFolderButton, SIGNAL(clicked()), this, SLOT(addFolder()));
+  connect(rescanButton, SIGNAL(clicked()), this, SLOT(rescan()));
+  connect(closeButton, SIGNAL(clicked()), this, SLOT(close()));
+
+  // the previous index is shown immediately, the folders are rescanned in the background
+  index.load(ModelLibraryIndex::defaultIndexFile());
+  rescan();
+}
+
+ModelLibraryDialog::~ModelLibraryDialog()
+{
+  if (indexer) {
+    indexer->abort();
+    indexer->wait();
+    delete indexer;
+  }
+}
+
+QStringList ModelLibraryDialog::folders()
+{
+  QStringList result = g.modelLibraryDirs();
+  if (result.isEmpty() && !g.eepromDir().isEmpty())
+    result << g.eepromDir();
+  return result;
+}
+
+void ModelLibraryDialog::addFolder()
+{
+  QString folder = QFileDialog::getExistingDirectory(this, tr("Add a folder to the model library"), g.eepromDir());
+  if (!folder.isEmpty()) {
+    QStringList list = g.modelLibraryDirs();
+    if (!list.contains(folder)) {
+      list << folder;
+      g.modelLibraryDirs(list);
+      rescan();
+    }
+  }
+}
+
+void ModelLibraryDialog::rescan()
+{
+  if (indexer)
+    return;
+
+  indexer = new ModelLibraryIndexer(index, folders(), ModelLibraryIndex::defaultIndexFile());
+  connect(indexer, SIGNAL(finished()), this, SLOT(indexerFinished()));
+  indexer->start(QThread::LowPriority);
+  search();
+}
+
+void ModelLibraryDialog::indexerFinished()
+{
+  index = indexer->result();
+  int updated = indexer->updatedFiles();
+  indexer->deleteLater();
+  indexer = NULL;
+  search();
+  if (updated > 0)
+    statusLabel->setText(statusLabel->text() + " - " + tr("%1 files updated").arg(updated));
+}
+
+void ModelLibraryDialog::search()
+{
+  QElapsedTimer timer;
+  timer.start();
+  QList<ModelLibraryMatch> matches = index.search(searchEdit->text(), MODEL_LIBRARY_MAX_RESULTS);
+  double duration = timer.nsecsElapsed() / 1000000.0;
+
+  resultsTree->setUpdatesEnabled(false);
+  resultsTree->clear();
+  QList<QTreeWidgetItem *> items;
+  foreach(const ModelLibraryMatch & match, matches) {
+    QTreeWidgetItem * item = new QTreeWidgetItem();
+    item->setText(0, match.model->name);
+    item->setText(1, match.model->modules);
+    item->setText(2, QString::number(match.model->flightModes));
+    item->setText(3, match.model->switches);
+    item->setText(4, QFileInfo(match.file->path).fileName());
+    item->setToolTip(4, match.file->path);
+    item->setText(5, QString::number(match.model->slot+1));
+    item->setData(0, Qt::UserRole, match.file->path);
+    items.append(item);
+  }
+  resultsTree->addTopLevelItems(items);
+  resultsTree->setUpdatesEnabled(true);
+
+  updateStatus(matches.size(), duration);
+}
+
+void ModelLibraryDialog::updateStatus(int found, double duration)
+{
+  QString status = tr("%1 of %2 models in %3 files (%4ms)").arg(found).arg(index.modelsCount()).arg(index.filesCount()).arg(duration, 0, 'f', 2);
+  if (found >= MODEL_LIBRARY_MAX_RESULTS)
+    status += " " + tr("only the first %1 are shown").arg(MODEL_LIBRARY_MAX_RESULTS);
+  if (indexer)
+    status += " - " + tr("indexing...");
+  statusLabel->setText(status);
+}
+
+void ModelLibraryDialog::itemActivated(QTreeWidgetItem * item, int column)
+{
+  emit openFile(item->data(0, Qt::UserRole).toString());
+}
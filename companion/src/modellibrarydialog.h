@@ -0,0 +1,39 @@
+#ifndef _MODELLIBRARYDIALOG_H_
+#define _MODELLIBRARYDIALOG_H_
+
+#include <QDialog>
+#include <QLineEdit>
+#include <QLabel>
+#include <QTreeWidget>
+#include "modellibrary.h"
+
+class ModelLibraryDialog : public QDialog
+{
+  Q_OBJECT
+
+  public:
+    ModelLibraryDialog(QWidget * parent);
+    ~ModelLibraryDialog();
+
+  signals:
+    void openFile(const QString & fileName);
+
+  protected slots:
+    void search();
+    void addFolder();
+    void rescan();
+    void indexerFinished();
+    void itemActivated(QTreeWidgetItem * item, int column);
+
+  protected:
+    QStringList folders();
+    void updateStatus(int found, double duration);
+
+    ModelLibraryIndex index;
+    ModelLibraryIndexer * indexer;
+    QLineEdit * searchEdit;
+    QTreeWidget * resultsTree;
+    QLabel * statusLabel;
+};
+
+#endif // _MODELLIBRARYDIALOG_H_
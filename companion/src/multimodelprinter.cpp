@@ -1,6 +1,7 @@
 #include "helpers.h"
 #include "helpers_html.h"
 #include "multimodelprinter.h"
+#include "modeldiff.h"
 #include <algorithm>
 
 MultiModelPrinter::MultiColumns::MultiColumns(int count):
@@ -95,7 +96,8 @@ QString MultiModelPrinter::printTitle(const QString & label)
 }
 
 MultiModelPrinter::MultiModelPrinter(Firmware * firmware):
-  firmware(firmware)
+  firmware(firmware),
+  compareSections(false)
 {
 }
 
@@ -126,25 +128,45 @@ QString MultiModelPrinter::print(QTextDocument * document)
 {
   if (document) document->clear();
 
+  // when comparing two models, the structural diff tells which sections are worth rendering
+  changedSections.clear();
+  compareSections = (models.size() == 2);
+  if (compareSections) {
+    FieldChanges changes = diffModels(*models[0], *models[1], firmware);
+    foreach(const FieldChange & change, changes) {
+      changedSections.insert(change.section());
+    }
+  }
+
   QString str = "<table border='1' cellspacing='0' cellpadding='3' width='100%' style='font-family: monospace;'>";
   str += printSetup();
   if (firmware->getCapability(Heli))
     str += printHeliSetup();
   if (firmware->getCapability(FlightModes))
-    str += printFlightModes();
-  str += printInputs();
-  str += printMixers();
-  str += printLimits();
-  str += printCurves(document);
+    str += isSectionChanged("Phase") ? printFlightModes() : printIdentical(tr("Flight modes"));
+  str += isSectionChanged("Input") ? printInputs() : printIdentical(tr("Inputs"));
+  str += isSectionChanged("Mix") ? printMixers() : printIdentical(tr("Mixers"));
+  str += isSectionChanged("Limit") ? printLimits() : printIdentical(tr("Limits"));
+  str += isSectionChanged("Curves") ? printCurves(document) : printIdentical(tr("Curves"));
   if (firmware->getCapability(Gvars) && !firmware->getCapability(GvarsFlightModes))
     str += printGvars();
-  str += printLogicalSwitches();
-  str += printCustomFunctions();
-  str += printTelemetry();
+  str += isSectionChanged("LogicalSwitch") ? printLogicalSwitches() : printIdentical(tr("Logical Switches"));
+  str += isSectionChanged("CustomFunction") ? printCustomFunctions() : printIdentical(tr("Special Functions"));
+  str += (isSectionChanged("FrSky") || isSectionChanged("Sensor") || isSectionChanged("MavLink")) ? printTelemetry() : printIdentical(tr("Telemetry Settings"));
   str += "</table>";
   return str;
 }
 
+bool MultiModelPrinter::isSectionChanged(const QString & section)
+{
+  return !compareSections || changedSections.contains(section);
+}
+
+QString MultiModelPrinter::printIdentical(const QString & label)
+{
+  return printTitle(label) + QString("<tr><td colspan='%1'><font color='grey'>%2</font></td></tr>").arg(modelPrinters.count()).arg(tr("No differences"));
+}
+
 QString MultiModelPrinter::printSetup()
 {
   QString str = printTitle(tr("General Model Settings"));
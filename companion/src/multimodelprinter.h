@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QTextDocument>
+#include <QSet>
 #include "eeprominterface.h"
 #include "modelprinter.h"
 
@@ -40,7 +41,11 @@ class MultiModelPrinter: public QObject
     GeneralSettings defaultSettings;
     QVector<ModelData *> models; // TODO const
     QVector<ModelPrinter *> modelPrinters;
+    bool compareSections;
+    QSet<QString> changedSections;
 
+    bool isSectionChanged(const QString & section);
+    QString printIdentical(const QString & label);
     QString printTitle(const QString & label);
     QString printSetup();
     QString printHeliSetup();
@@ -2,6 +2,7 @@
 #include "ui_simulatordialog-9x.h"
 #include "ui_simulatordialog-taranis.h"
 #include <iostream>
+#include <QElapsedTimer>
 #include "helpers.h"
 #include "simulatorinterface.h"
 
@@ -55,6 +56,7 @@ SimulatorDialog::SimulatorDialog(QWidget * parent, SimulatorInterface *simulator
   simulator(simulator),
   lastPhase(-1),
   beepVal(0),
+  lcdDirty(false),
   TelemetrySimu(0),
   TrainerSimu(0),
   DebugOut(0),
@@ -69,6 +71,7 @@ SimulatorDialog::SimulatorDialog(QWidget * parent, SimulatorInterface *simulator
   new QShortcut(QKeySequence(Qt::Key_F6), this, SLOT(openDebugOutput()));
   new QShortcut(QKeySequence(Qt::Key_F7), this, SLOT(luaReload()));
   traceCallbackInstance = this;
+  memset(lastGvars, 0, sizeof(lastGvars));
 }
 
 uint32_t SimulatorDialog9X::switchstatus = 0;
@@ -473,8 +476,6 @@ void SimulatorDialog::initUi(T * ui)
     ui->holdRightY->setChecked(true);
   }
 
-  setTrims();
-
   int outputs = std::min(32, GetCurrentFirmware()->getCapability(Outputs));
   if (outputs <= 16) {
     // hide second Outputs tab
@@ -651,35 +652,23 @@ void SimulatorDialog::onTimerEvent()
 
   getValues();
 
-  if (tabWidget->currentIndex()==0) {
-    bool lightEnable;
-    if (simulator->lcdChanged(lightEnable)) {
-      lcd->onLcdChanged(lightEnable);
-      if (lightOn != lightEnable) {
-        setLightOn(lightEnable);
-        lightOn = lightEnable;
-      }
+  // only what changed since the last tick is updated
+  SimulatorChange changes[64];
+  unsigned int count;
+  while ((count = simulator->getChanges(changes, sizeof(changes)/sizeof(changes[0]))) > 0) {
+    for (unsigned int i=0; i<count; i++) {
+      applyChange(changes[i]);
     }
   }
 
-  // display current flight mode in window title
-  unsigned int currentPhase = simulator->getPhase();
-  if (currentPhase != lastPhase) {
-    lastPhase = currentPhase;
-    const char * phase_name = simulator->getPhaseName(currentPhase);
-    if (phase_name && phase_name[0]) {
-      setWindowTitle(windowName + QString(" - Flight Mode %1").arg(QString(phase_name)));
-    }
-    else {
-      setWindowTitle(windowName + QString(" - Flight Mode %1").arg(simulator->getPhase()));
-    }
+  if (lcdDirty && tabWidget->currentIndex()==0) {
+    lcd->onLcdChanged(lightOn);
+    lcdDirty = false;
   }
 
   if (!(lcd_counter++ % 5)) {
 
-    setValues();
-
-    setTrims();
+    updateStickLabels();
 
     centerSticks();
 
@@ -694,6 +683,196 @@ void SimulatorDialog::onTimerEvent()
   updateDebugOutput();
 }
 
+void SimulatorDialog::applyChange(const SimulatorChange & change)
+{
+  static const QString CSWITCH_ON = "QLabel { background-color: #4CC417 }";
+  static const QString CSWITCH_OFF = "QLabel { }";
+  mySlider * trims[NUM_STICKS] = { trimHLeft, trimVLeft, trimVRight, trimHRight };
+
+  switch (change.type) {
+    case SIMULATOR_CHANGE_CHANNEL:
+      if (change.index < channelSliders.size()) {
+        channelSliders[change.index]->setValue(chVal(change.value));
+        channelValues[change.index]->setText(QString("%1").arg((qreal)change.value*100/1024, 0, 'f', 1));
+      }
+      break;
+
+    case SIMULATOR_CHANGE_LOGICAL_SWITCH:
+      if (change.index < logicalSwitchLabels.size()) {
+        logicalSwitchLabels[change.index]->setStyleSheet(change.value ? CSWITCH_ON : CSWITCH_OFF);
+        if (!logicalSwitchLabels2.isEmpty()) {
+          logicalSwitchLabels2[change.index]->setStyleSheet(change.value ? CSWITCH_ON : CSWITCH_OFF);
+        }
+      }
+      break;
+
+    // the sliders don't send back the values coming from the simulator
+    case SIMULATOR_CHANGE_TRIM:
+      if (change.index < NUM_STICKS) {
+        trims[change.index]->blockSignals(true);
+        trims[change.index]->setValue(change.value);
+        trims[change.index]->blockSignals(false);
+      }
+      break;
+
+    case SIMULATOR_CHANGE_TRIMS_RANGE:
+    {
+      int trimMax = change.value ? 500 : 125;
+      for (int i=0; i<NUM_STICKS; i++) {
+        trims[i]->blockSignals(true);
+        trims[i]->setRange(-trimMax, trimMax);
+        trims[i]->blockSignals(false);
+      }
+      break;
+    }
+
+    case SIMULATOR_CHANGE_GVAR:
+    {
+      unsigned int fm = change.index / C9X_MAX_GVARS;
+      unsigned int gv = change.index % C9X_MAX_GVARS;
+      lastGvars[fm][gv] = change.value;
+      if (gv < numGvars && fm < numFlightModes) {
+        gvarValues[gv*numFlightModes+fm]->setText(QString((fm==lastPhase)?"<b>%1</b>":"%1").arg(change.value));
+      }
+      break;
+    }
+
+    case SIMULATOR_CHANGE_PHASE:
+    {
+      // display current flight mode in window title
+      lastPhase = change.value;
+      const char * phase_name = simulator->getPhaseName(lastPhase);
+      if (phase_name && phase_name[0]) {
+        setWindowTitle(windowName + QString(" - Flight Mode %1").arg(QString(phase_name)));
+      }
+      else {
+        setWindowTitle(windowName + QString(" - Flight Mode %1").arg(lastPhase));
+      }
+      for (unsigned int gv=0; gv<numGvars; gv++) {
+        for (unsigned int fm=0; fm<numFlightModes; fm++) {
+          gvarValues[gv*numFlightModes+fm]->setText(QString((fm==lastPhase)?"<b>%1</b>":"%1").arg(lastGvars[fm][gv]));
+        }
+      }
+      break;
+    }
+
+    case SIMULATOR_CHANGE_LCD:
+      lcdDirty = true;
+      if (lightOn != (bool)change.value) {
+        lightOn = change.value;
+        setLightOn(lightOn);
+      }
+      break;
+
+    case SIMULATOR_CHANGE_BEEP:
+      beepVal = change.value;
+      break;
+
+    default:
+      break;
+  }
+}
+
+// The widgets update as done before the change sets, only kept for the benchmark
+void SimulatorDialog::setAllWidgets()
+{
+  static const QString CSWITCH_ON = "QLabel { background-color: #4CC417 }";
+  static const QString CSWITCH_OFF = "QLabel { }";
+  TxOutputs outputs;
+  simulator->getValues(outputs);
+  Trims trims;
+  simulator->getTrims(trims);
+
+  for (int i=0; i<channelSliders.size(); i++) {
+    channelSliders[i]->setValue(chVal(outputs.chans[i]));
+    channelValues[i]->setText(QString("%1").arg((qreal)outputs.chans[i]*100/1024, 0, 'f', 1));
+  }
+
+  for (int i=0; i<logicalSwitchLabels.size(); i++) {
+    logicalSwitchLabels[i]->setStyleSheet(outputs.vsw[i] ? CSWITCH_ON : CSWITCH_OFF);
+    if (!logicalSwitchLabels2.isEmpty()) {
+      logicalSwitchLabels2[i]->setStyleSheet(outputs.vsw[i] ? CSWITCH_ON : CSWITCH_OFF);
+    }
+  }
+
+  for (unsigned int gv=0; gv<numGvars; gv++) {
+    for (unsigned int fm=0; fm<numFlightModes; fm++) {
+      gvarValues[gv*numFlightModes+fm]->setText(QString((fm==lastPhase)?"<b>%1</b>":"%1").arg(outputs.gvars[fm][gv]));
+    }
+  }
+
+  int trimMax = (trims.extended ? 500 : 125);
+  mySlider * sliders[NUM_STICKS] = { trimHLeft, trimVLeft, trimVRight, trimHRight };
+  for (int i=0; i<NUM_STICKS; i++) {
+    sliders[i]->blockSignals(true);
+    sliders[i]->setRange(-trimMax, trimMax);
+    sliders[i]->setValue(trims.values[i]);
+    sliders[i]->blockSignals(false);
+  }
+
+  updateStickLabels();
+
+  bool lightEnable;
+  if (simulator->lcdChanged(lightEnable) && tabWidget->currentIndex()==0) {
+    lcd->onLcdChanged(lightEnable);
+  }
+}
+
+QString SimulatorDialog::benchmark(int seconds)
+{
+  const char * passes[] = { "poll", "changes" };
+  QString result;
+
+  timer->stop();
+
+  for (int pass=0; pass<2; pass++) {
+    simulator->setChangesEnabled(pass > 0);
+    SimulatorChange changes[64];
+    unsigned int ticks = 0, count = 0;
+    qint64 total = 0, max = 0;
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    while (elapsed.elapsed() < seconds*1000) {
+      if (!simulator->timer10ms()) {
+        return result + QString("Simulator error: %1\n").arg(simulator->getError());
+      }
+      QElapsedTimer tick;
+      tick.start();
+      getValues();
+      if (pass == 0) {
+        setAllWidgets();
+      }
+      else {
+        unsigned int n;
+        while ((n = simulator->getChanges(changes, sizeof(changes)/sizeof(changes[0]))) > 0) {
+          for (unsigned int i=0; i<n; i++) {
+            applyChange(changes[i]);
+          }
+          count += n;
+        }
+        if (lcdDirty && tabWidget->currentIndex()==0) {
+          lcd->onLcdChanged(lightOn);
+          lcdDirty = false;
+        }
+      }
+      // the repaints are part of the cost
+      QApplication::processEvents();
+      qint64 duration = tick.nsecsElapsed();
+      total += duration;
+      max = qMax(max, duration);
+      ticks++;
+    }
+
+    result += QString("%1: %2 ticks, %3us of widgets update per tick (max %4us), %5 changes\n")
+              .arg(passes[pass], -7).arg(ticks).arg(total / 1000.0 / ticks, 0, 'f', 1).arg(max / 1000.0, 0, 'f', 1).arg(count);
+  }
+
+  simulator->setChangesEnabled(true);
+  timer->start(10);
+  return result;
+}
+
 void SimulatorDialog::centerSticks()
 {
   if (leftStick->scene())
@@ -723,22 +902,6 @@ void SimulatorDialog::start(const char * filename)
   setupTimer();
 }
 
-void SimulatorDialog::setTrims()
-{
-  Trims trims;
-  simulator->getTrims(trims);
-
-  int trimMin = -125, trimMax = +125;
-  if (trims.extended) {
-    trimMin = -500;
-    trimMax = +500;
-  }
-  trimHLeft->setRange(trimMin, trimMax);  trimHLeft->setValue(trims.values[0]);
-  trimVLeft->setRange(trimMin, trimMax);  trimVLeft->setValue(trims.values[1]);
-  trimVRight->setRange(trimMin, trimMax); trimVRight->setValue(trims.values[2]);
-  trimHRight->setRange(trimMin, trimMax); trimHRight->setValue(trims.values[3]);
-}
-
 void SimulatorDialog9X::getValues()
 {
   TxInputs inputs = {
@@ -969,45 +1132,13 @@ void SimulatorDialog::on_trimHRight_valueChanged(int value)
   simulator->setTrim(3, value);
 }
 
-void SimulatorDialog::setValues()
+void SimulatorDialog::updateStickLabels()
 {
-  TxOutputs outputs;
-  simulator->getValues(outputs);
-  Trims trims;
-  simulator->getTrims(trims);
-
-  for (int i=0; i<GetCurrentFirmware()->getCapability(Outputs); i++) {
-    if (i < channelSliders.size()) {
-      channelSliders[i]->setValue(chVal(outputs.chans[i]));
-      channelValues[i]->setText(QString("%1").arg((qreal)outputs.chans[i]*100/1024, 0, 'f', 1));
-    }
-  }
-
-  leftXPerc->setText(QString("X %1%").arg((qreal)nodeLeft->getX()*100+trims.values[0]/5, 2, 'f', 0));
-  leftYPerc->setText(QString("Y %1%").arg((qreal)nodeLeft->getY()*-100+trims.values[1]/5, 2, 'f', 0));
-
-  rightXPerc->setText(QString("X %1%").arg((qreal)nodeRight->getX()*100+trims.values[3]/5, 2, 'f', 0));
-  rightYPerc->setText(QString("Y %1%").arg((qreal)nodeRight->getY()*-100+trims.values[2]/5, 2, 'f', 0));
+  leftXPerc->setText(QString("X %1%").arg((qreal)nodeLeft->getX()*100+trimHLeft->value()/5, 2, 'f', 0));
+  leftYPerc->setText(QString("Y %1%").arg((qreal)nodeLeft->getY()*-100+trimVLeft->value()/5, 2, 'f', 0));
 
-  QString CSWITCH_ON = "QLabel { background-color: #4CC417 }";
-  QString CSWITCH_OFF = "QLabel { }";
-
-  for (int i=0; i<GetCurrentFirmware()->getCapability(LogicalSwitches); i++) {
-    logicalSwitchLabels[i]->setStyleSheet(outputs.vsw[i] ? CSWITCH_ON : CSWITCH_OFF);
-    if (!logicalSwitchLabels2.isEmpty()) {
-      logicalSwitchLabels2[i]->setStyleSheet(outputs.vsw[i] ? CSWITCH_ON : CSWITCH_OFF);
-    }
-  }
-
-  for (unsigned int gv=0; gv<numGvars; gv++) {
-    for (unsigned int fm=0; fm<numFlightModes; fm++) {
-      gvarValues[gv*numFlightModes+fm]->setText(QString((fm==lastPhase)?"<b>%1</b>":"%1").arg(outputs.gvars[fm][gv]));
-    }
-  }
-
-  if (outputs.beep) {
-    beepVal = outputs.beep;
-  }
+  rightXPerc->setText(QString("X %1%").arg((qreal)nodeRight->getX()*100+trimHRight->value()/5, 2, 'f', 0));
+  rightYPerc->setText(QString("Y %1%").arg((qreal)nodeRight->getY()*-100+trimVRight->value()/5, 2, 'f', 0));
 }
 
 void SimulatorDialog::setupSticks()
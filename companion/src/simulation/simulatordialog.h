@@ -49,6 +49,8 @@ class SimulatorDialog : public QDialog
     void start(const char * filename);
     void start(QByteArray & eeprom);
     virtual void traceCallback(const char * text);
+    // stops the timer and measures the widgets update cost, by polling everything and by draining the changes
+    QString benchmark(int seconds);
 
   protected:
     template <class T> void initUi(T * ui);
@@ -96,15 +98,18 @@ class SimulatorDialog : public QDialog
     void resizeEvent(QResizeEvent *event  = 0);
 
     virtual void getValues() = 0;
-    void setValues();
+    void applyChange(const SimulatorChange & change);
+    void setAllWidgets();
+    void updateStickLabels();
     void centerSticks();
 
     int getValue(qint8 i);
     bool getSwitch(int swtch, bool nc, qint8 level=0);
-    void setTrims();
     QFrame * createLogicalSwitch(QWidget * parent, int switchNo, QVector<QLabel *> & labels);
 
     int beepVal;
+    bool lcdDirty;
+    int lastGvars[C9X_MAX_FLIGHT_MODES][C9X_MAX_GVARS];
 
     int lcdWidth;
     int lcdHeight;
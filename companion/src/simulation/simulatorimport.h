@@ -58,7 +58,7 @@ if (inputs.rotenc) simuSetKey(KEY_ENTER, true);
 #ifdef GETVALUES_IMPORT
 #undef GETVALUES_IMPORT
 memset(outputs.chans, 0, sizeof(outputs.chans));
-for (unsigned int i=0; i<DIM(g_chans512); i++)
+for (unsigned int i=0; i<NUM_CHNOUT; i++)
   outputs.chans[i] = g_chans512[i];
 for (int i=0; i<NUM_LOGICAL_SWITCH; i++)
 #if defined(BOLD_FONT)
@@ -93,7 +93,6 @@ return false;
 if (!main_thread_running)
   return false;
 per10ms();
-return true;
 #endif
 
 #ifdef GETLCD_IMPORT
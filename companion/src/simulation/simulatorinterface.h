@@ -53,12 +53,113 @@ class TxOutputs
     // uint8_t phase;
 };
 
+#define SIMULATOR_PROFILER_MAX_STAGES 8
+
+struct MixerProfile
+{
+  unsigned int cycles;
+  unsigned int count;
+  struct {
+    const char * name;
+    unsigned int p50; /* durations in us */
+    unsigned int p99;
+    unsigned int max;
+  } stages[SIMULATOR_PROFILER_MAX_STAGES];
+};
+
+struct TelemetryStreamStatus
+{
+  bool running;
+  unsigned int packets;
+  unsigned int lost;       /* packets which never reached the radio */
+  unsigned int bytes;
+  unsigned int overruns;   /* bytes lost by the receive FIFO */
+  unsigned int updates;
+  unsigned int parserTime; /* us per wakeup */
+  unsigned int latency;    /* average, in us */
+  unsigned int latencyMax;
+};
+
 struct Trims
 {
   int values[NUM_STICKS]; /* lh lv rv rh */
   bool extended;
 };
 
+enum SimulatorChangeType
+{
+  SIMULATOR_CHANGE_CHANNEL,
+  SIMULATOR_CHANGE_LOGICAL_SWITCH,
+  SIMULATOR_CHANGE_TRIM,          /* index is lh lv rv rh */
+  SIMULATOR_CHANGE_TRIMS_RANGE,   /* value is 1 with extended trims */
+  SIMULATOR_CHANGE_GVAR,          /* index is flight mode * C9X_MAX_GVARS + gvar */
+  SIMULATOR_CHANGE_PHASE,
+  SIMULATOR_CHANGE_LCD,           /* value is the backlight state */
+  SIMULATOR_CHANGE_BEEP,
+  SIMULATOR_CHANGE_TELEMETRY,     /* index is the sensor */
+  SIMULATOR_CHANGE_TYPES
+};
+
+#define SIMULATOR_CHANGE_INDEXES 256
+#define SIMULATOR_CHANGES_MAX    (SIMULATOR_CHANGE_TYPES*SIMULATOR_CHANGE_INDEXES)
+
+struct SimulatorChange
+{
+  uint8_t type;
+  uint8_t index;
+  int value;
+};
+
+/*
+ * Changes published by the simulator, waiting for the UI. A value which changes
+ * again before being drained replaces the pending one, so the queue can't
+ * hold more than one change per type and index
+ */
+class SimulatorChangeQueue
+{
+  public:
+    SimulatorChangeQueue() { clear(); }
+
+    void clear()
+    {
+      first = count = 0;
+      memset(pending, -1, sizeof(pending));
+    }
+
+    void push(uint8_t type, uint8_t index, int value)
+    {
+      int & slot = pending[type][index];
+      if (slot < 0) {
+        slot = (first + count) % SIMULATOR_CHANGES_MAX;
+        changes[slot].type = type;
+        changes[slot].index = index;
+        count++;
+      }
+      changes[slot].value = value;
+    }
+
+    unsigned int pop(SimulatorChange * result, unsigned int max)
+    {
+      unsigned int n = 0;
+      while (count > 0 && n < max) {
+        SimulatorChange & change = changes[first];
+        pending[change.type][change.index] = -1;
+        result[n++] = change;
+        first = (first + 1) % SIMULATOR_CHANGES_MAX;
+        count--;
+      }
+      return n;
+    }
+
+    unsigned int size() const { return count; }
+
+  protected:
+    SimulatorChange changes[SIMULATOR_CHANGES_MAX];
+    int pending[SIMULATOR_CHANGE_TYPES][SIMULATOR_CHANGE_INDEXES];
+    unsigned int first;
+    unsigned int count;
+};
+
 class SimulatorInterface
 {
   public:
@@ -89,6 +190,12 @@ class SimulatorInterface
 
     virtual void getTrims(Trims &trims) = 0;
 
+    // drains the changes published by timer10ms(), returns how many were copied
+    virtual unsigned int getChanges(SimulatorChange * changes, unsigned int max) = 0;
+
+    // enabled by default, timer10ms() doesn't publish anything when disabled
+    virtual void setChangesEnabled(bool enabled) = 0;
+
     virtual unsigned int getPhase() = 0;
     
     virtual const char * getPhaseName(unsigned int phase) = 0;
@@ -108,6 +215,15 @@ class SimulatorInterface
     virtual void installTraceHook(void (*callback)(const char *)) = 0;
 
     virtual void setLuaStateReloadPermanentScripts() = 0;
+
+    virtual void getMixerProfile(MixerProfile & profile) { profile.cycles = profile.count = 0; };
+
+    // replays a telemetry capture into the radio parser, in a loop
+    virtual bool startTelemetryStream(const char * capture, unsigned int speed /* percent */) { return false; };
+
+    virtual void stopTelemetryStream() { };
+
+    virtual void getTelemetryStreamStatus(TelemetryStreamStatus & status) { status.running = false; };
 };
 
 class SimulatorFactory {
@@ -22,8 +22,12 @@ TelemetrySimulator::TelemetrySimulator(QWidget * parent, SimulatorInterface * si
   logTimer = new QTimer(this);
   connect(logTimer, SIGNAL(timeout()), this, SLOT(onLogTimerEvent()));
 
+  streamTimer = new QTimer(this);
+  connect(streamTimer, SIGNAL(timeout()), this, SLOT(onStreamTimerEvent()));
+
   connect(ui->Simulate, SIGNAL(clicked(bool)), this, SLOT(onSimulateToggled(bool)));
   connect(ui->loadLogFile, SIGNAL(released()), this, SLOT(onLoadLogFile()));
+  connect(ui->loadCapture, SIGNAL(released()), this, SLOT(onLoadCapture()));
   connect(ui->play, SIGNAL(released()), this, SLOT(onPlay()));
   connect(ui->rewind, SIGNAL(clicked()), this, SLOT(onRewind()));
   connect(ui->stepForward, SIGNAL(clicked()), this, SLOT(onStepForward()));
@@ -50,6 +54,8 @@ TelemetrySimulator::~TelemetrySimulator()
 {
   timer->stop();
   logTimer->stop();
+  streamTimer->stop();
+  simulator->stopTelemetryStream();
   delete ui;
 }
 
@@ -81,6 +87,34 @@ void TelemetrySimulator::onLoadLogFile()
   logPlayback->loadLogFile();
 }
 
+void TelemetrySimulator::onLoadCapture()
+{
+  onStop();
+  QString fileName = QFileDialog::getOpenFileName(this, tr("Telemetry Capture"), ".", tr("Telemetry captures (*.txt *.log *.bin);;All files (*)"));
+  if (fileName.isEmpty()) {
+    return;
+  }
+  // the capture is replayed by the simulator itself, at the replay rate when it starts
+  if (simulator->startTelemetryStream(fileName.toLocal8Bit().constData(), SPEEDS[ui->replayRate->value()] * 100)) {
+    ui->logFileLabel->setText(QFileInfo(fileName).fileName());
+    ui->stop->setEnabled(true);
+    streamTimer->start(500);
+  }
+  else {
+    ui->logFileLabel->setText(tr("ERROR - invalid file"));
+  }
+}
+
+void TelemetrySimulator::onStreamTimerEvent()
+{
+  TelemetryStreamStatus status;
+  simulator->getTelemetryStreamStatus(status);
+  ui->positionLabel->setText(tr("%1 bytes, %2 updates, %3 packets lost, %4 bytes overrun\nparser %5us, latency %6us").arg(status.bytes).arg(status.updates).arg(status.lost).arg(status.overruns).arg(status.parserTime).arg(status.latency));
+  if (!status.running) {
+    streamTimer->stop();
+  }
+}
+
 void TelemetrySimulator::onPlay()
 {
   if (logPlayback->isReady()) {
@@ -115,6 +149,10 @@ void TelemetrySimulator::onStepBack()
 
 void TelemetrySimulator::onStop()
 {
+  if (streamTimer->isActive()) {
+    streamTimer->stop();
+    simulator->stopTelemetryStream();
+  }
   if (logPlayback->isReady()) {
     logTimer->stop();
     logPlayback->stop();
@@ -140,6 +178,8 @@ void TelemetrySimulator::closeEvent(QCloseEvent *event)
 {
   timer->stop();
   logTimer->stop();
+  streamTimer->stop();
+  simulator->stopTelemetryStream();
   event->accept();
 }
 
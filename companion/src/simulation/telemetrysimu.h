@@ -107,6 +107,7 @@ private:
     Ui::TelemetrySimulator * ui;
     QTimer * timer;
     QTimer * logTimer;
+    QTimer * streamTimer;
     SimulatorInterface *simulator;
     void generateTelemetryFrame();
     TelemetrySimulator::LogPlaybackController *logPlayback;
@@ -116,6 +117,8 @@ private:
     void onTimerEvent();
     void onLogTimerEvent();
     void onLoadLogFile();
+    void onLoadCapture();
+    void onStreamTimerEvent();
     void onPlay();
     void onRewind();
     void onStepForward();
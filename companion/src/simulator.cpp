@@ -49,6 +49,8 @@
 #include <QThread>
 #include <QDebug>
 #include <QTextStream>
+#include <QElapsedTimer>
+#include <time.h>
 #if defined(JOYSTICKS) || defined(SIMU_AUDIO)
   #include <SDL.h>
   #undef main
@@ -61,8 +63,10 @@
 #if defined WIN32 || !defined __GNUC__
 #include <windows.h>
 #define sleep(x) Sleep(x*1000)
+#define msleep(x) Sleep(x)
 #else
 #include <unistd.h>
+#define msleep(x) usleep((x)*1000)
 #endif
 
 #ifdef __APPLE__
@@ -88,10 +92,79 @@ void showMessage(const QString & message, enum QMessageBox::Icon icon = QMessage
   msgBox.exec();
 }
 
+/*
+ * Headless run of the simulator, without any widget, to measure the host CPU
+ * used when nothing moves and the cost of each 10ms tick: first when the whole
+ * state is polled like the dialog used to do, then when only the published
+ * changes are drained. The widgets update is measured by --dialog-benchmark
+ */
+int runBenchmark(SimulatorInterface * simulator, const QString & eepromFileName, int seconds)
+{
+  QTextStream out(stdout);
+  const char * passes[] = { "poll", "changes" };
+
+  simulator->start(eepromFileName.toAscii().constData());
+
+  for (int pass=0; pass<2; pass++) {
+    // the poll pass doesn't pay for the changes
+    simulator->setChangesEnabled(pass > 0);
+    SimulatorChange changes[64];
+    unsigned int ticks = 0, count = 0;
+    qint64 total = 0, max = 0;
+    QElapsedTimer elapsed;
+    clock_t cpu = clock();
+    elapsed.start();
+
+    while (elapsed.elapsed() < seconds*1000) {
+      QElapsedTimer tick;
+      tick.start();
+      if (!simulator->timer10ms()) {
+        out << "Simulator error: " << simulator->getError() << endl;
+        simulator->stop();
+        return 3;
+      }
+      if (pass == 0) {
+        TxOutputs outputs;
+        Trims trims;
+        simulator->getValues(outputs);
+        simulator->getTrims(trims);
+        simulator->getPhase();
+        bool lightEnable;
+        simulator->lcdChanged(lightEnable);
+      }
+      unsigned int n;
+      while ((n = simulator->getChanges(changes, sizeof(changes)/sizeof(changes[0]))) > 0) {
+        count += n;
+      }
+      qint64 duration = tick.nsecsElapsed();
+      total += duration;
+      max = qMax(max, duration);
+      ticks++;
+      msleep(10);
+    }
+
+    double load = 100.0 * (clock() - cpu) / CLOCKS_PER_SEC / (elapsed.elapsed() / 1000.0);
+    out << QString("%1: %2 ticks, %3us per tick (max %4us), %5 changes, host CPU %6%")
+           .arg(passes[pass], -7).arg(ticks).arg(total / 1000.0 / ticks, 0, 'f', 1).arg(max / 1000.0, 0, 'f', 1)
+           .arg(count).arg(load, 0, 'f', 1) << endl;
+  }
+
+  simulator->stop();
+  return 0;
+}
+
 int main(int argc, char *argv[])
 {
   Q_INIT_RESOURCE(companion);
-  QApplication app(argc, argv);
+
+  // no display needed for the benchmark
+  bool gui = true;
+  for (int i=1; i<argc; i++) {
+    if (!strncmp(argv[i], "--benchmark", 11))
+      gui = false;
+  }
+
+  QApplication app(argc, argv, gui);
   app.setApplicationName("OpenTX Simulator");
   app.setOrganizationName("OpenTX");
   app.setOrganizationDomain("open-tx.org");
@@ -149,6 +222,8 @@ int main(int argc, char *argv[])
   QxtCommandOptions options;
   options.add("radio", "radio to simulate", QxtCommandOptions::ValueRequired);
   options.alias("radio", "r");
+  options.add("benchmark", "run the simulator without UI during the given seconds and print its load", QxtCommandOptions::ValueRequired);
+  options.add("dialog-benchmark", "measure the simulator window update during the given seconds", QxtCommandOptions::ValueRequired);
   options.add("help", "show this help text");
   options.alias("help", "h");
   options.parse(QCoreApplication::arguments());
@@ -177,6 +252,10 @@ int main(int argc, char *argv[])
       ok = true;
     }
   }
+  if (!ok && !gui) {
+    QTextStream(stderr) << "The radio is needed for the benchmark" << endl;
+    return 1;
+  }
   if (!ok) {
     firmwareId = QInputDialog::getItem(0, QObject::tr("Radio type"), 
                                                 QObject::tr("Which radio type do you want to simulate?"),
@@ -216,6 +295,14 @@ int main(int argc, char *argv[])
       showMessage(QObject::tr("ERROR: Simulator %1 not found").arg(firmwareId), QMessageBox::Critical);
       return 2;
     }
+    if (!gui) {
+      SimulatorInterface * simulator = factory->create();
+      int result = runBenchmark(simulator, eepromFileName, qMax(1, options.value("benchmark").toInt()));
+      delete simulator;
+      unregisterSimulators();
+      unregisterOpenTxFirmwares();
+      return result;
+    }
     if (factory->type() == BOARD_TARANIS)
       dialog = new SimulatorDialogTaranis(NULL, factory->create(), SIMULATOR_FLAGS_S1|SIMULATOR_FLAGS_S2);
     else
@@ -228,7 +315,14 @@ int main(int argc, char *argv[])
   dialog->show();
   dialog->start(eepromFileName.toAscii().constData());
 
-  int result = app.exec();
+  int result;
+  if (options.count("dialog-benchmark")) {
+    QTextStream(stdout) << dialog->benchmark(qMax(1, options.value("dialog-benchmark").toInt()));
+    result = 0;
+  }
+  else {
+    result = app.exec();
+  }
 
   delete dialog;
 
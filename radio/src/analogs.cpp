@@ -0,0 +1,160 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include "opentx.h"
+
+AnalogFilter analogFilters[NUMBER_ANALOG];
+CalibrationMultipliers calibrationMultipliers;
+
+#define EURO_MIN_ALPHA     16   // smoothing factor at rest, 1/256
+#define EURO_BETA          12   // how fast the smoothing is released when the input moves
+#define EURO_SLOPE_ALPHA   4    // low-pass filter on the input variation
+
+static inline uint16_t median3(uint16_t a, uint16_t b, uint16_t c)
+{
+  if (a > b) {
+    uint16_t tmp = a;
+    a = b;
+    b = tmp;
+  }
+  if (c <= a)
+    return a;
+  else if (c >= b)
+    return b;
+  else
+    return c;
+}
+
+uint16_t analogFilterApply(AnalogFilter & filter, uint16_t filtered, uint16_t value, uint8_t stages)
+{
+  if (!filter.primed) {
+    filter.history[0] = filter.history[1] = value;
+    filter.euroValue = (int32_t)value << 4;
+    filter.euroSlope = 0;
+    filter.primed = true;
+  }
+
+  // the history is always kept, so that the median may be enabled at any time
+  uint16_t input = value;
+  if (stages & ANALOG_FILTER_MEDIAN) {
+    value = median3(filter.history[0], filter.history[1], input);
+  }
+  filter.history[0] = filter.history[1];
+  filter.history[1] = input;
+
+  // 1€ filter (Casiez et al.): a low-pass filter whose cutoff frequency rises with the
+  // speed of the input. Everything is done in 1/16 units, the sampling period is constant
+  // so the cutoff frequencies are directly expressed as smoothing factors
+  if (stages & ANALOG_FILTER_EURO) {
+    int32_t delta = ((int32_t)value << 4) - filter.euroValue;
+    filter.euroSlope += (delta - filter.euroSlope) / EURO_SLOPE_ALPHA;
+    uint32_t alpha = EURO_MIN_ALPHA + ((abs(filter.euroSlope) * EURO_BETA) >> 4);
+    if (alpha >= 256)
+      filter.euroValue += delta;
+    else
+      filter.euroValue += (delta * (int32_t)alpha) / 256;
+    value = (filter.euroValue + 8) >> 4;
+  }
+  else {
+    filter.euroValue = (int32_t)value << 4;
+    filter.euroSlope = 0;
+  }
+
+  // Jitter filter:
+  //    * pass trough any big change directly
+  //    * for small change use Modified moving average (MMA) filter
+  //
+  // Explanation:
+  //
+  // Normal MMA filter has this formula:
+  //            <out> = ((ALPHA-1)*<out> + <in>)/ALPHA
+  //
+  // If calculation is done this way with integer arithmetics, then any small change in
+  // input signal is lost. One way to combat that, is to rearrange the formula somewhat,
+  // to store a more precise (larger) number between iterations. The basic idea is to
+  // store undivided value between iterations. Therefore an new variable <filtered> is
+  // used. The new formula becomes:
+  //           <filtered> = <filtered> - <filtered>/ALPHA + <in>
+  //           <out> = <filtered>/ALPHA  (use only when out is needed)
+  //
+  // The above formula with a maximum allowed ALPHA value (we are limited by
+  // the 16 bit s_anaFilt[]) was tested on the radio. The resulting signal still had
+  // some jitter (a value of 1 was observed). The jitter might be bigger on other
+  // radios.
+  //
+  // So another idea is to use larger input values for filtering. So instead of using
+  // input in a range from 0 to 2047, we use twice larger number (temp[x] is divided less)
+  //
+  // This also means that ALPHA must be lowered (remember 16 bit limit), but test results
+  // have proved that this kind of filtering gives better results. So the recommended values
+  // for filter are:
+  //     JITTER_FILTER_STRENGTH  4
+  //     ANALOG_SCALE            1
+  //
+  // Variables mapping:
+  //   * <in> = value
+  //   * <out> = s_anaFilt[x] = filtered
+  if (stages & ANALOG_FILTER_JITTER) {
+    uint16_t previous = filtered / JITTER_ALPHA;
+    uint16_t diff = (value > previous) ? (value - previous) : (previous - value);
+    if (diff < (10*ANALOG_MULTIPLIER)) {
+      return (filtered - previous) + value;
+    }
+  }
+
+  // use unfiltered value
+  return value * JITTER_ALPHA;
+}
+
+void analogFiltersReset()
+{
+  memclear(analogFilters, sizeof(analogFilters));
+}
+
+void updateCalibrationMultipliers()
+{
+  // rounded up, so that a value equal to the span gives exactly RESX
+  for (uint8_t i=0; i<NUM_STICKS+NUM_POTS; i++) {
+    CalibData * calib = &g_eeGeneral.calib[i];
+    int32_t spanPos = max<int16_t>(100, calib->spanPos);
+    int32_t spanNeg = max<int16_t>(100, calib->spanNeg);
+    calibrationMultipliers.pos[i] = (((int32_t)RESX << 16) + spanPos - 1) / spanPos;
+    calibrationMultipliers.neg[i] = (((int32_t)RESX << 16) + spanNeg - 1) / spanNeg;
+  }
+  calibrationMultipliers.chkSum = g_eeGeneral.chkSum;
+  calibrationMultipliers.valid = true;
+}
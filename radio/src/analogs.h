@@ -0,0 +1,110 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#ifndef _ANALOGS_H_
+#define _ANALOGS_H_
+
+// Filters applied by getADC() to each analog input, in this order
+enum AnalogFilterStages {
+  ANALOG_FILTER_MEDIAN = 0x01,   // median of the last 3 samples, removes the isolated spikes
+  ANALOG_FILTER_EURO   = 0x02,   // 1€ filter, strong smoothing at rest, little lag when moving
+  ANALOG_FILTER_JITTER = 0x04,   // modified moving average on small changes only
+};
+
+#define ANALOG_FILTER_USER_MAX  (ANALOG_FILTER_MEDIAN | ANALOG_FILTER_EURO)   // g_eeGeneral.analogFilter
+
+#if defined(VIRTUALINPUTS)
+  #define JITTER_FILTER_STRENGTH  4         // tune this value, bigger value - more filtering (range: 1-5) (see explanation in analogs.cpp)
+  #define ANALOG_SCALE            1         // tune this value, bigger value - more filtering (range: 0-3) (see explanation in analogs.cpp)
+
+  #define JITTER_ALPHA            (1<<JITTER_FILTER_STRENGTH)
+  #define ANALOG_MULTIPLIER       (1<<ANALOG_SCALE)
+  #define ANA_FILT(chan)          (s_anaFilt[chan] / (JITTER_ALPHA * ANALOG_MULTIPLIER))
+  #if (JITTER_ALPHA * ANALOG_MULTIPLIER > 32)
+    #error "JITTER_FILTER_STRENGTH and ANALOG_SCALE are too big, their summ should be <= 5 !!!"
+  #endif
+#else
+  #define ANALOG_SCALE            0
+  #define JITTER_ALPHA            1
+  #define ANALOG_MULTIPLIER       1
+  #define ANA_FILT(chan)          (s_anaFilt[chan])
+#endif
+
+struct AnalogFilter {
+  uint16_t history[2];   // previous inputs, for the median
+  int32_t  euroValue;    // 1€ filter output, 1/16 units
+  int32_t  euroSlope;    // low-passed variation of the input, 1/16 units per sample
+  bool     primed;
+};
+
+extern AnalogFilter analogFilters[NUMBER_ANALOG];
+
+// value is the new sample, filtered the previous result (JITTER_ALPHA times the output)
+uint16_t analogFilterApply(AnalogFilter & filter, uint16_t filtered, uint16_t value, uint8_t stages);
+void analogFiltersReset();
+
+// Calibration: the sticks and pots are scaled to [-RESX..RESX] with a multiply and
+// a shift, the multipliers are computed again when the calibration checksum changes,
+// and on each cycle while the calibration menu writes the spans
+struct CalibrationMultipliers {
+  int32_t  pos[NUM_STICKS+NUM_POTS];
+  int32_t  neg[NUM_STICKS+NUM_POTS];
+  uint16_t chkSum;
+  bool     valid;
+};
+
+extern CalibrationMultipliers calibrationMultipliers;
+
+void updateCalibrationMultipliers();
+
+inline void checkCalibrationMultipliers()
+{
+  if (calibrationState || !calibrationMultipliers.valid || calibrationMultipliers.chkSum != g_eeGeneral.chkSum) {
+    updateCalibrationMultipliers();
+  }
+}
+
+// v is the input minus its calibrated middle
+inline int16_t applyCalibration(uint8_t index, int32_t v)
+{
+  if (v >= 0)
+    return (v * calibrationMultipliers.pos[index]) >> 16;
+  else
+    return -((-v * calibrationMultipliers.neg[index]) >> 16);
+}
+
+#endif // _ANALOGS_H_
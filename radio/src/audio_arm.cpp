@@ -519,6 +519,10 @@ void audioTask(void* pdata)
 
   setSampleRate(AUDIO_SAMPLE_RATE);
 
+#if defined(PCBTARANIS)
+  sdIoSetTaskClass(SDIO_AUDIO);
+#endif
+
 #if defined(SDCARD)
   if (!unexpectedShutdown) {
     sdInit();
@@ -741,6 +745,8 @@ int ToneContext::mixBuffer(AudioBuffer *buffer, int volume, unsigned int fade)
 
 void AudioQueue::wakeup()
 {
+  TRACE_TASK_BEGIN(task_audio);
+
   int result;
   AudioBuffer *buffer = getEmptyBuffer();
   if (buffer) {
@@ -816,6 +822,8 @@ void AudioQueue::wakeup()
       __enable_irq();
     }
   }
+
+  TRACE_TASK_END(task_audio);
 }
 
 inline unsigned int getToneLength(uint16_t len)
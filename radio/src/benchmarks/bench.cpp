@@ -0,0 +1,283 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include <chrono>
+#include <algorithm>
+#include <new>
+#include <unistd.h>
+#include "bench.h"
+
+// The allocations are counted by wrapping the allocator at link time (-Wl,--wrap=malloc,...),
+// the C++ operators are redirected to malloc() so that they are counted as well
+
+volatile uint32_t benchAllocations = 0;
+volatile uint32_t benchAllocatedBytes = 0;
+
+extern "C" {
+  void * __real_malloc(size_t size);
+  void * __real_calloc(size_t count, size_t size);
+  void * __real_realloc(void * ptr, size_t size);
+  void __real_free(void * ptr);
+
+  void * __wrap_malloc(size_t size)
+  {
+    benchAllocations++;
+    benchAllocatedBytes += size;
+    return __real_malloc(size);
+  }
+
+  void * __wrap_calloc(size_t count, size_t size)
+  {
+    benchAllocations++;
+    benchAllocatedBytes += count * size;
+    return __real_calloc(count, size);
+  }
+
+  void * __wrap_realloc(void * ptr, size_t size)
+  {
+    if (size > 0) {
+      benchAllocations++;
+      benchAllocatedBytes += size;
+    }
+    return __real_realloc(ptr, size);
+  }
+
+  void __wrap_free(void * ptr)
+  {
+    __real_free(ptr);
+  }
+}
+
+void * operator new(size_t size)
+{
+  void * result = malloc(size ? size : 1);
+  if (!result)
+    throw std::bad_alloc();
+  return result;
+}
+
+void * operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void * ptr) throw()
+{
+  free(ptr);
+}
+
+void operator delete[](void * ptr) throw()
+{
+  free(ptr);
+}
+
+// the same stubs as the gtests
+
+int32_t lastAct = 0;
+uint16_t anaInValues[NUM_STICKS+NUM_POTS] = { 0 };
+uint16_t anaIn(uint8_t chan)
+{
+  if (chan < NUM_STICKS+NUM_POTS)
+    return anaInValues[chan];
+  else
+    return 0;
+}
+
+uint16_t getAnalogValue(uint32_t index)
+{
+  return anaIn(index);
+}
+
+static char _zchar2stringResult[200];
+const char * zchar2string(const char * zstring, int size)
+{
+  if (size > (int)sizeof(_zchar2stringResult) ) {
+    return 0;
+  }
+  zchar2str(_zchar2stringResult, zstring, size);
+  return _zchar2stringResult;
+}
+
+Benchmark * Benchmark::first = NULL;
+
+Benchmark::Benchmark(const char * group, const char * name, BenchFunction setup, BenchFunction run):
+  group(group),
+  name(name),
+  setup(setup),
+  run(run),
+  next(NULL)
+{
+  // keep the order of the declarations
+  Benchmark ** last = &first;
+  while (*last)
+    last = &(*last)->next;
+  *last = this;
+}
+
+double benchPercentile(const double * sorted, uint32_t count, double percentile)
+{
+  if (count == 0)
+    return 0;
+  double position = percentile * (count - 1) / 100;
+  uint32_t index = position;
+  if (index + 1 >= count)
+    return sorted[count - 1];
+  return sorted[index] + (position - index) * (sorted[index + 1] - sorted[index]);
+}
+
+#define BENCH_DEFAULT_SAMPLES  200
+#define BENCH_MIN_SAMPLE_NS    20000   // the operations are grouped until a sample lasts that long
+#define BENCH_MAX_ITERATIONS   (1 << 20)
+
+static double benchRunSample(BenchFunction run, uint32_t iterations)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (uint32_t i=0; i<iterations; i++) {
+    run();
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+// the percentiles are those of the samples, each sample being the mean of its operations
+static void benchRun(const Benchmark & benchmark, uint32_t samples, BenchResult & result)
+{
+  if (benchmark.setup)
+    benchmark.setup();
+
+  uint32_t iterations = 1;
+  while (benchRunSample(benchmark.run, iterations) < BENCH_MIN_SAMPLE_NS && iterations < BENCH_MAX_ITERATIONS) {
+    iterations *= 2;
+  }
+
+  double * durations = (double *)__real_malloc(samples * sizeof(double));
+  double total = 0;
+  uint32_t allocations = benchAllocations;
+  uint32_t allocatedBytes = benchAllocatedBytes;
+  for (uint32_t i=0; i<samples; i++) {
+    durations[i] = benchRunSample(benchmark.run, iterations) / iterations;
+    total += durations[i];
+  }
+  allocations = benchAllocations - allocations;
+  allocatedBytes = benchAllocatedBytes - allocatedBytes;
+  std::sort(durations, durations + samples);
+
+  double operations = (double)samples * iterations;
+  result.samples = samples;
+  result.iterations = iterations;
+  result.mean = total / samples;
+  result.p50 = benchPercentile(durations, samples, 50);
+  result.p90 = benchPercentile(durations, samples, 90);
+  result.p99 = benchPercentile(durations, samples, 99);
+  result.max = durations[samples - 1];
+  result.allocations = allocations / operations;
+  result.allocatedBytes = allocatedBytes / operations;
+  __real_free(durations);
+}
+
+static void benchPrint(FILE * output, const Benchmark & benchmark, const BenchResult & result, bool json)
+{
+  if (json) {
+    fprintf(output, "{\"benchmark\": \"%s.%s\", \"samples\": %u, \"iterations\": %u, \"ns_per_op\": %.1f, \"p50_ns\": %.1f, \"p90_ns\": %.1f, \"p99_ns\": %.1f, \"max_ns\": %.1f, \"allocs_per_op\": %.3f, \"bytes_per_op\": %.1f}\n",
+           benchmark.group, benchmark.name, result.samples, result.iterations, result.mean, result.p50, result.p90, result.p99, result.max,
+           result.allocations, result.allocatedBytes);
+  }
+  else {
+    char name[64];
+    snprintf(name, sizeof(name), "%s.%s", benchmark.group, benchmark.name);
+    fprintf(output, "%-32s %10.0f %10.0f %10.0f %10.0f %10.3f %10.1f\n", name, result.mean, result.p50, result.p90, result.p99,
+           result.allocations, result.allocatedBytes);
+  }
+  fflush(output);
+}
+
+static bool benchMatch(const Benchmark & benchmark, const char * filter)
+{
+  char name[64];
+  snprintf(name, sizeof(name), "%s.%s", benchmark.group, benchmark.name);
+  return !filter || strstr(name, filter);
+}
+
+int main(int argc, char ** argv)
+{
+  bool json = false;
+  bool list = false;
+  const char * filter = NULL;
+  uint32_t samples = BENCH_DEFAULT_SAMPLES;
+
+  for (int i=1; i<argc; i++) {
+    if (!strcmp(argv[i], "--json"))
+      json = true;
+    else if (!strcmp(argv[i], "--list"))
+      list = true;
+    else if (!strncmp(argv[i], "--filter=", 9))
+      filter = argv[i] + 9;
+    else if (!strncmp(argv[i], "--samples=", 10) && atoi(argv[i] + 10) > 0)
+      samples = atoi(argv[i] + 10);
+    else {
+      printf("Usage: %s [--json] [--list] [--filter=text] [--samples=n]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  // the simulator traces go to stderr, stdout only holds the results
+  FILE * output = fdopen(dup(STDOUT_FILENO), "w");
+  dup2(STDERR_FILENO, STDOUT_FILENO);
+
+  simuInit();
+  StartEepromThread(NULL);
+  menuLevel = 0;
+  menuHandlers[0] = menuMainView;
+
+  if (!json && !list) {
+    fprintf(output, "%-32s %10s %10s %10s %10s %10s %10s\n", "benchmark", "ns/op", "p50", "p90", "p99", "allocs/op", "bytes/op");
+  }
+
+  for (Benchmark * benchmark=Benchmark::first; benchmark; benchmark=benchmark->next) {
+    if (!benchMatch(*benchmark, filter))
+      continue;
+    if (list) {
+      fprintf(output, "%s.%s\n", benchmark->group, benchmark->name);
+      continue;
+    }
+    BenchResult result;
+    benchRun(*benchmark, samples, result);
+    benchPrint(output, *benchmark, result, json);
+  }
+
+  fclose(output);
+  return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include "../opentx.h"
+
+// Host micro-benchmarks of the hot paths, built like the gtests (make bench PCB=...).
+// Each benchmark has an optional setup function (its fixture) and a function running one operation
+
+typedef void (*BenchFunction)();
+
+class Benchmark
+{
+  public:
+    Benchmark(const char * group, const char * name, BenchFunction setup, BenchFunction run);
+
+    const char * group;
+    const char * name;
+    BenchFunction setup;
+    BenchFunction run;
+    Benchmark * next;
+
+    static Benchmark * first;
+};
+
+#define BENCHMARK(group, name, setup) \
+  static void bench_##group##_##name(); \
+  static Benchmark benchmark_##group##_##name(#group, #name, setup, bench_##group##_##name); \
+  static void bench_##group##_##name()
+
+struct BenchResult
+{
+  uint32_t samples;
+  uint32_t iterations;          // operations per sample
+  double   mean;                // ns/op
+  double   p50;
+  double   p90;
+  double   p99;
+  double   max;
+  double   allocations;         // per op
+  double   allocatedBytes;      // per op
+};
+
+// percentile (0..100) of sorted values, with linear interpolation
+double benchPercentile(const double * sorted, uint32_t count, double percentile);
+
+extern volatile uint32_t benchAllocations;
+extern volatile uint32_t benchAllocatedBytes;
+
+// the same inputs as the gtests
+extern uint16_t anaInValues[NUM_STICKS+NUM_POTS];
+
+#endif // _BENCH_H_
@@ -0,0 +1,772 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include "bench.h"
+
+// The fixture is a heavy model: all the mixer lines (64 on the Taranis), all the logical
+// switches (32) and, with the FrSky telemetry, a stream of 40 S.PORT sensors
+
+static tmr10ms_t benchTime = 0;
+
+static void benchResetModel()
+{
+  memset(&g_model, 0, sizeof(g_model));
+  memset(&anaInValues, 0, sizeof(anaInValues));
+#if defined(CPUARM)
+  memset(channelOutputsBuffers, 0, sizeof(channelOutputsBuffers));
+#else
+  memset(channelOutputs, 0, sizeof(channelOutputs));
+#endif
+  memset(chans, 0, sizeof(chans));
+  memset(ex_chans, 0, sizeof(ex_chans));
+  memset(act, 0, sizeof(act));
+  memset(swOn, 0, sizeof(swOn));
+  extern uint8_t s_mixer_first_run_done;
+  s_mixer_first_run_done = false;
+  mixerCurrentFlightMode = 0;
+  lastFlightMode = 255;
+#if defined(CPUARM)
+  flightModesFadeSharing = true;
+#endif
+  logicalSwitchesReset();
+}
+
+static void benchSetMixes()
+{
+#if defined(VIRTUALINPUTS)
+  defaultInputs();
+#endif
+
+  for (int i=0; i<MAX_MIXERS; i++) {
+    MixData * md = mixAddress(i);
+    md->destCh = i % 16;
+    md->weight = 100 - i;
+    switch (i % 8) {
+      case 0:
+#if defined(VIRTUALINPUTS)
+        md->srcRaw = MIXSRC_FIRST_INPUT + (i / 8) % NUM_STICKS;
+#else
+        md->srcRaw = MIXSRC_Rud + (i / 8) % NUM_STICKS;
+#endif
+        break;
+      case 1:
+        md->srcRaw = MIXSRC_FIRST_POT;
+        md->offset = 10;
+        break;
+      case 2:
+        md->srcRaw = MIXSRC_Thr;
+        md->swtch = TR(SWSRC_THR, SWSRC_SA0);
+        break;
+      case 3:
+        md->srcRaw = MIXSRC_MAX;
+        md->swtch = SWSRC_SW1;
+        break;
+      case 4:
+        md->srcRaw = MIXSRC_Ail;
+        md->speedUp = md->speedDown = SLOW_STEP;
+        break;
+      case 5:
+        md->srcRaw = MIXSRC_CH1 + (i / 8);
+        break;
+      case 6:
+        md->srcRaw = MIXSRC_Ele;
+        md->mltpx = MLTPX_MUL;
+        break;
+      case 7:
+        md->srcRaw = MIXSRC_Rud;
+#if defined(PCBTARANIS)
+        md->curve.type = CURVE_REF_EXPO;
+        md->curve.value = 40;
+#endif
+        break;
+    }
+  }
+}
+
+static void benchSetLogicalSwitches()
+{
+  static const uint8_t functions[] = {
+    LS_FUNC_VPOS, LS_FUNC_VNEG, LS_FUNC_APOS, LS_FUNC_ANEG, LS_FUNC_AND, LS_FUNC_OR, LS_FUNC_XOR, LS_FUNC_EQUAL,
+    LS_FUNC_GREATER, LS_FUNC_LESS, LS_FUNC_DIFFEGREATER, LS_FUNC_ADIFFEGREATER, LS_FUNC_TIMER, LS_FUNC_STICKY, LS_FUNC_VALMOSTEQUAL,
+#if defined(CPUARM)
+    LS_FUNC_RANGE, LS_FUNC_EDGE,
+#endif
+  };
+
+  for (int i=0; i<NUM_LOGICAL_SWITCH; i++) {
+    LogicalSwitchData * cs = lswAddress(i);
+    cs->func = functions[i % DIM(functions)];
+    switch (lswFamily(cs->func)) {
+      case LS_FAMILY_BOOL:
+      case LS_FAMILY_STICKY:
+        cs->v1 = SWSRC_SW1 + (i + 1) % NUM_LOGICAL_SWITCH;
+        cs->v2 = TR(SWSRC_THR, SWSRC_SA0);
+        break;
+      case LS_FAMILY_TIMER:
+        cs->v1 = 5;
+        cs->v2 = 5;
+        break;
+      case LS_FAMILY_EDGE:
+        cs->v1 = SWSRC_SW1 + (i + 3) % NUM_LOGICAL_SWITCH;
+        cs->v2 = 0;
+#if defined(CPUARM)
+        cs->v3 = 10;
+#endif
+        break;
+      case LS_FAMILY_COMP:
+        cs->v1 = MIXSRC_Rud + i % NUM_STICKS;
+        cs->v2 = MIXSRC_Rud + (i + 1) % NUM_STICKS;
+        break;
+      default:
+        cs->v1 = MIXSRC_Rud + i % NUM_STICKS;
+        cs->v2 = i * 3 - 40;
+        break;
+    }
+  }
+}
+
+// the sticks move a little at each cycle, as they would in the hands of a pilot
+static void benchMoveSticks()
+{
+  benchTime++;
+  g_tmr10ms = benchTime;
+  for (int i=0; i<NUM_STICKS+NUM_POTS; i++) {
+    anaInValues[i] = 1024 + (benchTime * (i + 3) * 37) % 2048;
+  }
+}
+
+static void benchSetupModel()
+{
+  benchResetModel();
+  benchSetMixes();
+  benchSetLogicalSwitches();
+  for (int i=0; i<10; i++) {
+    benchMoveSticks();
+    doMixerCalculations();
+  }
+}
+
+BENCHMARK(Mixer, doMixerCalculations, benchSetupModel)
+{
+  benchMoveSticks();
+  doMixerCalculations();
+}
+
+BENCHMARK(Mixer, evalLogicalSwitches, benchSetupModel)
+{
+  benchMoveSticks();
+  evalLogicalSwitches();
+}
+
+#if defined(CPUARM)
+// FM1 follows the elevator stick, moved from one end to the other every 0.5s, so that
+// the two flight modes keep fading into each other
+static void benchSetupFadingModel()
+{
+  benchSetupModel();
+  LogicalSwitchData * cs = lswAddress(0);
+  cs->func = LS_FUNC_VPOS;
+  cs->v1 = MIXSRC_Ele;
+  g_model.flightModeData[0].fadeIn = g_model.flightModeData[0].fadeOut = 10;
+  g_model.flightModeData[1].swtch = SWSRC_SW1;
+  g_model.flightModeData[1].fadeIn = g_model.flightModeData[1].fadeOut = 10;
+  for (int i=0; i<MAX_MIXERS; i+=4) {
+    mixAddress(i)->flightModes = 0x02; // disabled in FM1
+  }
+}
+
+static void benchMoveSticksFading()
+{
+  benchMoveSticks();
+  anaInValues[ELE_STICK] = ((benchTime / 50) & 1) ? 2048 : 0;
+}
+
+static void benchSetupFadeShared()
+{
+  benchSetupFadingModel();
+  flightModesFadeSharing = true;
+}
+
+static void benchSetupFadeFull()
+{
+  benchSetupFadingModel();
+  flightModesFadeSharing = false;
+}
+
+BENCHMARK(Mixer, fadeShared, benchSetupFadeShared)
+{
+  benchMoveSticksFading();
+  doMixerCalculations();
+}
+
+BENCHMARK(Mixer, fadeFull, benchSetupFadeFull)
+{
+  benchMoveSticksFading();
+  doMixerCalculations();
+}
+
+// the same random limits than the gtests, without the channels overrides
+static int32_t benchLimitsValues[NUM_CHNOUT];
+static int16_t benchLimitsOutputs[NUM_CHNOUT];
+
+static void benchSetupLimits()
+{
+  benchResetModel();
+  srand(42);
+  for (int i=0; i<NUM_CHNOUT; i++) {
+    LimitData * lim = limitAddress(i);
+#if defined(PCBTARANIS)
+    lim->min = rand() % 1001 - 500;
+    lim->max = rand() % 1001 - 500;
+    lim->curve = rand() % 3 - 1;
+#else
+    lim->min = rand() % 201 - 100;
+    lim->max = rand() % 201 - 100;
+#endif
+    lim->offset = rand() % 2001 - 1000;
+    lim->symetrical = rand() & 1;
+    lim->revert = rand() & 1;
+  }
+  for (int i=0; i<NUM_CHNOUT; i++) {
+    benchLimitsValues[i] = (rand() % (2*RESX+1) - RESX) * 256;
+  }
+}
+
+BENCHMARK(Mixer, applyLimits, benchSetupLimits)
+{
+  for (int i=0; i<NUM_CHNOUT; i++) {
+    benchLimitsOutputs[i] = applyLimits(i, benchLimitsValues[i]);
+  }
+}
+
+BENCHMARK(Mixer, evalLimits, benchSetupLimits)
+{
+  evalLimits(benchLimitsValues, benchLimitsOutputs);
+}
+
+// the inputs of a stick moved quickly from the center to near the end, shifted for each analog
+static const uint16_t benchAnalogTrace[] = {
+  2048, 2050, 2047, 2049, 2130, 2260, 2420, 2600, 2790, 2980, 3160, 3320, 3450, 3540, 3590, 3601,
+  3598, 3603, 3600, 3597, 3602, 3599, 3601, 3600, 3598, 3602, 3600, 3601, 3599, 3603, 3600, 3598,
+};
+static int benchAnalogIndex = 0;
+static volatile int32_t benchAnalogResult;   // keeps the calibration results
+static AnalogFilter benchAnalogFilters[NUMBER_ANALOG];
+static uint16_t benchAnalogFiltered[NUMBER_ANALOG];
+
+static void benchSetupAnalogs()
+{
+  for (int i=0; i<NUM_STICKS+NUM_POTS; i++) {
+    g_eeGeneral.calib[i].spanNeg = 900 + i;
+    g_eeGeneral.calib[i].spanPos = 1000 - i;
+  }
+  updateCalibrationMultipliers();
+  memclear(benchAnalogFilters, sizeof(benchAnalogFilters));
+  memclear(benchAnalogFiltered, sizeof(benchAnalogFiltered));
+  benchAnalogIndex = 0;
+}
+
+static inline uint16_t benchAnalogInput(int i)
+{
+  return benchAnalogTrace[(benchAnalogIndex + i) % DIM(benchAnalogTrace)];
+}
+
+// the division done by evalSticks() before the multipliers
+BENCHMARK(Analogs, calibrationDivisions, benchSetupAnalogs)
+{
+  for (int i=0; i<NUM_STICKS+NUM_POTS; i++) {
+    int16_t v = benchAnalogInput(i) - 2048;
+    benchAnalogResult += v * (int32_t)RESX / (max((int16_t)100, (v>0 ? g_eeGeneral.calib[i].spanPos : g_eeGeneral.calib[i].spanNeg)));
+  }
+  benchAnalogIndex++;
+}
+
+BENCHMARK(Analogs, calibrationMultipliers, benchSetupAnalogs)
+{
+  for (int i=0; i<NUM_STICKS+NUM_POTS; i++) {
+    int16_t v = benchAnalogInput(i) - 2048;
+    benchAnalogResult += applyCalibration(i, v);
+  }
+  benchAnalogIndex++;
+}
+
+BENCHMARK(Analogs, filterChain, benchSetupAnalogs)
+{
+  for (int i=0; i<NUMBER_ANALOG; i++) {
+    benchAnalogFiltered[i] = analogFilterApply(benchAnalogFilters[i], benchAnalogFiltered[i], benchAnalogInput(i), ANALOG_FILTER_MEDIAN|ANALOG_FILTER_EURO|ANALOG_FILTER_JITTER);
+  }
+  benchAnalogIndex++;
+}
+#endif
+
+#if defined(CPUARM) && defined(FRSKY_SPORT)
+#define BENCH_SENSORS          40
+#define BENCH_SENSOR_VALUES    8
+#define BENCH_SPORT_FRAME      (BENCH_SENSORS+1)  // the sensors and the receiver RSSI
+
+bool checkSportPacket(uint8_t * packet);
+void processSportPacket(uint8_t * packet);
+
+static uint8_t benchSportPackets[BENCH_SPORT_FRAME*BENCH_SENSOR_VALUES][FRSKY_SPORT_PACKET_SIZE];
+static int benchSportIndex = 0;
+
+static void benchSetSportPacket(uint8_t * packet, uint8_t physicalId, uint16_t id, uint32_t data)
+{
+  packet[0] = physicalId;
+  packet[1] = DATA_FRAME;
+  *((uint16_t *)(packet+2)) = id;
+  *((uint32_t *)(packet+4)) = data;
+  short crc = 0;
+  for (int i=1; i<FRSKY_SPORT_PACKET_SIZE-1; i++) {
+    crc += packet[i];
+    crc += crc >> 8;
+    crc &= 0x00ff;
+    crc += crc >> 8;
+    crc &= 0x00ff;
+  }
+  packet[FRSKY_SPORT_PACKET_SIZE-1] = 0xFF - crc;
+}
+
+// 8 kinds of sensors with 5 instances each, the packets of a sensor are interleaved with the others,
+// each round starts with the RSSI which keeps the telemetry streaming
+static void benchSetupSensors()
+{
+  static const uint16_t kinds[] = { ALT_FIRST_ID, VARIO_FIRST_ID, CURR_FIRST_ID, VFAS_FIRST_ID, T1_FIRST_ID, T2_FIRST_ID, RPM_FIRST_ID, FUEL_FIRST_ID };
+
+  for (int value=0; value<BENCH_SENSOR_VALUES; value++) {
+    uint8_t (* frame)[FRSKY_SPORT_PACKET_SIZE] = &benchSportPackets[value*BENCH_SPORT_FRAME];
+    benchSetSportPacket(frame[0], 0, RSSI_ID, 80 + value);
+    for (int sensor=0; sensor<BENCH_SENSORS; sensor++) {
+      int kind = sensor % DIM(kinds);
+      int instance = sensor / DIM(kinds);
+      benchSetSportPacket(frame[1+sensor], kind, kinds[kind] + instance, 100 + value * 10 + sensor);
+    }
+  }
+}
+
+// the radio discovers the sensors until its MAX_SENSORS slots are full, the packets of the others are ignored
+static void benchSetupTelemetry()
+{
+  benchSetupModel();
+  benchSetupSensors();
+  memclear(&frskyData, sizeof(frskyData));
+  for (int i=0; i<MAX_SENSORS; i++) {
+    telemetryItems[i].clear();
+  }
+  allowNewSensors = true;
+  for (int i=0; i<BENCH_SPORT_FRAME && availableTelemetryIndex() >= 0; i++) {
+    processSportPacket(benchSportPackets[i]);
+  }
+  allowNewSensors = false;
+  benchSportIndex = 0;
+}
+
+BENCHMARK(Telemetry, processSportPacket, benchSetupTelemetry)
+{
+  processSportPacket(benchSportPackets[benchSportIndex]);
+  if (++benchSportIndex == DIM(benchSportPackets))
+    benchSportIndex = 0;
+}
+
+// the same packets as received on the S.Port line, with the byte stuffing, all of them per op
+extern uint8_t dataState;
+void processSerialData(uint8_t data);
+
+static uint8_t benchSportStream[DIM(benchSportPackets)*(2*FRSKY_SPORT_PACKET_SIZE)];
+static int benchSportStreamLen = 0;
+
+static void benchSetupSportStream()
+{
+  benchSetupTelemetry();
+  telemetryProtocol = PROTOCOL_FRSKY_SPORT;
+  dataState = STATE_DATA_IDLE;
+  benchSportStreamLen = 0;
+  for (unsigned int i=0; i<DIM(benchSportPackets); i++) {
+    const uint8_t * packet = benchSportPackets[i];
+    benchSportStream[benchSportStreamLen++] = START_STOP;
+    benchSportStream[benchSportStreamLen++] = packet[0];
+    for (int j=1; j<FRSKY_SPORT_PACKET_SIZE; j++) {
+      if (packet[j] == START_STOP || packet[j] == BYTESTUFF) {
+        benchSportStream[benchSportStreamLen++] = BYTESTUFF;
+        benchSportStream[benchSportStreamLen++] = packet[j] ^ STUFF_MASK;
+      }
+      else {
+        benchSportStream[benchSportStreamLen++] = packet[j];
+      }
+    }
+  }
+}
+
+BENCHMARK(Telemetry, processSerialData, benchSetupSportStream)
+{
+  for (int i=0; i<benchSportStreamLen; i++) {
+    processSerialData(benchSportStream[i]);
+  }
+}
+
+BENCHMARK(Telemetry, processSerialBuffer, benchSetupSportStream)
+{
+  uint8_t chunk[TELEMETRY_RX_CHUNK_SIZE];
+  for (int i=0; i<benchSportStreamLen; i+=TELEMETRY_RX_CHUNK_SIZE) {
+    int count = min(TELEMETRY_RX_CHUNK_SIZE, benchSportStreamLen-i);
+    memcpy(chunk, benchSportStream+i, count);
+    processSerialBuffer(chunk, count);
+  }
+}
+
+// one second of S.Port line with the RSSI and the sensors every 100ms, the radio wakes up every 10ms
+static void benchSetupTelemetryStream()
+{
+  benchSetupModel();
+  memclear(&frskyData, sizeof(frskyData));
+  for (int i=0; i<MAX_SENSORS; i++) {
+    telemetryItems[i].clear();
+  }
+  telemetryProtocol = PROTOCOL_FRSKY_SPORT;
+  telemetryStream.init(PROTOCOL_FRSKY_SPORT);
+  telemetryStream.addSensor(RSSI_ID, 0x18, 100, 80);
+  for (int i=0; i<BENCH_SENSORS; i++) {
+    telemetryStream.addSensor(T1_FIRST_ID + i/16, i%16, 100, i, 1);
+  }
+  allowNewSensors = true;
+  telemetryStream.run(1000);
+  allowNewSensors = false;
+}
+
+BENCHMARK(Telemetry, stream, benchSetupTelemetryStream)
+{
+  telemetryStream.run(1000);
+}
+
+// 16 cells sensors, then 16 calculated sensors using them, one cell is updated per pass
+static int benchCellIndex = 0;
+static int benchCellValue = 0;
+
+static void benchSetupCalculatedSensors()
+{
+  benchResetModel();
+  for (int i=0; i<MAX_SENSORS; i++) {
+    telemetryItems[i].clear();
+  }
+  for (int i=0; i<MAX_SENSORS/2; i++) {
+    g_model.telemetrySensors[i].init("Cell", UNIT_VOLTS, 2);
+    telemetryItems[i].setValue(g_model.telemetrySensors[i], 1000+i, UNIT_VOLTS, 2);
+  }
+  for (int i=MAX_SENSORS/2; i<MAX_SENSORS; i++) {
+    TelemetrySensor & sensor = g_model.telemetrySensors[i];
+    sensor.init("Calc", UNIT_VOLTS, 2);
+    sensor.type = TELEM_TYPE_CALCULATED;
+    sensor.formula = TELEM_FORMULA_ADD + (i % 4);
+    sensor.calc.sources[0] = i-MAX_SENSORS/2+1;
+    sensor.calc.sources[1] = (i+1)%(MAX_SENSORS/2)+1;
+  }
+  telemetrySensorsDirty = true;
+  evalCalculatedSensors();
+  benchCellIndex = 0;
+  benchCellValue = 0;
+}
+
+static void benchUpdateCell()
+{
+  telemetryItems[benchCellIndex].setValue(g_model.telemetrySensors[benchCellIndex], 1000+benchCellValue, UNIT_VOLTS, 2);
+  if (++benchCellIndex == MAX_SENSORS/2)
+    benchCellIndex = 0;
+  if (++benchCellValue == 100)
+    benchCellValue = 0;
+}
+
+// all the calculated sensors evaluated on each pass, as done before their evaluation order
+BENCHMARK(Telemetry, evalAllCalculatedSensors, benchSetupCalculatedSensors)
+{
+  benchUpdateCell();
+  for (int i=0; i<MAX_SENSORS; i++) {
+    const TelemetrySensor & sensor = g_model.telemetrySensors[i];
+    if (sensor.type == TELEM_TYPE_CALCULATED) {
+      telemetryItems[i].eval(sensor);
+    }
+  }
+}
+
+BENCHMARK(Telemetry, evalCalculatedSensors, benchSetupCalculatedSensors)
+{
+  benchUpdateCell();
+  evalCalculatedSensors();
+}
+#endif
+
+static void benchSetupLcd()
+{
+  lcd_clear();
+}
+
+BENCHMARK(Lcd, putsAtt, benchSetupLcd)
+{
+  lcd_putsAtt(0, 0, "Throttle cut", 0);
+  lcd_putsAtt(0, FH, "Throttle cut", INVERS);
+  lcd_putsAtt(0, 2*FH, "Throttle cut", SMLSIZE);
+  lcd_putsAtt(0, 3*FH, "Throttle cut", MIDSIZE);
+  lcd_putsAtt(0, 5*FH, "Throttle cut", DBLSIZE);
+}
+
+#if defined(PCBTARANIS)
+// the files are written in the current directory, outside of the simulated SD card
+#define BENCH_CAPTURE_BMP   "./bench-capture.bmp"
+#define BENCH_CAPTURE_OTC   "./bench-capture.otc"
+
+static int benchCaptureFrame = 0;
+
+static void benchDrawCaptureScreen()
+{
+  lcd_clear();
+  for (int i=0; i<16; i++) {
+    drawFilledRect(i*13, 40, 13, 24, SOLID, GREY(i));
+  }
+  lcd_putsAtt(benchCaptureFrame % 100, 8, "Capture test", DBLSIZE);
+  lcd_outdezAtt(10*FW, 30, benchCaptureFrame, LEFT);
+}
+
+static void benchRemoveCaptureFiles()
+{
+  if (captureRunning())
+    captureStop();
+  unlink(BENCH_CAPTURE_BMP);
+  unlink(BENCH_CAPTURE_OTC);
+}
+
+static void benchSetupCapture()
+{
+  static bool cleanup = false;
+  if (!cleanup) {
+    atexit(benchRemoveCaptureFiles);
+    cleanup = true;
+  }
+  benchRemoveCaptureFiles();
+  benchCaptureFrame = 0;
+  benchDrawCaptureScreen();
+}
+
+static uint8_t benchCapturePixel(unsigned int x, unsigned int y)
+{
+  if (x>=LCD_W || y>=LCD_H)
+    return 0;
+  display_t * p = &displayBuf[y / 2 * LCD_W + x];
+  return (y & 1) ? (*p >> 4) : (*p & 0x0F);
+}
+
+// the screenshot as it was written before, pixel by pixel and byte by byte
+BENCHMARK(Capture, writeBmpPixels, benchSetupCapture)
+{
+  static const uint8_t header[118] = { 'B', 'M' };
+  FIL bmpFile;
+  UINT written;
+
+  f_open(&bmpFile, BENCH_CAPTURE_BMP, FA_CREATE_ALWAYS | FA_WRITE);
+  f_write(&bmpFile, header, sizeof(header), &written);
+  for (int y=LCD_H-1; y>=0; y-=1) {
+    for (int x=0; x<8*((LCD_W+7)/8); x+=2) {
+      uint8_t byte = benchCapturePixel(x+1, y) + (benchCapturePixel(x, y) << 4);
+      f_write(&bmpFile, &byte, 1, &written);
+    }
+  }
+  f_close(&bmpFile);
+}
+
+BENCHMARK(Capture, writeBmp, benchSetupCapture)
+{
+  captureWriteBmp(BENCH_CAPTURE_BMP);
+}
+
+static display_t benchCaptureScreens[2][DISPLAY_BUF_SIZE];
+
+static void benchSetupCaptureRecording()
+{
+  benchSetupCapture();
+  for (int i=0; i<2; i++) {
+    benchCaptureFrame = i;
+    benchDrawCaptureScreen();
+    memcpy(benchCaptureScreens[i], displayBuf, DISPLAY_BUF_SIZE);
+  }
+  benchCaptureFrame = 0;
+  captureStart(BENCH_CAPTURE_OTC);
+}
+
+// the screen only changes every other frame
+BENCHMARK(Capture, frame, benchSetupCaptureRecording)
+{
+  if (++benchCaptureFrame % 2 == 0)
+    memcpy(displayBuf, benchCaptureScreens[(benchCaptureFrame/2) % 2], DISPLAY_BUF_SIZE);
+  captureFrame();
+}
+#endif
+
+#if defined(EEPROM_RLC)
+static uint8_t benchModelBuffer[sizeof(ModelData)];
+
+static void benchSetupEeprom()
+{
+  benchSetupModel();
+  eepromFile = NULL; // in memory
+  eepromFormat();
+  theFile.writeRlc(FILE_MODEL(0), FILE_TYP_MODEL|FILE_TYP_ENCODING, (uint8_t *)&g_model, sizeof(g_model), true);
+}
+
+BENCHMARK(Eeprom, writeModel, benchSetupEeprom)
+{
+  theFile.writeRlc(FILE_MODEL(0), FILE_TYP_MODEL|FILE_TYP_ENCODING, (uint8_t *)&g_model, sizeof(g_model), true);
+}
+
+BENCHMARK(Eeprom, readModel, benchSetupEeprom)
+{
+  theFile.openRd(FILE_MODEL(0));
+  theFile.readRlc(benchModelBuffer, sizeof(benchModelBuffer));
+}
+
+#if defined(PCBTARANIS)
+// the same model RLC encoded, as the firmwares before the EEPROM v218 wrote it
+static void benchSetupEepromRlc()
+{
+  benchSetupModel();
+  eepromFile = NULL; // in memory
+  eepromFormat();
+  theFile.writeRlc(FILE_MODEL(0), FILE_TYP_MODEL, (uint8_t *)&g_model, sizeof(g_model), true);
+}
+
+BENCHMARK(Eeprom, writeModelRlc, benchSetupEepromRlc)
+{
+  theFile.writeRlc(FILE_MODEL(0), FILE_TYP_MODEL, (uint8_t *)&g_model, sizeof(g_model), true);
+}
+
+BENCHMARK(Eeprom, readModelRlc, benchSetupEepromRlc)
+{
+  theFile.openRd(FILE_MODEL(0));
+  theFile.readRlc(benchModelBuffer, sizeof(benchModelBuffer));
+}
+#endif
+#endif
+
+#if defined(LUA)
+static char benchSdDirectory[] = "/tmp/otxbenchXXXXXX";
+
+static const char benchMixScript[] =
+  "local inputs = { { \"Src\", SOURCE }, { \"Rate\", VALUE, -100, 100, 50 } }\n"
+  "local outputs = { \"Mix\", \"Thr\" }\n"
+  "local filtered = 0\n"
+  "local function run(src, rate)\n"
+  "  filtered = filtered + (src - filtered) / 4\n"
+  "  return math.floor(filtered * rate / 100), getValue(\"thr\")\n"
+  "end\n"
+  "return { input=inputs, output=outputs, run=run }\n";
+
+static void benchRemoveSdDirectory()
+{
+  char path[sizeof(benchSdDirectory)+64];
+  const char * const files[] = { SCRIPTS_MIXES_PATH "/bench.lua", SCRIPTS_MIXES_PATH "/bench.luac", SCRIPTS_MIXES_PATH, SCRIPTS_PATH, "" };
+  for (unsigned int i=0; i<DIM(files); i++) {
+    snprintf(path, sizeof(path), "%s%s", benchSdDirectory, files[i]);
+    remove(path);
+  }
+}
+
+// the script is written in a temporary SD card directory
+static void benchSetupLua()
+{
+  benchSetupModel();
+
+  if (!simuSdDirectory[0] || strcmp(simuSdDirectory, benchSdDirectory)) {
+    if (!mkdtemp(benchSdDirectory))
+      return;
+    atexit(benchRemoveSdDirectory);
+    strcpy(simuSdDirectory, benchSdDirectory);
+    char path[sizeof(benchSdDirectory)+64];
+    snprintf(path, sizeof(path), "%s" SCRIPTS_PATH, benchSdDirectory);
+    mkdir(path, 0777);
+    snprintf(path, sizeof(path), "%s" SCRIPTS_MIXES_PATH, benchSdDirectory);
+    mkdir(path, 0777);
+    snprintf(path, sizeof(path), "%s" SCRIPTS_MIXES_PATH "/bench.lua", benchSdDirectory);
+    FILE * file = fopen(path, "w");
+    if (file) {
+      fputs(benchMixScript, file);
+      fclose(file);
+    }
+  }
+
+  strncpy(g_model.scriptsData[0].file, "bench", sizeof(g_model.scriptsData[0].file));
+  g_model.scriptsData[0].inputs[0] = MIXSRC_Thr;
+  LUA_LOAD_MODEL_SCRIPTS();
+  luaTask(0, RUN_MIX_SCRIPT, false);
+}
+
+BENCHMARK(Lua, luaTask, benchSetupLua)
+{
+  benchMoveSticks();
+  luaTask(0, RUN_MIX_SCRIPT, false);
+}
+
+#if defined(PCBTARANIS)
+// a telemetry screen with 3 icons, drawn from the SD card, then by a script through the bitmaps cache
+extern void luaInit();
+
+static void benchSetupBitmaps()
+{
+  if (!L)
+    luaInit();
+  luaLcdAllowed = true;
+  luaFreeBitmaps();
+  luaL_dostring(L, "function benchFrame() "
+                   "lcd.drawPixmap(0, 0, './tests/4b_20x20.bmp') "
+                   "lcd.drawPixmap(30, 0, './tests/4b_31x31.bmp') "
+                   "lcd.drawPixmap(70, 0, './tests/1b_39x32.bmp') "
+                   "end");
+}
+
+BENCHMARK(Lua, drawBitmapsFromSd, benchSetupBitmaps)
+{
+  uint8_t bitmap[BITMAP_BUFFER_SIZE(LCD_W/2, LCD_H)];
+  if (!bmpLoad(bitmap, "./tests/4b_20x20.bmp", LCD_W/2, LCD_H)) lcd_bmp(0, 0, bitmap);
+  if (!bmpLoad(bitmap, "./tests/4b_31x31.bmp", LCD_W/2, LCD_H)) lcd_bmp(30, 0, bitmap);
+  if (!bmpLoad(bitmap, "./tests/1b_39x32.bmp", LCD_W/2, LCD_H)) lcd_bmp(70, 0, bitmap);
+}
+
+BENCHMARK(Lua, drawBitmapsCached, benchSetupBitmaps)
+{
+  lua_getglobal(L, "benchFrame");
+  lua_pcall(L, 0, 0, 0);
+}
+#endif
+#endif
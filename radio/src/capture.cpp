@@ -0,0 +1,317 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include "opentx.h"
+
+FRESULT CaptureFile::open(const char * filename)
+{
+  count = 0;
+  return f_open(&file, filename, FA_CREATE_ALWAYS | FA_WRITE);
+}
+
+FRESULT CaptureFile::flush()
+{
+  UINT written;
+  FRESULT result = f_write(&file, buffer, count, &written);
+  if (result == FR_OK && written != count)
+    result = FR_DENIED;  // the card is full
+  count = 0;
+  return result;
+}
+
+FRESULT CaptureFile::write(const void * data, uint32_t size)
+{
+  const uint8_t * src = (const uint8_t *)data;
+
+  while (size > 0) {
+    uint32_t len = min<uint32_t>(size, CAPTURE_CHUNK_SIZE - count);
+    memcpy(&buffer[count], src, len);
+    count += len;
+    src += len;
+    size -= len;
+    if (count == CAPTURE_CHUNK_SIZE) {
+      FRESULT result = flush();
+      if (result != FR_OK)
+        return result;
+    }
+  }
+
+  return FR_OK;
+}
+
+FRESULT CaptureFile::close()
+{
+  FRESULT result = FR_OK;
+  if (count > 0)
+    result = flush();
+  FRESULT closeResult = f_close(&file);
+  return result != FR_OK ? result : closeResult;
+}
+
+#define BMP_ROW_SIZE    (((4*LCD_W+31)/32)*4)
+
+const uint8_t bmpHeader[] = {
+  0x42, 0x4d, 0xF8, 0x1A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x76, 0x00, 0x00, 0x00, 0x28, 0x00,
+  0x00, 0x00, 212,  0x00, 0x00, 0x00, 64,   0x00, 0x00, 0x00, 0x01, 0x00, 0x04, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x02, 0x04, 0x00, 0x00, 0xbc, 0x38, 0x00, 0x00, 0xbc, 0x38, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x00, 0xee, 0xee, 0xee, 0x00, 0xdd, 0xdd,
+  0xdd, 0x00, 0xcc, 0xcc, 0xcc, 0x00, 0xbb, 0xbb, 0xbb, 0x00, 0xaa, 0xaa, 0xaa, 0x00, 0x99, 0x99,
+  0x99, 0x00, 0x88, 0x88, 0x88, 0x00, 0x77, 0x77, 0x77, 0x00, 0x66, 0x66, 0x66, 0x00, 0x55, 0x55,
+  0x55, 0x00, 0x44, 0x44, 0x44, 0x00, 0x33, 0x33, 0x33, 0x00, 0x22, 0x22, 0x22, 0x00, 0x11, 0x11,
+  0x11, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+void captureEncodeBmpRow(uint8_t * dst, const display_t * src, coord_t y)
+{
+  // 2 rows are stored in each byte of the display buffer, the even one in the low nibble
+  const display_t * p = src + (y / 2) * LCD_W;
+  const display_t * end = p + LCD_W;
+  uint8_t * q = dst;
+
+  if (y & 1) {
+    while (p < end) {
+      *q++ = (p[0] & 0xF0) | (p[1] >> 4);
+      p += 2;
+    }
+  }
+  else {
+    while (p < end) {
+      *q++ = (p[0] << 4) | (p[1] & 0x0F);
+      p += 2;
+    }
+  }
+
+  memclear(q, dst + BMP_ROW_SIZE - q);
+}
+
+const char * captureWriteBmp(const char * filename)
+{
+  CaptureFile file;
+  uint8_t row[BMP_ROW_SIZE];
+
+  FRESULT result = file.open(filename);
+  if (result != FR_OK) {
+    return SDCARD_ERROR(result);
+  }
+
+  result = file.write(bmpHeader, sizeof(bmpHeader));
+
+  // the BMP rows are stored from the bottom
+  for (int y=LCD_H-1; result==FR_OK && y>=0; y--) {
+    captureEncodeBmpRow(row, displayBuf, y);
+    result = file.write(row, BMP_ROW_SIZE);
+  }
+
+  FRESULT closeResult = file.close();
+  if (result == FR_OK)
+    result = closeResult;
+
+  return result == FR_OK ? NULL : SDCARD_ERROR(result);
+}
+
+static const char * captureGetFilename(char * filename, const char * prefix, const char * extension)
+{
+  DIR folder;
+
+  // check and create folder here
+  strcpy_P(filename, SCREENSHOTS_PATH);
+  FRESULT result = f_opendir(&folder, filename);
+  if (result != FR_OK) {
+    if (result == FR_NO_PATH)
+      result = f_mkdir(filename);
+    if (result != FR_OK)
+      return SDCARD_ERROR(result);
+  }
+
+  char * tmp = strAppend(&filename[sizeof(SCREENSHOTS_PATH)-1], prefix);
+  tmp = strAppendDate(tmp, true);
+  strcpy(tmp, extension);
+  return NULL;
+}
+
+const char * writeScreenshot()
+{
+  char filename[42]; // /SCREENSHOTS/screen-2013-01-01-123540.bmp
+
+  const char * error = captureGetFilename(filename, "/screen", BITMAPS_EXT);
+  if (error) {
+    return error;
+  }
+
+  return captureWriteBmp(filename);
+}
+
+uint8_t captureDiff(const display_t * frame, display_t * previous, uint8_t * blocks)
+{
+  uint8_t count = 0;
+
+  for (uint8_t i=0; i<CAPTURE_BLOCKS; i++) {
+    if (memcmp(frame, previous, CAPTURE_BLOCK_SIZE)) {
+      memcpy(previous, frame, CAPTURE_BLOCK_SIZE);
+      blocks[count++] = i;
+    }
+    frame += CAPTURE_BLOCK_SIZE;
+    previous += CAPTURE_BLOCK_SIZE;
+  }
+
+  return count;
+}
+
+struct CaptureRecorder {
+  CaptureFile file;
+  tmr10ms_t start;
+  display_t previous[DISPLAY_BUF_SIZE];
+};
+
+// only allocated during a recording
+static CaptureRecorder * captureRecorder = NULL;
+static volatile bool captureToggle = false;
+
+static void putCaptureInt(uint8_t * &p, uint32_t value, uint8_t size)
+{
+  for (uint8_t i=0; i<size; i++) {
+    *p++ = value >> (8*i);
+  }
+}
+
+const char * captureStart(const char * filename)
+{
+  char name[42]; // /SCREENSHOTS/capture-2013-01-01-123540.otc
+
+  if (captureRecorder) {
+    return NULL;
+  }
+
+  if (!filename) {
+    const char * error = captureGetFilename(name, "/capture", CAPTURES_EXT);
+    if (error) {
+      return error;
+    }
+    filename = name;
+  }
+
+  captureRecorder = (CaptureRecorder *)malloc(sizeof(CaptureRecorder));
+  if (!captureRecorder) {
+    return "Not enough memory";
+  }
+
+  // the first frame holds the blocks which are not blank
+  memclear(captureRecorder->previous, DISPLAY_BUF_SIZE);
+  captureRecorder->start = get_tmr10ms();
+
+  uint8_t header[12] = { 'O', 'T', 'X', 'C', CAPTURE_VERSION, 4 };
+  uint8_t * p = &header[6];
+  putCaptureInt(p, LCD_W, 2);
+  putCaptureInt(p, LCD_H, 2);
+  putCaptureInt(p, CAPTURE_BLOCK_SIZE, 2);
+
+  FRESULT result = captureRecorder->file.open(filename);
+  if (result == FR_OK) {
+    result = captureRecorder->file.write(header, sizeof(header));
+    if (result != FR_OK) {
+      captureRecorder->file.close();
+    }
+  }
+
+  if (result != FR_OK) {
+    free(captureRecorder);
+    captureRecorder = NULL;
+    return SDCARD_ERROR(result);
+  }
+
+  return NULL;
+}
+
+void captureStop()
+{
+  if (captureRecorder) {
+    captureRecorder->file.close();
+    free(captureRecorder);
+    captureRecorder = NULL;
+  }
+}
+
+bool captureRunning()
+{
+  return captureRecorder != NULL;
+}
+
+void captureRequestToggle()
+{
+  captureToggle = true;
+}
+
+void captureFrame()
+{
+  if (captureToggle) {
+    captureToggle = false;
+    if (captureRecorder)
+      captureStop();
+    else
+      captureStart();
+  }
+
+  if (!captureRecorder) {
+    return;
+  }
+
+  uint8_t blocks[CAPTURE_BLOCKS];
+  uint8_t count = captureDiff(displayBuf, captureRecorder->previous, blocks);
+  if (count == 0) {
+    return;
+  }
+
+  uint8_t header[5];
+  uint8_t * p = header;
+  putCaptureInt(p, get_tmr10ms() - captureRecorder->start, 4);
+  putCaptureInt(p, count, 1);
+
+  CaptureFile & file = captureRecorder->file;
+  FRESULT result = file.write(header, sizeof(header));
+  for (uint8_t i=0; result==FR_OK && i<count; i++) {
+    uint8_t block = blocks[i];
+    result = file.write(&block, 1);
+    if (result == FR_OK) {
+      result = file.write(&displayBuf[block * CAPTURE_BLOCK_SIZE], CAPTURE_BLOCK_SIZE);
+    }
+  }
+
+  if (result != FR_OK) {
+    // the card is full or removed
+    captureStop();
+  }
+}
@@ -0,0 +1,86 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#ifndef _CAPTURE_H_
+#define _CAPTURE_H_
+
+#define CAPTURE_CHUNK_SIZE    512   // one sector, FatFs writes it directly when the file position is aligned
+#define CAPTURE_BLOCK_SIZE    64
+#define CAPTURE_BLOCKS        (DISPLAY_BUF_SIZE / CAPTURE_BLOCK_SIZE)
+#define CAPTURE_VERSION       1
+
+#if DISPLAY_BUF_SIZE % CAPTURE_BLOCK_SIZE != 0
+  #error "The display buffer must be made of whole capture blocks"
+#endif
+
+// A file written by chunks of CAPTURE_CHUNK_SIZE
+class CaptureFile
+{
+  public:
+    FRESULT open(const char * filename);
+    FRESULT write(const void * data, uint32_t size);
+    FRESULT close();
+
+  protected:
+    FRESULT flush();
+
+    FIL      file;
+    uint32_t count;
+    uint8_t  buffer[CAPTURE_CHUNK_SIZE];
+};
+
+// One BMP row (4 bits per pixel, padded to 32 bits) from the display buffer
+void captureEncodeBmpRow(uint8_t * dst, const display_t * src, coord_t y);
+const char * captureWriteBmp(const char * filename);
+
+// Fills the indexes of the blocks which changed since the previous frame, which is updated
+uint8_t captureDiff(const display_t * frame, display_t * previous, uint8_t * blocks);
+
+// The frames recording, the file holds a header:
+//   "OTXC", version, bits per pixel, width (16 bits), height (16 bits), block size (16 bits)
+// then each frame which changed:
+//   time in 10ms since the start (32 bits), blocks count, then each block index and its content
+// The blocks are taken from the display buffer as is, the integers are little endian
+const char * captureStart(const char * filename=NULL);
+void captureStop();
+bool captureRunning();
+void captureFrame();
+
+// from another task, the recording is started or stopped by the next captureFrame()
+void captureRequestToggle();
+
+#endif // _CAPTURE_H_
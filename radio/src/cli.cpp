@@ -39,6 +39,9 @@
 
 #define CLI_COMMAND_MAX_ARGS           8
 #define CLI_COMMAND_MAX_LEN            256
+#define CLI_BENCH_ITERATIONS           100
+#define CLI_BENCH_MAX_ITERATIONS       10000
+#define CLI_BENCH_MAX_DURATION         500     // ms, the loop stops earlier
 
 OS_TID cliTaskId;
 TaskStack<CLI_STACK_SIZE> cliStack;
@@ -153,7 +156,17 @@ int cliTrace(const char ** argv)
 int cliStackInfo(const char ** argv)
 {
   int tid = 0;
-  if (toInt(argv, 1, &tid) > 0) {
+  if (*argv[1] == '\0') {
+    // the high-water marks of all the tasks, in the simulator the tasks are threads which don't use these stacks
+    serialPrint("menus %d available (%d total)", menusStack.available(), menusStack.size());
+    serialPrint("mixer %d available (%d total)", mixerStack.available(), mixerStack.size());
+    serialPrint("audio %d available (%d total)", audioStack.available(), audioStack.size());
+    serialPrint("cli   %d available (%d total)", cliStack.available(), cliStack.size());
+#if !defined(SIMU)
+    serialPrint("main  %d available (%d total)", stackAvailable(), stackSize() * 4);
+#endif
+  }
+  else if (toInt(argv, 1, &tid) > 0) {
     int available = 0;
     int total = 0;
     switch(tid) {
@@ -173,10 +186,12 @@ int cliStackInfo(const char ** argv)
         total = cliStack.size();
         available = cliStack.available();
         break;
+#if !defined(SIMU)
       case MAIN_TASK_INDEX:
         total = stackSize() * 4;
         available = stackAvailable();
         break;
+#endif
       default:
         break;
     }
@@ -188,6 +203,181 @@ int cliStackInfo(const char ** argv)
   return 0;
 }
 
+int cliProfile(const char ** argv)
+{
+  if (!strcmp(argv[1], "reset")) {
+    mixerProfiler.reset();
+    maxMixerDuration = 0;
+  }
+  else if (*argv[1] == '\0') {
+    serialPrint("mixer max duration %dus", maxMixerDuration/2);
+    serialPrint("%lu mixer cycles (p50 / p99 / max in us)", mixerProfiler.getCycles());
+    for (int i=0; i<PROFILE_STAGES_COUNT; i++) {
+      serialPrint("%-8s %5d %5d %5d", MixerProfiler::getStageName(i), mixerProfiler.getPercentile(i, 50)/2, mixerProfiler.getPercentile(i, 99)/2, mixerProfiler.getMax(i)/2);
+    }
+  }
+  else {
+    serialPrint("%s: Invalid argument \"%s\"", argv[0], argv[1]);
+  }
+  return 0;
+}
+
+#if defined(FRSKY_SPORT)
+bool checkSportPacket(uint8_t * packet);
+struct FrSkySportSensor;
+const FrSkySportSensor * getFrSkySportSensor(uint16_t id, uint8_t subId);
+
+// a sensor of the DIY range, unknown to the radio
+static uint8_t cliBenchPacket[FRSKY_SPORT_PACKET_SIZE] = { 0x1B, DATA_FRAME, 0x00, 0x52, 0x10, 0x27, 0x00, 0x00, 0x66 };
+static volatile uint8_t cliBenchSensors;
+
+// the packet is checked and its sensors searched like processSportPacket() does, but nothing is stored:
+// the telemetry parser keeps running (it is not under mixerMutex)
+void cliBenchTelemetry()
+{
+  if (checkSportPacket(cliBenchPacket)) {
+    uint16_t id = *((uint16_t *)(cliBenchPacket+2));
+    uint8_t instance = (cliBenchPacket[0] & 0x1F) + 1;
+    uint8_t count = (getFrSkySportSensor(id, 0) != NULL);
+    for (int index=0; index<MAX_SENSORS; index++) {
+      TelemetrySensor & telemetrySensor = g_model.telemetrySensors[index];
+      if (telemetrySensor.type == TELEM_TYPE_CUSTOM && telemetrySensor.id == id && telemetrySensor.subId == 0 && (telemetrySensor.instance == instance || g_model.ignoreSensorIds)) {
+        count++;
+      }
+    }
+    cliBenchSensors = count;
+  }
+}
+#endif
+
+void cliBenchMixer()
+{
+  doMixerCalculations();
+}
+
+void cliBenchLogicalSwitches()
+{
+  evalLogicalSwitches();
+}
+
+// drawn in the screen buffer, the next refresh of the menus erases it
+void cliBenchLcd()
+{
+  lcd_putsAtt(0, 0, "Throttle cut", 0);
+  lcd_putsAtt(0, FH, "Throttle cut", INVERS);
+  lcd_putsAtt(0, 2*FH, "Throttle cut", SMLSIZE);
+  lcd_putsAtt(0, 3*FH, "Throttle cut", MIDSIZE);
+  lcd_putsAtt(0, 5*FH, "Throttle cut", DBLSIZE);
+}
+
+struct CliBenchmark
+{
+  const char * name;
+  void (* func)();
+  bool pauseMixer;
+};
+
+const CliBenchmark cliBenchmarks[] = {
+  { "mixer", cliBenchMixer, true },
+  { "switches", cliBenchLogicalSwitches, true },
+#if defined(FRSKY_SPORT)
+  { "telemetry", cliBenchTelemetry, false },
+#endif
+  { "lcd", cliBenchLcd, false },
+  { NULL, NULL, false }  /* sentinel */
+};
+
+// the mixer task is paused during each iteration of the loops which share its data, and runs (and kicks the
+// watchdog) between them. The min is the cost without any preemption
+void cliRunBenchmark(const CliBenchmark & benchmark, int iterations)
+{
+  uint32_t min = 0xFFFFFFFF, max = 0, total = 0;
+  uint16_t maxDuration = maxMixerDuration;
+  uint32_t maxCycles = getCyclesFrequency() / 1000 * CLI_BENCH_MAX_DURATION;
+  uint32_t begin = getCycles();
+  int count = 0;
+
+  while (count < iterations && getCycles() - begin < maxCycles) {
+    if (benchmark.pauseMixer)
+      pauseMixerCalculations();
+    uint32_t start = getCycles();
+    benchmark.func();
+    uint32_t duration = getCycles() - start;
+    if (benchmark.pauseMixer)
+      resumeMixerCalculations();
+    total += duration;
+    if (duration < min) min = duration;
+    if (duration > max) max = duration;
+    count++;
+  }
+  if (benchmark.pauseMixer) {
+    // the mixer cycles which waited for an iteration are not its longest ones
+    CoTickDelay(5); // 10ms
+    maxMixerDuration = maxDuration;
+  }
+
+  serialPrint("%-9s %6d %9lu %9lu %9lu", benchmark.name, count, (unsigned long)min, (unsigned long)(total / count), (unsigned long)max);
+}
+
+int cliBench(const char ** argv)
+{
+  int iterations = CLI_BENCH_ITERATIONS;
+  if (toInt(argv, 2, &iterations) < 0) {
+    return 0;
+  }
+  if (iterations <= 0 || iterations > CLI_BENCH_MAX_ITERATIONS) {
+    serialPrint("%s: Invalid argument \"%s\"", argv[0], argv[2]);
+    return 0;
+  }
+
+  bool all = (*argv[1] == '\0' || !strcmp(argv[1], "all"));
+  bool found = false;
+  cyclesInit();
+  for (const CliBenchmark * benchmark = cliBenchmarks; benchmark->name != NULL; benchmark++) {
+    if (all || !strcmp(argv[1], benchmark->name)) {
+      if (!found) {
+        serialPrint("cycles per iteration at %luHz", (unsigned long)getCyclesFrequency());
+        serialPrint("%-9s %6s %9s %9s %9s", "loop", "count", "min", "avg", "max");
+        found = true;
+      }
+      cliRunBenchmark(*benchmark, iterations);
+    }
+  }
+  if (!found) {
+    serialPrint("%s: Invalid argument \"%s\"", argv[0], argv[1]);
+  }
+  return 0;
+}
+
+#if defined(DEBUG_TRACE_BUFFER)
+int cliTraceBuffer(const char ** argv)
+{
+  if (!strcmp(argv[1], "dump")) {
+    uint16_t count = getTraceCount();
+    serialPrint("# %d events, %d lost, %lu Hz", count, (int)getTraceLost(), (unsigned long)getTraceFrequency());
+    for (int n=0; n<count; n++) {
+      const struct TraceElement * te = getTraceElement(n);
+      if (te) {
+        serialPrint("%lu %d %c %s 0x%08lx", (unsigned long)te->time, te->context, (te->event & TRACE_PHASE_BEGIN) ? 'B' : ((te->event & TRACE_PHASE_END) ? 'E' : 'i'), getTraceEventName(te->event), (unsigned long)te->data);
+      }
+    }
+  }
+  else if (!strcmp(argv[1], "save")) {
+    const char * result = writeTraceBuffer();
+    if (result) {
+      serialPrint("%s: %s", argv[0], result);
+    }
+  }
+  else if (!strcmp(argv[1], "clear")) {
+    clearTraceBuffer();
+  }
+  else {
+    serialPrint("%s: Invalid argument \"%s\"", argv[0], argv[1]);
+  }
+  return 0;
+}
+#endif
+
 int cliVolume(const char ** argv)
 {
   int level = 0;
@@ -200,6 +390,7 @@ int cliVolume(const char ** argv)
   return 0;
 }
 
+#if !defined(SIMU)
 const MemArea memAreas[] = {
   { "RCC", RCC, sizeof(RCC_TypeDef) },
   { "GPIOA", GPIOA, sizeof(GPIO_TypeDef) },
@@ -213,11 +404,13 @@ const MemArea memAreas[] = {
   { "USART3", USART3, sizeof(USART_TypeDef) },
   { NULL, NULL, 0 },
 };
+#endif
 
 int cliDisplay(const char ** argv)
 {
   int address = 0;
 
+#if !defined(SIMU)
   for (const MemArea * area = memAreas; area->name != NULL; area++) {
     if (!strcmp(area->name, argv[1])) {
       dump((uint8_t *)area->start, area->size);
@@ -230,8 +423,11 @@ int cliDisplay(const char ** argv)
     for (int i=0; i<NUMBER_ANALOG; i++) {
       serialPrint("adc[%d] = %04X", i, Analog_values[i]);
     }
+    return 0;
   }
-  else if (!strcmp(argv[1], "outputs")) {
+#endif
+
+  if (!strcmp(argv[1], "outputs")) {
     for (int i=0; i<NUM_CHNOUT; i++) {
       serialPrint("outputs[%d] = %04X", i, channelOutputs[i]);
     }
@@ -254,11 +450,16 @@ int cliHelp(const char ** argv);
 
 const CliCommand cliCommands[] = {
   { "beep", cliBeep, "[<frequency>] [<duration>]" },
+  { "bench", cliBench, "[mixer | switches | telemetry | lcd | all] [<iterations>]" },
   { "ls", cliLs, "<directory>" },
   { "play", cliPlay, "<filename>" },
   { "print", cliDisplay, "<address> [<size>] | <what>" },
-  { "stackinfo", cliStackInfo, "<tid>" },
+  { "profile", cliProfile, "[reset]" },
+  { "stackinfo", cliStackInfo, "[<tid>]" },
   { "trace", cliTrace, "on | off" },
+#if defined(DEBUG_TRACE_BUFFER)
+  { "tracebuf", cliTraceBuffer, "dump | save | clear" },
+#endif
   { "volume", cliVolume, "<level>" },
   { "help", cliHelp, "[<command>]" },
   { NULL, NULL, NULL }  /* sentinel */
@@ -298,7 +499,10 @@ int cliExecLine(char * line)
 {
   int len = strlen(line);
   const char * argv[CLI_COMMAND_MAX_ARGS];
-  memset(argv, 0, sizeof(argv));
+  // the missing arguments are empty strings, the commands don't check how many they got
+  for (int i=0; i<CLI_COMMAND_MAX_ARGS; i++) {
+    argv[i] = "";
+  }
   int argc = 1;
   argv[0] = line;
   for (int i=0; i<len; i++) {
@@ -312,6 +516,31 @@ int cliExecLine(char * line)
   return cliExecCommand(argv);
 }
 
+#if defined(SIMU)
+// the simulator CLI reads the commands on its standard input
+void * cliThread(void * pdata)
+{
+  char line[CLI_COMMAND_MAX_LEN+1];
+
+  cliPrompt();
+
+  while (fgets(line, sizeof(line), stdin)) {
+    line[strcspn(line, "\r\n")] = '\0';
+    cliExecLine(line);
+    cliPrompt();
+  }
+
+  return NULL;
+}
+
+void cliStart()
+{
+  pthread_t pid;
+  if (!pthread_create(&pid, NULL, &cliThread, NULL)) {
+    pthread_detach(pid);
+  }
+}
+#else
 void cliTask(void * pdata)
 {
   char line[CLI_COMMAND_MAX_LEN+1];
@@ -357,3 +586,4 @@ void cliStart()
 {
   cliTaskId = CoCreateTaskEx(cliTask, NULL, 10, &cliStack.stack[CLI_STACK_SIZE-1], CLI_STACK_SIZE, 1, false);
 }
+#endif
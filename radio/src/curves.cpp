@@ -38,26 +38,44 @@
 
 #if defined(XCURVES)
 int8_t *curveEnd[MAX_CURVES];
-void loadCurves()
+int8_t *shadowCurveEnd[MAX_CURVES];
+
+// the ends always point into g_model.points, where the model will be copied
+static void loadCurves(ModelData & model, int8_t ** ends)
 {
   int8_t * tmp = g_model.points;
   for (int i=0; i<MAX_CURVES; i++) {
-    switch (g_model.curves[i].type) {
+    switch (model.curves[i].type) {
       case CURVE_TYPE_STANDARD:
-        tmp += 5+g_model.curves[i].points;
+        tmp += 5+model.curves[i].points;
         break;
       case CURVE_TYPE_CUSTOM:
-        tmp += 8+2*g_model.curves[i].points;
+        tmp += 8+2*model.curves[i].points;
         break;
       default:
         TRACE("Wrong curve type! Fixing...");
-        g_model.curves[i].type = CURVE_TYPE_STANDARD;
-        tmp += 5+g_model.curves[i].points;
+        model.curves[i].type = CURVE_TYPE_STANDARD;
+        tmp += 5+model.curves[i].points;
         break;
     }
-    curveEnd[i] = tmp;
+    ends[i] = tmp;
   }
 }
+
+void loadCurves()
+{
+  loadCurves(g_model, curveEnd);
+}
+
+void loadShadowCurves()
+{
+  loadCurves(shadowModel, shadowCurveEnd);
+}
+
+void swapShadowCurves()
+{
+  memcpy(curveEnd, shadowCurveEnd, sizeof(curveEnd));
+}
 int8_t *curveAddress(uint8_t idx)
 {
   return idx==0 ? g_model.points : curveEnd[idx-1];
@@ -59,59 +59,304 @@ void debugPrintf(const char * format, ...)
 }
 #endif
 
+#if defined(CPUARM)
+#if defined(SIMU)
+#include <chrono>
+#else
+#define DWT_DEMCR            (*(volatile uint32_t *)0xE000EDFC)
+#define DWT_CTRL             (*(volatile uint32_t *)0xE0001000)
+#define DWT_CYCCNT           (*(volatile uint32_t *)0xE0001004)
+#endif
+
+void cyclesInit()
+{
+#if !defined(SIMU)
+  DWT_DEMCR |= 0x01000000;   // TRCENA
+  DWT_CTRL |= 0x00000001;    // CYCCNTENA
+#endif
+}
+
+uint32_t getCycles()
+{
+#if defined(SIMU)
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+  return DWT_CYCCNT;
+#endif
+}
+
+uint32_t getCyclesFrequency()
+{
+#if defined(SIMU)
+  return 1000000000;
+#elif defined(PCBTARANIS)
+  return SystemCoreClock;
+#else
+  return Master_frequency;
+#endif
+}
+#endif
+
 #if defined(DEBUG_TRACE_BUFFER)
+
+#define TRACE_BUFFER_MASK    (TRACE_BUFFER_LEN - 1)
+
 static struct TraceElement traceBuffer[TRACE_BUFFER_LEN];
-static uint8_t traceBufferPos;
-gtime_t filltm(gtime_t *t, struct gtm *tp);
+static volatile uint32_t traceBufferHead;   // next slot to be reserved
+static volatile uint32_t traceBufferLost;   // events dropped while paused
+static volatile bool traceBufferPaused;
+static volatile uint8_t traceBufferWriters; // tasks and ISRs inside trace_record()
 
-void trace_event(enum TraceEvent event, uint32_t data)
+// The slot position in the ring does not tell the laps apart, its lap does.
+// 0 is never valid in the first lap, so that a cleared slot is skipped
+static inline uint8_t getTraceSeq(uint32_t slot)
 {
-  if (traceBufferPos >= TRACE_BUFFER_LEN) return;
-  __disable_irq();
-  struct TraceElement * p = &traceBuffer[traceBufferPos++];
-  __enable_irq();
-  p->time = g_rtcTime;
-  p->time_ms = g_ms100;
-  p->event = event;
+  return slot / TRACE_BUFFER_LEN + 1;
+}
+
+#define TRACE_EVENT_NAME(name, value) { value, #name },
+static const struct {
+  uint16_t id;
+  const char * name;
+} traceEventNames[] = {
+  TRACE_EVENTS(TRACE_EVENT_NAME)
+};
+
+void traceInit()
+{
+  // the events are timed by the cycle counter, which runs at the core clock
+  // and must be enabled (TRCENA) before it can be written
+  cyclesInit();
+#if !defined(SIMU)
+  DWT_CYCCNT = 0;
+#endif
+}
+
+uint32_t getTraceFrequency()
+{
+#if defined(SIMU)
+  return 1000000;
+#else
+  return getCyclesFrequency();
+#endif
+}
+
+static inline uint32_t getTraceTime()
+{
+#if defined(SIMU)
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+  return getCycles();
+#endif
+}
+
+static inline uint8_t getTraceContext()
+{
+#if defined(SIMU)
+  // simulator tasks are threads, give each of them its own id
+  static uint8_t threadsCount;
+  static __thread uint8_t context;
+  if (context == 0) context = __sync_add_and_fetch(&threadsCount, 1);
+  return context;
+#else
+  uint32_t ipsr;
+  __asm volatile ("mrs %0, ipsr" : "=r" (ipsr));
+  return ipsr ? TRACE_CONTEXT_ISR : CoGetCurTaskID();
+#endif
+}
+
+static void trace_record(uint16_t event, uint32_t data)
+{
+  // Registered before the pause check, so that pauseTraceBuffer() waits for us
+  __sync_add_and_fetch(&traceBufferWriters, 1);
+  if (traceBufferPaused) {
+    traceBufferLost++;
+    __sync_sub_and_fetch(&traceBufferWriters, 1);
+    return;
+  }
+  // The slot is reserved atomically, a task or ISR preempting us takes the next one
+  uint32_t slot = __sync_fetch_and_add(&traceBufferHead, 1);
+  struct TraceElement * p = &traceBuffer[slot & TRACE_BUFFER_MASK];
+  uint8_t seq = getTraceSeq(slot);
+  p->seq = seq - 1;   // invalid until completely written
+  p->time = getTraceTime();
   p->data = data;
+  p->event = event;
+  p->context = getTraceContext();
+  __sync_synchronize();
+  p->seq = seq;
+  __sync_sub_and_fetch(&traceBufferWriters, 1);
+}
+
+// New events are dropped, the ones already being written are finished
+static void pauseTraceBuffer()
+{
+  traceBufferPaused = true;
+  __sync_synchronize();
+  while (traceBufferWriters) {
+#if defined(SIMU)
+    sleep(1/*ms*/);
+#else
+    CoTickDelay(1);  // let a preempted lower priority task complete its record
+#endif
+  }
+}
+
+void trace_event(enum TraceEvent event, uint32_t data)
+{
+  trace_record(event, data);
 }
 
 void trace_event_i(enum TraceEvent event, uint32_t data)
 {
-  if (traceBufferPos >= TRACE_BUFFER_LEN) return;
-  struct TraceElement * p = &traceBuffer[traceBufferPos++];
-  p->time = g_rtcTime;
-  p->time_ms = g_ms100;
-  p->event = event;
-  p->data = data;
+  trace_record(event, data);
+}
+
+void trace_span(enum TraceEvent event, uint16_t phase)
+{
+  trace_record(event | phase, 0);
+}
+
+void clearTraceBuffer()
+{
+  pauseTraceBuffer();
+  memclear(traceBuffer, sizeof(traceBuffer));
+  traceBufferHead = 0;
+  traceBufferLost = 0;
+  traceBufferPaused = false;
+}
+
+static inline uint32_t getTraceFirstSlot()
+{
+  return traceBufferHead > TRACE_BUFFER_LEN ? traceBufferHead - TRACE_BUFFER_LEN : 0;
 }
 
+uint16_t getTraceCount()
+{
+  return traceBufferHead - getTraceFirstSlot();
+}
+
+uint32_t getTraceLost()
+{
+  return traceBufferLost;
+}
 
+const char * getTraceEventName(uint16_t event)
+{
+  event &= ~TRACE_PHASE_MASK;
+  for (unsigned int i=0; i<DIM(traceEventNames); i++) {
+    if (traceEventNames[i].id == event) {
+      return traceEventNames[i].name;
+    }
+  }
+  return "?";
+}
+
+// idx 0 is the oldest event still in the ring
 const struct TraceElement * getTraceElement(uint16_t idx)
 {
-  if (idx < TRACE_BUFFER_LEN) return &traceBuffer[idx];
-  return 0;
+  uint32_t slot = getTraceFirstSlot() + idx;
+  if (slot >= traceBufferHead) return 0;
+  const struct TraceElement * p = &traceBuffer[slot & TRACE_BUFFER_MASK];
+  // skip a slot being written or overwritten right now
+  if (p->seq != getTraceSeq(slot)) return 0;
+  return p;
+}
+
+static char getTracePhaseChar(uint16_t event)
+{
+  switch (event & TRACE_PHASE_MASK) {
+    case TRACE_PHASE_BEGIN:
+      return 'B';
+    case TRACE_PHASE_END:
+      return 'E';
+    default:
+      return 'i';
+  }
 }
 
 #include "stamp-opentx.h"
 
+// The text format is also understood by util/trace2json.py
 void dumpTraceBuffer()
 {
+  pauseTraceBuffer();
+  uint16_t count = getTraceCount();
   TRACE("Dump of Trace Buffer (" VERS_STR " " DATE_STR " " TIME_STR "):");
-  TRACE("#   Time                     Event  Data");
-  for(int n = 0; n < TRACE_BUFFER_LEN; ++n) {
-    struct gtm tp;
-    filltm(&traceBuffer[n].time, &tp);
-    TRACE_INFO_WP("%02d  ", n);
-    TRACE_INFO_WP("%4d-%02d-%02d,%02d:%02d:%02d.%02d0", tp.tm_year+1900, tp.tm_mon+1, tp.tm_mday, tp.tm_hour, tp.tm_min, tp.tm_sec, traceBuffer[n].time_ms);
-    TRACE("  %03d    0x%08x", traceBuffer[n].event, traceBuffer[n].data);  
-    if (traceBuffer[n].time == 0 && traceBuffer[n].time_ms == 0) break;
+  TRACE("# %d events, %d lost, %lu Hz", count, (int)traceBufferLost, (unsigned long)getTraceFrequency());
+  for (int n = 0; n < count; ++n) {
+    const struct TraceElement * te = getTraceElement(n);
+    if (te) {
+      TRACE("%lu %d %c %s 0x%08lx", (unsigned long)te->time, te->context, getTracePhaseChar(te->event), getTraceEventName(te->event), (unsigned long)te->data);
+    }
+#if !defined(SIMU)
     if ((n % 5) == 0) {
-      while (!serial2TxFifo.empty()) { 
+      while (!serial2TxFifo.empty()) {
         CoTickDelay(1);
       }
     }
+#endif
   }
   TRACE("End of Trace Buffer dump");
+  traceBufferPaused = false;
+}
+
+#if defined(SDCARD)
+#define TRACE_FILENAME       ROOT_PATH "TRACE.BIN"
+
+static bool writeTraceData(FIL * file, const void * data, UINT size)
+{
+  UINT written;
+  return f_write(file, data, size, &written) == FR_OK && written == size;
+}
+
+// Binary dump, converted to Chrome trace JSON by util/trace2json.py
+const char * writeTraceBuffer()
+{
+  FIL file;
+
+  if (!sdMounted())
+    return STR_NO_SDCARD;
+
+  if (f_open(&file, TRACE_FILENAME, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+    return STR_SDCARD_ERROR;
+
+  pauseTraceBuffer();
+
+  struct TraceFileHeader header;
+  memcpy(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic));
+  header.version = TRACE_FILE_VERSION;
+  header.elementSize = sizeof(struct TraceElement);
+  header.namesCount = DIM(traceEventNames);
+  header.frequency = getTraceFrequency();
+  header.count = 0;
+  header.lost = traceBufferLost;
+
+  uint16_t count = getTraceCount();
+  for (int n = 0; n < count; ++n) {
+    if (getTraceElement(n)) header.count++;
+  }
+
+  bool result = writeTraceData(&file, &header, sizeof(header));
+  for (unsigned int i=0; result && i<DIM(traceEventNames); i++) {
+    uint8_t len = strlen(traceEventNames[i].name);
+    result = writeTraceData(&file, &traceEventNames[i].id, sizeof(uint16_t)) &&
+             writeTraceData(&file, &len, sizeof(len)) &&
+             writeTraceData(&file, traceEventNames[i].name, len);
+  }
+  for (int n = 0; result && n < count; ++n) {
+    const struct TraceElement * te = getTraceElement(n);
+    if (te) {
+      result = writeTraceData(&file, te, sizeof(struct TraceElement));
+    }
+  }
+
+  traceBufferPaused = false;
+
+  if (f_close(&file) != FR_OK || !result)
+    return STR_SDCARD_ERROR;
+
+  return NULL;
 }
 #endif
+#endif
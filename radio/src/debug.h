@@ -40,7 +40,7 @@
 #include <inttypes.h>
 #include "rtc.h"
 #include "dump.h"
-#if defined(CLI)
+#if defined(CLI) && !defined(SIMU)
 #include "cli.h"
 #elif defined(CPUARM)
 #include "serial.h"
@@ -78,66 +78,114 @@ void debugPrintf(const char * format, ...);
 #define TRACE_WARNING_WP(...) debugPrintf(__VA_ARGS__)
 #define TRACE_ERROR(...)      debugPrintf("-E- " __VA_ARGS__)
 
-#if defined(DEBUG_TRACE_BUFFER)
+#if defined(CPUARM)
+// Cycle counter of the Cortex-M3 debug unit, the simulator counts nanoseconds instead
+void cyclesInit();
+uint32_t getCycles();
+uint32_t getCyclesFrequency();
+#endif
 
-#define TRACE_BUFFER_LEN  50
+#if defined(DEBUG_TRACE_BUFFER)
 
+// Lock-free ring of (timestamp, event, data) records, which may be written
+// from any task or ISR. Its length must be a power of 2
+#define TRACE_BUFFER_LEN  256
+
+// Event names are registered here at compile time, they are stored in the
+// binary dump so that util/trace2json.py does not need to parse this file
+#define TRACE_EVENTS(_) \
+  _(trace_start, 1) \
+  _(sd_wait_ready, 10) \
+  _(sd_rcvr_datablock, 11) \
+  _(sd_xmit_datablock_wait_ready, 12) \
+  _(sd_xmit_datablock_rcvr_spi, 13) \
+  _(sd_send_cmd_wait_ready, 14) \
+  _(sd_send_cmd_rcvr_spi, 15) \
+  _(sd_SD_ReadSectors, 16) \
+  _(sd_disk_read, 17) \
+  _(sd_SD_WriteSectors, 18) \
+  _(sd_disk_write, 19) \
+  _(sd_disk_ioctl_CTRL_SYNC, 20) \
+  _(sd_disk_ioctl_GET_SECTOR_COUNT, 21) \
+  _(sd_disk_ioctl_MMC_GET_CSD, 22) \
+  _(sd_disk_ioctl_MMC_GET_CID, 23) \
+  _(sd_disk_ioctl_MMC_GET_OCR, 24) \
+  _(sd_disk_ioctl_MMC_GET_SDSTAT_1, 25) \
+  _(sd_disk_ioctl_MMC_GET_SDSTAT_2, 26) \
+  _(sd_spi_reset, 27) \
+  _(ff_f_write_validate, 30) \
+  _(ff_f_write_flag, 31) \
+  _(ff_f_write_clst, 32) \
+  _(ff_f_write_sync_window, 33) \
+  _(ff_f_write_disk_write_dirty, 34) \
+  _(ff_f_write_clust2sect, 35) \
+  _(ff_f_write_disk_write, 36) \
+  _(ff_f_write_disk_read, 37) \
+  _(ff_f_write_move_window, 38) \
+  _(audio_getNextFilledBuffer_skip, 50) \
+  _(task_mixer, 60) \
+  _(task_menus, 61) \
+  _(task_audio, 62) \
+  _(task_lua, 63) \
+  _(isr_per10ms, 70)
+
+#define TRACE_EVENT_ENUM(name, value) name = value,
 enum TraceEvent {
-  trace_start = 1,
-
-  sd_wait_ready = 10,
-  sd_rcvr_datablock,
-  sd_xmit_datablock_wait_ready,
-  sd_xmit_datablock_rcvr_spi,
-  sd_send_cmd_wait_ready,
-  sd_send_cmd_rcvr_spi,
-
-  sd_SD_ReadSectors = 16,
-  sd_disk_read,
-  sd_SD_WriteSectors,
-  sd_disk_write,
-
-  sd_disk_ioctl_CTRL_SYNC = 20,
-  sd_disk_ioctl_GET_SECTOR_COUNT,
-  sd_disk_ioctl_MMC_GET_CSD,
-  sd_disk_ioctl_MMC_GET_CID,
-  sd_disk_ioctl_MMC_GET_OCR,
-  sd_disk_ioctl_MMC_GET_SDSTAT_1,
-  sd_disk_ioctl_MMC_GET_SDSTAT_2,
-  sd_spi_reset,
-
-  ff_f_write_validate = 30,
-  ff_f_write_flag,
-  ff_f_write_clst,
-  ff_f_write_sync_window,
-  ff_f_write_disk_write_dirty,
-  ff_f_write_clust2sect,
-  ff_f_write_disk_write,
-  ff_f_write_disk_read,
-  ff_f_write_move_window,
-
-  audio_getNextFilledBuffer_skip = 50,
+  TRACE_EVENTS(TRACE_EVENT_ENUM)
 };
 
+#define TRACE_PHASE_INSTANT     0x0000
+#define TRACE_PHASE_BEGIN       0x4000
+#define TRACE_PHASE_END         0x8000
+#define TRACE_PHASE_MASK        0xC000
+
+#define TRACE_CONTEXT_ISR       0xFF
+
 struct TraceElement {
-  gtime_t time;
-  uint8_t time_ms;
-  uint8_t event;
+  uint32_t time;     // in 1/getTraceFrequency() s, wraps around
   uint32_t data;
+  uint16_t event;    // TraceEvent | TRACE_PHASE_xxx
+  uint8_t  context;  // task id, or TRACE_CONTEXT_ISR
+  uint8_t  seq;      // lap of the slot in the ring + 1, written last
 };
 
+#define TRACE_FILE_MAGIC        "OTXT"
+#define TRACE_FILE_VERSION      1
+
+struct TraceFileHeader {
+  char     magic[4];
+  uint8_t  version;
+  uint8_t  elementSize;
+  uint16_t namesCount;   // followed by namesCount * {uint16 id, uint8 len, char name[len]}
+  uint32_t frequency;
+  uint32_t count;        // followed by count * TraceElement, oldest first
+  uint32_t lost;
+};
+
+void traceInit();
 void trace_event(enum TraceEvent event, uint32_t data);
 void trace_event_i(enum TraceEvent event, uint32_t data);
+void trace_span(enum TraceEvent event, uint16_t phase);
+void clearTraceBuffer();
+uint16_t getTraceCount();
+uint32_t getTraceLost();
+uint32_t getTraceFrequency();
+const char * getTraceEventName(uint16_t event);
 const struct TraceElement * getTraceElement(uint16_t idx);
 void dumpTraceBuffer();
+const char * writeTraceBuffer();
 
 #define TRACE_EVENT(condition, event, data)   if (condition) { trace_event(event, data); }
 #define TRACEI_EVENT(condition, event, data)  if (condition) { trace_event_i(event, data); }
+#define TRACE_BEGIN(event)                    trace_span(event, TRACE_PHASE_BEGIN)
+#define TRACE_END(event)                      trace_span(event, TRACE_PHASE_END)
 
 #else  // #if defined(DEBUG_TRACE_BUFFER)
 
 #define TRACE_EVENT(condition, event, data)  
 #define TRACEI_EVENT(condition, event, data)  
+#define TRACE_BEGIN(event)
+#define TRACE_END(event)
 
 #endif // #if defined(DEBUG_TRACE_BUFFER)
 
@@ -158,6 +206,13 @@ void dumpTraceBuffer();
   #define TRACE_AUDIO_EVENT(condition, event, data)  
   #define TRACEI_AUDIO_EVENT(condition, event, data)  
 #endif
+#if defined(TRACE_TASKS)
+  #define TRACE_TASK_BEGIN(event)  TRACE_BEGIN(event)
+  #define TRACE_TASK_END(event)    TRACE_END(event)
+#else
+  #define TRACE_TASK_BEGIN(event)
+  #define TRACE_TASK_END(event)
+#endif
 
 
 #if defined(JITTER_MEASURE)  && defined(__cplusplus)
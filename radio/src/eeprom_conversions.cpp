@@ -709,6 +709,11 @@ void ConvertGeneralSettings_216_to_217(EEGeneral &settings)
 #endif
 }
 
+void ConvertGeneralSettings_217_to_218(EEGeneral &settings)
+{
+  settings.version = 218; // same data, the files are written again LZ encoded
+}
+
 int ConvertTelemetrySource_215_to_216(int source)
 {
   // TELEM_TX_TIME and 5 spare added
@@ -1068,6 +1073,9 @@ void ConvertModel(int id, int version)
     version = 217;
     ConvertModel_216_to_217(g_model);
   }
+  if (version == 217) {
+    version = 218; // same data, the model is written again LZ encoded
+  }
 
   uint8_t currModel = g_eeGeneral.currModel;
   g_eeGeneral.currModel = id;
@@ -1080,16 +1088,17 @@ bool eeConvert()
 {
   const char *msg = NULL;
 
-#if defined(REV9E)
-  return false;
-#else
-  if (g_eeGeneral.version == 216) {
+  if (g_eeGeneral.version == 217) {
+    msg = PSTR("EEprom Data v217");
+  }
+#if !defined(REV9E)
+  else if (g_eeGeneral.version == 216) {
     msg = PSTR("EEprom Data v216");
   }
+#endif
   else {
     return false;
   }
-#endif
 
   int conversionVersionStart = g_eeGeneral.version;
 
@@ -1114,6 +1123,10 @@ bool eeConvert()
     version = 217;
     ConvertGeneralSettings_216_to_217(g_eeGeneral);
   }
+  if (version == 217) {
+    version = 218;
+    ConvertGeneralSettings_217_to_218(g_eeGeneral);
+  }
   s_eeDirtyMsk = EE_GENERAL;
   eeCheck(true);
 
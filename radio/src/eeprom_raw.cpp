@@ -333,10 +333,14 @@ void eeLoadModel(uint8_t id)
 {
   if (id<MAX_MODELS) {
 
+    startModelSwitch();
+
 #if defined(SDCARD)
     closeLogs();
 #endif
 
+    startModelSwap();
+
     if (pulsesStarted()) {
       pausePulses();
     }
@@ -375,13 +379,16 @@ void eeLoadModel(uint8_t id)
       TelemetrySensor & sensor = g_model.telemetrySensors[i];
       if (sensor.type == TELEM_TYPE_CALCULATED && sensor.persistent) {
         telemetryItems[i].value = sensor.persistentValue;
-        telemetryItems[i].lastReceived = TELEMETRY_VALUE_OLD;   // #3595: make value visible even before the first new value is received)
+        telemetryItems[i].setOld();   // #3595: make value visible even before the first new value is received)
       }
     }
+    telemetrySensorsDirty = true;
 #endif
 
     LOAD_MODEL_CURVES();
 
+    endModelSwap();
+
     resumeMixerCalculations();
     // TODO pulses should be started after mixer calculations ...
 
@@ -396,6 +403,8 @@ void eeLoadModel(uint8_t id)
     LOAD_MODEL_BITMAP();
     SEND_FAILSAFE_1S();
     PLAY_MODEL_NAME();
+
+    endModelSwitch();
   }
 }
 
@@ -438,6 +447,7 @@ void eeErase(bool warn)
   eeDirty(EE_GENERAL);
   eeDirty(EE_MODEL);
   eeCheck(true);
+  eeLoadModelHeaders();
 }
 
 void eepromWriteWait(EepromWriteState state/* = EEPROM_IDLE*/)
@@ -472,6 +482,7 @@ void eeCheck(bool immediately)
     TRACE("eeprom write model");
     s_eeDirtyMsk -= EE_MODEL;
     writeModel(g_eeGeneral.currModel);
+    modelHeaders[g_eeGeneral.currModel] = g_model.header;
     if (immediately)
       eepromWriteWait();
   }
@@ -108,12 +108,14 @@ void eepromWriteBlock(uint8_t * i_pointer_ram, uint16_t i_pointer_eeprom, size_t
 }
 #endif
 
+#if !defined(CPUARM)
 static uint8_t EeFsRead(blkid_t blk, uint8_t ofs)
 {
   uint8_t ret;
   eepromReadBlock(&ret, (uint16_t)(blk*BS+ofs+BLOCKS_OFFSET), 1);
   return ret;
 }
+#endif
 
 static blkid_t EeFsGetLink(blkid_t blk)
 {
@@ -133,9 +135,9 @@ static void EeFsSetLink(blkid_t blk, blkid_t val)
   eepromWriteBlock((uint8_t *)&s_link, (blk*BS)+BLOCKS_OFFSET, sizeof(blkid_t));
 }
 
-static uint8_t EeFsGetDat(blkid_t blk, uint8_t ofs)
+static void EeFsGetDat(blkid_t blk, uint8_t ofs, uint8_t *buf, uint8_t len)
 {
-  return EeFsRead(blk, ofs+sizeof(blkid_t));
+  eepromReadBlock(buf, (blk*BS)+ofs+sizeof(blkid_t)+BLOCKS_OFFSET, len);
 }
 
 static void EeFsSetDat(blkid_t blk, uint8_t ofs, uint8_t *buf, uint8_t len)
@@ -355,6 +357,9 @@ void RlcFile::openRlc(uint8_t i_fileId)
   EFile::openRd(i_fileId);
   m_zeroes   = 0;
   m_bRlc     = 0;
+#if defined(CPUARM)
+  m_lz       = (eeFs.files[i_fileId].typ & FILE_TYP_LZ);
+#endif
 }
 
 uint8_t EFile::read(uint8_t *buf, uint8_t i_len)
@@ -365,13 +370,18 @@ uint8_t EFile::read(uint8_t *buf, uint8_t i_len)
   uint8_t remaining = i_len;
   while (remaining) {
     if (!m_currBlk) break;
-  
-    *buf++ = EeFsGetDat(m_currBlk, m_ofs++);
+
+    // what is left in the current block is read at once
+    uint8_t len = BS-sizeof(blkid_t)-m_ofs;
+    if (len > remaining) len = remaining;
+    EeFsGetDat(m_currBlk, m_ofs, buf, len);
+    buf += len;
+    m_ofs += len;
     if (m_ofs >= BS-sizeof(blkid_t)) {
       m_ofs = 0;
       m_currBlk = EeFsGetLink(m_currBlk);
     }
-    remaining--;
+    remaining -= len;
   }
 
   i_len -= remaining;
@@ -384,6 +394,12 @@ uint8_t EFile::read(uint8_t *buf, uint8_t i_len)
  */
 uint16_t RlcFile::readRlc(uint8_t *buf, uint16_t i_len)
 {
+#if defined(CPUARM)
+  if (m_lz) {
+    return readLz(buf, i_len);
+  }
+#endif
+
   uint16_t i = 0;
   for( ; 1; ) {
     uint8_t ln = min<uint16_t>(m_zeroes, i_len-i);
@@ -414,6 +430,94 @@ uint16_t RlcFile::readRlc(uint8_t *buf, uint16_t i_len)
   return i;
 }
 
+#if defined(CPUARM)
+// The LZ files are read block per block, the tokens and literals are then taken from RAM
+class LzReader {
+  public:
+    LzReader(EFile & file):
+      file(file),
+      pos(0),
+      count(0)
+    {
+    }
+
+    bool get(uint8_t & byte)
+    {
+      if (pos == count && !fill())
+        return false;
+      byte = data[pos++];
+      return true;
+    }
+
+    uint8_t get(uint8_t * buf, uint8_t len)
+    {
+      uint8_t result = 0;
+      while (result < len && (pos < count || fill())) {
+        uint8_t n = min<uint8_t>(len-result, count-pos);
+        memcpy(&buf[result], &data[pos], n);
+        pos += n;
+        result += n;
+      }
+      return result;
+    }
+
+  protected:
+    EFile & file;
+    uint8_t data[BS-sizeof(blkid_t)];
+    uint8_t pos;
+    uint8_t count;
+
+    bool fill()
+    {
+      pos = 0;
+      count = file.read(data, sizeof(data));
+      return count > 0;
+    }
+};
+
+/*
+ * Read LZ compressed bytes into buf, the matches are copied from what is already decoded.
+ */
+uint16_t RlcFile::readLz(uint8_t *buf, uint16_t i_len)
+{
+  LzReader reader(*this);
+  uint16_t i = 0;
+  uint8_t token;
+
+  while (i < i_len && reader.get(token)) {
+    if (!(token & LZ_ZEROES)) {
+      uint8_t ln = min<uint16_t>(token+1, i_len-i);
+      uint8_t lr = reader.get(&buf[i], ln);
+      i += lr;
+      if (lr != ln) break;
+    }
+    else if ((token & LZ_MATCH) == LZ_ZEROES) {
+      uint16_t ln = (token & 0x3F) + 1;
+      if (token == LZ_ZEROES_LONG) {
+        uint8_t extra;
+        if (!reader.get(extra)) break;
+        ln = 64 + extra;
+      }
+      ln = min<uint16_t>(ln, i_len-i);
+      memclear(&buf[i], ln);
+      i += ln;
+    }
+    else {
+      uint8_t distance;
+      if (!reader.get(distance) || distance >= i) break; // corrupted file
+      uint8_t ln = min<uint16_t>((token & 0x3F) + LZ_MATCH_MIN, i_len-i);
+      // byte per byte, the match may overlap what it writes
+      uint8_t * src = &buf[i-distance-1];
+      for (uint8_t j=0; j<ln; j++) {
+        buf[i++] = *src++;
+      }
+    }
+  }
+
+  return i;
+}
+#endif
+
 void RlcFile::write1(uint8_t b)
 {
   m_write1_byte = b;
@@ -524,7 +628,7 @@ bool RlcFile::copy(uint8_t i_fileDst, uint8_t i_fileSrc)
   EFile theFile2;
   theFile2.openRd(i_fileSrc);
 
-  create(i_fileDst, FILE_TYP_MODEL/*optimization, only model files are copied. should be eeFs.files[i_fileSrc].typ*/, true);
+  create(i_fileDst, eeFs.files[i_fileSrc].typ, true);
 
   uint8_t buf[BS-sizeof(blkid_t)];
   uint8_t len;
@@ -619,7 +723,7 @@ const pm_char * eeBackupModel(uint8_t i_fileSrc)
 
   *(uint32_t*)&buf[0] = O9X_FOURCC;
   buf[4] = g_eeGeneral.version;
-  buf[5] = 'M';
+  buf[5] = (eeFs.files[FILE_MODEL(i_fileSrc)].typ & FILE_TYP_LZ) ? 'L' : 'M';
   *(uint16_t*)&buf[6] = eeModelSize(i_fileSrc);
 
   result = f_write(&g_oLogFile, buf, 8, &written);
@@ -670,7 +774,11 @@ const pm_char * eeRestoreModel(uint8_t i_fileDst, char *model_name)
   }
 
   uint8_t version = (uint8_t)buf[4];
-  if (*(uint32_t*)&buf[0] != O9X_FOURCC || version < FIRST_CONV_EEPROM_VER || version > EEPROM_VER || buf[5] != 'M') {
+  uint8_t typ = FILE_TYP_MODEL;
+#if defined(LZ_EEPROM_VER)
+  if (buf[5] == 'L' && version >= LZ_EEPROM_VER) typ |= FILE_TYP_LZ;
+#endif
+  if (*(uint32_t*)&buf[0] != O9X_FOURCC || version < FIRST_CONV_EEPROM_VER || version > EEPROM_VER || (buf[5] != 'M' && typ == FILE_TYP_MODEL)) {
     f_close(&g_oLogFile);
     return STR_INCOMPATIBLE;
   }
@@ -679,7 +787,7 @@ const pm_char * eeRestoreModel(uint8_t i_fileDst, char *model_name)
     eeDeleteModel(i_fileDst);
   }
 
-  theFile.create(FILE_MODEL(i_fileDst), FILE_TYP_MODEL, true);
+  theFile.create(FILE_MODEL(i_fileDst), typ, true);
 
   do {
     result = f_read(&g_oLogFile, (uint8_t *)buf, 15, &read);
@@ -733,8 +841,12 @@ void RlcFile::writeRlc(uint8_t i_fileId, uint8_t typ, uint8_t *buf, uint16_t i_l
   m_rlc_buf = buf;
   m_rlc_len = i_len;
   m_cur_rlc_len = 0;
+#if defined(CPUARM)
+  m_lz = (typ & FILE_TYP_LZ);
+  m_lz_start = buf;
+#endif
 #if defined (EEPROM_PROGRESS_BAR)
-  m_ratio = (typ == FILE_TYP_MODEL ? 100 : 10);
+  m_ratio = ((typ & ~FILE_TYP_LZ) == FILE_TYP_MODEL ? 100 : 10);
 #endif
 
   do {
@@ -757,6 +869,13 @@ void RlcFile::nextRlcWriteStep()
     return;
   }
 
+#if defined(CPUARM)
+  if (m_lz && m_rlc_len) {
+    nextLzWriteStep();
+    return;
+  }
+#endif
+
   bool run0 = (m_rlc_buf[0] == 0);
 
   if (m_rlc_len==0) goto close;
@@ -849,6 +968,84 @@ void RlcFile::nextRlcWriteStep()
   }
 }
 
+#if defined(CPUARM)
+static uint16_t lzCountZeroes(const uint8_t * src, uint16_t len)
+{
+  uint16_t max = min<uint16_t>(len, LZ_ZEROES_MAX);
+  uint16_t count = 0;
+  while (count < max && src[count] == 0)
+    count++;
+  return count;
+}
+
+// the longest match of src in the window before it
+static uint8_t lzFindMatch(const uint8_t * start, const uint8_t * src, uint16_t len, uint8_t & distance)
+{
+  uint16_t window = min<uint16_t>(src - start, LZ_WINDOW);
+  uint8_t max = min<uint16_t>(len, LZ_MATCH_MAX);
+  uint8_t best = 0;
+  for (uint16_t d=1; d<=window; d++) {
+    const uint8_t * ref = src - d;
+    if (ref[best] != src[best])
+      continue; // this one can't be longer than the best one
+    uint8_t count = 0;
+    while (count < max && ref[count] == src[count])
+      count++;
+    if (count > best) {
+      best = count;
+      distance = d - 1;
+      if (best == max)
+        break;
+    }
+  }
+  return best;
+}
+
+/*
+ * One LZ token per step, the literals are written by the next step as for the RLC encoding.
+ */
+void RlcFile::nextLzWriteStep()
+{
+  uint8_t distance = 0;
+  uint16_t zeroes = lzCountZeroes(m_rlc_buf, m_rlc_len);
+  uint8_t match = lzFindMatch(m_lz_start, m_rlc_buf, m_rlc_len, distance);
+
+  if (zeroes >= 2 && zeroes >= match) {
+    m_rlc_buf += zeroes;
+    m_rlc_len -= zeroes;
+    if (zeroes < 64) {
+      write1(LZ_ZEROES | (zeroes-1));
+    }
+    else {
+      m_lz_token[0] = LZ_ZEROES_LONG;
+      m_lz_token[1] = zeroes - 64;
+      write(m_lz_token, 2);
+    }
+  }
+  else if (match >= LZ_MATCH_MIN) {
+    m_rlc_buf += match;
+    m_rlc_len -= match;
+    m_lz_token[0] = LZ_MATCH | (match-LZ_MATCH_MIN);
+    m_lz_token[1] = distance;
+    write(m_lz_token, 2);
+  }
+  else {
+    // literals until the next zeroes or match
+    uint8_t count = 1;
+    while (count < LZ_LITERAL_MAX && count < m_rlc_len) {
+      const uint8_t * src = m_rlc_buf + count;
+      uint16_t len = m_rlc_len - count;
+      if (lzCountZeroes(src, len) >= 2 || lzFindMatch(m_lz_start, src, len, distance) >= LZ_MATCH_MIN)
+        break;
+      count++;
+    }
+    m_rlc_len -= count;
+    m_cur_rlc_len = count;
+    write1(count-1);
+  }
+}
+#endif
+
 void RlcFile::flush()
 {
 #if !defined(CPUARM)
@@ -943,20 +1140,39 @@ void eeLoadModel(uint8_t id)
 
 #if defined(CPUARM)
     watchdogSetTimeout(500/*5s*/);
+    startModelSwitch();
 #endif
 
 #if defined(SDCARD)
     closeLogs();
 #endif
 
+#if defined(PCBTARANIS)
+    // the next model is prepared while the current one keeps flying
+    memclear(&shadowModel, sizeof(shadowModel));
+    theFile.openRlc(FILE_MODEL(id));
+    uint16_t sz = theFile.readRlc((uint8_t*)&shadowModel, sizeof(shadowModel));
+    LOAD_SHADOW_MODEL_BITMAP();
+    LOAD_SHADOW_MODEL_CURVES();
+
+    // then swapped between two mixer cycles
+    startModelSwap();
+#endif
+
     if (pulsesStarted()) {
       pausePulses();
     }
 
     pauseMixerCalculations();
 
+#if defined(PCBTARANIS)
+    memcpy(&g_model, &shadowModel, sizeof(g_model));
+    SWAP_SHADOW_MODEL_BITMAP();
+    SWAP_SHADOW_MODEL_CURVES();
+#else
     theFile.openRlc(FILE_MODEL(id));
     uint16_t sz = theFile.readRlc((uint8_t*)&g_model, sizeof(g_model));
+#endif
 
 #ifdef SIMU
     if (sz > 0 && sz != sizeof(g_model)) {
@@ -970,6 +1186,10 @@ void eeLoadModel(uint8_t id)
       modelDefault(id);
       eeCheck(true);
       newModel = true;
+#if defined(PCBTARANIS)
+      LOAD_MODEL_BITMAP();
+      LOAD_MODEL_CURVES();
+#endif
     }
 
     AUDIO_FLUSH();
@@ -994,12 +1214,19 @@ void eeLoadModel(uint8_t id)
       TelemetrySensor & sensor = g_model.telemetrySensors[i];
       if (sensor.type == TELEM_TYPE_CALCULATED && sensor.persistent) {
         telemetryItems[i].value = sensor.persistentValue;
-        telemetryItems[i].lastReceived = TELEMETRY_VALUE_OLD;   // #3595: make value visible even before the first new value is received)
+        telemetryItems[i].setOld();   // #3595: make value visible even before the first new value is received)
       }
     }
+    telemetrySensorsDirty = true;
 #endif
 
+#if !defined(PCBTARANIS)
     LOAD_MODEL_CURVES();
+#endif
+
+#if defined(CPUARM)
+    endModelSwap();
+#endif
 
     resumeMixerCalculations();
     // TODO pulses should be started after mixer calculations ...
@@ -1012,10 +1239,13 @@ void eeLoadModel(uint8_t id)
     referenceModelAudioFiles();
 #endif
 
-    LOAD_MODEL_BITMAP();
     LUA_LOAD_MODEL_SCRIPTS();
     SEND_FAILSAFE_1S();
     PLAY_MODEL_NAME();
+
+#if defined(CPUARM)
+    endModelSwitch();
+#endif
   }
 }
 
@@ -1029,9 +1259,10 @@ void eeErase(bool warn)
 
   MESSAGE(STR_EEPROMWARN, STR_EEPROMFORMATTING, NULL, AU_EEPROM_FORMATTING);
   eepromFormat();
-  theFile.writeRlc(FILE_GENERAL, FILE_TYP_GENERAL, (uint8_t*)&g_eeGeneral, sizeof(EEGeneral), true);
+  theFile.writeRlc(FILE_GENERAL, FILE_TYP_GENERAL|FILE_TYP_ENCODING, (uint8_t*)&g_eeGeneral, sizeof(EEGeneral), true);
   modelDefault(0);
-  theFile.writeRlc(FILE_MODEL(0), FILE_TYP_MODEL, (uint8_t*)&g_model, sizeof(g_model), true);
+  theFile.writeRlc(FILE_MODEL(0), FILE_TYP_MODEL|FILE_TYP_ENCODING, (uint8_t*)&g_model, sizeof(g_model), true);
+  eeLoadModelHeaders();
 }
 
 void eeCheck(bool immediately)
@@ -1043,14 +1274,17 @@ void eeCheck(bool immediately)
   if (s_eeDirtyMsk & EE_GENERAL) {
     TRACE("eeprom write general");
     s_eeDirtyMsk -= EE_GENERAL;
-    theFile.writeRlc(FILE_GENERAL, FILE_TYP_GENERAL, (uint8_t*)&g_eeGeneral, sizeof(EEGeneral), immediately);
+    theFile.writeRlc(FILE_GENERAL, FILE_TYP_GENERAL|FILE_TYP_ENCODING, (uint8_t*)&g_eeGeneral, sizeof(EEGeneral), immediately);
     if (!immediately) return;
   }
 
   if (s_eeDirtyMsk & EE_MODEL) {
     TRACE("eeprom write model");
     s_eeDirtyMsk = 0;
-    theFile.writeRlc(FILE_MODEL(g_eeGeneral.currModel), FILE_TYP_MODEL, (uint8_t*)&g_model, sizeof(g_model), immediately);
+    theFile.writeRlc(FILE_MODEL(g_eeGeneral.currModel), FILE_TYP_MODEL|FILE_TYP_ENCODING, (uint8_t*)&g_model, sizeof(g_model), immediately);
+#if defined(CPUARM)
+    modelHeaders[g_eeGeneral.currModel] = g_model.header;
+#endif
   }
 }
 
@@ -97,6 +97,14 @@ extern EeFs eeFs;
 
 #define FILE_TYP_GENERAL 1
 #define FILE_TYP_MODEL   2
+#define FILE_TYP_LZ      0x08 // flag, the file is LZ encoded instead of RLC encoded
+
+#if defined(PCBTARANIS)
+  #define LZ_EEPROM_VER     218 // the files are written LZ encoded since this version, the older firmwares only read RLC
+  #define FILE_TYP_ENCODING FILE_TYP_LZ
+#else
+  #define FILE_TYP_ENCODING 0
+#endif
 
 /// fileId of general file
 #define FILE_GENERAL   0
@@ -163,10 +171,32 @@ extern uint8_t  s_sync_write;
 ///deliver current errno, this is reset in open
 inline uint8_t write_errno() { return s_write_err; }
 
+/*
+ * LZ encoding, one token followed by its data:
+ * 0nnnnnnn           n+1 bytes copied from the file (1..128)
+ * 10nnnnnn           n+1 zeroes (1..63)
+ * 10111111 nnnnnnnn  n+64 zeroes (64..319)
+ * 11nnnnnn dddddddd  n+3 bytes copied from the output, d+1 bytes before (3..66)
+ * The window is the output buffer itself, nothing else is needed in RAM
+ */
+#define LZ_LITERAL_MAX   128
+#define LZ_ZEROES        0x80
+#define LZ_ZEROES_LONG   0xBF
+#define LZ_ZEROES_MAX    (64+255)
+#define LZ_MATCH         0xC0
+#define LZ_MATCH_MIN     3
+#define LZ_MATCH_MAX     (LZ_MATCH_MIN+0x3F)
+#define LZ_WINDOW        256
+
 class RlcFile: public EFile
 {
     uint8_t  m_bRlc;      // control byte for run length decoder
     uint8_t  m_zeroes;
+#if defined(CPUARM)
+    bool     m_lz;        // LZ encoded file
+    uint8_t * m_lz_start; // start of the buffer being written, for the matches
+    uint8_t  m_lz_token[2];
+#endif
 
 #define WRITE_FIRST_LINK               0x01
 #define WRITE_NEXT_LINK_1              0x02
@@ -207,8 +237,14 @@ class RlcFile: public EFile
     void flush();
 
     // read from opened file and decode rlc-coded data
+    // LZ files are decoded in a single pass, they must be read from the start in one call
     uint16_t readRlc(uint8_t *buf, uint16_t i_len);
 
+#if defined(CPUARM)
+    uint16_t readLz(uint8_t *buf, uint16_t i_len);
+    void nextLzWriteStep();
+#endif
+
 #if defined (EEPROM_PROGRESS_BAR)
     void DisplayProgressBar(uint8_t x);
 #endif
@@ -66,6 +66,9 @@ void menuCommonCalib(uint8_t event)
   {
     case EVT_ENTRY:
       reusableBuffer.calib.state = CALIB_START;
+#if defined(CPUARM)
+      analogFiltersReset(); // the calibration reads the inputs without the lag of the previous samples
+#endif
       break;
 
     case EVT_KEY_BREAK(KEY_ENTER):
@@ -110,6 +110,9 @@ void menuModelSelect(uint8_t event);
 void menuModelCustomFunctions(uint8_t event);
 void menuStatisticsView(uint8_t event);
 void menuStatisticsDebug(uint8_t event);
+#if defined(CPUARM)
+void menuStatisticsProfiler(uint8_t event);
+#endif
 void menuAboutView(uint8_t event);
 #if defined(DEBUG_TRACE_BUFFER)
 void menuTraceBuffer(uint8_t event);
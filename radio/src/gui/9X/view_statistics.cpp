@@ -135,7 +135,11 @@ void menuStatisticsDebug(uint8_t event)
 #endif
 
     case EVT_KEY_FIRST(KEY_DOWN):
+#if defined(CPUARM)
+      chainMenu(menuStatisticsProfiler);
+#else
       chainMenu(menuStatisticsView);
+#endif
       break;
     case EVT_KEY_FIRST(KEY_EXIT):
       chainMenu(menuMainView);
@@ -192,6 +196,9 @@ void menuStatisticsDebug(uint8_t event)
   lcd_putsLeft(MENU_DEBUG_Y_MIXMAX, STR_TMIXMAXMS);
   lcd_outdezAtt(MENU_DEBUG_COL1_OFS, MENU_DEBUG_Y_MIXMAX, DURATION_MS_PREC2(maxMixerDuration), PREC2|LEFT);
   lcd_puts(lcdLastPos, MENU_DEBUG_Y_MIXMAX, "ms");
+  // pulses gap of the last model switch
+  lcd_putsAtt(MENU_DEBUG_COL2_OFS, MENU_DEBUG_Y_MIXMAX+2, "GAP", TINSIZE);
+  lcd_outdezAtt(lcdLastPos+1, MENU_DEBUG_Y_MIXMAX+2, DURATION_MS_PREC2(modelSwitchStatistics.pulsesGap), PREC2|LEFT|TINSIZE);
 #endif
 
 #if defined(CPUARM)
@@ -219,3 +226,44 @@ void menuStatisticsDebug(uint8_t event)
   lcd_puts(4*FW, 7*FH+1, STR_MENUTORESET);
   lcd_status_line();
 }
+
+#if defined(CPUARM)
+#define MENU_PROFILER_COL1_OFS  (11*FW)
+#define MENU_PROFILER_COL2_OFS  (16*FW)
+#define MENU_PROFILER_COL3_OFS  (21*FW)
+
+void menuStatisticsProfiler(uint8_t event)
+{
+  TITLE("PROFILER");
+
+  switch(event)
+  {
+    case EVT_KEY_FIRST(KEY_ENTER):
+      mixerProfiler.reset();
+      AUDIO_KEYPAD_UP();
+      break;
+    case EVT_KEY_FIRST(KEY_UP):
+      chainMenu(menuStatisticsDebug);
+      break;
+    case EVT_KEY_FIRST(KEY_DOWN):
+      chainMenu(menuStatisticsView);
+      break;
+    case EVT_KEY_FIRST(KEY_EXIT):
+      chainMenu(menuMainView);
+      break;
+  }
+
+  // durations in us
+  lcd_puts(MENU_PROFILER_COL1_OFS-3*FW, 0, "p50");
+  lcd_puts(MENU_PROFILER_COL2_OFS-3*FW, 0, "p99");
+  lcd_puts(MENU_PROFILER_COL3_OFS-3*FW, 0, "max");
+
+  for (uint8_t i=0; i<PROFILE_STAGES_COUNT; i++) {
+    coord_t y = (i+1)*FH;
+    lcd_putsLeft(y, MixerProfiler::getStageName(i));
+    lcd_outdezAtt(MENU_PROFILER_COL1_OFS, y, mixerProfiler.getPercentile(i, 50)/2, UNSIGN);
+    lcd_outdezAtt(MENU_PROFILER_COL2_OFS, y, mixerProfiler.getPercentile(i, 99)/2, UNSIGN);
+    lcd_outdezAtt(MENU_PROFILER_COL3_OFS, y, mixerProfiler.getMax(i)/2, UNSIGN);
+  }
+}
+#endif
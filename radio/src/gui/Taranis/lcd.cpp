@@ -1129,19 +1129,20 @@ void lcd_bmp(coord_t x, coord_t y, const uint8_t * img, coord_t offset, coord_t
   for (uint8_t row=0; row<rows; row++) {
     q = img + 2 + row*w + offset;
     uint8_t *p = &displayBuf[(row + (y/2)) * LCD_W + x];
-    for (coord_t i=0; i<width; i++) {
-      if (p >= DISPLAY_END) return;
-      uint8_t b = *q++;
-      if (y & 1) {
+    if (p >= DISPLAY_END) return;
+    if (y & 1) {
+      for (coord_t i=0; i<width; i++) {
+        uint8_t b = *q++;
         *p = (*p & 0x0f) + ((b & 0x0f) << 4);
         if ((p+LCD_W) < DISPLAY_END) {
           *(p+LCD_W) = (*(p+LCD_W) & 0xf0) + ((b & 0xf0) >> 4);
         }
+        p++;
       }
-      else {
-        *p = b;
-      }
-      p++;
+    }
+    else {
+      // the bitmap rows have the same layout as the display, the row is copied at once
+      memcpy(p, q, width);
     }
   }
 }
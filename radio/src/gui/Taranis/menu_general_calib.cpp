@@ -110,6 +110,8 @@ void menuCommonCalib(uint8_t event)
   switch (event)
   {
     case EVT_ENTRY:
+      analogFiltersReset(); // the calibration reads the inputs without the lag of the previous samples
+      // no break
     case EVT_KEY_BREAK(KEY_EXIT):
       reusableBuffer.calib.state = CALIB_START;
       break;
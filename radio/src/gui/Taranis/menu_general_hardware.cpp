@@ -73,6 +73,7 @@ enum menuGeneralHwItems {
   CASE_REV9E(ITEM_SETUP_HW_BLUETOOTH)
   ITEM_SETUP_HW_UART3_MODE,
   ITEM_SETUP_HW_JITTER_FILTER,
+  ITEM_SETUP_HW_ANALOG_FILTER,
   ITEM_SETUP_HW_MAX
 };
 
@@ -99,7 +100,7 @@ enum menuGeneralHwItems {
 
 void menuGeneralHardware(uint8_t event)
 {
-  MENU(STR_HARDWARE, menuTabGeneral, e_Hardware, ITEM_SETUP_HW_MAX, { LABEL(Sticks), 0, 0, 0, 0, LABEL(Pots), POTS_ROWS, LABEL(Switches), SWITCHES_ROWS, BLUETOOTH_ROWS 0 });
+  MENU(STR_HARDWARE, menuTabGeneral, e_Hardware, ITEM_SETUP_HW_MAX, { LABEL(Sticks), 0, 0, 0, 0, LABEL(Pots), POTS_ROWS, LABEL(Switches), SWITCHES_ROWS, BLUETOOTH_ROWS 0, 0, 0 });
 
   uint8_t sub = menuVerticalPosition;
 
@@ -234,6 +235,12 @@ void menuGeneralHardware(uint8_t event)
         g_eeGeneral.jitterFilter = 1 - onoffMenuItem(b, RADIO_SETUP_2ND_COLUMN, y, STR_JITTER_FILTER, attr, event);
         break;
       }
+      case ITEM_SETUP_HW_ANALOG_FILTER:
+        g_eeGeneral.analogFilter = selectMenuItem(RADIO_SETUP_2ND_COLUMN, y, STR_ANALOG_FILTER, STR_ANALOG_FILTERS, g_eeGeneral.analogFilter, 0, ANALOG_FILTER_USER_MAX, attr, event);
+        if (attr && checkIncDec_Ret) {
+          analogFiltersReset();
+        }
+        break;
     }
   }
 }
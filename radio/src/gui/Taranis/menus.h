@@ -112,6 +112,8 @@ void menuModelSelect(uint8_t event);
 void menuModelCustomFunctions(uint8_t event);
 void menuStatisticsView(uint8_t event);
 void menuStatisticsDebug(uint8_t event);
+void menuStatisticsProfiler(uint8_t event);
+void menuStatisticsSdIo(uint8_t event);
 void menuAboutView(uint8_t event);
 #if defined(DEBUG_TRACE_BUFFER)
 void menuTraceBuffer(uint8_t event);
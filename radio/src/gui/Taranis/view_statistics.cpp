@@ -49,7 +49,7 @@ void menuStatisticsView(uint8_t event)
   switch(event)
   {
     case EVT_KEY_FIRST(KEY_UP):
-      chainMenu(menuStatisticsDebug);
+      chainMenu(menuStatisticsSdIo);
       break;
 
     case EVT_KEY_LONG(KEY_MENU):
@@ -104,11 +104,12 @@ void menuStatisticsView(uint8_t event)
 }
 
 #define MENU_DEBUG_COL1_OFS   (11*FW-2)
-#define MENU_DEBUG_Y_MIXMAX   (2*FH-3)
-#define MENU_DEBUG_Y_LUA      (3*FH-2)
-#define MENU_DEBUG_Y_FREE_RAM (4*FH-1)
-#define MENU_DEBUG_Y_USB      (5*FH)
-#define MENU_DEBUG_Y_RTOS     (6*FH)
+#define MENU_DEBUG_Y_MIXMAX   (FH+3)
+#define MENU_DEBUG_Y_SWITCH   (2*FH+2)
+#define MENU_DEBUG_Y_LUA      (3*FH+1)
+#define MENU_DEBUG_Y_FREE_RAM (4*FH)
+#define MENU_DEBUG_Y_USB      (5*FH-1)
+#define MENU_DEBUG_Y_RTOS     (6*FH-2)
 
 #if defined(USB_SERIAL)
   extern uint16_t usbWraps;
@@ -155,7 +156,7 @@ void menuStatisticsDebug(uint8_t event)
 #endif
 
     case EVT_KEY_FIRST(KEY_DOWN):
-      chainMenu(menuStatisticsView);
+      chainMenu(menuStatisticsProfiler);
       break;
     case EVT_KEY_FIRST(KEY_EXIT):
       chainMenu(menuMainView);
@@ -187,6 +188,14 @@ void menuStatisticsDebug(uint8_t event)
   lcd_outdezAtt(MENU_DEBUG_COL1_OFS, MENU_DEBUG_Y_MIXMAX, DURATION_MS_PREC2(maxMixerDuration), PREC2|LEFT);
   lcd_puts(lcdLastPos, MENU_DEBUG_Y_MIXMAX, "ms");
 
+  lcd_putsLeft(MENU_DEBUG_Y_SWITCH, "Model load");
+  lcd_putsAtt(MENU_DEBUG_COL1_OFS, MENU_DEBUG_Y_SWITCH+1, "[Total]", SMLSIZE);
+  lcd_outdezAtt(lcdLastPos, MENU_DEBUG_Y_SWITCH, 10*modelSwitchStatistics.duration, LEFT);
+  lcd_puts(lcdLastPos, MENU_DEBUG_Y_SWITCH, "ms");
+  lcd_putsAtt(lcdLastPos+2, MENU_DEBUG_Y_SWITCH+1, "[Gap]", SMLSIZE);
+  lcd_outdezAtt(lcdLastPos, MENU_DEBUG_Y_SWITCH, DURATION_MS_PREC2(modelSwitchStatistics.pulsesGap), PREC2|LEFT);
+  lcd_puts(lcdLastPos, MENU_DEBUG_Y_SWITCH, "ms");
+
 #if defined(USB_SERIAL)
   lcd_putsLeft(MENU_DEBUG_Y_USB, "Usb");
   lcd_outdezAtt(MENU_DEBUG_COL1_OFS, MENU_DEBUG_Y_USB, charsWritten, LEFT);
@@ -210,6 +219,105 @@ void menuStatisticsDebug(uint8_t event)
   lcd_status_line();
 }
 
+#define MENU_PROFILER_COL1_OFS  (16*FW)
+#define MENU_PROFILER_COL2_OFS  (24*FW)
+#define MENU_PROFILER_COL3_OFS  (32*FW)
+
+void menuStatisticsProfiler(uint8_t event)
+{
+  TITLE("PROFILER");
+
+  switch(event)
+  {
+    case EVT_KEY_FIRST(KEY_ENTER):
+      mixerProfiler.reset();
+      AUDIO_KEYPAD_UP();
+      break;
+    case EVT_KEY_FIRST(KEY_UP):
+      chainMenu(menuStatisticsDebug);
+      break;
+    case EVT_KEY_FIRST(KEY_DOWN):
+      chainMenu(menuStatisticsSdIo);
+      break;
+    case EVT_KEY_FIRST(KEY_EXIT):
+      chainMenu(menuMainView);
+      break;
+  }
+
+  // durations in us
+  lcd_puts(MENU_PROFILER_COL1_OFS-3*FW, 0, "p50");
+  lcd_puts(MENU_PROFILER_COL2_OFS-3*FW, 0, "p99");
+  lcd_puts(MENU_PROFILER_COL3_OFS-3*FW, 0, "max");
+
+  for (uint8_t i=0; i<PROFILE_STAGES_COUNT; i++) {
+    coord_t y = (i+1)*FH;
+    lcd_putsLeft(y, MixerProfiler::getStageName(i));
+    lcd_outdezAtt(MENU_PROFILER_COL1_OFS, y, mixerProfiler.getPercentile(i, 50)/2, UNSIGN);
+    lcd_outdezAtt(MENU_PROFILER_COL2_OFS, y, mixerProfiler.getPercentile(i, 99)/2, UNSIGN);
+    lcd_outdezAtt(MENU_PROFILER_COL3_OFS, y, mixerProfiler.getMax(i)/2, UNSIGN);
+  }
+}
+
+#define MENU_SDIO_COL1_OFS      (12*FW)
+#define MENU_SDIO_COL2_OFS      (16*FW)
+#define MENU_SDIO_COL3_OFS      (23*FW)
+#define MENU_SDIO_COL4_OFS      (29*FW)
+#define MENU_SDIO_COL5_OFS      (35*FW)
+#define MENU_SDIO_Y_READS       (5*FH)
+#define MENU_SDIO_Y_WRITES      (6*FH)
+
+void menuStatisticsSdIo(uint8_t event)
+{
+  TITLE("SD I/O");
+
+  switch(event)
+  {
+    case EVT_KEY_FIRST(KEY_ENTER):
+      sdIoScheduler.resetStats();
+      AUDIO_KEYPAD_UP();
+      break;
+    case EVT_KEY_FIRST(KEY_UP):
+      chainMenu(menuStatisticsProfiler);
+      break;
+    case EVT_KEY_FIRST(KEY_DOWN):
+      chainMenu(menuStatisticsView);
+      break;
+    case EVT_KEY_FIRST(KEY_EXIT):
+      chainMenu(menuMainView);
+      break;
+  }
+
+  // the requests, the max queue depth, then the waits and holds in 0.1ms
+  lcd_puts(MENU_SDIO_COL1_OFS-3*FW, 0, "req");
+  lcd_puts(MENU_SDIO_COL2_OFS-FW, 0, "q");
+  lcd_puts(MENU_SDIO_COL3_OFS-3*FW, 0, "avg");
+  lcd_puts(MENU_SDIO_COL4_OFS-3*FW, 0, "max");
+  lcd_puts(MENU_SDIO_COL5_OFS-4*FW, 0, "hold");
+
+  for (uint8_t i=0; i<SDIO_CLASSES_COUNT; i++) {
+    const SdIoStats & stats = sdIoScheduler.getStats(i);
+    coord_t y = (i+1)*FH + FH/2;
+    lcd_putsLeft(y, SdIoScheduler::getClassName(i));
+    lcd_outdezAtt(MENU_SDIO_COL1_OFS, y, stats.requests, UNSIGN);
+    lcd_outdezAtt(MENU_SDIO_COL2_OFS, y, stats.maxDepth, UNSIGN);
+    lcd_outdezAtt(MENU_SDIO_COL3_OFS, y, stats.contended ? stats.totalWait / stats.contended / 100 : 0, PREC1|UNSIGN);
+    lcd_outdezAtt(MENU_SDIO_COL4_OFS, y, stats.maxWait / 100, PREC1|UNSIGN);
+    lcd_outdezAtt(MENU_SDIO_COL5_OFS, y, stats.maxHold / 100, PREC1|UNSIGN);
+  }
+
+  lcd_putsLeft(MENU_SDIO_Y_READS, "Reads");
+  lcd_outdezAtt(MENU_SDIO_COL1_OFS, MENU_SDIO_Y_READS, sdIoScheduler.readCommands, UNSIGN);
+  lcd_puts(MENU_SDIO_COL1_OFS+FW/2, MENU_SDIO_Y_READS, "cmd");
+  lcd_outdezAtt(MENU_SDIO_COL4_OFS, MENU_SDIO_Y_READS, sdIoScheduler.readSectors, UNSIGN);
+  lcd_puts(MENU_SDIO_COL4_OFS+FW/2, MENU_SDIO_Y_READS, "sect");
+
+  lcd_putsLeft(MENU_SDIO_Y_WRITES, "Writes");
+  lcd_outdezAtt(MENU_SDIO_COL1_OFS, MENU_SDIO_Y_WRITES, sdIoScheduler.writeCommands, UNSIGN);
+  lcd_puts(MENU_SDIO_COL1_OFS+FW/2, MENU_SDIO_Y_WRITES, "cmd");
+  lcd_outdezAtt(MENU_SDIO_COL4_OFS, MENU_SDIO_Y_WRITES, sdIoScheduler.writeSectors, UNSIGN);
+  lcd_puts(MENU_SDIO_COL4_OFS+FW/2, MENU_SDIO_Y_WRITES, "sect");
+}
+
 
 #if defined(DEBUG_TRACE_BUFFER)
 #include "stamp-opentx.h"
@@ -219,26 +327,40 @@ void menuTraceBuffer(uint8_t event)
   switch(event)
   {
     case EVT_KEY_LONG(KEY_ENTER):
+    {
       dumpTraceBuffer();
+#if defined(SDCARD)
+      const char * result = writeTraceBuffer();
+      if (result) {
+        POPUP_WARNING(result);
+      }
+#endif
+      killEvents(event);
+      break;
+    }
+    case EVT_KEY_LONG(KEY_MENU):
+      clearTraceBuffer();
       killEvents(event);
       break;
   }
 
-  SIMPLE_SUBMENU("Trace Buffer " VERS_STR, TRACE_BUFFER_LEN);
+  SIMPLE_SUBMENU("Trace Buffer " VERS_STR, getTraceCount());
   /* RTC time */
-  struct gtm t;
-  gettime(&t);
-  putsTime(LCD_W+1, 0, t, TIMEBLINK);
+  putsRtcTime(LCD_W-5*FW, 0, LEFT|TIMEBLINK);
 
   uint8_t y = 0;
-  uint8_t k = 0;
+  uint16_t k = 0;
   int8_t sub = menuVerticalPosition;
 
   lcd_putc(0, FH, '#');
-  lcd_puts(4*FW, FH, "Time");
+  lcd_puts(4*FW, FH, "Time(us)");
   lcd_puts(14*FW, FH, "Event");
   lcd_puts(20*FW, FH, "Data");
 
+  // times are relative to the oldest event
+  const struct TraceElement * first = getTraceElement(0);
+  uint32_t ticksPerUs = max<uint32_t>(1, getTraceFrequency() / 1000000);
+
   for (uint8_t i=0; i<LCD_LINES-2; i++) {
     y = 1 + (i+2)*FH;
     k = i+menuVerticalOffset;
@@ -247,12 +369,15 @@ void menuTraceBuffer(uint8_t event)
     lcd_outdezAtt(0, y, k, LEFT | (sub==k ? INVERS : 0));
 
     const struct TraceElement * te = getTraceElement(k);
-    if (te) {
+    if (te && first) {
       //time
-      putstime_t tme = te->time % SECS_PER_DAY;
-      putsTimer(4*FW, y, tme, TIMEHOUR|LEFT, TIMEHOUR|LEFT);
+      lcd_outdezAtt(4*FW, y, (te->time - first->time) / ticksPerUs, LEFT);
       //event
-      lcd_outdezNAtt(14*FW, y, te->event, LEADING0|LEFT, 3);
+      if (te->event & TRACE_PHASE_BEGIN)
+        lcd_putc(13*FW, y, 'B');
+      else if (te->event & TRACE_PHASE_END)
+        lcd_putc(13*FW, y, 'E');
+      lcd_putsn(14*FW, y, getTraceEventName(te->event), 6);
       //data
       lcd_putsn  (20*FW, y, "0x", 2);
       lcd_outhex4(22*FW-2, y, (uint16_t)(te->data >> 16));
@@ -212,6 +212,11 @@ void writeLogs()
     if (lastLogTime == 0 || (tmr10ms_t)(tmr10ms - lastLogTime) >= (tmr10ms_t)logDelay*10) {
       lastLogTime = tmr10ms;
 
+#if defined(PCBTARANIS)
+      // the audio and the interactive loads go first
+      SdIoClassScope sdIoScope(SDIO_BACKGROUND);
+#endif
+
       if (!g_oLogFile.fs) {
         const pm_char * result = openLogs();
         if (result != NULL) {
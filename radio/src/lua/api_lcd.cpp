@@ -312,26 +312,165 @@ static int luaLcdDrawSource(lua_State *L)
   return 0;
 }
 
+#define LUA_BITMAP                 "BITMAP"
+#define LUA_BITMAPS_CACHE_ENTRIES  8
+#define LUA_BITMAPS_CACHE_SIZE     (16*1024)
+
+// The bitmaps are Lua userdata (the bitmap followed by its file name), the cache keeps
+// them alive in the registry, they are freed by the GC once evicted and not used anymore
+struct LuaBitmapsCacheEntry {
+  uint32_t hash;      // 0 when the entry is free
+  int reference;
+  uint16_t size;
+  uint16_t lastUse;
+};
+
+static LuaBitmapsCacheEntry luaBitmapsCache[LUA_BITMAPS_CACHE_ENTRIES];
+static uint32_t luaBitmapsCacheSize = 0;
+static uint16_t luaBitmapsCacheClock = 0;
+
+// The cache never takes more than half of the heap left to the scripts, itself included
+static uint32_t luaBitmapsCacheMax()
+{
+#if defined(SIMU)
+  return LUA_BITMAPS_CACHE_SIZE;
+#else
+  return min<uint32_t>(LUA_BITMAPS_CACHE_SIZE, (luaBitmapsCacheSize + availableMemory()) / 2);
+#endif
+}
+
+static uint32_t luaBitmapHash(const char * filename)
+{
+  uint32_t hash = 2166136261u; // FNV-1a
+  while (*filename) {
+    hash = (hash ^ (uint8_t)*filename++) * 16777619u;
+  }
+  return hash ? hash : 1;
+}
+
+static void luaEvictBitmap(LuaBitmapsCacheEntry & entry)
+{
+  luaL_unref(L, LUA_REGISTRYINDEX, entry.reference);
+  luaBitmapsCacheSize -= entry.size;
+  entry.hash = 0;
+}
+
+void luaFreeBitmaps()
+{
+  for (int i=0; i<LUA_BITMAPS_CACHE_ENTRIES; i++) {
+    if (luaBitmapsCache[i].hash && L) {
+      luaEvictBitmap(luaBitmapsCache[i]);
+    }
+    luaBitmapsCache[i].hash = 0;
+  }
+  luaBitmapsCacheSize = 0;
+}
+
+// Pushes the bitmap on the stack (nil if it can't be loaded), the SD card is only read on a cache miss
+static const uint8_t * luaPushBitmap(lua_State * L, const char * filename)
+{
+  uint32_t hash = luaBitmapHash(filename);
+
+  for (int i=0; i<LUA_BITMAPS_CACHE_ENTRIES; i++) {
+    LuaBitmapsCacheEntry & entry = luaBitmapsCache[i];
+    if (entry.hash == hash) {
+      lua_rawgeti(L, LUA_REGISTRYINDEX, entry.reference);
+      const uint8_t * bitmap = (const uint8_t *)lua_touserdata(L, -1);
+      if (!strcmp((const char *)bitmap + BITMAP_BUFFER_SIZE(bitmap[0], bitmap[1]), filename)) {
+        entry.lastUse = ++luaBitmapsCacheClock;
+        return bitmap;
+      }
+      lua_pop(L, 1);
+    }
+  }
+
+  uint8_t buffer[BITMAP_BUFFER_SIZE(LCD_W/2, LCD_H)]; // width max is LCD_W/2 pixels for saving stack
+  if (bmpLoad(buffer, filename, LCD_W/2, LCD_H)) {
+    lua_pushnil(L);
+    return NULL;
+  }
+
+  uint16_t size = BITMAP_BUFFER_SIZE(buffer[0], buffer[1]);
+  uint16_t len = strlen(filename) + 1;
+  uint8_t * bitmap = (uint8_t *)lua_newuserdata(L, size + len);
+  memcpy(bitmap, buffer, size);
+  memcpy(bitmap + size, filename, len);
+  luaL_newmetatable(L, LUA_BITMAP);
+  lua_setmetatable(L, -2);
+
+  uint32_t cacheMax = luaBitmapsCacheMax();
+  if (size + len <= cacheMax) {
+    // the least recently used bitmaps are evicted until there is room for this one
+    while (true) {
+      LuaBitmapsCacheEntry * slot = NULL, * oldest = NULL;
+      for (int i=0; i<LUA_BITMAPS_CACHE_ENTRIES; i++) {
+        LuaBitmapsCacheEntry & entry = luaBitmapsCache[i];
+        if (!entry.hash)
+          slot = &entry;
+        else if (!oldest || (uint16_t)(luaBitmapsCacheClock - entry.lastUse) > (uint16_t)(luaBitmapsCacheClock - oldest->lastUse))
+          oldest = &entry;
+      }
+      if (slot && luaBitmapsCacheSize + size + len <= cacheMax) {
+        lua_pushvalue(L, -1);
+        slot->reference = luaL_ref(L, LUA_REGISTRYINDEX);
+        slot->hash = hash;
+        slot->size = size + len;
+        slot->lastUse = ++luaBitmapsCacheClock;
+        luaBitmapsCacheSize += slot->size;
+        break;
+      }
+      luaEvictBitmap(*oldest);
+    }
+  }
+
+  return bitmap;
+}
+
+/*luadoc
+@function lcd.loadBitmap(name)
+
+Loads a bitmap from the SD card into memory
+
+@param name (string) full path to the bitmap on SD card (i.e. “/BMP/test.bmp”)
+
+@retval bitmap handle to be given to lcd.drawPixmap(), nil if the bitmap can't be loaded
+
+@notice The bitmap stays in memory as long as the handle is used by the script
+
+@status current Introduced in 2.1.0
+*/
+static int luaLcdLoadBitmap(lua_State *L)
+{
+  const char * filename = luaL_checkstring(L, 1);
+  luaPushBitmap(L, filename);
+  return 1;
+}
+
 /*luadoc
-@function lcd.drawPixmap(x, y, name)
+@function lcd.drawPixmap(x, y, bitmap)
 
 Draws a bitmap at (x,y)  
 
 @param x,y (positive numbers) starting coordinate
 
-@param name (string) full path to the bitmap on SD card (i.e. “/BMP/test.bmp”)
+@param bitmap (string or bitmap) full path to the bitmap on SD card (i.e. “/BMP/test.bmp”),
+or a bitmap returned by lcd.loadBitmap()
 
-@status current Introduced in 2.0.0
+@notice The bitmaps drawn by their path are kept in a small cache, the SD card is only
+read the first time
+
+@status current Introduced in 2.0.0, bitmap handles introduced in 2.1.0
 */
 static int luaLcdDrawPixmap(lua_State *L)
 {
   if (!luaLcdAllowed) return 0;
   int x = luaL_checkinteger(L, 1);
   int y = luaL_checkinteger(L, 2);
-  const char * filename = luaL_checkstring(L, 3);
-  uint8_t bitmap[BITMAP_BUFFER_SIZE(LCD_W/2, LCD_H)]; // width max is LCD_W/2 pixels for saving stack and avoid a malloc here
-  const pm_char * error = bmpLoad(bitmap, filename, LCD_W/2, LCD_H);
-  if (!error) {
+  const uint8_t * bitmap = (const uint8_t *)luaL_testudata(L, 3, LUA_BITMAP);
+  if (!bitmap) {
+    bitmap = luaPushBitmap(L, luaL_checkstring(L, 3));
+  }
+  if (bitmap) {
     lcd_bmp(x, y, bitmap);
   }
   return 0;
@@ -541,6 +680,7 @@ const luaL_Reg lcdLib[] = {
   { "drawChannel", luaLcdDrawChannel },
   { "drawSwitch", luaLcdDrawSwitch },
   { "drawSource", luaLcdDrawSource },
+  { "loadBitmap", luaLcdLoadBitmap },
   { "drawPixmap", luaLcdDrawPixmap },
   { "drawScreenTitle", luaLcdDrawScreenTitle },
   { "drawCombobox", luaLcdDrawCombobox },
@@ -40,15 +40,20 @@
 #include "bin_allocator.h"
 #include "lua/lua_api.h"
  
-#if defined(LUA_COMPILER) && defined(SIMU)
+#if !defined(SIMU)
+extern "C" {
+#endif
   #include <lundump.h>
   #include <lstate.h>
+#if !defined(SIMU)
+}
 #endif
 
 #define PERMANENT_SCRIPTS_MAX_INSTRUCTIONS (10000/100)
 #define MANUAL_SCRIPTS_MAX_INSTRUCTIONS    (20000/100)
 #define SET_LUA_INSTRUCTIONS_COUNT(x)      (instructionsPercent=0, lua_sethook(L, hook, LUA_MASKCOUNT, x))
 #define LUA_WARNING_INFO_LEN 64
+#define LUA_FILENAME_MAXLEN  64
 
 lua_State *L = NULL;
 uint8_t luaState = 0;
@@ -175,6 +180,7 @@ void luaClose()
     UNPROTECT_LUA();
     L = NULL;
   }
+  luaFreeBitmaps();
 }
 
 void luaRegisterAll()
@@ -225,6 +231,7 @@ void luaFree(ScriptInternalData & sid)
       luaL_unref(L, LUA_REGISTRYINDEX, sid.background);
       sid.background = 0;
     }
+    luaFreeBitmaps();
     lua_gc(L, LUA_GCCOLLECT, 0);
   }
   else {
@@ -233,15 +240,16 @@ void luaFree(ScriptInternalData & sid)
   UNPROTECT_LUA();
 }
 
-#if defined(LUA_COMPILER) && defined(SIMU)
 static int luaDumpWriter(lua_State* L, const void* p, size_t size, void* u)
 {
   UNUSED(L);
   UINT written;
   FRESULT result = f_write((FIL *)u, p, size, &written);
-  return (result != FR_OK && !written);
+  return (result != FR_OK || written != size);
 }
 
+#if defined(LUA_COMPILER) && defined(SIMU)
+
 static void luaCompileAndSave(const char *bytecodeName)
 {
   FIL D;
@@ -271,6 +279,69 @@ static void luaCompileAndSave(const char *bytecodeName)
 }
 #endif
 
+static bool luaGetFileTime(const char * filename, uint32_t & time)
+{
+  FILINFO info;
+#if _USE_LFN
+  info.lfname = NULL;
+  info.lfsize = 0;
+#endif
+  if (f_stat(filename, &info) != FR_OK) {
+    return false;
+  }
+  time = ((uint32_t)info.fdate << 16) + info.ftime;
+  return true;
+}
+
+// The function on the top of the stack is saved as (stripped) bytecode
+static void luaSaveBytecode(const char * bytecodeName)
+{
+  FIL D;
+  if (f_open(&D, bytecodeName, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+    TRACE("Could not open Lua bytecode output file %s", bytecodeName);
+    return;
+  }
+
+  lua_lock(L);
+  int result = luaU_dump(L, getproto(L->top - 1), luaDumpWriter, &D, 1);
+  lua_unlock(L);
+  f_close(&D);
+
+  if (result) {
+    // a partial bytecode would be loaded next time
+    f_unlink(bytecodeName);
+  }
+}
+
+// Loads a script on the top of the stack. The script is compiled only once, its bytecode is saved
+// next to the source (.luac) and used as long as it is not older than the source
+static int luaLoadScriptFile(const char * filename)
+{
+  char bytecodeName[LUA_FILENAME_MAXLEN+1];
+  uint32_t sourceTime, bytecodeTime;
+  int len = strlen(filename);
+
+  if (len < LUA_FILENAME_MAXLEN && len >= (int)sizeof(SCRIPTS_EXT)-1 && !strcasecmp(filename+len-sizeof(SCRIPTS_EXT)+1, SCRIPTS_EXT) && luaGetFileTime(filename, sourceTime)) {
+    strcpy(bytecodeName, filename);
+    strcat(bytecodeName, "c");
+    if (luaGetFileTime(bytecodeName, bytecodeTime) && bytecodeTime >= sourceTime) {
+      if (luaL_loadfilex(L, bytecodeName, "b") == 0) {
+        return 0;
+      }
+      // corrupt or from another Lua version, the source is compiled again
+      TRACE("Invalid Lua bytecode %s: %s", bytecodeName, lua_tostring(L, -1));
+      lua_pop(L, 1);
+    }
+    int result = luaL_loadfile(L, filename);
+    if (result == 0) {
+      luaSaveBytecode(bytecodeName);
+    }
+    return result;
+  }
+
+  return luaL_loadfile(L, filename);
+}
+
 int luaLoad(const char *filename, ScriptInternalData & sid, ScriptInputsOutputs * sio=NULL)
 {
   int init = 0;
@@ -294,7 +365,7 @@ int luaLoad(const char *filename, ScriptInternalData & sid, ScriptInputsOutputs
   SET_LUA_INSTRUCTIONS_COUNT(MANUAL_SCRIPTS_MAX_INSTRUCTIONS);
 
   PROTECT_LUA() {
-    if (luaL_loadfile(L, filename) == 0 &&
+    if (luaLoadScriptFile(filename) == 0 &&
         lua_pcall(L, 0, 1, 0) == 0 &&
         lua_istable(L, -1)) {
 
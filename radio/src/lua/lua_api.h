@@ -122,6 +122,7 @@ extern "C" {
   void luaExec(const char * filename);
   void luaError(uint8_t error, bool acknowledge=true);
   int luaGetMemUsed();
+  void luaFreeBitmaps();
   void luaGetValueAndPush(int src);
   #define luaGetCpuUsed(idx) scriptInternalData[idx].instructions
   uint8_t isTelemetryScriptAvailable(uint8_t index);
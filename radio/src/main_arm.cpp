@@ -168,7 +168,9 @@ void perMain()
   }
 
   // run Lua scripts that don't use LCD (to use CPU time while LCD DMA is running)
+  TRACE_TASK_BEGIN(task_lua);
   luaTask(0, RUN_MIX_SCRIPT | RUN_FUNC_SCRIPT | RUN_TELEM_BG_SCRIPT, false);
+  TRACE_TASK_END(task_lua);
 
   t0 = get_tmr10ms() - t0;
   if (t0 > maxLuaDuration) {
@@ -245,6 +247,15 @@ void perMain()
     handleGui(evt);
   }
 
+#if defined(PCBTARANIS)
+  // before the refresh, which swaps the buffers when they are doubled
+  if (requestScreenshot) {
+    requestScreenshot = false;
+    writeScreenshot();
+  }
+  captureFrame();
+#endif
+
   lcdRefresh();
 
 #if defined(REV9E) && !defined(SIMU)
@@ -260,12 +271,4 @@ void perMain()
 #if defined(REV9E) && !defined(SIMU)
   bluetoothWakeup();
 #endif
-
-#if defined(PCBTARANIS)
-  if (requestScreenshot) {
-    requestScreenshot = false;
-    writeScreenshot();
-  }
-#endif
-
 }
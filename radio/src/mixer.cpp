@@ -58,7 +58,12 @@ uint8_t mixWarning;
 #endif
 
 int16_t calibratedStick[NUM_STICKS+NUM_POTS];
+#if defined(CPUARM)
+int16_t channelOutputsBuffers[2][NUM_CHNOUT] = {{0}};
+int16_t * channelOutputs = channelOutputsBuffers[0];
+#else
 int16_t channelOutputs[NUM_CHNOUT] = {0};
+#endif
 int16_t ex_chans[NUM_CHNOUT] = {0}; // Outputs (before LIMITS) of the last perMain;
 
 #if defined(HELI)
@@ -238,6 +243,99 @@ int16_t applyLimits(uint8_t channel, int32_t value)
   return ofs;
 }
 
+#if defined(CPUARM)
+// Same computation than applyLimits, done for all channels at once. The limits are first converted
+// into one array per factor, the channels are then processed by blocks with no branch nor access to
+// the model, which lets the compiler keep the factors in registers and use conditional instructions.
+#define LIMITS_BLOCK_SIZE   8
+#define LIMITS_NO_OVERRIDE  -32768
+
+#if defined(__GNUC__)
+  #define CHANNEL_OUTPUTS_BARRIER() __sync_synchronize()
+#else
+  #define CHANNEL_OUTPUTS_BARRIER()
+#endif
+
+struct LimitsFactors {
+  int16_t ofs[NUM_CHNOUT];
+  int16_t max[NUM_CHNOUT];
+  int16_t min[NUM_CHNOUT];
+  int16_t positive[NUM_CHNOUT];
+  int16_t negative[NUM_CHNOUT];
+  int16_t sign[NUM_CHNOUT];
+  int16_t override[NUM_CHNOUT];
+};
+
+static LimitsFactors limitsFactors;
+
+static void evalLimitsFactors()
+{
+  for (uint8_t i=0; i<NUM_CHNOUT; i++) {
+    LimitData * lim = limitAddress(i);
+    int16_t ofs   = LIMIT_OFS_RESX(lim);
+    int16_t lim_p = LIMIT_MAX_RESX(lim);
+    int16_t lim_n = LIMIT_MIN_RESX(lim);
+
+    if (ofs > lim_p) ofs = lim_p;
+    if (ofs < lim_n) ofs = lim_n;
+
+    limitsFactors.ofs[i] = ofs;
+    limitsFactors.max[i] = lim_p;
+    limitsFactors.min[i] = lim_n;
+#if defined(PPM_LIMITS_SYMETRICAL)
+    if (lim->symetrical) {
+      limitsFactors.positive[i] = lim_p;
+      limitsFactors.negative[i] = -lim_n;
+    }
+    else
+#endif
+    {
+      limitsFactors.positive[i] = lim_p - ofs;
+      limitsFactors.negative[i] = -lim_n + ofs;
+    }
+    limitsFactors.sign[i] = (lim->revert ? -1 : 1);
+#if defined(OVERRIDE_CHANNEL_FUNCTION)
+    limitsFactors.override[i] = (safetyCh[i] != OVERRIDE_CHANNEL_UNDEFINED ? calc100toRESX(safetyCh[i]) : LIMITS_NO_OVERRIDE);
+#else
+    limitsFactors.override[i] = LIMITS_NO_OVERRIDE;
+#endif
+  }
+}
+
+// values are 1024*256 based (as for applyLimits), the curves are applied in place
+void evalLimits(int32_t * values, int16_t * outputs)
+{
+#if defined(PCBTARANIS)
+  for (uint8_t i=0; i<NUM_CHNOUT; i++) {
+    int8_t curve = g_model.limitData[i].curve;
+    if (curve > 0)
+      values[i] = 256 * applyCustomCurve(values[i]/256, curve-1);
+    else if (curve < 0)
+      values[i] = 256 * applyCustomCurve(-values[i]/256, -curve-1);
+  }
+#endif
+
+  evalLimitsFactors();
+
+  for (uint8_t block=0; block<NUM_CHNOUT; block+=LIMITS_BLOCK_SIZE) {
+    for (uint8_t i=block; i<block+LIMITS_BLOCK_SIZE; i++) {
+      int32_t value = limit(int32_t(-RESXl*256), values[i], int32_t(RESXl*256));
+      value *= (value > 0 ? limitsFactors.positive[i] : limitsFactors.negative[i]);
+#if defined(CORRECT_NEGATIVE_SHIFTS)
+      int32_t sign = (value < 0);
+      int32_t result = limitsFactors.ofs[i] + ((value - sign) >> 18) + sign;
+#else
+      int32_t result = limitsFactors.ofs[i] + (value >> 18);
+#endif
+      result = (result > limitsFactors.max[i] ? limitsFactors.max[i] : result);
+      result = (result < limitsFactors.min[i] ? limitsFactors.min[i] : result);
+      result *= limitsFactors.sign[i];
+      outputs[i] = (limitsFactors.override[i] != LIMITS_NO_OVERRIDE ? limitsFactors.override[i] : result);
+    }
+  }
+}
+#endif
+
 // TODO same naming convention than the putsMixerSource
 
 getvalue_t getValue(mixsrc_t i)
@@ -372,7 +470,22 @@ getvalue_t getValue(mixsrc_t i)
   else return 0;
 }
 
-void evalInputs(uint8_t mode)
+#if defined(CPUARM)
+// While flight modes are fading, the work which doesn't depend on the flight
+// mode is done once per cycle and shared between the fading modes
+struct FlightModesFadeCache {
+  bool     sticksDone;      // sticks and pots already read in this cycle
+  uint64_t sharedMixes;     // mixer lines whose result doesn't depend on the flight mode
+  uint64_t cachedMixes;     // shared lines already evaluated in this cycle
+  uint64_t disabledMixes;   // cached lines which don't contribute to their channel
+  int32_t  mixes[MAX_MIXERS];
+};
+
+FlightModesFadeCache fadeCache;
+bool flightModesFadeSharing = true;   // false evaluates everything for each fading mode
+#endif
+
+void evalSticks(uint8_t mode)
 {
   BeepANACenter anaCenter = 0;
 
@@ -388,6 +501,10 @@ void evalInputs(uint8_t mode)
   }
 #endif
 
+#if defined(CPUARM) && !defined(SIMU)
+  checkCalibrationMultipliers();
+#endif
+
   for (uint8_t i=0; i<NUM_STICKS+NUM_POTS+NUM_ROTARY_ENCODERS; i++) {
 
     // normalization [0..2048] -> [-1024..1024]
@@ -407,7 +524,11 @@ void evalInputs(uint8_t mode)
       else {
         CalibData * calib = &g_eeGeneral.calib[i];
         v -= calib->mid;
+#if defined(CPUARM)
+        v = applyCalibration(i, v);
+#else
         v = v * (int32_t)RESX / (max((int16_t)100, (v>0 ? calib->spanPos : calib->spanNeg)));
+#endif
       }
     }
 #endif
@@ -496,12 +617,6 @@ void evalInputs(uint8_t mode)
     }
   }
 
-  /* EXPOs */
-  applyExpos(anas, mode);
-
-  /* TRIMs */
-  evalTrims(); // when no virtual inputs, the trims need the anas array calculated above (when throttle trim enabled)
-
   if (mode == e_perout_mode_normal) {
 #if !defined(CPUARM)
     anaCenter &= g_model.beepANACenter;
@@ -511,6 +626,29 @@ void evalInputs(uint8_t mode)
   }
 }
 
+void evalInputs(uint8_t mode)
+{
+#if defined(CPUARM)
+  if (fadeCache.sticksDone) {
+#if !defined(VIRTUALINPUTS)
+    memcpy(anas, rawAnas, sizeof(anas)); // the expos of the previous flight mode have been applied on anas
+#endif
+  }
+  else
+#endif
+  {
+    evalSticks(mode);
+  }
+
+  /* EXPOs */
+  PROFILE_ENTER(PROFILE_EXPOS);
+  applyExpos(anas, mode);
+  PROFILE_LEAVE();
+
+  /* TRIMs */
+  evalTrims(); // when no virtual inputs, the trims need the anas array calculated above (when throttle trim enabled)
+}
+
 #if defined(VIRTUALINPUTS)
 int getStickTrimValue(int stick, int stickValue)
 {
@@ -541,12 +679,179 @@ int getSourceTrimValue(int source, int stickValue=0)
 }
 #endif
 
+#if defined(CPUARM)
+// true when the result of a mixer line may differ from a flight mode to another
+bool isMixFlightModeDependent(const MixData * md)
+{
+  if (md->flightModes || md->delayUp || md->delayDown || md->speedUp || md->speedDown)
+    return true;
+
+  int swtch = abs(md->swtch);
+  if (swtch >= SWSRC_FIRST_LOGICAL_SWITCH && swtch != SWSRC_ON && swtch != SWSRC_ONE)
+    return true; // logical switches states are kept per flight mode
+
+  mixsrc_t source = md->srcRaw;
+#if defined(VIRTUALINPUTS)
+  if (source >= MIXSRC_FIRST_INPUT && source <= MIXSRC_LAST_INPUT)
+    return true;
+  if (md->carryTrim == 0 && source >= MIXSRC_Rud && source <= MIXSRC_Ail)
+    return true;
+#else
+  if (source >= MIXSRC_Rud && source <= MIXSRC_Ail)
+    return true;
+  if (md->carryTrim < TRIM_ON)
+    return true;
+#endif
+  if ((source >= MIXSRC_FIRST_HELI && source <= MIXSRC_LAST_TRIM) ||
+      (source >= MIXSRC_FIRST_LOGICAL_SWITCH && source <= MIXSRC_LAST_LOGICAL_SWITCH) ||
+      (source >= MIXSRC_FIRST_CH && source <= MIXSRC_LAST_CH))
+    return true;
+
+#if defined(GVARS)
+  if (source >= MIXSRC_FIRST_GVAR && source <= MIXSRC_LAST_GVAR)
+    return true;
+  if (GV_IS_GV_VALUE(MD_WEIGHT(md), GV_RANGELARGE_NEG, GV_RANGELARGE) || GV_IS_GV_VALUE(MD_OFFSET(md), GV_RANGELARGE_NEG, GV_RANGELARGE))
+    return true;
+#if defined(XCURVES)
+  if ((md->curve.type == CURVE_REF_DIFF || md->curve.type == CURVE_REF_EXPO) && GV_IS_GV_VALUE(md->curve.value, -100, 100))
+    return true;
+#else
+  if (md->curveMode == MODE_DIFFERENTIAL && GV_IS_GV_VALUE(md->curveParam, -100, 100))
+    return true;
+#endif
+#endif
+
+  return false;
+}
+
+static inline void cacheFadingMix(uint8_t i, uint8_t mode, int32_t dv, bool disabled)
+{
+  uint64_t mask = (uint64_t)1 << i;
+  // in the active flight mode, a delay still running from a previous setting changes the result
+  if ((fadeCache.sharedMixes & mask) && (mode != e_perout_mode_normal || swOn[i].delay == 0)) {
+    fadeCache.mixes[i] = dv;
+    fadeCache.cachedMixes |= mask;
+    if (disabled)
+      fadeCache.disabledMixes |= mask;
+    else
+      fadeCache.disabledMixes &= ~mask;
+  }
+}
+
+void startFlightModesFadeCache()
+{
+  if (!flightModesFadeSharing)
+    return;
+
+#if defined(HELI) && !defined(VIRTUALINPUTS)
+  // the swash ring uses the sticks values of the previous evaluation
+  if (!g_model.swashR.value)
+#endif
+  {
+    PROFILE_ENTER(PROFILE_INPUTS);
+    evalSticks(e_perout_mode_normal);
+    PROFILE_LEAVE();
+    fadeCache.sticksDone = true;
+  }
+
+  fadeCache.sharedMixes = 0;
+  fadeCache.cachedMixes = 0;
+  for (uint8_t i=0; i<MAX_MIXERS; i++) {
+    MixData * md = mixAddress(i);
+    if (md->srcRaw == 0) break;
+    if (!isMixFlightModeDependent(md)) {
+      fadeCache.sharedMixes |= (uint64_t)1 << i;
+    }
+  }
+}
+
+void stopFlightModesFadeCache()
+{
+  fadeCache.sticksDone = false;
+  fadeCache.sharedMixes = 0;
+  fadeCache.cachedMixes = 0;
+}
+#endif
+
+static inline void applyMixMultiplex(uint8_t i, MixData * md, int32_t dv, uint8_t mode)
+{
+  int32_t *ptr = &chans[md->destCh]; // Save calculating address several times
+
+  switch (md->mltpx) {
+    case MLTPX_REP:
+      *ptr = dv;
+#if defined(BOLD_FONT)
+      if (mode==e_perout_mode_normal) {
+        for (uint8_t m=i-1; m<MAX_MIXERS && mixAddress(m)->destCh==md->destCh; m--)
+          swOn[m].activeMix = false;
+      }
+#endif
+      break;
+    case MLTPX_MUL:
+      // @@@2 we have to remove the weight factor of 256 in case of 100%; now we use the new base of 256
+      dv >>= 8;
+      dv *= *ptr;
+      dv >>= RESX_SHIFT;   // same as dv /= RESXl;
+      *ptr = dv;
+      break;
+    default: // MLTPX_ADD
+      *ptr += dv; //Mixer output add up to the line (dv + (dv>0 ? 100/2 : -100/2))/(100);
+      break;
+  } //endswitch md->mltpx
+#ifdef PREVENT_ARITHMETIC_OVERFLOW
+/*
+  // a lot of assumptions must be true, for this kind of check; not really worth for only 4 bytes flash savings
+  // this solution would save again 4 bytes flash
+  int8_t testVar=(*ptr<<1)>>24;
+  if ( (testVar!=-1) && (testVar!=0 ) ) {
+    // this devices by 64 which should give a good balance between still over 100% but lower then 32x100%; should be OK
+    *ptr >>= 6;  // this is quite tricky, reduces the value a lot but should be still over 100% and reduces flash need
+  } */
+
+
+  PACK( union u_int16int32_t {
+    struct {
+      int16_t lo;
+      int16_t hi;
+    } words_t;
+    int32_t dword;
+  });
+
+  u_int16int32_t tmp;
+  tmp.dword=*ptr;
+
+  if (tmp.dword<0) {
+    if ((tmp.words_t.hi&0xFF80)!=0xFF80) tmp.words_t.hi=0xFF86; // set to min nearly
+  }
+  else {
+    if ((tmp.words_t.hi|0x007F)!=0x007F) tmp.words_t.hi=0x0079; // set to max nearly
+  }
+  *ptr = tmp.dword;
+  // this implementation saves 18bytes flash
+
+/*      dv=*ptr>>8;
+  if (dv>(32767-RESXl)) {
+    *ptr=(32767-RESXl)<<8;
+  } else if (dv<(-32767+RESXl)) {
+    *ptr=(-32767+RESXl)<<8;
+  }*/
+  // *ptr=limit( int32_t(int32_t(-1)<<23), *ptr, int32_t(int32_t(1)<<23));  // limit code cost 72 bytes
+  // *ptr=limit( int32_t((-32767+RESXl)<<8), *ptr, int32_t((32767-RESXl)<<8));  // limit code cost 80 bytes
+#endif
+}
+
 uint8_t mixerCurrentFlightMode;
 void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
 {
+  PROFILE_ENTER(PROFILE_INPUTS);
   evalInputs(mode);
+  PROFILE_LEAVE();
 
-  if (tick10ms) evalLogicalSwitches(mode==e_perout_mode_normal);
+  if (tick10ms) {
+    PROFILE_ENTER(PROFILE_LOGICAL_SWITCHES);
+    evalLogicalSwitches(mode==e_perout_mode_normal);
+    PROFILE_LEAVE();
+  }
 
 #if defined(MODULE_ALWAYS_SEND_PULSES)
   checkStartupWarnings();
@@ -664,6 +969,16 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
         chans[md->destCh] = 0;
       }
 
+#if defined(CPUARM)
+      // the active flight mode is always evaluated, for the delays and warnings
+      if (mode == e_perout_mode_inactive_flight_mode && (fadeCache.cachedMixes & ((uint64_t)1 << i))) {
+        if (!(fadeCache.disabledMixes & ((uint64_t)1 << i))) {
+          applyMixMultiplex(i, md, fadeCache.mixes[i], mode);
+        }
+        continue;
+      }
+#endif
+
       //========== PHASE && SWITCH =====
       bool mixCondition = (md->flightModes != 0 || md->swtch);
       delayval_t mixEnabled = (!(md->flightModes & (1 << mixerCurrentFlightMode)) && getSwitch(md->swtch)) ? DELAY_POS_MARGIN+1 : 0;
@@ -757,6 +1072,9 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
             }
           }
           else if (mixCondition) {
+#if defined(CPUARM)
+            cacheFadingMix(i, mode, 0, true);
+#endif
             continue;
           }
         }
@@ -877,69 +1195,11 @@ void evalFlightModeMixes(uint8_t mode, uint8_t tick10ms)
       }
 #endif
 
-      int32_t *ptr = &chans[md->destCh]; // Save calculating address several times
-
-      switch (md->mltpx) {
-        case MLTPX_REP:
-          *ptr = dv;
-#if defined(BOLD_FONT)
-          if (mode==e_perout_mode_normal) {
-            for (uint8_t m=i-1; m<MAX_MIXERS && mixAddress(m)->destCh==md->destCh; m--)
-              swOn[m].activeMix = false;
-          }
+#if defined(CPUARM)
+      cacheFadingMix(i, mode, dv, false);
 #endif
-          break;
-        case MLTPX_MUL:
-          // @@@2 we have to remove the weight factor of 256 in case of 100%; now we use the new base of 256
-          dv >>= 8;
-          dv *= *ptr;
-          dv >>= RESX_SHIFT;   // same as dv /= RESXl;
-          *ptr = dv;
-          break;
-        default: // MLTPX_ADD
-          *ptr += dv; //Mixer output add up to the line (dv + (dv>0 ? 100/2 : -100/2))/(100);
-          break;
-      } //endswitch md->mltpx
-#ifdef PREVENT_ARITHMETIC_OVERFLOW
-/*
-      // a lot of assumptions must be true, for this kind of check; not really worth for only 4 bytes flash savings
-      // this solution would save again 4 bytes flash
-      int8_t testVar=(*ptr<<1)>>24;
-      if ( (testVar!=-1) && (testVar!=0 ) ) {
-        // this devices by 64 which should give a good balance between still over 100% but lower then 32x100%; should be OK
-        *ptr >>= 6;  // this is quite tricky, reduces the value a lot but should be still over 100% and reduces flash need
-      } */
-
-
-      PACK( union u_int16int32_t {
-        struct {
-          int16_t lo;
-          int16_t hi;
-        } words_t;
-        int32_t dword;
-      });
-
-      u_int16int32_t tmp;
-      tmp.dword=*ptr;
-
-      if (tmp.dword<0) {
-        if ((tmp.words_t.hi&0xFF80)!=0xFF80) tmp.words_t.hi=0xFF86; // set to min nearly
-      }
-      else {
-        if ((tmp.words_t.hi|0x007F)!=0x007F) tmp.words_t.hi=0x0079; // set to max nearly
-      }
-      *ptr = tmp.dword;
-      // this implementation saves 18bytes flash
 
-/*      dv=*ptr>>8;
-      if (dv>(32767-RESXl)) {
-        *ptr=(32767-RESXl)<<8;
-      } else if (dv<(-32767+RESXl)) {
-        *ptr=(-32767+RESXl)<<8;
-      }*/
-      // *ptr=limit( int32_t(int32_t(-1)<<23), *ptr, int32_t(int32_t(1)<<23));  // limit code cost 72 bytes
-      // *ptr=limit( int32_t((-32767+RESXl)<<8), *ptr, int32_t((32767-RESXl)<<8));  // limit code cost 80 bytes
-#endif
+      applyMixMultiplex(i, md, dv, mode);
 
     } //endfor mixers
 
@@ -982,6 +1242,9 @@ void evalMixes(uint8_t tick10ms)
 #endif
 
     if (lastFlightMode == 255) {
+      // model (re)loaded, forget any fade of the previous model
+      memclear(fp_act, sizeof(fp_act));
+      flightModesFade = 0;
       fp_act[fm] = MAX_ACT;
     }
     else {
@@ -1017,11 +1280,16 @@ void evalMixes(uint8_t tick10ms)
   int32_t weight = 0;
   if (flightModesFade) {
     memclear(sum_chans512, sizeof(sum_chans512));
+#if defined(CPUARM)
+    startFlightModesFadeCache();
+#endif
     for (uint8_t p=0; p<MAX_FLIGHT_MODES; p++) {
       LS_RECURSIVE_EVALUATION_RESET();
       if (flightModesFade & ((ACTIVE_PHASES_TYPE)1 << p)) {
         mixerCurrentFlightMode = p;
+        PROFILE_ENTER(PROFILE_MIXES);
         evalFlightModeMixes(p==fm ? e_perout_mode_normal : e_perout_mode_inactive_flight_mode, p==fm ? tick10ms : 0);
+        PROFILE_LEAVE();
         for (uint8_t i=0; i<NUM_CHNOUT; i++)
           sum_chans512[i] += (chans[i] >> 4) * fp_act[p];
         weight += fp_act[p];
@@ -1030,16 +1298,22 @@ void evalMixes(uint8_t tick10ms)
     }
     assert(weight);
     mixerCurrentFlightMode = fm;
+#if defined(CPUARM)
+    stopFlightModesFadeCache();
+#endif
   }
   else {
     mixerCurrentFlightMode = fm;
+    PROFILE_ENTER(PROFILE_MIXES);
     evalFlightModeMixes(e_perout_mode_normal, tick10ms);
+    PROFILE_LEAVE();
   }
 
   //========== FUNCTIONS ===============
   // must be done after mixing because some functions use the inputs/channels values
   // must be done before limits because of the applyLimit function: it checks for safety switches which would be not initialized otherwise
   if (tick10ms) {
+    PROFILE_ENTER(PROFILE_FUNCTIONS);
 #if defined(CPUARM)
     requiredSpeakerVolume = g_eeGeneral.speakerVolume + VOLUME_LEVEL_DEF;
 #endif
@@ -1052,9 +1326,25 @@ void evalMixes(uint8_t tick10ms)
 #else
     evalFunctions();
 #endif
+    PROFILE_LEAVE();
   }
 
   //========== LIMITS ===============
+  PROFILE_ENTER(PROFILE_LIMITS);
+#if defined(CPUARM)
+  int32_t values[NUM_CHNOUT];
+  for (uint8_t i=0; i<NUM_CHNOUT; i++) {
+    // same scaling as below, chans[i] = v*weight => 1024*256
+    values[i] = (flightModesFade ? (sum_chans512[i] / weight) << 4 : chans[i]);
+    ex_chans[i] = values[i] / 256;
+  }
+
+  // the outputs are computed in the back buffer and published at once
+  int16_t * outputs = (channelOutputs == channelOutputsBuffers[0] ? channelOutputsBuffers[1] : channelOutputsBuffers[0]);
+  evalLimits(values, outputs);
+  CHANNEL_OUTPUTS_BARRIER();
+  channelOutputs = outputs;
+#else
   for (uint8_t i=0; i<NUM_CHNOUT; i++) {
     // chans[i] holds data from mixer.   chans[i] = v*weight => 1024*256
     // later we multiply by the limit (up to 100) and then we need to normalize
@@ -1075,6 +1365,8 @@ void evalMixes(uint8_t tick10ms)
     channelOutputs[i] = value;  // copy consistent word to int-level
     sei();
   }
+#endif
+  PROFILE_LEAVE();
 
   if (tick10ms && flightModesFade) {
     uint16_t tick_delta = delta * tick10ms;
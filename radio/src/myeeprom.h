@@ -62,7 +62,7 @@
 #define BEEP_VAL     ( (g_eeGeneral.warnOpts & WARN_BVAL_BIT) >>3 )
 
 #if defined(PCBTARANIS)
-  #define EEPROM_VER             217
+  #define EEPROM_VER             218
   #define FIRST_CONV_EEPROM_VER  216
 #elif defined(PCBSKY9X)
   #define EEPROM_VER             217
@@ -337,7 +337,8 @@ enum BeeperMode {
   uint8_t  btBaudrate; \
   uint8_t  optrexDisplay:1; \
   uint8_t  jitterFilter:1; /* 0 - active */\
-  uint8_t  spareArm:6; \
+  uint8_t  analogFilter:2; /* AnalogFilterStages */\
+  uint8_t  spareArm:4; \
   uint8_t  sticksGain; \
   uint8_t  rotarySteps; \
   uint8_t  countryCode; \
@@ -1271,6 +1272,8 @@ enum TelemetrySensorFormula
   TELEM_FORMULA_LAST = TELEM_FORMULA_DIST
 };
 
+class TelemetryConversion;
+
 PACK(typedef struct {
   union {
     uint16_t id;                   // data identifier, for FrSky we can reuse existing ones. Source unit is derived from type.
@@ -1317,7 +1320,7 @@ PACK(typedef struct {
   void init(const char *label, uint8_t unit=UNIT_RAW, uint8_t prec=0);
   void init(uint16_t id);
   bool isAvailable() const;
-  int32_t getValue(int32_t value, uint8_t unit, uint8_t prec) const;
+  int32_t getValue(int32_t value, uint8_t unit, uint8_t prec, TelemetryConversion * conversion=NULL) const;
   bool isConfigurable() const;
   bool isPrecConfigurable() const;
   int32_t getPrecMultiplier() const;
@@ -57,6 +57,7 @@ Clipboard clipboard;
 
 #if defined(PCBTARANIS) && defined(SDCARD)
 uint8_t modelBitmap[MODEL_BITMAP_SIZE];
+uint8_t shadowModelBitmap[MODEL_BITMAP_SIZE];
 void loadModelBitmap(char *name, uint8_t *bitmap)
 {
   uint8_t len = zlen(name, LEN_BITMAP_NAME);
@@ -88,6 +89,41 @@ uint8_t unexpectedShutdown = 0;
 /* ARM: mixer duration in 0.5us */
 uint16_t maxMixerDuration;
 
+#if defined(PCBTARANIS)
+ModelData shadowModel;
+#endif
+
+#if defined(CPUARM)
+ModelSwitchStatistics modelSwitchStatistics;
+
+void startModelSwitch()
+{
+  modelSwitchStatistics.start = get_tmr10ms();
+}
+
+void startModelSwap()
+{
+  modelSwitchStatistics.swapStart = get_tmr10ms();
+  modelSwitchStatistics.swapStart2MHz = getTmr2MHz();
+}
+
+void endModelSwap()
+{
+  // the 2MHz timer wraps after 32ms, longer gaps (throttle warning) are measured with the 10ms timer
+  tmr10ms_t ticks = get_tmr10ms() - modelSwitchStatistics.swapStart;
+  if (ticks >= 3)
+    modelSwitchStatistics.pulsesGap = ticks * 20000;
+  else
+    modelSwitchStatistics.pulsesGap = (uint16_t)(getTmr2MHz() - modelSwitchStatistics.swapStart2MHz);
+}
+
+void endModelSwitch()
+{
+  modelSwitchStatistics.duration = get_tmr10ms() - modelSwitchStatistics.start;
+  TRACE("Model switch: %dms, pulses gap %dus", modelSwitchStatistics.duration*10, modelSwitchStatistics.pulsesGap/2);
+}
+#endif
+
 #if defined(AUDIO) && !defined(CPUARM)
 audioQueue  audio;
 #endif
@@ -139,6 +175,8 @@ void watchdogSetTimeout(uint32_t timeout)
 
 void per10ms()
 {
+  TRACE_TASK_BEGIN(isr_per10ms);
+
   g_tmr10ms++;
 
 #if defined(CPUARM)
@@ -226,6 +264,8 @@ void per10ms()
 #endif
 
   heartbeat |= HEART_TIMER_10MS;
+
+  TRACE_TASK_END(isr_per10ms);
 }
 
 FlightModeData *flightModeAddress(uint8_t idx)
@@ -439,6 +479,7 @@ void modelDefault(uint8_t id)
     modelHeaders[id].modelId[i] = g_model.header.modelId[i] = id+1;
   }
   checkModelIdUnique(id, 0);
+  telemetrySensorsDirty = true;
 #endif
 
 #if defined(CPUARM) && defined(FLIGHT_MODES) && defined(GVARS)
@@ -1443,24 +1484,6 @@ uint16_t BandGap ;
 #endif
 
 
-#if defined(VIRTUALINPUTS)
-  #define JITTER_FILTER_STRENGTH  4         // tune this value, bigger value - more filtering (range: 1-5) (see explanation below)
-  #define ANALOG_SCALE            1         // tune this value, bigger value - more filtering (range: 0-3) (see explanation below)
-
-  #define JITTER_ALPHA            (1<<JITTER_FILTER_STRENGTH)
-  #define ANALOG_MULTIPLIER       (1<<ANALOG_SCALE)
-  #define ANA_FILT(chan)          (s_anaFilt[chan] / (JITTER_ALPHA * ANALOG_MULTIPLIER))
-  #if (JITTER_ALPHA * ANALOG_MULTIPLIER > 32)
-    #error "JITTER_FILTER_STRENGTH and ANALOG_SCALE are too big, their summ should be <= 5 !!!"
-  #endif
-#else
-  #define ANALOG_SCALE            0
-  #define JITTER_ALPHA            1
-  #define ANALOG_MULTIPLIER       1
-  #define ANA_FILT(chan)          (s_anaFilt[chan])
-#endif
-
-
 #if !defined(SIMU)
 uint16_t anaIn(uint8_t chan)
 {
@@ -1508,6 +1531,19 @@ void getADC()
   }
 #endif
 
+#if defined(ADC_OVERSAMPLING)
+  // the ADC and its DMA run continuously, adcRead() only averages the last conversions
+  adcRead();
+  for (uint32_t x=0; x<NUMBER_ANALOG; x++) {
+    uint16_t val = getAnalogValue(x);
+#if defined(JITTER_MEASURE)
+    if (JITTER_MEASURE_ACTIVE()) {
+      rawJitter[x].measure(val);
+    }
+#endif
+    temp[x] = 4 * val;
+  }
+#else
   for (uint32_t i=0; i<4; i++) {
     adcRead();
     for (uint32_t x=0; x<NUMBER_ANALOG; x++) {
@@ -1520,57 +1556,18 @@ void getADC()
       temp[x] += val;
     }
   }
+#endif
 
-  for (uint32_t x=0; x<NUMBER_ANALOG; x++) {
-    uint16_t v = temp[x] >> (3 - ANALOG_SCALE);
-
+  uint8_t stages = g_eeGeneral.analogFilter;
 #if defined(VIRTUALINPUTS)
-    // Jitter filter: 
-    //    * pass trough any big change directly
-    //    * for small change use Modified moving average (MMA) filter
-    //
-    // Explanation:
-    //
-    // Normal MMA filter has this formula:   
-    //            <out> = ((ALPHA-1)*<out> + <in>)/ALPHA
-    //
-    // If calculation is done this way with integer arithmetics, then any small change in
-    // input signal is lost. One way to combat that, is to rearrange the formula somewhat,
-    // to store a more precise (larger) number between iterations. The basic idea is to 
-    // store undivided value between iterations. Therefore an new variable <filtered> is 
-    // used. The new formula becomes:
-    //           <filtered> = <filtered> - <filtered>/ALPHA + <in>
-    //           <out> = <filtered>/ALPHA  (use only when out is needed)
-    //
-    // The above formula with a maximum allowed ALPHA value (we are limited by 
-    // the 16 bit s_anaFilt[]) was tested on the radio. The resulting signal still had
-    // some jitter (a value of 1 was observed). The jitter might be bigger on other 
-    // radios.
-    //
-    // So another idea is to use larger input values for filtering. So instead of using
-    // input in a range from 0 to 2047, we use twice larger number (temp[x] is divided less)
-    //
-    // This also means that ALPHA must be lowered (remember 16 bit limit), but test results
-    // have proved that this kind of filtering gives better results. So the recommended values
-    // for filter are:
-    //     JITTER_FILTER_STRENGTH  4
-    //     ANALOG_SCALE            1
-    //
-    // Variables mapping:
-    //   * <in> = v
-    //   * <out> = s_anaFilt[x]
-    uint16_t previous = s_anaFilt[x] / JITTER_ALPHA;
-    uint16_t diff = (v > previous) ? (v - previous) : (previous - v);
-    if (!g_eeGeneral.jitterFilter && diff < (10*ANALOG_MULTIPLIER)) { // g_eeGeneral.jitterFilter is inverted, 0 - active
-      // apply jitter filter
-      s_anaFilt[x] = (s_anaFilt[x] - previous) + v;
-    }
-    else
+  if (!g_eeGeneral.jitterFilter) { // g_eeGeneral.jitterFilter is inverted, 0 - active
+    stages |= ANALOG_FILTER_JITTER;
+  }
 #endif
-    {
-    	//use unfiltered value
-      s_anaFilt[x] = v * JITTER_ALPHA;
-    }
+
+  for (uint32_t x=0; x<NUMBER_ANALOG; x++) {
+    uint16_t v = temp[x] >> (3 - ANALOG_SCALE);
+    s_anaFilt[x] = analogFilterApply(analogFilters[x], s_anaFilt[x], v, stages);
 
 #if defined(JITTER_MEASURE)
     if (JITTER_MEASURE_ACTIVE()) {
@@ -1702,11 +1699,12 @@ void doMixerCalculations()
   lastTMR = tmr10ms;
 #endif
 
-  getADC();
+  TRACE_TASK_BEGIN(task_mixer);
+  PROFILE_BEGIN_CYCLE();
 
-#if defined(PCBTARANIS)
-  processSbusInput();
-#endif
+  PROFILE_ENTER(PROFILE_GETADC);
+  getADC();
+  PROFILE_LEAVE();
 
   getSwitchesPosition(!s_mixer_first_run_done);
 
@@ -1726,6 +1724,9 @@ void doMixerCalculations()
 
   evalMixes(tick10ms);
 
+  PROFILE_END_CYCLE();
+  TRACE_TASK_END(task_mixer);
+
 #if !defined(CPUARM)
   // Bandgap has had plenty of time to settle...
   getADC_bandgap();
@@ -1914,6 +1915,7 @@ void opentxStart()
   doSplash();
 
 #if defined(DEBUG_TRACE_BUFFER)
+  traceInit();
   trace_event(trace_start, 0x12345678);
 #endif 
 
@@ -467,17 +467,28 @@
   #define MODEL_BITMAP_HEIGHT 32
   #define MODEL_BITMAP_SIZE   BITMAP_BUFFER_SIZE(MODEL_BITMAP_WIDTH, MODEL_BITMAP_HEIGHT)
   extern uint8_t modelBitmap[MODEL_BITMAP_SIZE];
+  extern uint8_t shadowModelBitmap[MODEL_BITMAP_SIZE];
   void loadModelBitmap(char *name, uint8_t *bitmap);
   #define LOAD_MODEL_BITMAP() loadModelBitmap(g_model.header.bitmap, modelBitmap)
+  #define LOAD_SHADOW_MODEL_BITMAP() loadModelBitmap(shadowModel.header.bitmap, shadowModelBitmap)
+  #define SWAP_SHADOW_MODEL_BITMAP() memcpy(modelBitmap, shadowModelBitmap, MODEL_BITMAP_SIZE)
 #else
   #define LOAD_MODEL_BITMAP()
+  #define LOAD_SHADOW_MODEL_BITMAP()
+  #define SWAP_SHADOW_MODEL_BITMAP()
 #endif
 
 #if defined(XCURVES)
   void loadCurves();
+  void loadShadowCurves();
+  void swapShadowCurves();
   #define LOAD_MODEL_CURVES() loadCurves()
+  #define LOAD_SHADOW_MODEL_CURVES() loadShadowCurves()
+  #define SWAP_SHADOW_MODEL_CURVES() swapShadowCurves()
 #else
   #define LOAD_MODEL_CURVES()
+  #define LOAD_SHADOW_MODEL_CURVES()
+  #define SWAP_SHADOW_MODEL_CURVES()
 #endif
 
 #if defined(CPUARM)
@@ -920,6 +931,30 @@ extern uint8_t unexpectedShutdown;
 
 extern uint16_t maxMixerDuration;
 
+#if defined(PCBTARANIS)
+// The next model is read in shadowModel while the current one keeps flying,
+// then copied to g_model with the mixer and pulses paused
+extern ModelData shadowModel;
+#endif
+
+#if defined(CPUARM)
+
+struct ModelSwitchStatistics {
+  tmr10ms_t start;
+  tmr10ms_t swapStart;
+  uint16_t  swapStart2MHz;
+  uint16_t  duration;           // whole model switch, in 10ms
+  uint32_t  pulsesGap;          // pulses and mixer paused, in 0.5us
+};
+
+extern ModelSwitchStatistics modelSwitchStatistics;
+
+void startModelSwitch();
+void startModelSwap();
+void endModelSwap();
+void endModelSwitch();
+#endif
+
 #if !defined(CPUARM)
 extern uint8_t g_tmr1Latency_max;
 extern uint8_t g_tmr1Latency_min;
@@ -990,6 +1025,8 @@ void checkAll();
 #include "sbus.h"
 #endif
 
+#include "profiler.h"
+
 extern void backlightOn();
 
 enum Analogs {
@@ -1060,6 +1097,9 @@ uint16_t isqrt32(uint32_t n);
 
 #if defined(CPUARM) && !defined(BOOT)
 #include "tasks_arm.h"
+#if defined(CLI)
+#include "cli.h"  // in the simulator the tasks types are only known here
+#endif
 extern OS_MutexID mixerMutex;
 inline void pauseMixerCalculations()
 {
@@ -1154,7 +1194,12 @@ extern uint8_t            g_beepVal[5];
 
 extern int32_t            chans[NUM_CHNOUT];
 extern int16_t            ex_chans[NUM_CHNOUT]; // Outputs (before LIMITS) of the last perMain
+#if defined(CPUARM)
+extern int16_t            channelOutputsBuffers[2][NUM_CHNOUT];
+extern int16_t *          channelOutputs; // the last complete outputs, swapped at once by the mixer
+#else
 extern int16_t            channelOutputs[NUM_CHNOUT];
+#endif
 extern uint16_t           BandGap;
 
 #if defined(VIRTUALINPUTS)
@@ -1209,8 +1254,15 @@ void defaultInputs();
 
 void applyExpos(int16_t *anas, uint8_t mode APPLY_EXPOS_EXTRA_PARAMS_INC);
 int16_t applyLimits(uint8_t channel, int32_t value);
+#if defined(CPUARM)
+void evalLimits(int32_t * values, int16_t * outputs);
+#endif
 
+void evalSticks(uint8_t mode);
 void evalInputs(uint8_t mode);
+#if defined(CPUARM)
+extern bool flightModesFadeSharing;
+#endif
 uint16_t anaIn(uint8_t chan);
 extern int16_t calibratedStick[NUM_STICKS+NUM_POTS];
 
@@ -1366,6 +1418,9 @@ void evalFunctions();
 #if defined (FRSKY)
   // FrSky Telemetry
   #include "telemetry/frsky.h"
+  #if defined(SIMU) && defined(CPUARM)
+    #include "telemetry/stream.h"
+  #endif
 #elif defined(JETI)
   // Jeti-DUPLEX Telemetry
   #include "telemetry/jeti.h"
@@ -1515,6 +1570,11 @@ enum AUDIO_SOUNDS {
 #include "sdcard.h"
 #endif
 
+#if defined(PCBTARANIS)
+#include "sdio.h"
+#include "capture.h"
+#endif
+
 #if defined(RTCLOCK)
 #include "rtc.h"
 #endif
@@ -1787,6 +1847,10 @@ extern Clipboard clipboard;
 extern uint16_t s_anaFilt[NUMBER_ANALOG];
 #endif
 
+#if defined(CPUARM)
+#include "analogs.h"
+#endif
+
 #if defined(JITTER_MEASURE)
 extern JitterMeter<uint16_t> rawJitter[NUMBER_ANALOG];
 extern JitterMeter<uint16_t> avgJitter[NUMBER_ANALOG];
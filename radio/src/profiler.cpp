@@ -0,0 +1,141 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include "opentx.h"
+
+#if defined(SIMU)
+#include <chrono>
+#endif
+
+MixerProfiler mixerProfiler;
+
+static uint16_t getProfilerTime()
+{
+#if defined(SIMU)
+  // the 2MHz timer doesn't run in the simulator
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count() * 2;
+#else
+  return getTmr2MHz();
+#endif
+}
+
+static uint8_t getBucket(uint32_t duration)
+{
+  if (duration < 2)
+    return duration;
+  if (duration > 0xFFFF)
+    return PROFILE_BUCKETS - 1;
+  uint8_t octave = 31 - __builtin_clz(duration);
+  return 2 * octave + ((duration >> (octave - 1)) & 1);
+}
+
+static uint16_t getBucketUpperBound(uint8_t bucket)
+{
+  if (bucket < 2)
+    return bucket;
+  uint8_t octave = bucket / 2;
+  return (1 << octave) + ((bucket & 1) + 1) * (1 << (octave - 1)) - 1;
+}
+
+void MixerProfiler::reset()
+{
+  memclear(this, sizeof(*this));
+}
+
+void MixerProfiler::update()
+{
+  uint16_t now = getProfilerTime();
+  if (depth > 0) {
+    durations[stack[depth-1]] += (uint16_t)(now - last);
+  }
+  last = now;
+}
+
+void MixerProfiler::endCycle()
+{
+  if (!active)
+    return;
+
+  active = false;
+  cycles++;
+
+  for (int i=0; i<PROFILE_STAGES_COUNT; i++) {
+    if (!(entered & (1 << i)))
+      continue;
+    uint32_t duration = durations[i];
+    uint16_t * histogram = histograms[i];
+    if (duration > max[i]) {
+      max[i] = min<uint32_t>(duration, 0xFFFF);
+    }
+    uint16_t & count = histogram[getBucket(duration)];
+    if (count == 0xFFFF) {
+      // keep the distribution while staying in 16 bits
+      for (int j=0; j<PROFILE_BUCKETS; j++) {
+        histogram[j] >>= 1;
+      }
+    }
+    count++;
+  }
+}
+
+uint16_t MixerProfiler::getPercentile(uint8_t stage, uint8_t percent) const
+{
+  const uint16_t * histogram = histograms[stage];
+
+  uint32_t total = 0;
+  for (int i=0; i<PROFILE_BUCKETS; i++) {
+    total += histogram[i];
+  }
+
+  uint32_t count = 0;
+  for (int i=0; i<PROFILE_BUCKETS; i++) {
+    count += histogram[i];
+    if (count > 0 && count * 100 >= total * percent) {
+      return min<uint16_t>(getBucketUpperBound(i), max[stage]);
+    }
+  }
+
+  return 0;
+}
+
+const char * MixerProfiler::getStageName(uint8_t stage)
+{
+  static const char * const names[PROFILE_STAGES_COUNT] = {
+    "ADC", "Inputs", "Expos", "LSw", "Mixes", "Funcs", "Limits"
+  };
+  return names[stage];
+}
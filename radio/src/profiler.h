@@ -0,0 +1,136 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+enum MixerProfilerStage {
+  PROFILE_GETADC,
+  PROFILE_INPUTS,
+  PROFILE_EXPOS,
+  PROFILE_LOGICAL_SWITCHES,
+  PROFILE_MIXES,
+  PROFILE_FUNCTIONS,
+  PROFILE_LIMITS,
+  PROFILE_STAGES_COUNT
+};
+
+#if defined(CPUARM)
+
+#define PROFILE_BUCKETS       32   // half octaves of the 2MHz timer, up to 32ms
+#define PROFILE_MAX_DEPTH     4
+
+// Each mixer cycle, the time spent in each stage which was run (excluding
+// the nested stages) is added to a log-scale histogram of this stage
+class MixerProfiler
+{
+  public:
+    void reset();
+
+    void beginCycle()
+    {
+      memclear(durations, sizeof(durations));
+      entered = 0;
+      depth = 0;
+      active = true;
+    }
+
+    void endCycle();
+
+    void enter(uint8_t stage)
+    {
+      if (active && depth < PROFILE_MAX_DEPTH) {
+        update();
+        entered |= (1 << stage);
+        stack[depth++] = stage;
+      }
+    }
+
+    void leave()
+    {
+      if (active && depth > 0) {
+        update();
+        depth--;
+      }
+    }
+
+    uint32_t getCycles() const
+    {
+      return cycles;
+    }
+
+    uint16_t getMax(uint8_t stage) const
+    {
+      return max[stage];
+    }
+
+    // in 0.5us, the upper bound of the bucket where the percentile falls
+    uint16_t getPercentile(uint8_t stage, uint8_t percent) const;
+
+    static const char * getStageName(uint8_t stage);
+
+  protected:
+    void update();
+
+    bool     active;
+    uint8_t  depth;
+    uint8_t  entered;           // stages run during this cycle
+    uint8_t  stack[PROFILE_MAX_DEPTH];
+    uint16_t last;
+    uint32_t cycles;
+    uint32_t durations[PROFILE_STAGES_COUNT];
+    uint16_t max[PROFILE_STAGES_COUNT];
+    uint16_t histograms[PROFILE_STAGES_COUNT][PROFILE_BUCKETS];
+};
+
+extern MixerProfiler mixerProfiler;
+
+#define PROFILE_BEGIN_CYCLE()   mixerProfiler.beginCycle()
+#define PROFILE_END_CYCLE()     mixerProfiler.endCycle()
+#define PROFILE_ENTER(stage)    mixerProfiler.enter(stage)
+#define PROFILE_LEAVE()         mixerProfiler.leave()
+
+#else
+
+#define PROFILE_BEGIN_CYCLE()
+#define PROFILE_END_CYCLE()
+#define PROFILE_ENTER(stage)
+#define PROFILE_LEAVE()
+
+#endif
+
+#endif // _PROFILER_H_
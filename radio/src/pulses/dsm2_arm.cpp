@@ -179,9 +179,10 @@ void setupPulsesDSM2(unsigned int port)
 
   dsmDat[1] = g_model.header.modelId[port]; // DSM2 Header second byte for model match
 
+  const int16_t * outputs = channelOutputs; // all the channels come from the same mixer run
   for (int i=0; i<DSM2_CHANS; i++) {
     int channel = g_model.moduleData[port].channelsStart+i;
-    int value = channelOutputs[channel] + 2*PPM_CH_CENTER(channel) - 2*PPM_CENTER;
+    int value = outputs[channel] + 2*PPM_CH_CENTER(channel) - 2*PPM_CENTER;
     uint16_t pulse = limit(0, ((value*13)>>5)+512, 1023);
     dsmDat[2+2*i] = (i<<2) | ((pulse>>8)&0x03);
     dsmDat[3+2*i] = pulse & 0xff;
@@ -69,8 +69,9 @@ void setupPulsesPPM(unsigned int port)                   // Don't enable interru
 
   int32_t rest = 22500u * 2;
   rest += (int32_t(g_model.moduleData[port].ppmFrameLength)) * 1000;
+  const int16_t * outputs = channelOutputs; // all the channels come from the same mixer run
   for (uint32_t i=firstCh; i<lastCh; i++) {
-    int16_t v = limit((int16_t)-PPM_range, channelOutputs[i], (int16_t)PPM_range) + 2*PPM_CH_CENTER(i);
+    int16_t v = limit((int16_t)-PPM_range, outputs[i], (int16_t)PPM_range) + 2*PPM_CH_CENTER(i);
     rest -= v;
     *ptr++ = v; /* as Pat MacKenzie suggests */
   }
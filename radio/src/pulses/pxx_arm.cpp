@@ -221,6 +221,7 @@ void setupPulsesPXX(unsigned int port)
   if (pass[port]++ & 0x01) {
     sendUpperChannels = g_model.moduleData[port].channelsCount;
   }
+  const int16_t * outputs = channelOutputs; // all the channels come from the same mixer run
   for (int i=0; i<8; i++) {
     if (flag1 & PXX_SEND_FAILSAFE) {
       if (g_model.moduleData[port].failsafeMode == FAILSAFE_HOLD) {
@@ -252,9 +253,9 @@ void setupPulsesPXX(unsigned int port)
     }
     else {
       if (i < sendUpperChannels)
-        chan = limit(2049, PPM_CH_CENTER(8+g_model.moduleData[port].channelsStart+i) - PPM_CENTER + (channelOutputs[8+g_model.moduleData[port].channelsStart+i] * 512 / 682) + 3072, 4094);
+        chan = limit(2049, PPM_CH_CENTER(8+g_model.moduleData[port].channelsStart+i) - PPM_CENTER + (outputs[8+g_model.moduleData[port].channelsStart+i] * 512 / 682) + 3072, 4094);
       else if (i < NUM_CHANNELS(port))
-        chan = limit(1, PPM_CH_CENTER(g_model.moduleData[port].channelsStart+i) - PPM_CENTER + (channelOutputs[g_model.moduleData[port].channelsStart+i] * 512 / 682) + 1024, 2046);
+        chan = limit(1, PPM_CH_CENTER(g_model.moduleData[port].channelsStart+i) - PPM_CENTER + (outputs[g_model.moduleData[port].channelsStart+i] * 512 / 682) + 1024, 2046);
       else
         chan = 1024;
     }
@@ -37,8 +37,6 @@
 #include "opentx.h"
 #include "sbus.h"
 
-#define SBUS_FRAME_GAP_DELAY   1000 // 500uS
-
 #define SBUS_START_BYTE        0x0F
 #define SBUS_FLAGS_IDX         23
 #define SBUS_FRAMELOST_BIT     2
@@ -49,27 +47,31 @@
 
 #define SBUS_CH_CENTER        0x3E0
 
-Fifo<32> sbusFifo;
-uint8_t SbusFrame[SBUS_MAX_FRAME_SIZE];
-uint16_t SbusTimer ;
-uint8_t SbusIndex = 0 ;
+// Frames are received in one bank while the other one holds the last
+// complete frame
+uint8_t sbusFrames[2][SBUS_MAX_FRAME_SIZE];
+uint8_t sbusBank = 0;
+uint8_t sbusIndex = 0;
+uint8_t sbusFrameError = 0;
+uint16_t sbusLastFrameTime;
+SbusStatistics sbusStatistics;
 
 // Range for pulses (ppm input) is [-512:+512]
-void processSbusFrame(uint8_t * sbus, int16_t * pulses, uint32_t size)
+bool processSbusFrame(uint8_t * sbus, int16_t * pulses, uint32_t size)
 {
   uint32_t inputbitsavailable = 0;
   uint32_t inputbits = 0;
 
   if (sbus[0] != SBUS_START_BYTE) {
-    return; // not a valid SBUS frame
+    return false; // not a valid SBUS frame
   }
 
   if (size < SBUS_MIN_FRAME_SIZE) {
-    return;
+    return false;
   }
 
   if (size > SBUS_FLAGS_IDX && ((sbus[SBUS_FLAGS_IDX] & (1<<SBUS_FAILSAFE_BIT)) || (sbus[SBUS_FLAGS_IDX] & (1<<SBUS_FRAMELOST_BIT)))) {
-    return; // SBUS invalid frame or failsafe mode
+    return false; // SBUS invalid frame or failsafe mode
   }
 
   // Skip start byte
@@ -86,29 +88,61 @@ void processSbusFrame(uint8_t * sbus, int16_t * pulses, uint32_t size)
   }
 
   ppmInputValidityTimer = PPM_IN_VALID_TIMEOUT;
+  return true;
 }
 
-void processSbusInput()
+// Called from the USART interrupt for each received byte
+void sbusRxByte(uint8_t byte)
 {
-  uint8_t rxchar;
-  uint32_t active = 0;
-  while (sbusFifo.pop(rxchar)) {
-    active = 1;
-    SbusFrame[SbusIndex++] = rxchar;
-    if (SbusIndex > SBUS_MAX_FRAME_SIZE-1) {
-      SbusIndex = SBUS_MAX_FRAME_SIZE-1;
-    }
+  if (sbusIndex < SBUS_MAX_FRAME_SIZE) {
+    sbusFrames[sbusBank][sbusIndex++] = byte;
   }
-  if (active) {
-    SbusTimer = getTmr2MHz();
+  else {
+    sbusFrameError = 1;
+  }
+}
+
+// Called from the USART interrupt when a byte is received with an error
+void sbusRxError()
+{
+  sbusFrameError = 1;
+}
+
+// Called from the USART interrupt when the line goes idle, i.e. at the end of a frame
+void sbusRxIdle()
+{
+  if (sbusIndex == 0) {
     return;
   }
-  else {
-    if (SbusIndex) {
-      if ((uint16_t) (getTmr2MHz() - SbusTimer) > SBUS_FRAME_GAP_DELAY) {
-        processSbusFrame(SbusFrame, ppmInput, SbusIndex);
-        SbusIndex = 0;
-      }
+
+  uint8_t * frame = sbusFrames[sbusBank];
+  uint8_t size = sbusIndex;
+  uint8_t error = sbusFrameError;
+
+  sbusBank ^= 1;
+  sbusIndex = 0;
+  sbusFrameError = 0;
+
+  if (error) {
+    sbusStatistics.badFrames++;
+  }
+  else if (processSbusFrame(frame, ppmInput, size)) {
+    uint16_t now = getTmr2MHz();
+    if (sbusStatistics.frames) {
+      sbusStatistics.framePeriod = (uint16_t)(now - sbusLastFrameTime);
     }
+    sbusLastFrameTime = now;
+    sbusStatistics.frames++;
+  }
+  else if (frame[0] == SBUS_START_BYTE && size > SBUS_FLAGS_IDX) {
+    sbusStatistics.lostFrames++;
   }
+  else {
+    sbusStatistics.badFrames++;
+  }
+}
+
+void sbusResetStatistics()
+{
+  memclear(&sbusStatistics, sizeof(sbusStatistics));
 }
@@ -41,7 +41,19 @@
 #define SBUS_MIN_FRAME_SIZE   23
 #define SBUS_MAX_FRAME_SIZE   28
 
-void processSbusInput();
-void processSbusFrame(uint8_t * sbus, int16_t * pulses, uint32_t size);
+struct SbusStatistics {
+  uint32_t frames;       // valid frames decoded
+  uint32_t lostFrames;   // frames flagged as lost / failsafe by the receiver
+  uint32_t badFrames;    // truncated, oversized or corrupted frames
+  uint16_t framePeriod;  // time between the last two valid frames (0.5us)
+};
+
+extern SbusStatistics sbusStatistics;
+
+bool processSbusFrame(uint8_t * sbus, int16_t * pulses, uint32_t size);
+void sbusRxByte(uint8_t byte);
+void sbusRxError();
+void sbusRxIdle();
+void sbusResetStatistics();
 
 #endif // _SBUS_H_
@@ -61,6 +61,7 @@
 #define LOGS_EXT            ".csv"
 #define SOUNDS_EXT          ".wav"
 #define BITMAPS_EXT         ".bmp"
+#define CAPTURES_EXT        ".otc"
 #define SCRIPTS_EXT         ".lua"
 #define TEXT_EXT            ".txt"
 #define FIRMWARE_EXT        ".bin"
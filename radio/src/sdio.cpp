@@ -0,0 +1,338 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include "opentx.h"
+
+#if defined(SIMU)
+#include <chrono>
+#include <pthread.h>
+#endif
+
+SdIoScheduler sdIoScheduler;
+
+void SdIoScheduler::reset()
+{
+  memclear(this, sizeof(*this));
+}
+
+void SdIoScheduler::resetStats()
+{
+  for (int i=0; i<SDIO_CLASSES_COUNT; i++) {
+    uint8_t depth = stats[i].depth;
+    memclear(&stats[i], sizeof(SdIoStats));
+    stats[i].depth = stats[i].maxDepth = depth;
+  }
+  readCommands = readSectors = 0;
+  writeCommands = writeSectors = 0;
+}
+
+bool SdIoScheduler::request(uint8_t cls, uint32_t now)
+{
+  SdIoStats & s = stats[cls];
+  s.requests++;
+
+  if (!busy) {
+    busy = true;
+    holder = cls;
+    holdStart = now;
+    return true;
+  }
+
+  s.contended++;
+  waiters[cls][(first[cls] + s.depth) % SDIO_MAX_WAITERS] = now;
+  if (++s.depth > s.maxDepth) {
+    s.maxDepth = s.depth;
+  }
+  return false;
+}
+
+int SdIoScheduler::next(uint32_t now) const
+{
+  // the background requests can't be postponed forever by the interactive ones
+  if (stats[SDIO_BACKGROUND].depth > 0 && stats[SDIO_AUDIO].depth == 0 && now - waiters[SDIO_BACKGROUND][first[SDIO_BACKGROUND]] >= SDIO_MAX_AGE) {
+    return SDIO_BACKGROUND;
+  }
+
+  for (int i=0; i<SDIO_CLASSES_COUNT; i++) {
+    if (stats[i].depth > 0) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+int SdIoScheduler::release(uint32_t now)
+{
+  uint32_t hold = now - holdStart;
+  if (hold > stats[holder].maxHold) {
+    stats[holder].maxHold = hold;
+  }
+
+  int cls = next(now);
+  if (cls < 0) {
+    busy = false;
+    return -1;
+  }
+
+  SdIoStats & s = stats[cls];
+  uint32_t wait = now - waiters[cls][first[cls]];
+  first[cls] = (first[cls] + 1) % SDIO_MAX_WAITERS;
+  s.depth--;
+  s.totalWait += wait;
+  if (wait > s.maxWait) {
+    s.maxWait = wait;
+  }
+
+  holder = cls;
+  holdStart = now;
+  return cls;
+}
+
+const char * SdIoScheduler::getClassName(uint8_t cls)
+{
+  static const char * const names[SDIO_CLASSES_COUNT] = {
+    "Audio", "Loads", "Logs"
+  };
+  return names[cls];
+}
+
+bool SdIoWriteBatch::add(const uint8_t * buff, uint32_t sector, uint32_t count)
+{
+  if (this->count > 0 && sector != this->sector + this->count)
+    return false;
+
+  if (this->count + count > SDIO_BATCH_SECTORS)
+    return false;
+
+  if (this->count == 0)
+    this->sector = sector;
+
+  memcpy(&buffer[this->count*512], buff, count*512);
+  this->count += count;
+  return true;
+}
+
+int8_t SdIoWriteBatch::flush()
+{
+  if (count > 0) {
+    int8_t result = function(buffer, sector, count);
+    if (result != 0) {
+      // kept to be written again
+      return result;
+    }
+    count = 0;
+  }
+  return 0;
+}
+
+int8_t SdIoWriteBatch::write(const uint8_t * buff, uint32_t sector, uint32_t count)
+{
+  int8_t result = 0;
+
+  if (!add(buff, sector, count)) {
+    result = flush();
+    if (result == 0 && !add(buff, sector, count)) {
+      // too large to be batched
+      result = function(buff, sector, count);
+    }
+  }
+
+  if (result == 0 && this->count == SDIO_BATCH_SECTORS) {
+    result = flush();
+  }
+
+  return result;
+}
+
+int8_t SdIoWriteBatch::writeThrough(const uint8_t * buff, uint32_t sector, uint32_t count)
+{
+  int8_t result = flush(sector, count);
+  if (result == 0) {
+    result = function(buff, sector, count);
+  }
+  return result;
+}
+
+#if defined(SIMU)
+// each simulator thread has its own class
+static __thread uint8_t sdIoTaskClass = SDIO_INTERACTIVE;
+
+uint8_t sdIoGetTaskClass()
+{
+  return sdIoTaskClass;
+}
+
+uint8_t sdIoSetTaskClass(uint8_t cls)
+{
+  uint8_t previous = sdIoTaskClass;
+  sdIoTaskClass = cls;
+  return previous;
+}
+
+uint32_t sdIoGetTime()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static pthread_mutex_t sdIoMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sdIoConditions[SDIO_CLASSES_COUNT] = { PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER };
+static uint8_t sdIoWakeups[SDIO_CLASSES_COUNT];
+
+void sdIoInit()
+{
+  pthread_mutex_lock(&sdIoMutex);
+  sdIoScheduler.reset();
+  memclear(sdIoWakeups, sizeof(sdIoWakeups));
+  pthread_mutex_unlock(&sdIoMutex);
+}
+
+bool sdIoRequest()
+{
+  uint8_t cls = sdIoGetTaskClass();
+  pthread_mutex_lock(&sdIoMutex);
+  if (!sdIoScheduler.request(cls, sdIoGetTime())) {
+    while (sdIoWakeups[cls] == 0) {
+      pthread_cond_wait(&sdIoConditions[cls], &sdIoMutex);
+    }
+    sdIoWakeups[cls]--;
+  }
+  pthread_mutex_unlock(&sdIoMutex);
+  return true;
+}
+
+void sdIoRelease()
+{
+  pthread_mutex_lock(&sdIoMutex);
+  int next = sdIoScheduler.release(sdIoGetTime());
+  if (next >= 0) {
+    sdIoWakeups[next]++;
+    pthread_cond_signal(&sdIoConditions[next]);
+  }
+  pthread_mutex_unlock(&sdIoMutex);
+}
+#else
+#define SDIO_MAX_TASKS        8
+#define SDIO_POLL_TICKS       5     // a lost wakeup (two tasks of the same class) only delays the request
+
+static uint8_t sdIoTaskClasses[SDIO_MAX_TASKS];   // the class + 1, 0 when not set
+static OS_FlagID sdIoFlags[SDIO_CLASSES_COUNT];
+static uint8_t sdIoWakeups[SDIO_CLASSES_COUNT];
+
+uint8_t sdIoGetTaskClass()
+{
+  OS_TID task = CoGetCurTaskID();
+  if (task < SDIO_MAX_TASKS && sdIoTaskClasses[task])
+    return sdIoTaskClasses[task] - 1;
+  else
+    return SDIO_INTERACTIVE;
+}
+
+uint8_t sdIoSetTaskClass(uint8_t cls)
+{
+  uint8_t previous = sdIoGetTaskClass();
+  OS_TID task = CoGetCurTaskID();
+  if (task < SDIO_MAX_TASKS)
+    sdIoTaskClasses[task] = cls + 1;
+  return previous;
+}
+
+// only called with the scheduler locked
+uint32_t sdIoGetTime()
+{
+  static uint32_t time;
+  static tmr10ms_t last10ms;
+  static uint16_t last2MHz;
+
+  tmr10ms_t now10ms = get_tmr10ms();
+  uint16_t now2MHz = getTmr2MHz();
+  uint32_t elapsed10ms = now10ms - last10ms;
+  if (elapsed10ms >= 3) {
+    // the 2MHz timer wrapped
+    time += elapsed10ms * 10000;
+  }
+  else {
+    time += (uint16_t)(now2MHz - last2MHz) / 2;
+  }
+  last10ms = now10ms;
+  last2MHz = now2MHz;
+  return time;
+}
+
+void sdIoInit()
+{
+  sdIoScheduler.reset();
+  for (int i=0; i<SDIO_CLASSES_COUNT; i++) {
+    sdIoFlags[i] = CoCreateFlag(true, false);
+  }
+}
+
+bool sdIoRequest()
+{
+  uint8_t cls = sdIoGetTaskClass();
+  CoSchedLock();
+  bool granted = sdIoScheduler.request(cls, sdIoGetTime());
+  CoSchedUnlock();
+
+  while (!granted) {
+    // the wakeups counter is the reference, the flag only avoids polling it
+    CoWaitForSingleFlag(sdIoFlags[cls], SDIO_POLL_TICKS);
+    CoSchedLock();
+    if (sdIoWakeups[cls] > 0) {
+      sdIoWakeups[cls]--;
+      granted = true;
+    }
+    CoSchedUnlock();
+  }
+
+  return true;
+}
+
+void sdIoRelease()
+{
+  CoSchedLock();
+  int next = sdIoScheduler.release(sdIoGetTime());
+  if (next >= 0) {
+    sdIoWakeups[next]++;
+  }
+  CoSchedUnlock();
+
+  if (next >= 0) {
+    CoSetFlag(sdIoFlags[next]);
+  }
+}
+#endif
@@ -0,0 +1,206 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#ifndef _SDIO_H_
+#define _SDIO_H_
+
+// The users of the FatFs volume, in priority order
+enum SdIoClass {
+  SDIO_AUDIO,         // the audio read-ahead, an underrun is heard
+  SDIO_INTERACTIVE,   // models, bitmaps, Lua scripts and screenshots
+  SDIO_BACKGROUND,    // logs
+  SDIO_CLASSES_COUNT
+};
+
+#define SDIO_MAX_WAITERS      8         // per class, more than the tasks
+#define SDIO_MAX_AGE          500000    // us, a background request waiting that long goes before the interactive ones
+#define SDIO_BATCH_SECTORS    4
+
+struct SdIoStats {
+  uint32_t requests;
+  uint32_t contended;     // the requests which had to wait
+  uint32_t totalWait;     // us
+  uint32_t maxWait;       // us
+  uint32_t maxHold;       // us
+  uint8_t  depth;         // the requests waiting now
+  uint8_t  maxDepth;
+};
+
+// The volume is held by one request at a time, when it is released it is
+// handed over to the waiting class with the highest priority. The scheduler
+// only does the accounting, blocking and waking the tasks is done by the
+// caller. FatFs holds the volume during a whole API call, there is no
+// preemption of the current holder
+class SdIoScheduler
+{
+  public:
+    void reset();
+
+    // true when the volume is granted at once, otherwise the caller waits until its class is returned by release()
+    bool request(uint8_t cls, uint32_t now);
+
+    // the class which gets the volume, -1 when nobody waits
+    int release(uint32_t now);
+
+    void countTransfer(bool write, uint32_t sectors)
+    {
+      if (write) {
+        writeCommands++;
+        writeSectors += sectors;
+      }
+      else {
+        readCommands++;
+        readSectors += sectors;
+      }
+    }
+
+    void resetStats();
+
+    const SdIoStats & getStats(uint8_t cls) const
+    {
+      return stats[cls];
+    }
+
+    uint32_t readCommands;
+    uint32_t readSectors;
+    uint32_t writeCommands;
+    uint32_t writeSectors;
+
+    static const char * getClassName(uint8_t cls);
+
+  protected:
+    int next(uint32_t now) const;
+
+    bool     busy;
+    uint8_t  holder;
+    uint32_t holdStart;
+    uint8_t  first[SDIO_CLASSES_COUNT];
+    uint32_t waiters[SDIO_CLASSES_COUNT][SDIO_MAX_WAITERS];    // the request times
+    SdIoStats stats[SDIO_CLASSES_COUNT];
+};
+
+typedef int8_t (*SdIoWriteFunction)(const uint8_t * buff, uint32_t sector, uint32_t count);
+
+// The small consecutive writes of the logs (written sector by sector) are
+// kept and sent as one multiple block write. Only the background writes are
+// batched, so that the other classes don't pay for them: the batch is only
+// flushed by the background writes, the reads and writes of the same sectors,
+// and a sync. A failed batch is kept, its error is returned by the next call
+// which flushes it
+class SdIoWriteBatch
+{
+  public:
+    SdIoWriteBatch(SdIoWriteFunction function):
+      function(function),
+      sector(0),
+      count(0)
+    {
+    }
+
+    // batched
+    int8_t write(const uint8_t * buff, uint32_t sector, uint32_t count);
+
+    // not batched, the batch is flushed first when it contains these sectors
+    int8_t writeThrough(const uint8_t * buff, uint32_t sector, uint32_t count);
+
+    // before a read of these sectors
+    int8_t flush(uint32_t sector, uint32_t count)
+    {
+      return overlaps(sector, count) ? flush() : 0;
+    }
+
+    int8_t flush();
+
+    uint32_t pending() const
+    {
+      return count;
+    }
+
+  protected:
+    bool add(const uint8_t * buff, uint32_t sector, uint32_t count);
+
+    bool overlaps(uint32_t sector, uint32_t count) const
+    {
+      return this->count > 0 && sector < this->sector + this->count && sector + count > this->sector;
+    }
+
+    SdIoWriteFunction function;
+    uint32_t sector;
+    uint32_t count;
+    uint8_t  buffer[SDIO_BATCH_SECTORS*512];
+};
+
+// The simulated card latency, a command setup time plus a transfer time per sector
+struct SdIoLatency {
+  uint32_t command;   // us
+  uint32_t sector;    // us
+
+  uint32_t get(uint32_t sectors) const
+  {
+    return command + sectors * sector;
+  }
+};
+
+extern SdIoScheduler sdIoScheduler;
+
+void sdIoInit();
+bool sdIoRequest();
+void sdIoRelease();
+uint32_t sdIoGetTime();
+
+// The class of the requests of the current task, SDIO_INTERACTIVE by default
+uint8_t sdIoGetTaskClass();
+uint8_t sdIoSetTaskClass(uint8_t cls);
+
+class SdIoClassScope
+{
+  public:
+    SdIoClassScope(uint8_t cls):
+      previous(sdIoSetTaskClass(cls))
+    {
+    }
+
+    ~SdIoClassScope()
+    {
+      sdIoSetTaskClass(previous);
+    }
+
+  protected:
+    uint8_t previous;
+};
+
+#endif // _SDIO_H_
@@ -212,6 +212,12 @@ long Open9xSim::onKeypress(FXObject*,FXSelector,void*v)
   if (evt->code=='s') {
     makeSnapshot(bmf);
   }
+#if defined(PCBTARANIS)
+  else if (evt->code=='r') {
+    // records the frames in the SCREENSHOTS folder until pressed again
+    captureRequestToggle();
+  }
+#endif
   return 0;
 }
 
@@ -449,6 +455,9 @@ int main(int argc,char **argv)
   StartEepromThread(argc >= 2 ? argv[1] : "eeprom.bin");
   StartAudioThread();
   StartMainThread();
+#if defined(CLI)
+  cliStart();
+#endif
 
   return application.run();
 }
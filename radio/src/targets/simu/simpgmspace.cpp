@@ -247,7 +247,7 @@ void simuSetSwitch(uint8_t swtch, int8_t state)
     SWITCH_CASE(5, ping, 1<<INP_G_Gear)
     SWITCH_CASE(6, pinb, 1<<INP_L_Trainer)
 #else // PCB9X
-#if defined(JETI) || defined(FRSKY) || defined(NMEA) || defined(ARDUPILOT)
+#if defined(JETI) || defined(FRSKY) || defined(NMEA) || defined(ARDUPILOT) || defined(MAVLINK)
     SWITCH_CASE(0, pinc, 1<<INP_C_ThrCt)
     SWITCH_CASE(4, pinc, 1<<INP_C_AileDR)
 #else
@@ -342,6 +342,9 @@ void *main_thread(void *)
     eeReadAll(); // load general setup and selected model
 
 #if defined(SIMU_DISKIO)
+#if defined(PCBTARANIS)
+    sdIoInit();
+#endif
     f_mount(&g_FATFS_Obj, "", 1);
     // call sdGetFreeSectors() now because f_getfree() takes a long time first time it's called
     sdGetFreeSectors();
@@ -367,12 +370,19 @@ void *main_thread(void *)
     while (main_thread_running) {
 #if defined(CPUARM)
       doMixerCalculations();
+#if defined(FRSKY)
+      CoEnterMutexSection(telemetryStreamMutex);
+      telemetryStream.wakeup();
+      CoLeaveMutexSection(telemetryStreamMutex);
+#endif
 #if defined(FRSKY) || defined(MAVLINK)
       telemetryWakeup();
 #endif
       checkTrims();
 #endif
+      TRACE_TASK_BEGIN(task_menus);
       perMain();
+      TRACE_TASK_END(task_menus);
       sleep(10/*ms*/);
     }
 
@@ -443,6 +453,40 @@ void StopMainThread()
   pthread_join(main_thread_pid, NULL);
 }
 
+#if defined(CLI)
+// the CLI output goes to stdout and to the simulator debug output, like the traces
+static void simuSerialWrite(const char * text)
+{
+  fputs(text, stdout);
+  fflush(stdout);
+  if (traceCallback) {
+    traceCallback(text);
+  }
+}
+
+void serialPutc(char c)
+{
+  char text[2] = { c, '\0' };
+  simuSerialWrite(text);
+}
+
+void serialPrintf(const char * format, ...)
+{
+  va_list arglist;
+  char tmp[256];
+
+  va_start(arglist, format);
+  vsnprintf(tmp, sizeof(tmp), format, arglist);
+  va_end(arglist);
+  simuSerialWrite(tmp);
+}
+
+void serialCrlf()
+{
+  simuSerialWrite("\n");
+}
+#endif
+
 #if defined(CPUARM)
 
 struct SimulatorAudio {
@@ -554,6 +598,10 @@ void * audioThread(void *)
   }
   SDL_PauseAudio(0);
 
+#if defined(PCBTARANIS)
+  sdIoSetTaskClass(SDIO_AUDIO);
+#endif
+
   while (simuAudio.threadRunning) {
     audioQueue.wakeup();
     sleep(1);
@@ -786,7 +834,7 @@ char *findTrueFileName(const char *path)
   return result;
 }
 
-FRESULT f_stat (const TCHAR * name, FILINFO *)
+FRESULT f_stat (const TCHAR * name, FILINFO * fno)
 {
   char *path = convertSimuPath(name);
   char * realPath = findTrueFileName(path);
@@ -797,6 +845,13 @@ FRESULT f_stat (const TCHAR * name, FILINFO *)
   }
   else {
     TRACE("f_stat(%s) = OK", path);
+    if (fno) {
+      const struct tm * t = gmtime(&tmp.st_mtime);
+      fno->fsize = tmp.st_size;
+      fno->fdate = ((t->tm_year - 80) << 9) | ((t->tm_mon+1) << 5) | t->tm_mday;
+      fno->ftime = (t->tm_hour << 11) | (t->tm_min << 5) | (t->tm_sec >> 1);
+      fno->fattrib = (S_ISDIR(tmp.st_mode) ? AM_DIR : 0);
+    }
     return FR_OK;
   }
 }
@@ -1032,11 +1087,46 @@ uint32_t Card_CSD[4]; // TODO elsewhere
 #include "FatFs/diskio.h"
 #include <time.h>
 #include <stdio.h>
+#if defined(PCBTARANIS)
+#include <thread>
+#endif
 
 #if defined(CPUARM)
 FATFS g_FATFS_Obj = { 0};
 #endif
 
+#if defined(PCBTARANIS)
+// the card latency, set with SIMU_SDCARD_LATENCY="<command us>,<sector us>"
+SdIoLatency simuSdLatency = { 0, 0 };
+
+static void simuSdTransfer(bool write, UINT count)
+{
+  sdIoScheduler.countTransfer(write, count);
+  uint32_t delay = simuSdLatency.get(count);
+  if (delay > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(delay));
+  }
+}
+#define simuFlushWriteBatch()   simuWriteBatch.flush()
+#define simuFlushWriteBatchSectors(sector, count) simuWriteBatch.flush(sector, count)
+#else
+#define simuSdTransfer(write, count)
+#define simuFlushWriteBatch()
+#define simuFlushWriteBatchSectors(sector, count)
+#endif
+
+static int8_t simuWriteSectors(const uint8_t * buff, uint32_t sector, uint32_t count)
+{
+  fseek(diskImage, sector*512, SEEK_SET);
+  fwrite(buff, count, 512, diskImage);
+  simuSdTransfer(true, count);
+  return 0;
+}
+
+#if defined(PCBTARANIS)
+static SdIoWriteBatch simuWriteBatch(simuWriteSectors);
+#endif
+
 int ff_cre_syncobj (BYTE vol, _SYNC_t* sobj) /* Create a sync object */
 {
   return 1;
@@ -1044,12 +1134,18 @@ int ff_cre_syncobj (BYTE vol, _SYNC_t* sobj) /* Create a sync object */
 
 int ff_req_grant (_SYNC_t sobj)        /* Lock sync object */
 {
+#if defined(PCBTARANIS)
+  return sdIoRequest();
+#else
   return 1;
+#endif
 }
 
 void ff_rel_grant (_SYNC_t sobj)        /* Unlock sync object */
 {
-
+#if defined(PCBTARANIS)
+  sdIoRelease();
+#endif
 }
 
 int ff_del_syncobj (_SYNC_t sobj)        /* Delete a sync object */
@@ -1085,6 +1181,12 @@ DSTATUS disk_initialize (BYTE pdrv)
 {
   traceDiskStatus();
   TRACE("disk_initialize(%u)", pdrv);
+#if defined(PCBTARANIS)
+  const char * latency = getenv("SIMU_SDCARD_LATENCY");
+  if (latency) {
+    sscanf(latency, "%u,%u", &simuSdLatency.command, &simuSdLatency.sector);
+  }
+#endif
   diskImage = fopen("sdcard.image", "r+");
   return diskImage ? (DSTATUS)0 : (DSTATUS)STA_NODISK;
 }
@@ -1101,8 +1203,10 @@ DRESULT disk_read (BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
   if (diskImage == 0) return RES_NOTRDY;
   traceDiskStatus();
   TRACE("disk_read(%u, %p, %u, %u)", pdrv, buff, sector, count);
+  simuFlushWriteBatchSectors(sector, count);
   fseek(diskImage, sector*512, SEEK_SET);
   fread(buff, count, 512, diskImage);
+  simuSdTransfer(false, count);
   return RES_OK;
 }
 
@@ -1111,8 +1215,14 @@ DRESULT disk_write (BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
   if (diskImage == 0) return RES_NOTRDY;
   traceDiskStatus();
   TRACE("disk_write(%u, %p, %u, %u)", pdrv, buff, sector, count);
-  fseek(diskImage, sector*512, SEEK_SET);
-  fwrite(buff, count, 512, diskImage);
+#if defined(PCBTARANIS)
+  if (sdIoGetTaskClass() == SDIO_BACKGROUND)
+    simuWriteBatch.write(buff, sector, count);
+  else
+    simuWriteBatch.writeThrough(buff, sector, count);
+#else
+  simuWriteSectors(buff, sector, count);
+#endif
   return RES_OK;
 }
 
@@ -1147,6 +1257,7 @@ DRESULT disk_ioctl (BYTE pdrv, BYTE cmd, void* buff)
   switch(cmd) {
 /* Generic command (Used by FatFs) */
     case CTRL_SYNC :     /* Complete pending write process (needed at _FS_READONLY == 0) */
+      simuFlushWriteBatch();
       break;
 
     case GET_SECTOR_COUNT: /* Get media size (needed at _USE_MKFS == 1) */
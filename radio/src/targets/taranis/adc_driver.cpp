@@ -41,9 +41,10 @@
 #define PIN_PORTB   0x0100
 #define PIN_PORTC   0x0200
 
-// Sample time should exceed 1uS
-#define SAMPTIME       2   // sample time = 28 cycles
-#define SAMPTIME_LONG  3   // sample time = 56 cycles
+// Sample time should exceed 1uS. The ADC runs continuously, a long sample time
+// spreads the ADC_OVERSAMPLING conversions of each input over ~0.7ms and keeps
+// the DMA traffic low
+#define SAMPTIME       7   // sample time = 480 cycles
 
 #if defined(REV9E)
   const int8_t ana_direction[NUMBER_ANALOG] = {1,1,-1,-1,  -1,-1,-1,1, -1,1,1,1,  -1};
@@ -67,7 +68,13 @@
     #define NUMBER_ANALOG_ADC1      10
 #endif
 
-uint16_t Analog_values[NUMBER_ANALOG] __DMA;
+uint16_t Analog_values[NUMBER_ANALOG];
+
+// written continuously by the DMA (circular mode), ADC_OVERSAMPLING scans of each ADC
+uint16_t adc1Samples[ADC_OVERSAMPLING][NUMBER_ANALOG_ADC1] __DMA;
+#if defined(REV9E)
+uint16_t adc3Samples[ADC_OVERSAMPLING][NUMBER_ANALOG_ADC3] __DMA;
+#endif
 
 void adcInit()
 {
@@ -87,7 +94,7 @@ void adcInit()
 #endif
 
   ADC1->CR1 = ADC_CR1_SCAN;
-  ADC1->CR2 = ADC_CR2_ADON | ADC_CR2_DMA | ADC_CR2_DDS;
+  ADC1->CR2 = ADC_CR2_ADON | ADC_CR2_DMA | ADC_CR2_DDS | ADC_CR2_CONT;
   ADC1->SQR1 = (NUMBER_ANALOG_ADC1-1) << 20 ; // bits 23:20 = number of conversions
 #if defined(REV9E)
   ADC1->SQR2 = (ADC_CHANNEL_POT4<<0) + (ADC_CHANNEL_SLIDER3<<5) + (ADC_CHANNEL_SLIDER4<<10) + (ADC_CHANNEL_BATT<<15); // conversions 7 and more
@@ -101,61 +108,60 @@ void adcInit()
 
   ADC->CCR = 0 ; //ADC_CCR_ADCPRE_0 ;             // Clock div 2
 
-  DMA2_Stream0->CR = DMA_SxCR_PL | DMA_SxCR_MSIZE_0 | DMA_SxCR_PSIZE_0 | DMA_SxCR_MINC;
+  DMA2_Stream0->CR = DMA_SxCR_PL | DMA_SxCR_MSIZE_0 | DMA_SxCR_PSIZE_0 | DMA_SxCR_MINC | DMA_SxCR_CIRC;
   DMA2_Stream0->PAR = CONVERT_PTR_UINT(&ADC1->DR);
-  DMA2_Stream0->M0AR = CONVERT_PTR_UINT(Analog_values);
-  DMA2_Stream0->NDTR = NUMBER_ANALOG_ADC1;
+  DMA2_Stream0->M0AR = CONVERT_PTR_UINT(adc1Samples);
+  DMA2_Stream0->NDTR = ADC_OVERSAMPLING * NUMBER_ANALOG_ADC1;
   DMA2_Stream0->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH_0 ;
 
 #if defined(REV9E)
   ADC3->CR1 = ADC_CR1_SCAN ;
-  ADC3->CR2 = ADC_CR2_ADON | ADC_CR2_DMA | ADC_CR2_DDS ;
+  ADC3->CR2 = ADC_CR2_ADON | ADC_CR2_DMA | ADC_CR2_DDS | ADC_CR2_CONT ;
   ADC3->SQR1 = (NUMBER_ANALOG_ADC3-1) << 20 ;   // NUMBER_ANALOG Channels
   ADC3->SQR2 = 0; 
   ADC3->SQR3 = (ADC_CHANNEL_POT1<<0) + (ADC_CHANNEL_SLIDER1<<5) + (ADC_CHANNEL_SLIDER2<<10) ; // conversions 1 to 3
   ADC3->SMPR1 = 0;
-  ADC3->SMPR2 = (SAMPTIME_LONG<<(3*ADC_CHANNEL_POT1)) + (SAMPTIME_LONG<<(3*ADC_CHANNEL_SLIDER1)) + (SAMPTIME_LONG<<(3*ADC_CHANNEL_SLIDER2));
+  ADC3->SMPR2 = (SAMPTIME<<(3*ADC_CHANNEL_POT1)) + (SAMPTIME<<(3*ADC_CHANNEL_SLIDER1)) + (SAMPTIME<<(3*ADC_CHANNEL_SLIDER2));
   
   // Enable the DMA channel here, DMA2 stream 1, channel 2
-  DMA2_Stream1->CR = DMA_SxCR_PL | DMA_SxCR_CHSEL_1 | DMA_SxCR_MSIZE_0 | DMA_SxCR_PSIZE_0 | DMA_SxCR_MINC;
+  DMA2_Stream1->CR = DMA_SxCR_PL | DMA_SxCR_CHSEL_1 | DMA_SxCR_MSIZE_0 | DMA_SxCR_PSIZE_0 | DMA_SxCR_MINC | DMA_SxCR_CIRC;
   DMA2_Stream1->PAR = CONVERT_PTR_UINT(&ADC3->DR);
-  DMA2_Stream1->M0AR = CONVERT_PTR_UINT(Analog_values + NUMBER_ANALOG_ADC1);
-  DMA2_Stream1->NDTR = NUMBER_ANALOG_ADC3;
+  DMA2_Stream1->M0AR = CONVERT_PTR_UINT(adc3Samples);
+  DMA2_Stream1->NDTR = ADC_OVERSAMPLING * NUMBER_ANALOG_ADC3;
   DMA2_Stream1->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH_0 ;
 #endif
-}
 
-void adcRead()
-{
-  DMA2_Stream0->CR &= ~DMA_SxCR_EN ;              // Disable DMA
-  ADC1->SR &= ~(uint32_t) ( ADC_SR_EOC | ADC_SR_STRT | ADC_SR_OVR ) ;
+  // start the conversions, they never stop
   DMA2->LIFCR = DMA_LIFCR_CTCIF0 | DMA_LIFCR_CHTIF0 |DMA_LIFCR_CTEIF0 | DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CFEIF0 ; // Write ones to clear bits
   DMA2_Stream0->CR |= DMA_SxCR_EN ;               // Enable DMA
   ADC1->CR2 |= (uint32_t)ADC_CR2_SWSTART ;
 
 #if defined(REV9E)
-  DMA2_Stream1->CR &= ~DMA_SxCR_EN ;    // Disable DMA
-  ADC3->SR &= ~(uint32_t) ( ADC_SR_EOC | ADC_SR_STRT | ADC_SR_OVR ) ;
   DMA2->LIFCR = DMA_LIFCR_CTCIF1 | DMA_LIFCR_CHTIF1 |DMA_LIFCR_CTEIF1 | DMA_LIFCR_CDMEIF1 | DMA_LIFCR_CFEIF1 ; // Write ones to clear bits
   DMA2_Stream1->CR |= DMA_SxCR_EN ;   // Enable DMA
   ADC3->CR2 |= (uint32_t)ADC_CR2_SWSTART ;
-#endif  // #if defined(REV9E)
+#endif
+}
 
-#if defined(REV9E)
-  for (unsigned int i=0; i<10000; i++) {
-    if ((DMA2->LISR & DMA_LISR_TCIF0) && (DMA2->LISR & DMA_LISR_TCIF1)) {
-      break;
+void adcRead()
+{
+  // no waiting here, the DMA keeps writing while the last scans are averaged
+  for (uint32_t x=0; x<NUMBER_ANALOG_ADC1; x++) {
+    uint32_t sum = 0;
+    for (uint32_t i=0; i<ADC_OVERSAMPLING; i++) {
+      sum += adc1Samples[i][x];
     }
+    Analog_values[x] = sum / ADC_OVERSAMPLING;
   }
-  DMA2_Stream0->CR &= ~DMA_SxCR_EN ;              // Disable DMA
-  DMA2_Stream1->CR &= ~DMA_SxCR_EN ;              // Disable DMA
-#else
-  for (unsigned int i=0; i<10000; i++) {
-    if (DMA2->LISR & DMA_LISR_TCIF0) {
-      break;
+
+#if defined(REV9E)
+  for (uint32_t x=0; x<NUMBER_ANALOG_ADC3; x++) {
+    uint32_t sum = 0;
+    for (uint32_t i=0; i<ADC_OVERSAMPLING; i++) {
+      sum += adc3Samples[i][x];
     }
+    Analog_values[NUMBER_ANALOG_ADC1+x] = sum / ADC_OVERSAMPLING;
   }
-  DMA2_Stream0->CR &= ~DMA_SxCR_EN ;              // Disable DMA
 #endif
 }
 
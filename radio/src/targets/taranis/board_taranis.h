@@ -250,6 +250,7 @@ void watchdogInit(unsigned int duration);
 #endif
 
 // ADC driver
+#define ADC_OVERSAMPLING  4   // conversions of each input kept by the ADC DMA
 void adcInit(void);
 void adcRead(void);
 uint16_t getAnalogValue(uint32_t value);
@@ -334,6 +335,7 @@ void hapticOff(void);
 #define DEBUG_BAUDRATE                 115200
 void serial2Init(unsigned int mode, unsigned int protocol);
 void serial2Putc(char c);
+void serial2Write(const uint8_t * data, uint32_t len);
 #define serial2TelemetryInit(protocol) serial2Init(UART_MODE_TELEMETRY, protocol)
 void serial2SbusInit(void);
 void serial2Stop(void);
@@ -42,6 +42,10 @@
 #include "hal.h"
 #include "../../debug.h"
 
+#if !defined(BOOT)
+#include "../../sdio.h"
+#endif
+
 /* Definitions for MMC/SDC command */
 #define CMD0    (0x40+0)        /* GO_IDLE_STATE */
 #define CMD1    (0x40+1)        /* SEND_OP_COND (MMC) */
@@ -80,23 +84,21 @@
 /* Lock / unlock functions                                               */
 /*-----------------------------------------------------------------------*/
 #if !defined(BOOT)
-static OS_MutexID ioMutex;
-volatile int mutexCheck = 0;
-
+// the volume is granted by the SD I/O scheduler, see sdio.cpp
 int ff_cre_syncobj (BYTE vol, _SYNC_t *mutex)
 {
-  *mutex = ioMutex;
+  *mutex = 0;
   return 1;
 }
 
 int ff_req_grant (_SYNC_t mutex)
 {
-  return CoEnterMutexSection(mutex) == E_OK;
+  return sdIoRequest();
 }
 
 void ff_rel_grant (_SYNC_t mutex)
 {
-  CoLeaveMutexSection(mutex);
+  sdIoRelease();
 }
 
 int ff_del_syncobj (_SYNC_t mutex)
@@ -687,6 +689,27 @@ int8_t SD_ReadSectors(uint8_t *buff, uint32_t sector, uint32_t count)
   return count ? -1 : 0;
 }
 
+#if defined(BOOT)
+#define flushWriteBatch()               0
+#define flushWriteBatchSectors(sector, count) 0
+#define COUNT_SD_TRANSFER(write, count)
+#else
+#define COUNT_SD_TRANSFER(write, count) sdIoScheduler.countTransfer(write, count)
+
+int8_t SD_WriteSectors(const uint8_t *buff, uint32_t sector, uint32_t count);
+
+static int8_t writeSectors(const uint8_t *buff, uint32_t sector, uint32_t count)
+{
+  COUNT_SD_TRANSFER(true, count);
+  return SD_WriteSectors(buff, sector, count);
+}
+
+static SdIoWriteBatch writeBatch(writeSectors);
+
+#define flushWriteBatch()               writeBatch.flush()
+#define flushWriteBatchSectors(sector, count) writeBatch.flush(sector, count)
+#endif
+
 DRESULT disk_read (
         BYTE drv,                       /* Physical drive number (0) */
         BYTE *buff,                     /* Pointer to the data buffer to store read data */
@@ -696,7 +719,12 @@ DRESULT disk_read (
 {
   if (drv || !count) return RES_PARERR;
   if (Stat & STA_NOINIT) return RES_NOTRDY;
-  int8_t res = SD_ReadSectors(buff, sector, count);
+  // the batched writes may contain these sectors
+  int8_t res = flushWriteBatchSectors(sector, count);
+  if (res == 0) {
+    res = SD_ReadSectors(buff, sector, count);
+    COUNT_SD_TRANSFER(false, count);
+  }
   TRACE_SD_CARD_EVENT((res != 0), sd_disk_read, (count << 24) + (sector & 0x00FFFFFF));
   return (res != 0) ? RES_ERROR : RES_OK;
 }
@@ -753,7 +781,16 @@ DRESULT disk_write (
   if (drv || !count) return RES_PARERR;
   if (Stat & STA_NOINIT) return RES_NOTRDY;
   if (Stat & STA_PROTECT) return RES_WRPRT;
+#if defined(BOOT)
   int8_t res = SD_WriteSectors(buff, sector, count);
+#else
+  // only the logs are batched, the other classes don't wait for their flush
+  int8_t res;
+  if (sdIoGetTaskClass() == SDIO_BACKGROUND)
+    res = writeBatch.write(buff, sector, count);
+  else
+    res = writeBatch.writeThrough(buff, sector, count);
+#endif
   TRACE_SD_CARD_EVENT((res != 0), sd_disk_write, (count << 24) + (sector & 0x00FFFFFF));
   return (res != 0) ? RES_ERROR : RES_OK;
 }
@@ -805,6 +842,9 @@ DRESULT disk_ioctl (
 
     switch (ctrl) {
     case CTRL_SYNC :                /* Make sure that no pending write process */
+      if (flushWriteBatch() != 0) {
+        break;
+      }
       SD_SELECT();
       if (wait_ready() == 0xFF) {
         res = RES_OK;
@@ -974,11 +1014,7 @@ void sdInit(void)
 // TODO shouldn't be there!
 void sdInit(void)
 {
-  ioMutex = CoCreateMutex();
-  if (ioMutex >= CFG_MAX_MUTEX ) {
-    //sd error
-    return;
-  }
+  sdIoInit();
 
   if (f_mount(&g_FATFS_Obj, "", 1) == FR_OK) {
     // call sdGetFreeSectors() now because f_getfree() takes a long time first time it's called
@@ -1002,6 +1038,9 @@ void sdDone()
 #if defined(SPORT_FILE_LOG)
     f_close(&g_telemetryFile);
 #endif
+    sdIoRequest();
+    disk_ioctl(0, CTRL_SYNC, NULL); // write the batched sectors
+    sdIoRelease();
     f_mount(NULL, "", 0); // unmount SD
   }
 }
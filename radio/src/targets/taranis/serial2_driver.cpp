@@ -39,7 +39,6 @@
 uint8_t serial2Mode = 0;
 Fifo<512> serial2TxFifo;
 extern Fifo<512> telemetryFifo;
-extern Fifo<32> sbusFifo;
 
 void uart3Setup(unsigned int baudrate)
 {
@@ -103,10 +102,20 @@ void serial2Putc(char c)
   USART_ITConfig(SERIAL_USART, USART_IT_TXE, ENABLE);
 }
 
+void serial2Write(const uint8_t * data, uint32_t len)
+{
+  while (len--) {
+    while (serial2TxFifo.isFull());
+    serial2TxFifo.push(*data++);
+  }
+  USART_ITConfig(SERIAL_USART, USART_IT_TXE, ENABLE);
+}
+
 void serial2SbusInit()
 {
   uart3Setup(SBUS_BAUDRATE);
   SERIAL_USART->CR1 |= USART_CR1_M | USART_CR1_PCE ;
+  USART_ITConfig(SERIAL_USART, USART_IT_IDLE, ENABLE);
 }
 
 void serial2Stop()
@@ -149,7 +158,7 @@ extern "C" void SERIAL_USART_IRQHandler(void)
           telemetryFifo.push(data);
           break;
         case UART_MODE_SBUS_TRAINER:
-          sbusFifo.push(data);
+          sbusRxByte(data);
           break;
 #if !defined(USB_SERIAL) && defined(CLI)
         case UART_MODE_DEBUG:
@@ -158,9 +167,20 @@ extern "C" void SERIAL_USART_IRQHandler(void)
 #endif
       }
     }
+    else if (serial2Mode == UART_MODE_SBUS_TRAINER) {
+      sbusRxError();
+    }
 
     status = SERIAL_USART->SR;
   }
+
+  // End of SBUS frame
+  if (status & USART_FLAG_IDLE) {
+    (void)SERIAL_USART->DR; // clears the IDLE flag
+    if (serial2Mode == UART_MODE_SBUS_TRAINER) {
+      sbusRxIdle();
+    }
+  }
 }
 #endif
 
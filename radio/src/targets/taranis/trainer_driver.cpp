@@ -36,7 +36,6 @@
 
 #include "../../opentx.h"
 
-extern Fifo<32> sbusFifo;
 
 #define setupTrainerPulses() setupPulsesPPM(TRAINER_MODULE)
 
@@ -223,6 +222,7 @@ void init_sbus_on_heartbeat_capture()
   USART_Init(HEARTBEAT_USART, &USART_InitStructure);
   USART_Cmd(HEARTBEAT_USART, ENABLE);
   USART_ITConfig(HEARTBEAT_USART, USART_IT_RXNE, ENABLE);
+  USART_ITConfig(HEARTBEAT_USART, USART_IT_IDLE, ENABLE);
 
   NVIC_SetPriority(HEARTBEAT_USART_IRQn, 6);
   NVIC_EnableIRQ(HEARTBEAT_USART_IRQn);
@@ -249,12 +249,21 @@ extern "C" void HEARTBEAT_USART_IRQHandler()
   while (status & (USART_FLAG_RXNE | USART_FLAG_ERRORS)) {
     data = HEARTBEAT_USART->DR;
 
-    if (!(status & USART_FLAG_ERRORS)) {
-      if (currentTrainerMode == TRAINER_MODE_MASTER_SBUS_EXTERNAL_MODULE)
-        sbusFifo.push(data);
+    if (currentTrainerMode == TRAINER_MODE_MASTER_SBUS_EXTERNAL_MODULE) {
+      if (!(status & USART_FLAG_ERRORS))
+        sbusRxByte(data);
+      else
+        sbusRxError();
     }
 
     status = HEARTBEAT_USART->SR;
   }
+
+  // End of SBUS frame
+  if (status & USART_FLAG_IDLE) {
+    (void)HEARTBEAT_USART->DR; // clears the IDLE flag
+    if (currentTrainerMode == TRAINER_MODE_MASTER_SBUS_EXTERNAL_MODULE)
+      sbusRxIdle();
+  }
 }
 #endif
@@ -178,7 +178,9 @@ void menusTask(void * pdata)
   while (pwrCheck() != e_power_off) {
 #endif
     U64 start = CoGetOSTime();
+    TRACE_TASK_BEGIN(task_menus);
     perMain();
+    TRACE_TASK_END(task_menus);
     // TODO remove completely massstorage from sky9x firmware
     U32 runtime = (U32)(CoGetOSTime() - start);
     // deduct the thread run-time from the wait, if run-time was more than 
@@ -158,34 +158,33 @@ extern uint8_t TrotCount;
 extern uint8_t TezRotary;
 #endif
 
-NOINLINE void processSerialData(uint8_t data)
-{
-  static uint8_t dataState = STATE_DATA_IDLE;
-
-#if defined(BLUETOOTH)
-  // TODO if (g_model.bt_telemetry)
-  btPushByte(data);
-#endif
-
-#if defined(PCBTARANIS)
-    if (g_eeGeneral.serial2Mode == UART_MODE_TELEMETRY_MIRROR) {
-      serial2Putc(data);
-    }
-#endif
-
 #if defined(PCBTARANIS) && defined(REV9E) && !defined(SIMU)
-    #define BLUETOOTH_BUFFER_LENGTH     20
-    static uint8_t bluetoothBuffer[BLUETOOTH_BUFFER_LENGTH];
-    static uint8_t bluetoothIndex = 0;
-    bluetoothBuffer[bluetoothIndex++] = data;
+#define BLUETOOTH_BUFFER_LENGTH     20
+uint8_t bluetoothBuffer[BLUETOOTH_BUFFER_LENGTH];
+uint8_t bluetoothIndex = 0;
+
+void bluetoothMirror(const uint8_t * data, uint32_t len)
+{
+  while (len > 0) {
+    uint32_t count = min<uint32_t>(len, BLUETOOTH_BUFFER_LENGTH - bluetoothIndex);
+    memcpy(&bluetoothBuffer[bluetoothIndex], data, count);
+    bluetoothIndex += count;
+    data += count;
+    len -= count;
     if (bluetoothIndex == BLUETOOTH_BUFFER_LENGTH) {
       if (bluetoothReady()) {
         bluetoothWrite(bluetoothBuffer, BLUETOOTH_BUFFER_LENGTH);
       }
       bluetoothIndex = 0;
     }
+  }
+}
 #endif
 
+uint8_t dataState = STATE_DATA_IDLE;
+
+NOINLINE void processFrskyByte(uint8_t data)
+{
   switch (dataState)
   {
     case STATE_DATA_START:
@@ -282,6 +281,101 @@ NOINLINE void processSerialData(uint8_t data)
 #endif
 }
 
+NOINLINE void processSerialData(uint8_t data)
+{
+#if defined(BLUETOOTH)
+  // TODO if (g_model.bt_telemetry)
+  btPushByte(data);
+#endif
+
+#if defined(PCBTARANIS)
+  if (g_eeGeneral.serial2Mode == UART_MODE_TELEMETRY_MIRROR) {
+    serial2Putc(data);
+  }
+#endif
+
+#if defined(PCBTARANIS) && defined(REV9E) && !defined(SIMU)
+  bluetoothMirror(&data, 1);
+#endif
+
+  processFrskyByte(data);
+}
+
+#if defined(CPUARM)
+#if defined(FRSKY_SPORT)
+// Scans a chunk of S.Port data for packets. The packets entirely contained
+// in the chunk without any byte stuffing are dispatched directly, everything
+// else (stuffed bytes, packets split across two chunks) goes through the byte
+// parser, so that both paths always end in the same state.
+void processSportBuffer(uint8_t * data, uint32_t len)
+{
+  uint8_t * end = data + len;
+
+  while (data < end) {
+    if (dataState != STATE_DATA_IDLE) {
+      processFrskyByte(*data++);
+      continue;
+    }
+
+    uint8_t * start = (uint8_t *)memchr(data, START_STOP, end - data);
+    if (!start) {
+      return;
+    }
+
+    uint8_t * packet = start + 1;
+    bool clean = (end - packet >= FRSKY_SPORT_PACKET_SIZE);
+    for (uint8_t i=0; clean && i<FRSKY_SPORT_PACKET_SIZE; i++) {
+      // the first byte is never destuffed by the byte parser
+      if (packet[i] == START_STOP || (i > 0 && packet[i] == BYTESTUFF)) {
+        clean = false;
+      }
+    }
+
+    if (clean) {
+      processSportPacket(packet);
+      data = packet + FRSKY_SPORT_PACKET_SIZE;
+    }
+    else {
+      processFrskyByte(START_STOP);
+      data = packet;
+    }
+  }
+}
+#endif
+
+// Same as processSerialData() on a whole chunk of received data, which may be
+// modified in place. The mirrors are written as blocks.
+void processSerialBuffer(uint8_t * data, uint32_t len)
+{
+#if defined(BLUETOOTH)
+  for (uint32_t i=0; i<len; i++) {
+    btPushByte(data[i]);
+  }
+#endif
+
+#if defined(PCBTARANIS)
+  if (g_eeGeneral.serial2Mode == UART_MODE_TELEMETRY_MIRROR) {
+    serial2Write(data, len);
+  }
+#endif
+
+#if defined(PCBTARANIS) && defined(REV9E) && !defined(SIMU)
+  bluetoothMirror(data, len);
+#endif
+
+#if defined(FRSKY_SPORT)
+  if (IS_FRSKY_SPORT_PROTOCOL()) {
+    processSportBuffer(data, len);
+    return;
+  }
+#endif
+
+  for (uint32_t i=0; i<len; i++) {
+    processFrskyByte(data[i]);
+  }
+}
+#endif
+
 void telemetryWakeup()
 {
 #if defined(CPUARM)
@@ -307,8 +401,14 @@ void telemetryWakeup()
   struct gtm utm;
   gettime(&utm);
 #endif
+  uint8_t buffer[TELEMETRY_RX_CHUNK_SIZE];
+  uint32_t count = 0;
   while (telemetryFifo.pop(data)) {
-    processSerialData(data);
+    buffer[count++] = data;
+    if (count == TELEMETRY_RX_CHUNK_SIZE) {
+      processSerialBuffer(buffer, count);
+      count = 0;
+    }
 #if defined(SPORT_FILE_LOG) && !defined(SIMU)
     extern FIL g_telemetryFile;
     if (lastTime != newTime) {
@@ -320,6 +420,9 @@ void telemetryWakeup()
     }
 #endif
   }
+  if (count > 0) {
+    processSerialBuffer(buffer, count);
+  }
 #elif defined(PCBSKY9X)
   if (telemetryProtocol == PROTOCOL_FRSKY_D_SECONDARY) {
     uint8_t data;
@@ -347,12 +450,7 @@ void telemetryWakeup()
 #endif
 
 #if defined(CPUARM)
-  for (int i=0; i<MAX_SENSORS; i++) {
-    const TelemetrySensor & sensor = g_model.telemetrySensors[i];
-    if (sensor.type == TELEM_TYPE_CALCULATED) {
-      telemetryItems[i].eval(sensor);
-    }
-  }
+  evalCalculatedSensors();
 #endif
 
 #if defined(VARIO)
@@ -379,7 +477,7 @@ void telemetryWakeup()
       if (isTelemetryFieldAvailable(i)) {
         uint8_t lastReceived = telemetryItems[i].lastReceived;
         if (lastReceived < TELEMETRY_VALUE_TIMER_CYCLE && uint8_t(now - lastReceived) > TELEMETRY_VALUE_OLD_THRESHOLD) {
-          telemetryItems[i].lastReceived = TELEMETRY_VALUE_OLD;
+          telemetryItems[i].setOld();
           TelemetrySensor * sensor = & g_model.telemetrySensors[i];
           if (sensor->unit == UNIT_DATETIME) {
             telemetryItems[i].datetime.datestate = 0;
@@ -526,6 +526,11 @@ void processSportPacket(uint8_t *packet);
 #if defined(PCBTARANIS)
 void sportFirmwareUpdate(ModuleIndex module, const char *filename);
 #endif
+
+#if defined(CPUARM)
+#define TELEMETRY_RX_CHUNK_SIZE 64
+void processSerialBuffer(uint8_t * data, uint32_t len);
+#endif
 void telemetryWakeup(void);
 void telemetryReset();
 
@@ -66,6 +66,45 @@ static uint8_t data_stream_start_stop = 0;
 // Telemetry data hold
 Telemetry_Data_t telemetry_data;
 
+// Receive counters
+MavlinkStats_t mavlink_stats;
+
+/*!	\brief Receive buffer
+ *	\details The messages are received in place in a small ring of frames
+ *	and given to their handler by telemetryWakeup(). A frame starts like a
+ *	mavlink_message_t, the handlers get a view of it instead of a copy.
+ *	The payload is only as long as the largest message of the dispatch table
+ *	(STATUSTEXT) rounded up to 8 bytes, the other messages are never stored.
+ *	HEARTBEAT and STATUSTEXT have their own frame: the periodic messages which
+ *	fill the ring during a long main loop cycle never make them overrun. They
+ *	only go to the ring when the previous one is not handled yet.
+ *	A frame is 65 bytes on AVR, the 4 + 2 frames take 390 bytes of RAM, 120
+ *	more than the single mavlink_message_t (about 270 bytes) they replaced.
+ *	A 2 frames ring would fit in the old budget but overruns at 115200 bauds.
+ */
+#define MAVLINK_RX_PAYLOAD_LEN 56
+#define MAVLINK_RX_FRAMES 4 // power of 2, one of them is being received
+#define MAVLINK_RX_OWN_FRAMES 2 // HEARTBEAT and STATUSTEXT
+typedef struct MavlinkRxFrame_ {
+	uint16_t checksum;
+	uint8_t magic;
+	uint8_t len;
+	uint8_t seq;
+	uint8_t sysid;
+	uint8_t compid;
+	uint8_t msgid;
+	uint64_t payload64[MAVLINK_RX_PAYLOAD_LEN / 8];
+	uint8_t handler; ///< Index in the dispatch table
+} MavlinkRxFrame_t;
+
+static MavlinkRxFrame_t mavlinkRxFrames[MAVLINK_RX_FRAMES];
+static volatile uint8_t mavlinkRxHead = 0; // frame being received
+static volatile uint8_t mavlinkRxTail = 0; // next frame to handle
+static uint8_t mavlinkRxSkip = 0; // bytes left of a dropped message
+static MavlinkRxFrame_t mavlinkRxOwnFrames[MAVLINK_RX_OWN_FRAMES];
+static volatile uint8_t mavlinkRxOwnPending[MAVLINK_RX_OWN_FRAMES]; // received, not handled yet
+static MavlinkRxFrame_t* mavlinkRxFrame = mavlinkRxFrames; // frame being received
+
 // *****************************************************
 static void MAVLINK_parse_char(uint8_t c);
 
@@ -110,6 +149,14 @@ void MAVLINK_reset(uint8_t warm_reset) {
 	mavlink_status_t* p_status = mavlink_get_channel_status(MAVLINK_COMM_0);
 	p_status->current_rx_seq = 0;
 	p_status->current_tx_seq = 0;
+	if (!warm_reset) {
+		p_status->parse_state = MAVLINK_PARSE_STATE_IDLE;
+		mavlinkRxHead = mavlinkRxTail = 0;
+		mavlinkRxSkip = 0;
+		memset((void*)mavlinkRxOwnPending, 0, sizeof(mavlinkRxOwnPending));
+		mavlinkRxFrame = mavlinkRxFrames;
+		memset(&mavlink_stats, 0, sizeof(mavlink_stats));
+	}
 	memset(&telemetry_data, 0, sizeof(telemetry_data));
 	telemetry_data.rcv_control_mode = ERROR_NUM_MODES;
 	telemetry_data.req_mode = ERROR_NUM_MODES;
@@ -142,6 +189,7 @@ void MAVLINK_Init(void) {
 
 static inline void REC_MAVLINK_MSG_ID_STATUSTEXT(const mavlink_message_t* msg) {
 	_MAV_RETURN_char_array(msg, mav_statustext, LEN_STATUSTEXT,  1);
+	AUDIO_WARNING1();
 }
 
 /*!	\brief System status including cpu load, battery status and communication status.
@@ -406,82 +454,94 @@ static inline void REC_MAVLINK_MSG_ID_PARAM_VALUE(const mavlink_message_t* msg)
 }
 #endif
 
-static inline void handleMessage(mavlink_message_t* p_rxmsg) {
-	switch (p_rxmsg->msgid) {
-	case MAVLINK_MSG_ID_HEARTBEAT:
-		REC_MAVLINK_MSG_ID_HEARTBEAT(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_STATUSTEXT:
-		REC_MAVLINK_MSG_ID_STATUSTEXT(p_rxmsg);
-		AUDIO_WARNING1();
-		break;
-	case MAVLINK_MSG_ID_SYS_STATUS:
-		REC_MAVLINK_MSG_ID_SYS_STATUS(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_RC_CHANNELS_RAW:
-		REC_MAVLINK_MSG_ID_RC_CHANNELS_RAW(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_RADIO:
-		REC_MAVLINK_MSG_ID_RADIO(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_RADIO_STATUS:
-		REC_MAVLINK_MSG_ID_RADIO_STATUS(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT:
-		REC_MAVLINK_MSG_ID_NAV_CONTROLLER_OUTPUT(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_VFR_HUD:
-		REC_MAVLINK_MSG_ID_VFR_HUD(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_HIL_CONTROLS:
-		REC_MAVLINK_MSG_ID_HIL_CONTROLS(p_rxmsg);
-		break;
-	case MAVLINK_MSG_ID_GPS_RAW_INT:
-		REC_MAVLINK_MSG_ID_GPS_RAW_INT(p_rxmsg);
-		break;
+/*!	\brief Dispatch table, sorted by message id
+ *	\details Only these messages are stored and checked, the parser skips the
+ *	other ones as soon as it gets their id. A message which doesn't fit in the
+ *	receive frames fails the build (negative array size).
+ */
+#define MAVLINK_RX_LEN(len) (sizeof(char[((len) <= MAVLINK_RX_PAYLOAD_LEN) ? 1 : -1]) * (len))
+#define MAVLINK_HANDLER(id, frame) { MAVLINK_MSG_ID_##id, MAVLINK_RX_LEN(MAVLINK_MSG_ID_##id##_LEN), MAVLINK_MSG_ID_##id##_CRC, frame, REC_MAVLINK_MSG_ID_##id }
+static const MavlinkDispatch_t mavlinkHandlers[] PROGMEM = {
+	MAVLINK_HANDLER(HEARTBEAT, 1),
+	MAVLINK_HANDLER(SYS_STATUS, 0),
 #ifdef MAVLINK_PARAMS
-	case MAVLINK_MSG_ID_PARAM_VALUE:
-		REC_MAVLINK_MSG_ID_PARAM_VALUE(p_rxmsg);
-		break;
+	MAVLINK_HANDLER(PARAM_VALUE, 0),
 #endif
-
+	MAVLINK_HANDLER(GPS_RAW_INT, 0),
+	MAVLINK_HANDLER(RC_CHANNELS_RAW, 0),
+	MAVLINK_HANDLER(NAV_CONTROLLER_OUTPUT, 0),
+	MAVLINK_HANDLER(VFR_HUD, 0),
+	MAVLINK_HANDLER(HIL_CONTROLS, 0),
+	MAVLINK_HANDLER(RADIO_STATUS, 0),
+	MAVLINK_HANDLER(RADIO, 0),
+	MAVLINK_HANDLER(STATUSTEXT, 2),
+};
+
+//! \brief Index of the message in the dispatch table, DIM(mavlinkHandlers) if not found
+static inline uint8_t MAVLINK_find_handler(uint8_t msgid) {
+	for (uint8_t i = 0; i < DIM(mavlinkHandlers); i++) {
+		uint8_t id = pgm_read_byte(&mavlinkHandlers[i].msgid);
+		if (id == msgid)
+			return i;
+		if (id > msgid)
+			break;
 	}
+	return DIM(mavlinkHandlers);
+}
 
+static void MAVLINK_handle(const MavlinkRxFrame_t* frame) {
+	MavlinkHandler handler = (MavlinkHandler)pgm_read_adr(&mavlinkHandlers[frame->handler].handler);
+	if (mav_heartbeat < 0)
+		mav_heartbeat = 0;
+	handler((const mavlink_message_t*)frame);
+	mavlink_stats.messages++;
+}
+
+//! \brief Gives the received messages to their handler
+static void MAVLINK_dispatch() {
+	for (uint8_t i = 0; i < MAVLINK_RX_OWN_FRAMES; i++) {
+		if (mavlinkRxOwnPending[i]) {
+			MAVLINK_handle(&mavlinkRxOwnFrames[i]);
+			mavlinkRxOwnPending[i] = 0;
+		}
+	}
+	while (mavlinkRxTail != mavlinkRxHead) {
+		MAVLINK_handle(&mavlinkRxFrames[mavlinkRxTail]);
+		mavlinkRxTail = (mavlinkRxTail + 1) & (MAVLINK_RX_FRAMES - 1);
+	}
 }
 
 
 /*!	\brief Mavlink message parser
- *	\details Parses the characters in to a mavlink message.
- *	Case statement parses each character as it is recieved.
+ *	\details Parses the characters in to the receive buffer.
+ *	Case statement parses each character as it is recieved. The messages
+ *	which are not in the dispatch table are skipped right after their id.
  *	\attention One big change form the 0.9 to 1.0 version is the
- *	MAVLINK_CRC_EXTRA. This requires the mavlink_message_crcs array of 256 bytes.
+ *	MAVLINK_CRC_EXTRA. It is taken from the dispatch table.
  *	\todo create dot for the statemachine
  */
 static void MAVLINK_parse_char(uint8_t c) {
 
-	static mavlink_message_t m_mavlink_message;
 	//! The currently decoded message
-	static mavlink_message_t* p_rxmsg = &m_mavlink_message;
+	MavlinkRxFrame_t* p_rxmsg = mavlinkRxFrame;
 	//! The current decode status
 	mavlink_status_t* p_status = mavlink_get_channel_status(MAVLINK_COMM_0);
 
+	mavlink_stats.bytes++;
 
-#if MAVLINK_CRC_EXTRA
-	static const uint8_t mavlink_message_crcs[256] PROGMEM = MAVLINK_MESSAGE_CRCS;
-#define MAVLINK_MESSAGE_CRC(msgid) mavlink_message_crcs[msgid]
-#endif
-
-	// Initializes only once, values keep unchanged after first initialization
-	//mavlink_parse_state_initialize(p_status);
-
-	//p_status->msg_received = 0;
+	if (mavlinkRxSkip) {
+		// Payload or checksum of a dropped message
+		mavlinkRxSkip--;
+		return;
+	}
 
 	switch (p_status->parse_state) {
 	case MAVLINK_PARSE_STATE_UNINIT:
 	case MAVLINK_PARSE_STATE_IDLE:
 		if (c == MAVLINK_STX) {
 			p_status->parse_state = MAVLINK_PARSE_STATE_GOT_STX;
-			mavlink_start_checksum(p_rxmsg);
+			mavlinkRxFrame = p_rxmsg = &mavlinkRxFrames[mavlinkRxHead];
+			crc_init(&p_rxmsg->checksum);
 		}
 		break;
 
@@ -489,41 +549,57 @@ static void MAVLINK_parse_char(uint8_t c) {
 		// NOT counting STX, LENGTH, SEQ, SYSID, COMPID, MSGID, CRC1 and CRC2
 		p_rxmsg->len = c;
 		p_status->packet_idx = 0;
-		mavlink_update_checksum(p_rxmsg, c);
+		crc_accumulate(c, &p_rxmsg->checksum);
 		p_status->parse_state = MAVLINK_PARSE_STATE_GOT_LENGTH;
 		break;
 
 	case MAVLINK_PARSE_STATE_GOT_LENGTH:
 		p_rxmsg->seq = c;
-		mavlink_update_checksum(p_rxmsg, c);
+		crc_accumulate(c, &p_rxmsg->checksum);
 		p_status->parse_state = MAVLINK_PARSE_STATE_GOT_SEQ;
 		break;
 
 	case MAVLINK_PARSE_STATE_GOT_SEQ:
 		p_rxmsg->sysid = c;
-		mavlink_update_checksum(p_rxmsg, c);
+		crc_accumulate(c, &p_rxmsg->checksum);
 		p_status->parse_state = MAVLINK_PARSE_STATE_GOT_SYSID;
 		break;
 
 	case MAVLINK_PARSE_STATE_GOT_SYSID:
 		p_rxmsg->compid = c;
-		mavlink_update_checksum(p_rxmsg, c);
+		crc_accumulate(c, &p_rxmsg->checksum);
 		p_status->parse_state = MAVLINK_PARSE_STATE_GOT_COMPID;
 		break;
 
 	case MAVLINK_PARSE_STATE_GOT_COMPID:
 		p_rxmsg->msgid = c;
-		mavlink_update_checksum(p_rxmsg, c);
-		if (p_rxmsg->len == 0) {
-			p_status->parse_state = MAVLINK_PARSE_STATE_GOT_PAYLOAD;
+		p_rxmsg->handler = MAVLINK_find_handler(c);
+		if (p_rxmsg->handler >= DIM(mavlinkHandlers) || p_rxmsg->len != pgm_read_byte(&mavlinkHandlers[p_rxmsg->handler].len)) {
+			// Not subscribed (or not the expected length), the rest is skipped
+			mavlinkRxSkip = p_rxmsg->len + MAVLINK_NUM_CHECKSUM_BYTES;
+			mavlink_stats.dropped++;
+			p_status->parse_state = MAVLINK_PARSE_STATE_IDLE;
 		} else {
-			p_status->parse_state = MAVLINK_PARSE_STATE_GOT_MSGID;
+			crc_accumulate(c, &p_rxmsg->checksum);
+			uint8_t own = pgm_read_byte(&mavlinkHandlers[p_rxmsg->handler].frame);
+			if (own && !mavlinkRxOwnPending[own - 1]) {
+				// Received in its own frame, the header is moved there
+				MavlinkRxFrame_t* frame = &mavlinkRxOwnFrames[own - 1];
+				memcpy(frame, p_rxmsg, offsetof(MavlinkRxFrame_t, payload64));
+				frame->handler = p_rxmsg->handler;
+				mavlinkRxFrame = p_rxmsg = frame;
+			}
+			if (p_rxmsg->len == 0) {
+				p_status->parse_state = MAVLINK_PARSE_STATE_GOT_PAYLOAD;
+			} else {
+				p_status->parse_state = MAVLINK_PARSE_STATE_GOT_MSGID;
+			}
 		}
 		break;
 
 	case MAVLINK_PARSE_STATE_GOT_MSGID:
 		_MAV_PAYLOAD_NON_CONST(p_rxmsg)[p_status->packet_idx++] = (char) c;
-		mavlink_update_checksum(p_rxmsg, c);
+		crc_accumulate(c, &p_rxmsg->checksum);
 		if (p_status->packet_idx == p_rxmsg->len) {
 			p_status->parse_state = MAVLINK_PARSE_STATE_GOT_PAYLOAD;
 		}
@@ -532,7 +608,7 @@ static void MAVLINK_parse_char(uint8_t c) {
 	case MAVLINK_PARSE_STATE_GOT_PAYLOAD:
 
 #if MAVLINK_CRC_EXTRA
-		mavlink_update_checksum(p_rxmsg, pgm_read_byte(&(mavlink_message_crcs[p_rxmsg->msgid])));
+		crc_accumulate(pgm_read_byte(&mavlinkHandlers[p_rxmsg->handler].crc_extra), &p_rxmsg->checksum);
 #endif
 		if (c != (p_rxmsg->checksum & 0xFF)) {
 			// Check first checksum byte
@@ -547,23 +623,29 @@ static void MAVLINK_parse_char(uint8_t c) {
 			// Check second checksum byte
 			p_status->parse_error = 4;
 		} else {
-			// Successfully got message
-			if (mav_heartbeat < 0)
-				mav_heartbeat = 0;
+			// Successfully got message, it will be handled by telemetryWakeup()
 			p_status->current_rx_seq = p_rxmsg->seq;
-			//p_status->msg_received = 1;
 			p_status->parse_state = MAVLINK_PARSE_STATE_IDLE;
-			//memcpy(r_message, p_rxmsg, sizeof(mavlink_message_t));
-			handleMessage(p_rxmsg);
+			uint8_t next = (mavlinkRxHead + 1) & (MAVLINK_RX_FRAMES - 1);
+			if (p_rxmsg != &mavlinkRxFrames[mavlinkRxHead]) {
+				mavlinkRxOwnPending[p_rxmsg - mavlinkRxOwnFrames] = 1;
+			} else if (next == mavlinkRxTail) {
+				// No free frame, this one will be overwritten
+				mavlink_stats.overruns++;
+			} else {
+				mavlinkRxHead = next;
+			}
 		}
 		break;
 	}
 	// Error occur
 	if (p_status->parse_error) {
+		mavlink_stats.errors++;
 		p_status->parse_state = MAVLINK_PARSE_STATE_IDLE;
 		if (c == MAVLINK_STX) {
 			p_status->parse_state = MAVLINK_PARSE_STATE_GOT_STX;
-			mavlink_start_checksum(p_rxmsg);
+			mavlinkRxFrame = p_rxmsg = &mavlinkRxFrames[mavlinkRxHead];
+			crc_init(&p_rxmsg->checksum);
 		}
 		p_status->parse_error = 0;
 
@@ -713,10 +795,13 @@ static inline void MAVLINK_msg_set_mode_send(uint8_t mode) {
 }
 #endif
 /*!	\brief Telemetry monitoring, calls \link MAVLINK10mspoll.
+ *	\details The messages received since the last call are handled first.
  *	\todo Reimplemnt \link MAVLINK10mspoll
  *
  */
 void telemetryWakeup() {
+	MAVLINK_dispatch();
+
 	uint16_t tmr10ms = get_tmr10ms();
 	uint8_t count = tmr10ms & 0x0f; // 15*10ms
 	if (!count) {
@@ -215,6 +215,33 @@ typedef struct Telemetry_Data_ {
 // Telemetry data hold
 extern Telemetry_Data_t telemetry_data;
 
+/*!	\brief Received message handler
+ *	\details The message is a view of the receive buffer, the fields are read
+ *	in place with the mavlink_msg_xxx_get functions. It is only valid until the
+ *	handler returns.
+ */
+typedef void (*MavlinkHandler)(const mavlink_message_t* msg);
+
+//! \brief Dispatch table entry, the messages which are not in the table are dropped
+typedef struct MavlinkDispatch_ {
+	uint8_t msgid;
+	uint8_t len; ///< Payload length, the messages with another length are dropped
+	uint8_t crc_extra;
+	uint8_t frame; ///< Own receive frame (from 1), 0 when received in the ring
+	MavlinkHandler handler;
+} MavlinkDispatch_t;
+
+//! \brief Receive counters
+typedef struct MavlinkStats_ {
+	uint32_t bytes; ///< Bytes received
+	uint16_t messages; ///< Messages given to their handler
+	uint16_t dropped; ///< Messages skipped without being stored nor checked
+	uint16_t errors; ///< Messages with a wrong checksum
+	uint16_t overruns; ///< Messages lost because the receive buffer was full
+} MavlinkStats_t;
+
+extern MavlinkStats_t mavlink_stats;
+
 /*
  * Funtion definitions
  */
@@ -239,6 +266,8 @@ extern inline uint8_t MAVLINK_Action2CtrlMode(uint8_t action) {
 #endif
 void telemetryWakeup();
 void MAVLINK_Init(void);
+void MAVLINK_reset(uint8_t warm_reset);
+void MAVLINK_rxhandler(uint8_t byte);
 void menuTelemetryMavlink(uint8_t event);
 void MAVLINK10mspoll(uint16_t time);
 
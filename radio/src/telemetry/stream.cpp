@@ -0,0 +1,469 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include "../opentx.h"
+
+#if defined(SIMU)
+
+TelemetryStream telemetryStream;
+OS_MutexID telemetryStreamMutex = PTHREAD_MUTEX_INITIALIZER;
+
+#define STREAM_FRAME_SIZE          32   // the largest frame once stuffed
+#define STREAM_CAPTURE_CHUNK_SIZE  64   // the largest chunk of a capture sent at once
+
+void TelemetryStream::init(uint8_t protocol)
+{
+  free(capture);
+  free(captureTimes);
+  memclear(this, sizeof(TelemetryStream));
+  this->protocol = protocol;
+  speed = 100;
+  byteTime = 10 * 1000000 / (protocol == PROTOCOL_FRSKY_SPORT ? FRSKY_SPORT_BAUDRATE : FRSKY_D_BAUDRATE);
+  random = 1;
+  resetStats();
+}
+
+bool TelemetryStream::addSensor(uint16_t id, uint8_t physicalId, uint16_t period, int32_t value, int32_t step)
+{
+  if (sensorsCount >= TELEMETRY_STREAM_MAX_SENSORS || period == 0) {
+    return false;
+  }
+
+  TelemetryStreamSensor & sensor = sensors[sensorsCount++];
+  memclear(&sensor, sizeof(sensor));
+  sensor.id = id;
+  sensor.physicalId = physicalId;
+  sensor.period = period;
+  sensor.value = value;
+  sensor.step = step;
+  sensor.next = now;
+  sensor.index = -1;
+  return true;
+}
+
+void TelemetryStream::setLoss(uint32_t pattern, uint8_t percent)
+{
+  lossPattern = pattern;
+  lossPercent = percent;
+  lossIndex = 0;
+}
+
+bool TelemetryStream::loadCapture(const char * path, bool loop)
+{
+  FILE * f = fopen(path, "rb");
+  if (!f) {
+    return false;
+  }
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char * text = (char *)malloc(size + 1);
+  size = fread(text, 1, size, f);
+  text[size] = '\0';
+  fclose(f);
+
+  free(capture);
+  free(captureTimes);
+  capture = (uint8_t *)malloc(size + 1);
+  captureTimes = (uint32_t *)malloc((size + 1) * sizeof(uint32_t));
+  captureSize = 0;
+  capturePos = 0;
+  captureStart = now;
+  captureLoop = loop;
+
+  int year, month, day, hour, min, sec, ms, len;
+  const char * line = text;
+  while (*line == '\r' || *line == '\n') {
+    line++;
+  }
+
+  if (sscanf(line, "%d-%d-%d,%d:%d:%d.%d:%n", &year, &month, &day, &hour, &min, &sec, &ms, &len) == 7) {
+    // SPORT_FILE_LOG, each line gives the time of its bytes
+    int32_t first = -1;
+    while (*line) {
+      if (sscanf(line, "%d-%d-%d,%d:%d:%d.%d:%n", &year, &month, &day, &hour, &min, &sec, &ms, &len) == 7) {
+        int32_t time = ((hour * 60 + min) * 60 + sec) * 1000 + ms;
+        if (first < 0) {
+          first = time;
+        }
+        time -= first;
+        if (time < 0) {
+          time += 24 * 60 * 60 * 1000; // midnight
+        }
+        const char * data = line + len;
+        unsigned int byte;
+        int count;
+        while (sscanf(data, " %2x%n", &byte, &count) == 1) {
+          captureTimes[captureSize] = time * 1000;
+          capture[captureSize++] = byte;
+          data += count;
+        }
+      }
+      line = strchr(line, '\n');
+      if (!line) {
+        break;
+      }
+      line++;
+    }
+  }
+  else {
+    // raw capture, the bytes follow each other on the line
+    for (long i=0; i<size; i++) {
+      captureTimes[captureSize] = i * byteTime;
+      capture[captureSize++] = text[i];
+    }
+  }
+
+  free(text);
+  return captureSize > 0;
+}
+
+void TelemetryStream::start(uint16_t speed)
+{
+  this->speed = speed;
+  lastWakeup = get_tmr10ms();
+  running = true;
+}
+
+void TelemetryStream::stop()
+{
+  running = false;
+}
+
+void TelemetryStream::wakeup()
+{
+  if (running) {
+    tmr10ms_t tmr = get_tmr10ms();
+    uint32_t elapsed = (tmr10ms_t)(tmr - lastWakeup) * 10000 * speed / 100;
+    lastWakeup = tmr;
+    if (elapsed > 0) {
+      step(elapsed);
+    }
+  }
+}
+
+void TelemetryStream::run(uint32_t duration, uint32_t period)
+{
+  uint32_t clock = 0;
+  for (uint32_t elapsed=0; elapsed<duration; elapsed+=period) {
+    step(period * 1000);
+    while (elapsed + period - clock >= 10) {
+      g_tmr10ms++;
+      clock += 10;
+    }
+  }
+}
+
+void TelemetryStream::resetStats()
+{
+  memclear(&stats, sizeof(stats));
+  for (int i=0; i<MAX_SENSORS; i++) {
+    itemsSequences[i] = telemetryItems[i].sequence;
+  }
+}
+
+uint32_t TelemetryStream::getParserTime() const
+{
+  if (stats.wakeups == 0)
+    return 0;
+  return stats.parserCycles * 1000000 / getCyclesFrequency() / stats.wakeups;
+}
+
+uint32_t TelemetryStream::getParserMaxTime() const
+{
+  return (uint64_t)stats.parserMaxCycles * 1000000 / getCyclesFrequency();
+}
+
+uint32_t TelemetryStream::getAverageLatency() const
+{
+  if (stats.latencyCount == 0)
+    return 0;
+  return stats.latencySum / stats.latencyCount;
+}
+
+// one wakeup of the radio: the packets due until the end of the step are sent,
+// the bytes which arrived meanwhile are pushed in the receive FIFO and parsed
+void TelemetryStream::step(uint32_t elapsed)
+{
+  uint32_t end = now + elapsed;
+
+  while (1) {
+    int next = -1;
+    for (int i=0; i<sensorsCount; i++) {
+      if ((int32_t)(end - sensors[i].next) > 0 && (next < 0 || (int32_t)(sensors[i].next - sensors[next].next) < 0)) {
+        next = i;
+      }
+    }
+    if (next < 0) {
+      break;
+    }
+    TelemetryStreamSensor & sensor = sensors[next];
+    sendSensor(next, sensor.next);
+    sensor.next += sensor.period * 1000;
+  }
+
+  now = end;
+  sendCapture();
+  receive();
+  checkItems();
+  stats.duration += elapsed;
+}
+
+bool TelemetryStream::isLost()
+{
+  bool result = lossPattern & (1 << lossIndex);
+  lossIndex = (lossIndex + 1) & 31;
+  if (!result && lossPercent > 0) {
+    random = random * 1103515245 + 12345;
+    result = ((random >> 16) % 100) < lossPercent;
+  }
+  return result;
+}
+
+static uint8_t * stuffByte(uint8_t * out, uint8_t byte)
+{
+  if (byte == START_STOP || byte == BYTESTUFF) {
+    *out++ = BYTESTUFF;
+    byte ^= STUFF_MASK;
+  }
+  *out++ = byte;
+  return out;
+}
+
+void TelemetryStream::sendSensor(uint8_t index, uint32_t time)
+{
+  TelemetryStreamSensor & sensor = sensors[index];
+  uint8_t frame[STREAM_FRAME_SIZE];
+  uint8_t * out = frame;
+
+  *out++ = START_STOP;
+  if (protocol == PROTOCOL_FRSKY_SPORT) {
+    uint8_t packet[FRSKY_SPORT_PACKET_SIZE];
+    packet[0] = sensor.physicalId;
+    packet[1] = DATA_FRAME;
+    *((uint16_t *)(packet+2)) = sensor.id;
+    *((int32_t *)(packet+4)) = sensor.value;
+    uint16_t crc = 0;
+    for (int i=1; i<FRSKY_SPORT_PACKET_SIZE-1; i++) {
+      crc += packet[i];
+      crc += crc >> 8;
+      crc &= 0x00ff;
+    }
+    packet[FRSKY_SPORT_PACKET_SIZE-1] = 0xFF - crc;
+    *out++ = packet[0];
+    for (int i=1; i<FRSKY_SPORT_PACKET_SIZE; i++) {
+      out = stuffByte(out, packet[i]);
+    }
+  }
+  else if (sensor.id >= D_RSSI_ID && sensor.id <= D_A2_ID) {
+    // A1, A2 and RSSI share the link frame
+    linkValues[sensor.id - D_RSSI_ID] = sensor.value;
+    *out++ = LINKPKT;
+    out = stuffByte(out, linkValues[1]);
+    out = stuffByte(out, linkValues[2]);
+    out = stuffByte(out, linkValues[0]);
+    out = stuffByte(out, linkValues[0]);
+    for (int i=0; i<4; i++) {
+      *out++ = 0;
+    }
+    *out++ = START_STOP;
+  }
+  else {
+    // a hub value in a user frame
+    uint8_t hub[6];
+    uint8_t len = 0;
+    hub[len++] = 0x5E;
+    hub[len++] = sensor.id;
+    for (int i=0; i<2; i++) {
+      uint8_t byte = sensor.value >> (8 * i);
+      if (byte == 0x5E || byte == 0x5D) {
+        hub[len++] = 0x5D;
+        byte ^= 0x60;
+      }
+      hub[len++] = byte;
+    }
+    *out++ = USRPKT;
+    *out++ = len;
+    *out++ = 0;
+    for (int i=0; i<len; i++) {
+      out = stuffByte(out, hub[i]);
+    }
+    *out++ = START_STOP;
+  }
+
+  sensor.value += sensor.step;
+
+  if (isLost()) {
+    stats.lost++;
+  }
+  else if (send(frame, out - frame, index, time)) {
+    stats.packets++;
+  }
+  else {
+    stats.saturated++;
+  }
+}
+
+void TelemetryStream::sendCapture()
+{
+  while (capturePos < captureSize) {
+    uint32_t time = captureStart + captureTimes[capturePos];
+    if ((int32_t)(now - time) < 0) {
+      return;
+    }
+    uint32_t count = 1;
+    while (count < STREAM_CAPTURE_CHUNK_SIZE && capturePos + count < captureSize && (int32_t)(now - captureStart - captureTimes[capturePos + count]) >= 0) {
+      count++;
+    }
+    if (!send(&capture[capturePos], count, TELEMETRY_STREAM_CAPTURE, time)) {
+      // the line is full, the capture waits
+      return;
+    }
+    capturePos += count;
+    if (capturePos == captureSize && captureLoop) {
+      capturePos = 0;
+      captureStart = now + byteTime;
+    }
+  }
+}
+
+bool TelemetryStream::send(const uint8_t * data, uint32_t len, uint8_t sensor, uint32_t time)
+{
+  if (lineIn - lineOut + len > TELEMETRY_STREAM_LINE_SIZE || (sensor != TELEMETRY_STREAM_CAPTURE && packetsIn - packetsOut >= TELEMETRY_STREAM_PACKETS)) {
+    return false;
+  }
+
+  uint32_t arrival = ((int32_t)(lineFree - time) > 0 ? lineFree : time);
+  for (uint32_t i=0; i<len; i++) {
+    arrival += byteTime;
+    line[lineIn % TELEMETRY_STREAM_LINE_SIZE] = data[i];
+    lineTimes[lineIn % TELEMETRY_STREAM_LINE_SIZE] = arrival;
+    lineIn++;
+  }
+  lineFree = arrival;
+
+  if (sensor != TELEMETRY_STREAM_CAPTURE) {
+    packets[packetsIn % TELEMETRY_STREAM_PACKETS].sensor = sensor;
+    packets[packetsIn % TELEMETRY_STREAM_PACKETS].end = lineIn;
+    packets[packetsIn % TELEMETRY_STREAM_PACKETS].time = time;
+    packetsIn++;
+  }
+
+  return true;
+}
+
+void TelemetryStream::receive()
+{
+  // the bytes which don't fit in the FIFO are lost, as in the driver
+  uint8_t fifo[TELEMETRY_STREAM_FIFO_SIZE - 1];
+  uint32_t count = 0;
+  while (lineOut != lineIn && (int32_t)(now - lineTimes[lineOut % TELEMETRY_STREAM_LINE_SIZE]) >= 0) {
+    if (count < sizeof(fifo))
+      fifo[count++] = line[lineOut % TELEMETRY_STREAM_LINE_SIZE];
+    else
+      stats.overruns++;
+    lineOut++;
+  }
+
+  while (packetsOut != packetsIn && (int32_t)(lineOut - packets[packetsOut % TELEMETRY_STREAM_PACKETS].end) >= 0) {
+    TelemetryStreamSensor & sensor = sensors[packets[packetsOut % TELEMETRY_STREAM_PACKETS].sensor];
+    if (!sensor.pending) {
+      sensor.pending = 1;
+      sensor.pendingTime = packets[packetsOut % TELEMETRY_STREAM_PACKETS].time;
+    }
+    packetsOut++;
+  }
+
+  if (count > 0) {
+    // same chunks as telemetryWakeup()
+    uint32_t start = getCycles();
+    for (uint32_t i=0; i<count; i+=TELEMETRY_RX_CHUNK_SIZE) {
+      processSerialBuffer(&fifo[i], min<uint32_t>(TELEMETRY_RX_CHUNK_SIZE, count-i));
+    }
+    uint32_t cycles = getCycles() - start;
+    stats.parserCycles += cycles;
+    if (cycles > stats.parserMaxCycles) {
+      stats.parserMaxCycles = cycles;
+    }
+    stats.bytes += count;
+  }
+  stats.wakeups++;
+}
+
+// the latency of a sensor goes from its oldest packet received to the update of its telemetry item,
+// a packet lost on the way delays the update until the next one
+void TelemetryStream::checkItems()
+{
+  for (int i=0; i<MAX_SENSORS; i++) {
+    stats.updates += (uint8_t)(telemetryItems[i].sequence - itemsSequences[i]);
+    itemsSequences[i] = telemetryItems[i].sequence;
+  }
+
+  for (int i=0; i<sensorsCount; i++) {
+    TelemetryStreamSensor & sensor = sensors[i];
+    if (!sensor.pending) {
+      continue;
+    }
+    bool updated = false;
+    if (sensor.index < 0) {
+      uint8_t instance = (protocol == PROTOCOL_FRSKY_SPORT ? (sensor.physicalId & 0x1F) + 1 : 0);
+      for (int index=0; index<MAX_SENSORS; index++) {
+        TelemetrySensor & telemetrySensor = g_model.telemetrySensors[index];
+        if (telemetrySensor.type == TELEM_TYPE_CUSTOM && telemetrySensor.id == sensor.id && telemetrySensor.instance == instance && isTelemetryFieldAvailable(index)) {
+          sensor.index = index;
+          updated = true;
+          break;
+        }
+      }
+    }
+    else {
+      updated = (telemetryItems[sensor.index].sequence != sensor.sequence);
+    }
+    if (updated) {
+      uint32_t latency = now - sensor.pendingTime;
+      stats.latencyCount++;
+      stats.latencySum += latency;
+      if (latency > stats.latencyMax) {
+        stats.latencyMax = latency;
+      }
+      sensor.sequence = telemetryItems[sensor.index].sequence;
+      sensor.pending = 0;
+    }
+  }
+}
+
+#endif // SIMU
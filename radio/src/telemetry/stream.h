@@ -0,0 +1,168 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#ifndef _TELEMETRY_STREAM_H_
+#define _TELEMETRY_STREAM_H_
+
+#include <inttypes.h>
+
+// Telemetry stream engine of the simulator: it synthesises the byte stream of
+// many sensors (or replays a capture) on a virtual serial line and feeds it to
+// the telemetry parser, the same way the radio receive FIFO does
+
+#define TELEMETRY_STREAM_MAX_SENSORS  64
+#define TELEMETRY_STREAM_LINE_SIZE    2048  // bytes sent but not yet received
+#define TELEMETRY_STREAM_PACKETS      256   // packets sent but not yet received
+#define TELEMETRY_STREAM_FIFO_SIZE    512   // the radio receive FIFO
+#define TELEMETRY_STREAM_CAPTURE      255   // the sensor of the replayed bytes
+
+struct TelemetryStreamSensor {
+  uint16_t id;
+  uint8_t  physicalId;           // S.PORT only
+  uint16_t period;               // ms
+  int32_t  value;
+  int32_t  step;                 // added to the value at each packet
+  uint32_t next;                 // time of the next packet
+  int8_t   index;                // the telemetry item once the radio discovered the sensor
+  uint8_t  sequence;             // the last sequence seen on this item
+  uint8_t  pending;              // received packets not seen on the item yet
+  uint32_t pendingTime;          // time the oldest of these packets was sent
+};
+
+struct TelemetryStreamStats {
+  uint64_t duration;             // us of stream
+  uint32_t packets;              // packets sent on the line
+  uint32_t lost;                 // packets dropped by the loss pattern
+  uint32_t saturated;            // packets which didn't fit on the line
+  uint32_t bytes;                // bytes received by the radio
+  uint32_t overruns;             // bytes lost because the receive FIFO was full
+  uint32_t wakeups;
+  uint64_t parserCycles;
+  uint32_t parserMaxCycles;      // the longest wakeup
+  uint32_t updates;              // telemetry items updates
+  uint32_t latencyCount;
+  uint64_t latencySum;           // us, from the packet sent to the item updated
+  uint32_t latencyMax;
+};
+
+class TelemetryStream
+{
+  public:
+    void init(uint8_t protocol);
+
+    // sensors synthesised at a fixed period, their value moves by step each packet
+    bool addSensor(uint16_t id, uint8_t physicalId, uint16_t period, int32_t value, int32_t step=0);
+
+    // each bit of pattern drops one packet (bit 0 first, the pattern repeats every 32 packets),
+    // and percent of the remaining ones are dropped at random
+    void setLoss(uint32_t pattern, uint8_t percent=0);
+
+    // a capture written by SPORT_FILE_LOG ("date,time: 7E 98 10 ..." lines) or a raw binary capture,
+    // it shares the line with the sensors and is replayed at its own pace, in a loop if asked
+    bool loadCapture(const char * path, bool loop=false);
+
+    // in the simulator, called by the main loop before telemetryWakeup(),
+    // the stream moves by the elapsed time multiplied by speed
+    void start(uint16_t speed=100 /*percent*/);
+    void stop();
+    bool isRunning() const { return running; }
+    void wakeup();
+
+    // faster than real time: the radio clock is moved by the stream, the parser is called each period
+    void run(uint32_t duration /*ms*/, uint32_t period=10 /*ms*/);
+
+    const TelemetryStreamStats & getStats() const { return stats; }
+    void resetStats();
+    uint32_t getParserTime() const;        // average parser time in us per wakeup
+    uint32_t getParserMaxTime() const;
+    uint32_t getAverageLatency() const;    // us
+
+  protected:
+    void step(uint32_t elapsed /*us*/);
+    bool isLost();
+    void sendSensor(uint8_t index, uint32_t time);
+    void sendCapture();
+    bool send(const uint8_t * data, uint32_t len, uint8_t sensor, uint32_t time);
+    void receive();
+    void checkItems();
+
+    uint8_t  protocol;
+    bool     running;
+    uint16_t speed;
+    tmr10ms_t lastWakeup;
+    uint32_t now;                          // us
+    uint32_t byteTime;                     // us
+    uint32_t lineFree;                     // time the line has sent everything
+
+    TelemetryStreamSensor sensors[TELEMETRY_STREAM_MAX_SENSORS];
+    uint8_t  sensorsCount;
+    int32_t  linkValues[3];                // FrSky D A1, A2, RSSI
+
+    uint32_t lossPattern;
+    uint8_t  lossPercent;
+    uint8_t  lossIndex;
+    uint32_t random;
+
+    // the positions are counters, the buffers index is their modulo
+    uint8_t  line[TELEMETRY_STREAM_LINE_SIZE];
+    uint32_t lineTimes[TELEMETRY_STREAM_LINE_SIZE];   // arrival of each byte
+    uint32_t lineIn;
+    uint32_t lineOut;
+    struct {
+      uint8_t  sensor;
+      uint32_t end;                        // line position after the last byte
+      uint32_t time;
+    } packets[TELEMETRY_STREAM_PACKETS];
+    uint32_t packetsIn;
+    uint32_t packetsOut;
+
+    uint8_t * capture;
+    uint32_t * captureTimes;               // relative to the capture start, in us
+    uint32_t captureSize;
+    uint32_t capturePos;
+    uint32_t captureStart;
+    bool     captureLoop;
+
+    uint8_t  itemsSequences[MAX_SENSORS];
+    TelemetryStreamStats stats;
+};
+
+extern TelemetryStream telemetryStream;
+// held by the main loop around wakeup(), and by the other threads driving the stream
+extern OS_MutexID telemetryStreamMutex;
+
+#endif // _TELEMETRY_STREAM_H_
@@ -19,6 +19,8 @@ void TelemetryItem::setValue(const TelemetrySensor & sensor, int32_t val, uint32
 {
   int32_t newVal = val;
 
+  sequence++;
+
   if (unit == UNIT_CELLS) {
     uint32_t data = uint32_t(newVal);
     uint8_t cellsCount = (data >> 24);
@@ -185,7 +187,11 @@ void TelemetryItem::setValue(const TelemetrySensor & sensor, int32_t val, uint32
     }
   }
   else {
+#if defined(TELEMETRY_CONVERSIONS_CACHE)
+    newVal = sensor.getValue(newVal, unit, prec, &conversion);
+#else
     newVal = sensor.getValue(newVal, unit, prec);
+#endif
     if (sensor.autoOffset) {
       if (!isAvailable()) {
         std.offsetAuto = -newVal;
@@ -258,6 +264,25 @@ bool TelemetryItem::isOld()
   return (lastReceived == TELEMETRY_VALUE_OLD);
 }
 
+#define MAX_CALC_SOURCES 4
+
+#if defined(TELEMETRY_CONVERSIONS_CACHE)
+// The unit conversions done by the calculated sensors, one per source, are
+// cached per sensor. They are cleared when the sensors config changes
+TelemetryConversion calcSensorsConversions[MAX_SENSORS][MAX_CALC_SOURCES];
+#endif
+
+int32_t TelemetryItem::convertSourceValue(uint8_t slot, int32_t value, uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec)
+{
+#if defined(TELEMETRY_CONVERSIONS_CACHE)
+  TelemetryConversion & conversion = calcSensorsConversions[this - telemetryItems][slot];
+  conversion.update(unit, prec, destUnit, destPrec);
+  return conversion.apply(value);
+#else
+  return convertTelemetryValue(value, unit, prec, destUnit, destPrec);
+#endif
+}
+
 void TelemetryItem::per10ms(const TelemetrySensor & sensor)
 {
   switch (sensor.formula) {
@@ -269,10 +294,10 @@ void TelemetryItem::per10ms(const TelemetrySensor & sensor)
           return;
         }
         else if (currentItem.isOld()) {
-          lastReceived = TELEMETRY_VALUE_OLD;
+          setOld();
           return;
         }
-        int32_t current = convertTelemetryValue(currentItem.value, currentSensor.unit, currentSensor.prec, UNIT_AMPS, 1);
+        int32_t current = convertSourceValue(0, currentItem.value, currentSensor.unit, currentSensor.prec, UNIT_AMPS, 1);
         currentItem.consumption.prescale += current;
         if (currentItem.consumption.prescale >= 3600) {
           currentItem.consumption.prescale -= 3600;
@@ -294,7 +319,7 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
       if (sensor.cell.source) {
         TelemetryItem & cellsItem = telemetryItems[sensor.cell.source-1];
         if (cellsItem.isOld()) {
-          lastReceived = TELEMETRY_VALUE_OLD;
+          setOld();
         }
         else {
           unsigned int index = sensor.cell.index;
@@ -337,13 +362,13 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
 
     case TELEM_FORMULA_DIST:
       if (sensor.dist.gps) {
-        TelemetryItem gpsItem = telemetryItems[sensor.dist.gps-1];
+        TelemetryItem & gpsItem = telemetryItems[sensor.dist.gps-1];
         TelemetryItem * altItem = NULL;
         if (!gpsItem.isAvailable()) {
           return;
         }
         else if (gpsItem.isOld()) {
-          lastReceived = TELEMETRY_VALUE_OLD;
+          setOld();
           return;
         }
         if (sensor.dist.alt) {
@@ -352,7 +377,7 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
             return;
           }
           else if (altItem->isOld()) {
-            lastReceived = TELEMETRY_VALUE_OLD;
+            setOld();
             return;
           }
         }
@@ -406,7 +431,7 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
               return;
             }
             else if (telemetryItem.isOld()) {
-              lastReceived = TELEMETRY_VALUE_OLD;
+              setOld();
               return;
             }
           }
@@ -416,10 +441,10 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
           count += 1;
           if (sensor.formula == TELEM_FORMULA_MULTIPLY) {
             mulprec += telemetrySensor.prec;
-            value *= convertTelemetryValue(sensorValue, telemetrySensor.unit, 0, sensor.unit, 0);
+            value *= convertSourceValue(i, sensorValue, telemetrySensor.unit, 0, sensor.unit, 0);
           }
           else {
-            sensorValue = convertTelemetryValue(sensorValue, telemetrySensor.unit, telemetrySensor.prec, sensor.unit, sensor.prec);
+            sensorValue = convertSourceValue(i, sensorValue, telemetrySensor.unit, telemetrySensor.prec, sensor.unit, sensor.prec);
             if (sensor.formula == TELEM_FORMULA_MIN)
               value = (count==1 ? sensorValue : min<int32_t>(value, sensorValue));
             else if (sensor.formula == TELEM_FORMULA_MAX)
@@ -432,7 +457,7 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
       if (sensor.formula == TELEM_FORMULA_AVERAGE) {
         if (count == 0) {
           if (available)
-            lastReceived = TELEMETRY_VALUE_OLD;
+            setOld();
           return;
         }
         else {
@@ -442,7 +467,7 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
       else if (sensor.formula == TELEM_FORMULA_MULTIPLY) {
         if (count == 0)
           return;
-        value = convertTelemetryValue(value, sensor.unit, mulprec, sensor.unit, sensor.prec);
+        value = convertSourceValue(2, value, sensor.unit, mulprec, sensor.unit, sensor.prec);
       }
       setValue(sensor, value, sensor.unit, sensor.prec);
       break;
@@ -453,10 +478,140 @@ void TelemetryItem::eval(const TelemetrySensor & sensor)
   }
 }
 
+// Calculated sensors are only evaluated when one of their sources was
+// updated since their last evaluation. They are evaluated in an order where
+// the calculated sensors used as sources come first, so that a whole chain
+// of calculated sensors is updated in one pass.
+bool telemetrySensorsDirty = true;
+uint8_t calcSensorsSources[MAX_SENSORS][MAX_CALC_SOURCES];
+uint8_t calcSensorsSequences[MAX_SENSORS][MAX_CALC_SOURCES];
+uint8_t calcSensorsOrder[MAX_SENSORS];
+uint8_t calcSensorsCount = 0;
+
+void getCalculatedSensorSources(const TelemetrySensor & sensor, uint8_t * sources)
+{
+  memclear(sources, MAX_CALC_SOURCES);
+
+  if (sensor.type != TELEM_TYPE_CALCULATED)
+    return;
+
+  switch (sensor.formula) {
+    case TELEM_FORMULA_CELL:
+      sources[0] = sensor.cell.source;
+      break;
+
+    case TELEM_FORMULA_DIST:
+      sources[0] = sensor.dist.gps;
+      sources[1] = sensor.dist.alt;
+      break;
+
+    case TELEM_FORMULA_ADD:
+    case TELEM_FORMULA_AVERAGE:
+    case TELEM_FORMULA_MIN:
+    case TELEM_FORMULA_MAX:
+    case TELEM_FORMULA_MULTIPLY:
+      for (int i=0; i<(sensor.formula == TELEM_FORMULA_MULTIPLY ? 2 : MAX_CALC_SOURCES); i++) {
+        sources[i] = abs(sensor.calc.sources[i]);
+      }
+      break;
+
+    default:
+      // TOTALIZE and CONSUMPTION are not evaluated in eval()
+      break;
+  }
+}
+
+bool isCalculatedSensorEvaluated(int index)
+{
+  for (int i=0; i<MAX_CALC_SOURCES; i++) {
+    if (calcSensorsSources[index][i])
+      return true;
+  }
+  return false;
+}
+
+void buildCalculatedSensorsOrder()
+{
+  uint32_t placed = 0;
+  uint32_t evaluated = 0;
+
+  calcSensorsCount = 0;
+#if defined(TELEMETRY_CONVERSIONS_CACHE)
+  memclear(calcSensorsConversions, sizeof(calcSensorsConversions));
+#endif
+
+  for (int i=0; i<MAX_SENSORS; i++) {
+    getCalculatedSensorSources(g_model.telemetrySensors[i], calcSensorsSources[i]);
+    if (isCalculatedSensorEvaluated(i))
+      evaluated |= ((uint32_t)1 << i);
+  }
+
+  // a sensor is placed once all the evaluated sensors it uses are placed
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    for (int i=0; i<MAX_SENSORS; i++) {
+      if ((evaluated & ((uint32_t)1 << i)) && !(placed & ((uint32_t)1 << i))) {
+        bool ready = true;
+        for (int j=0; j<MAX_CALC_SOURCES; j++) {
+          uint8_t source = calcSensorsSources[i][j];
+          if (source && source-1 != i && (evaluated & ((uint32_t)1 << (source-1))) && !(placed & ((uint32_t)1 << (source-1)))) {
+            ready = false;
+            break;
+          }
+        }
+        if (ready) {
+          calcSensorsOrder[calcSensorsCount++] = i;
+          placed |= ((uint32_t)1 << i);
+          progress = true;
+        }
+      }
+    }
+  }
+
+  // sensors in a loop are evaluated last, one step of the loop per pass
+  for (int i=0; i<MAX_SENSORS; i++) {
+    if ((evaluated & ((uint32_t)1 << i)) && !(placed & ((uint32_t)1 << i))) {
+      calcSensorsOrder[calcSensorsCount++] = i;
+    }
+  }
+}
+
+void evalCalculatedSensors()
+{
+  bool force = false;
+
+  if (telemetrySensorsDirty) {
+    telemetrySensorsDirty = false;
+    buildCalculatedSensorsOrder();
+    force = true;
+  }
+
+  for (int k=0; k<calcSensorsCount; k++) {
+    uint8_t index = calcSensorsOrder[k];
+    uint8_t * sources = calcSensorsSources[index];
+    uint8_t * sequences = calcSensorsSequences[index];
+    bool updated = force;
+    for (int i=0; i<MAX_CALC_SOURCES; i++) {
+      if (sources[i]) {
+        uint8_t sequence = telemetryItems[sources[i]-1].sequence;
+        if (sequence != sequences[i]) {
+          sequences[i] = sequence;
+          updated = true;
+        }
+      }
+    }
+    if (updated) {
+      telemetryItems[index].eval(g_model.telemetrySensors[index]);
+    }
+  }
+}
+
 void delTelemetryIndex(uint8_t index)
 {
   memclear(&g_model.telemetrySensors[index], sizeof(TelemetrySensor));
   telemetryItems[index].clear();
+  telemetrySensorsDirty = true;
   eeDirty(EE_MODEL);
 }
 
@@ -515,6 +670,7 @@ void setTelemetryValue(TelemetryProtocol protocol, uint16_t id, uint8_t subId, u
       default:
         return;
     }
+    telemetrySensorsDirty = true;
     telemetryItems[index].setValue(g_model.telemetrySensors[index], value, unit, prec);
   }
   else {
@@ -575,35 +731,72 @@ const UnitConversionRule unitConversionTable[] = {
   { 0, 0, 0, 0}   // termination
 };
 
-int32_t convertTelemetryValue(int32_t value, uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec)
+void TelemetryConversion::init(uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec)
 {
+  // the conversion is value * num / den (truncated), followed by the offset
+  // and divisor for the Celsius to Fahrenheit conversion
+  uint32_t num = 1;
+  uint32_t den = 1;
+
+  key = getKey(unit, prec, destUnit, destPrec);
+  offset = 0;
+  divisor = 1;
+
   for (int i=prec; i<destPrec; i++)
-    value *= 10;
+    num *= 10;
 
   if (unit == UNIT_CELSIUS) {
     if (destUnit == UNIT_FAHRENHEIT) {
       // T(°F) = T(°C)×1,8 + 32
-      value = 32 + (value*18) / 10;
+      num *= 18;
+      den *= 10;
+      offset = 32;
     }
   }
   else {
     const UnitConversionRule * p = unitConversionTable;
     while (p->divisor) {
       if (p->unitFrom == unit && p->unitTo == destUnit) {
-        value = (value * (int32_t)p->multiplier) / (int32_t)p->divisor;
+        num *= p->multiplier;
+        den *= p->divisor;
         break;
       }
       ++p;
     }
   }
-  
-  for (int i=destPrec; i<prec; i++)
-    value /= 10;
 
-  return value;
+  for (int i=destPrec; i<prec; i++) {
+    if (offset)
+      divisor *= 10;
+    else
+      den *= 10;
+  }
+
+  if (num == den) {
+    multiplier = 0;
+    shift = 0;
+  }
+  else {
+    // the largest shift keeping the multiplier on 32 bits, the result is then
+    // exact as long as value * num fits in 31 bits
+    shift = 0;
+    while (((uint64_t)num << (shift+1)) <= (uint64_t)den * 0xFFFFFFFF)
+      shift++;
+    multiplier = (((uint64_t)num << shift) + den - 1) / den;
+  }
+}
+
+int32_t convertTelemetryValue(int32_t value, uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec)
+{
+  if (unit == destUnit && prec == destPrec)
+    return value;
+
+  TelemetryConversion conversion;
+  conversion.init(unit, prec, destUnit, destPrec);
+  return conversion.apply(value);
 }
 
-int32_t TelemetrySensor::getValue(int32_t value, uint8_t unit, uint8_t prec) const
+int32_t TelemetrySensor::getValue(int32_t value, uint8_t unit, uint8_t prec, TelemetryConversion * conversion) const
 {
   if (type == TELEM_TYPE_CUSTOM && custom.ratio) {
     if (this->prec == 2) {
@@ -616,7 +809,13 @@ int32_t TelemetrySensor::getValue(int32_t value, uint8_t unit, uint8_t prec) con
     value = (custom.ratio * value + 122) / 255;
   }
 
-  value = convertTelemetryValue(value, unit, prec, this->unit, this->prec);
+  if (conversion) {
+    conversion->update(unit, prec, this->unit, this->prec);
+    value = conversion->apply(value);
+  }
+  else {
+    value = convertTelemetryValue(value, unit, prec, this->unit, this->prec);
+  }
 
   if (type == TELEM_TYPE_CUSTOM) {
     value += custom.offset;
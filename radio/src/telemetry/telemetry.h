@@ -76,6 +76,53 @@ PACK(struct CellValue
   }
 });
 
+#if defined(PCBTARANIS)
+  // the resolved conversions are kept per item and per calculated sensor source,
+  // about 2KB of RAM the smaller ARM boards don't spare
+  #define TELEMETRY_CONVERSIONS_CACHE
+#endif
+
+// A unit / precision conversion resolved once into a multiply-shift
+// (plus the Celsius to Fahrenheit offset), giving the same results as
+// the multiply / divide sequence for all values which don't overflow it
+class TelemetryConversion
+{
+  public:
+    void init(uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec);
+
+    void update(uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec)
+    {
+      if (key != getKey(unit, prec, destUnit, destPrec)) {
+        init(unit, prec, destUnit, destPrec);
+      }
+    }
+
+    int32_t apply(int32_t value) const
+    {
+      if (multiplier) {
+        uint32_t result = ((uint64_t)(value < 0 ? -(uint32_t)value : (uint32_t)value) * multiplier) >> shift;
+        value = (value < 0 ? -(int32_t)result : (int32_t)result);
+      }
+      if (offset) {
+        value = (value + offset) / divisor;
+      }
+      return value;
+    }
+
+  protected:
+    static uint32_t getKey(uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec)
+    {
+      // bit 31 set, so that a cleared conversion never matches
+      return 0x80000000 + unit + (prec << 8) + (destUnit << 16) + (destPrec << 24);
+    }
+
+    uint32_t key;
+    uint32_t multiplier;        // 0 when the value is not scaled
+    uint8_t  shift;
+    int8_t   offset;            // added after the multiply-shift (Celsius to Fahrenheit only)
+    uint16_t divisor;           // applied after the offset
+};
+
 class TelemetryItem
 {
   public:
@@ -95,6 +142,10 @@ class TelemetryItem
     };
 
     uint8_t lastReceived;       // for detection of sensor loss
+    uint8_t sequence;           // incremented each time the item is updated
+#if defined(TELEMETRY_CONVERSIONS_CACHE)
+    TelemetryConversion conversion; // from the received unit / prec to the sensor unit / prec
+#endif
 
     union {
       struct {
@@ -150,8 +201,16 @@ class TelemetryItem
 
     void clear()
     {
+      uint8_t seq = sequence;
       memset(this, 0, sizeof(*this));
       lastReceived = TELEMETRY_VALUE_UNAVAILABLE;
+      sequence = seq + 1;
+    }
+
+    void setOld()
+    {
+      lastReceived = TELEMETRY_VALUE_OLD;
+      sequence++;
     }
 
     void eval(const TelemetrySensor & sensor);
@@ -162,10 +221,14 @@ class TelemetryItem
     bool isFresh();
     bool isOld();
     void gpsReceived();
+
+  protected:
+    int32_t convertSourceValue(uint8_t slot, int32_t value, uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec);
 };
 
 extern TelemetryItem telemetryItems[MAX_SENSORS];
 extern uint8_t allowNewSensors;
+extern bool telemetrySensorsDirty; // to be set when g_model.telemetrySensors is modified
 
 inline bool isTelemetryFieldAvailable(int index)
 {
@@ -183,6 +246,7 @@ inline bool isTelemetryFieldComparisonAvailable(int index)
   return (sensor.id != 0);
 }
 
+void evalCalculatedSensors();
 void setTelemetryValue(TelemetryProtocol protocol, uint16_t id, uint8_t subId, uint8_t instance, int32_t value, uint32_t unit, uint32_t prec);
 void delTelemetryIndex(uint8_t index);
 int availableTelemetryIndex();
@@ -0,0 +1,148 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include "gtests.h"
+
+#if defined(CPUARM)
+
+// The traces below are synthetic, no hardware capture was available: they
+// stand for the 12 bits getADC() values of the Taranis after the oversampling
+// average (ADC_OVERSAMPLING scans, see adcRead()), with a few LSB of noise and one spike.
+// The filters only see these averaged values, the circular DMA buffer feeding
+// them is not exercised here.
+
+// getADC() inputs of a pot at rest, with one conversion spike
+static const uint16_t restingPot[] = {
+  2050, 2048, 2051, 2047, 2049, 2052, 2046, 2049, 2050, 2048, 2700, 2049, 2047, 2050, 2051, 2048,
+  2046, 2049, 2053, 2048, 2047, 2050, 2049, 2051, 2045, 2048, 2050, 2052, 2047, 2049, 2048, 2050,
+};
+
+// getADC() inputs of a stick moved quickly from the center to near the end
+static const uint16_t movingStick[] = {
+  2048, 2050, 2047, 2049, 2130, 2260, 2420, 2600, 2790, 2980, 3160, 3320, 3450, 3540, 3590, 3601,
+  3598, 3603, 3600, 3597, 3602, 3599, 3601, 3600, 3598, 3602, 3600, 3601, 3599, 3603, 3600, 3598,
+};
+
+#define TRACE_LENGTH(trace)  (sizeof(trace) / sizeof(trace[0]))
+
+int filterTrace(const uint16_t * trace, int count, uint8_t stages, uint16_t * output)
+{
+  AnalogFilter filter;
+  memclear(&filter, sizeof(filter));
+  uint16_t filtered = 0;
+  for (int i=0; i<count; i++) {
+    filtered = analogFilterApply(filter, filtered, trace[i], stages);
+    output[i] = filtered / JITTER_ALPHA;
+  }
+  return count;
+}
+
+TEST(Analogs, jitterFilterUnchanged)
+{
+  uint16_t output[TRACE_LENGTH(restingPot)];
+  filterTrace(restingPot, TRACE_LENGTH(restingPot), ANALOG_FILTER_JITTER, output);
+
+  // the filter which was in getADC()
+  uint16_t filtered = 0;
+  for (unsigned int i=0; i<TRACE_LENGTH(restingPot); i++) {
+    uint16_t v = restingPot[i];
+    uint16_t previous = filtered / JITTER_ALPHA;
+    uint16_t diff = (v > previous) ? (v - previous) : (previous - v);
+    if (diff < (10*ANALOG_MULTIPLIER))
+      filtered = (filtered - previous) + v;
+    else
+      filtered = v * JITTER_ALPHA;
+    EXPECT_EQ(output[i], filtered / JITTER_ALPHA) << "sample " << i;
+  }
+}
+
+TEST(Analogs, medianRemovesSpikes)
+{
+  uint16_t output[TRACE_LENGTH(restingPot)];
+  filterTrace(restingPot, TRACE_LENGTH(restingPot), ANALOG_FILTER_MEDIAN, output);
+  for (unsigned int i=0; i<TRACE_LENGTH(restingPot); i++) {
+    EXPECT_LE(output[i], 2053) << "sample " << i;
+    EXPECT_GE(output[i], 2045) << "sample " << i;
+  }
+}
+
+TEST(Analogs, euroFilter)
+{
+  uint16_t output[TRACE_LENGTH(movingStick)];
+
+  // at rest the noise is reduced
+  filterTrace(restingPot+12, TRACE_LENGTH(restingPot)-12, ANALOG_FILTER_EURO, output);
+  uint16_t low = 0xFFFF, high = 0;
+  for (unsigned int i=4; i<TRACE_LENGTH(restingPot)-12; i++) {
+    low = min(low, output[i]);
+    high = max(high, output[i]);
+  }
+  EXPECT_LE(high - low, 3);
+
+  // the stick moves are followed without much lag
+  filterTrace(movingStick, TRACE_LENGTH(movingStick), ANALOG_FILTER_EURO, output);
+  for (unsigned int i=4; i<16; i++) {
+    EXPECT_LE(abs(output[i] - movingStick[i]), 120) << "sample " << i;
+  }
+  for (unsigned int i=20; i<TRACE_LENGTH(movingStick); i++) {
+    EXPECT_LE(abs(output[i] - 3600), 3) << "sample " << i;
+  }
+}
+
+TEST(Analogs, calibrationMultipliers)
+{
+  MODEL_RESET();
+  const int16_t spans[] = { 0, 100, 333, 700, 1000, 1024, 1500, 2047 };
+  for (unsigned int s=0; s<DIM(spans); s++) {
+    g_eeGeneral.calib[0].spanNeg = spans[s];
+    g_eeGeneral.calib[0].spanPos = spans[DIM(spans)-1-s];
+    updateCalibrationMultipliers();
+    for (int v=-2048; v<=2048; v++) {
+      int16_t expected = v * (int32_t)RESX / (max((int16_t)100, (v>0 ? g_eeGeneral.calib[0].spanPos : g_eeGeneral.calib[0].spanNeg)));
+      int16_t result = applyCalibration(0, v);
+      EXPECT_LE(abs(result - expected), 1) << "span " << spans[s] << " value " << v;
+      if (v == max<int16_t>(100, g_eeGeneral.calib[0].spanPos)) {
+        EXPECT_EQ(result, RESX);
+      }
+      if (v == -max<int16_t>(100, g_eeGeneral.calib[0].spanNeg)) {
+        EXPECT_EQ(result, -RESX);
+      }
+    }
+  }
+}
+
+#endif // #if defined(CPUARM)
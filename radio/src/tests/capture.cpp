@@ -0,0 +1,197 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include <vector>
+#include "gtests.h"
+
+#if defined(PCBTARANIS)
+
+#define CAPTURE_TEST_BMP    "/tmp/opentx-capture-test.bmp"
+#define CAPTURE_TEST_OTC    "/tmp/opentx-capture-test.otc"
+
+static std::vector<uint8_t> readCaptureFile(const char * filename)
+{
+  std::vector<uint8_t> result;
+  FILE * f = fopen(filename, "rb");
+  if (f) {
+    int c;
+    while ((c = fgetc(f)) != EOF)
+      result.push_back(c);
+    fclose(f);
+  }
+  return result;
+}
+
+static uint8_t getTestPixel(unsigned int x, unsigned int y)
+{
+  if (x>=LCD_W || y>=LCD_H)
+    return 0;
+  display_t * p = &displayBuf[y / 2 * LCD_W + x];
+  return (y & 1) ? (*p >> 4) : (*p & 0x0F);
+}
+
+static void drawTestScreen(int frame)
+{
+  lcd_clear();
+  for (int i=0; i<16; i++) {
+    drawFilledRect(i*13, 40, 13, 24, SOLID, GREY(i));
+  }
+  lcd_putsAtt(frame % 100, 8, "Capture test", DBLSIZE);
+  lcd_outdezAtt(10*FW, 30, frame, LEFT);
+}
+
+// the previous implementation, pixel by pixel and byte by byte
+static const char * writeTestBmp(const char * filename, const uint8_t * header)
+{
+  FIL bmpFile;
+  UINT written;
+
+  f_open(&bmpFile, filename, FA_CREATE_ALWAYS | FA_WRITE);
+  f_write(&bmpFile, header, 118, &written);
+  for (int y=LCD_H-1; y>=0; y-=1) {
+    for (int x=0; x<8*((LCD_W+7)/8); x+=2) {
+      uint8_t byte = getTestPixel(x+1, y) + (getTestPixel(x, y) << 4);
+      f_write(&bmpFile, &byte, 1, &written);
+    }
+  }
+  f_close(&bmpFile);
+  return NULL;
+}
+
+TEST(Capture, bmp)
+{
+  drawTestScreen(0);
+
+  EXPECT_EQ(NULL, captureWriteBmp(CAPTURE_TEST_BMP));
+  std::vector<uint8_t> result = readCaptureFile(CAPTURE_TEST_BMP);
+  ASSERT_EQ(118u + 108*LCD_H, result.size());
+
+  writeTestBmp(CAPTURE_TEST_BMP, &result[0]);
+  std::vector<uint8_t> expected = readCaptureFile(CAPTURE_TEST_BMP);
+
+  EXPECT_TRUE(expected == result);
+  unlink(CAPTURE_TEST_BMP);
+}
+
+TEST(Capture, diff)
+{
+  display_t previous[DISPLAY_BUF_SIZE];
+  uint8_t blocks[CAPTURE_BLOCKS];
+
+  drawTestScreen(0);
+  memcpy(previous, displayBuf, DISPLAY_BUF_SIZE);
+  EXPECT_EQ(0, captureDiff(displayBuf, previous, blocks));
+
+  displayBuf[0] = 0x11;
+  displayBuf[CAPTURE_BLOCK_SIZE*5 + 3] ^= 0xFF;
+  displayBuf[DISPLAY_BUF_SIZE-1] ^= 0xFF;
+  EXPECT_EQ(3, captureDiff(displayBuf, previous, blocks));
+  EXPECT_EQ(0, blocks[0]);
+  EXPECT_EQ(5, blocks[1]);
+  EXPECT_EQ(CAPTURE_BLOCKS-1, blocks[2]);
+  EXPECT_EQ(0, memcmp(previous, displayBuf, DISPLAY_BUF_SIZE));
+  EXPECT_EQ(0, captureDiff(displayBuf, previous, blocks));
+}
+
+static uint32_t getCaptureInt(const uint8_t * &p, uint8_t size)
+{
+  uint32_t result = 0;
+  for (uint8_t i=0; i<size; i++) {
+    result |= *p++ << (8*i);
+  }
+  return result;
+}
+
+TEST(Capture, recording)
+{
+  #define FRAMES 100
+  std::vector< std::vector<uint8_t> > frames;
+
+  g_tmr10ms = 0; // the frames times are relative to the start
+  EXPECT_EQ(NULL, captureStart(CAPTURE_TEST_OTC));
+  EXPECT_TRUE(captureRunning());
+
+  for (int i=0; i<FRAMES; i++) {
+    g_tmr10ms = 2*i;
+    // the screen only changes every other frame
+    drawTestScreen(i/2);
+    captureFrame();
+    if (i % 2 == 0)
+      frames.push_back(std::vector<uint8_t>(displayBuf, displayBuf+DISPLAY_BUF_SIZE));
+  }
+
+  captureStop();
+  EXPECT_FALSE(captureRunning());
+
+  // replay the file
+  std::vector<uint8_t> file = readCaptureFile(CAPTURE_TEST_OTC);
+  ASSERT_GE(file.size(), 12u);
+  const uint8_t * p = &file[0];
+  const uint8_t * end = p + file.size();
+  EXPECT_EQ(0, memcmp(p, "OTXC", 4));
+  p += 4;
+  EXPECT_EQ(CAPTURE_VERSION, *p++);
+  EXPECT_EQ(4, *p++);
+  EXPECT_EQ(LCD_W, getCaptureInt(p, 2));
+  EXPECT_EQ(LCD_H, getCaptureInt(p, 2));
+  EXPECT_EQ(CAPTURE_BLOCK_SIZE, getCaptureInt(p, 2));
+
+  uint8_t screen[DISPLAY_BUF_SIZE];
+  memset(screen, 0, sizeof(screen));
+  unsigned int count = 0;
+  while (p < end && count < frames.size()) {
+    uint32_t time = getCaptureInt(p, 4);
+    EXPECT_EQ(4*count, time);
+    uint8_t blocks = *p++;
+    for (uint8_t i=0; i<blocks; i++) {
+      uint8_t block = *p++;
+      ASSERT_LT(block, CAPTURE_BLOCKS);
+      memcpy(&screen[block*CAPTURE_BLOCK_SIZE], p, CAPTURE_BLOCK_SIZE);
+      p += CAPTURE_BLOCK_SIZE;
+    }
+    EXPECT_EQ(0, memcmp(screen, &frames[count][0], DISPLAY_BUF_SIZE));
+    count++;
+  }
+  EXPECT_EQ(frames.size(), count);
+  EXPECT_TRUE(p == end);
+
+  // only the changed blocks of half of the frames are written
+  EXPECT_LT(file.size(), FRAMES*DISPLAY_BUF_SIZE/4u);
+  unlink(CAPTURE_TEST_OTC);
+}
+
+#endif // #if defined(PCBTARANIS)
@@ -0,0 +1,102 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include <string>
+#include "gtests.h"
+
+#if defined(CLI)
+int cliExecLine(char * line);
+
+static std::string cliOutput;
+
+static void cliCapture(const char * text)
+{
+  cliOutput += text;
+}
+
+static std::string cliRun(const char * command)
+{
+  char line[256];
+  strncpy(line, command, sizeof(line));
+  cliOutput.clear();
+  traceCallback = cliCapture;
+  cliExecLine(line);
+  traceCallback = NULL;
+  return cliOutput;
+}
+
+TEST(Cli, bench)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+  std::string output = cliRun("bench mixer 10");
+  EXPECT_NE(output.find("cycles per iteration at 1000000000Hz"), std::string::npos) << output;
+  EXPECT_NE(output.find("mixer         10"), std::string::npos) << output;
+  EXPECT_EQ(output.find("lcd"), std::string::npos) << output;
+
+  output = cliRun("bench");
+  EXPECT_NE(output.find("mixer        100"), std::string::npos) << output;
+  EXPECT_NE(output.find("switches     100"), std::string::npos) << output;
+  EXPECT_NE(output.find("lcd          100"), std::string::npos) << output;
+#if defined(FRSKY_SPORT)
+  EXPECT_NE(output.find("telemetry    100"), std::string::npos) << output;
+#endif
+
+  output = cliRun("bench servos");
+  EXPECT_NE(output.find("Invalid argument \"servos\""), std::string::npos) << output;
+  output = cliRun("bench lcd 0");
+  EXPECT_NE(output.find("Invalid argument \"0\""), std::string::npos) << output;
+}
+
+TEST(Cli, profileReset)
+{
+  maxMixerDuration = 1000;
+  std::string output = cliRun("profile");
+  EXPECT_NE(output.find("mixer max duration 500us"), std::string::npos) << output;
+  cliRun("profile reset");
+  EXPECT_EQ(maxMixerDuration, 0);
+}
+
+TEST(Cli, stackInfo)
+{
+  std::string output = cliRun("stackinfo");
+  EXPECT_NE(output.find("menus "), std::string::npos) << output;
+  EXPECT_NE(output.find("mixer "), std::string::npos) << output;
+  EXPECT_NE(output.find("audio "), std::string::npos) << output;
+  EXPECT_NE(output.find("cli "), std::string::npos) << output;
+}
+#endif
@@ -161,4 +161,256 @@ TEST(EEPROM, rm)
   }
   EXPECT_EQ(sz, 0);
 }
+
+#if defined(CPUARM)
+TEST(EEPROM, eeLoadModel)
+{
+  eepromFile = NULL; // in memory
+
+  eepromFormat();
+
+  MODEL_RESET();
+  g_model.header.name[0] = 1;
+  g_model.mixData[0].weight = 50;
+  theFile.writeRlc(FILE_MODEL(0), FILE_TYP_MODEL, (uint8_t*)&g_model, sizeof(g_model), true);
+  g_model.header.name[0] = 2;
+  g_model.mixData[0].weight = 75;
+  theFile.writeRlc(FILE_MODEL(1), FILE_TYP_MODEL, (uint8_t*)&g_model, sizeof(g_model), true);
+
+  eeLoadModel(0);
+  EXPECT_EQ(g_model.header.name[0], 1);
+  EXPECT_EQ(g_model.mixData[0].weight, 50);
+
+  eeLoadModel(1);
+  EXPECT_EQ(g_model.header.name[0], 2);
+  EXPECT_EQ(g_model.mixData[0].weight, 75);
+#if defined(PCBTARANIS)
+  EXPECT_EQ(memcmp(&g_model, &shadowModel, sizeof(g_model)), 0);
+#endif
+}
+
+void checkModelHeaders()
+{
+  for (int i=0; i<MAX_MODELS; i++) {
+    ModelHeader header;
+    eeLoadModelHeader(i, &header);
+    EXPECT_EQ(memcmp(&header, &modelHeaders[i], sizeof(header)), 0) << "model " << i;
+  }
+}
+
+TEST(EEPROM, modelHeadersCache)
+{
+  eepromFile = NULL; // in memory
+
+  eepromFormat();
+
+  MODEL_RESET();
+  for (int i=0; i<3; i++) {
+    g_model.header.name[0] = i+1;
+    g_model.header.modelId[0] = 10+i;
+    theFile.writeRlc(FILE_MODEL(i), FILE_TYP_MODEL, (uint8_t*)&g_model, sizeof(g_model), true);
+  }
+  eeLoadModelHeaders();
+  checkModelHeaders();
+
+  EXPECT_TRUE(eeCopyModel(5, 1));
+  EXPECT_EQ(modelHeaders[5].name[0], 2);
+  checkModelHeaders();
+
+  eeSwapModels(0, 2);
+  EXPECT_EQ(modelHeaders[0].name[0], 3);
+  EXPECT_EQ(modelHeaders[2].modelId[0], 10);
+  checkModelHeaders();
+
+  eeDeleteModel(1);
+  EXPECT_FALSE(eeModelExists(1));
+  checkModelHeaders();
+
+  // the current model written in the background
+  g_eeGeneral.currModel = 4;
+  g_model.header.name[0] = 9;
+  eeDirty(EE_MODEL);
+  eeCheck(true);
+  EXPECT_EQ(modelHeaders[4].name[0], 9);
+  checkModelHeaders();
+}
+
+TEST(EEPROM, lzRandomWrites)
+{
+  eepromFile = NULL; // in memory
+  RlcFile f;
+  uint8_t buf[1000];
+  uint8_t buf2[1000];
+
+  eepromFormat();
+
+  for (int i=0; i<100; i++) {
+    int size = rand()%1000;
+    for (int j=0; j<size; j++) {
+      // zeroes, random bytes and copies of what is before (closer and further than the window)
+      int kind = rand() % 4;
+      if (kind == 0 || j < 300)
+        buf[j] = rand() < (RAND_MAX/100*i) ? 0 : rand();
+      else if (kind == 1)
+        buf[j] = buf[j-1-rand()%3];
+      else
+        buf[j] = buf[j-1-rand()%300];
+    }
+    f.writeRlc(5, 5|FILE_TYP_LZ, buf, size, true);
+    f.openRlc(5);
+    uint16_t n = f.readRlc(buf2, size+1);
+    EXPECT_EQ(n, size);
+    EXPECT_EQ(memcmp(buf, buf2, size), 0);
+  }
+}
+
+void setSampleModel(int index)
+{
+  static const char * const labels[] = { "RSSI", "A1", "A2", "VFAS", "Curr", "Alt", "VSpd", "Cels", "RPM", "Tmp1", "Fuel", "GPS" };
+
+  modelDefault(index % MAX_MODELS);
+  char name[] = "Model  ";
+  name[6] = 'A' + index % 26;
+  str2zchar(g_model.header.name, name, sizeof(g_model.header.name));
+  g_model.header.modelId[0] = index;
+
+  for (int i=4; i<4+index%12; i++) {
+    MixData * mix = mixAddress(i);
+    mix->destCh = i;
+    mix->srcRaw = MIXSRC_FIRST_INPUT + i%4;
+    mix->weight = 100 - 5*(index%8);
+    mix->swtch = (i%3 ? SWSRC_SA0+i%6 : 0);
+    mix->speedUp = mix->speedDown = (i%5 ? 0 : 20);
+    str2zchar(mix->name, "Flap", sizeof(mix->name));
+  }
+
+  for (int i=0; i<8+index%8; i++) {
+    char channel[] = "CH  ";
+    channel[2] = '0' + (i+1)/10;
+    channel[3] = '0' + (i+1)%10;
+    str2zchar(g_model.limitData[i].name, channel, sizeof(g_model.limitData[i].name));
+    g_model.limitData[i].min = -(index%5)*10;
+    g_model.limitData[i].ppmCenter = (i%4 ? 0 : 15);
+  }
+
+  for (int i=0; i<index%4; i++) {
+    g_model.curves[i].points = 4;
+    for (int j=0; j<9; j++) {
+      g_model.points[9*i+j] = -100 + 25*j;
+    }
+  }
+
+  for (int i=0; i<4+index%8; i++) {
+    LogicalSwitchData * ls = lswAddress(i);
+    ls->func = LS_FUNC_VPOS;
+    ls->v1 = MIXSRC_FIRST_INPUT + i%4;
+    ls->v2 = 10*i;
+    ls->duration = (i%3 ? 0 : 5);
+  }
+
+  for (int i=0; i<4+index%8; i++) {
+    g_model.customFn[i].swtch = SWSRC_FIRST_LOGICAL_SWITCH + i;
+    g_model.customFn[i].func = FUNC_PLAY_SOUND;
+    g_model.customFn[i].all.val = i;
+    g_model.customFn[i].active = 1;
+  }
+
+  for (int i=1; i<1+index%4; i++) {
+    g_model.flightModeData[i].swtch = SWSRC_SB0+i;
+    str2zchar(g_model.flightModeData[i].name, "Land", sizeof(g_model.flightModeData[i].name));
+    g_model.flightModeData[i].fadeIn = g_model.flightModeData[i].fadeOut = 10;
+  }
+
+  for (int i=0; i<(int)DIM(labels) && i<4+index%10; i++) {
+    TelemetrySensor & sensor = g_model.telemetrySensors[i];
+    sensor.id = 0x0100 + 0x10*i;
+    sensor.instance = 1 + i%3;
+    str2zchar(sensor.label, labels[i], TELEM_LABEL_LEN);
+    sensor.unit = i%5;
+    sensor.prec = i%2;
+    sensor.custom.ratio = (i%3 ? 0 : 132);
+  }
+}
+
+TEST(EEPROM, lzModels)
+{
+  eepromFile = NULL; // in memory
+  eepromFormat();
+
+  for (int i=0; i<10; i++) {
+    MODEL_RESET();
+    setSampleModel(i);
+    theFile.writeRlc(FILE_MODEL(i), i%2 ? FILE_TYP_MODEL|FILE_TYP_LZ : FILE_TYP_MODEL, (uint8_t*)&g_model, sizeof(g_model), true);
+  }
+
+  // both encodings are read the same way
+  for (int i=0; i<10; i++) {
+    MODEL_RESET();
+    setSampleModel(i);
+    ModelData model;
+    memcpy(&model, &g_model, sizeof(model));
+    MODEL_RESET();
+    loadModel(i);
+    EXPECT_EQ(memcmp(&model, &g_model, sizeof(model)), 0) << "model " << i;
+    char name[sizeof(g_model.header.name)];
+    eeLoadModelName(i, name);
+    EXPECT_EQ(memcmp(name, model.header.name, sizeof(name)), 0) << "model " << i;
+  }
+
+  // the copy keeps the encoding
+  EXPECT_TRUE(eeCopyModel(20, 1));
+  EXPECT_EQ(eeFs.files[FILE_MODEL(20)].typ, FILE_TYP_MODEL|FILE_TYP_LZ);
+  ModelData model;
+  loadModel(1);
+  memcpy(&model, &g_model, sizeof(model));
+  loadModel(20);
+  EXPECT_EQ(memcmp(&model, &g_model, sizeof(model)), 0);
+
+  // the models written by the radio are LZ encoded
+  g_eeGeneral.currModel = 3;
+  eeDirty(EE_MODEL);
+  eeCheck(true);
+  EXPECT_EQ(eeFs.files[FILE_MODEL(3)].typ, FILE_TYP_MODEL|FILE_TYP_LZ);
+}
+
+TEST(EEPROM, lzConvertModel)
+{
+  eepromFile = NULL; // in memory
+  eepromFormat();
+
+  MODEL_RESET();
+  setSampleModel(4);
+  ModelData model;
+  memcpy(&model, &g_model, sizeof(model));
+  theFile.writeRlc(FILE_MODEL(4), FILE_TYP_MODEL, (uint8_t*)&g_model, sizeof(g_model), true);
+
+  // the v217 models are unchanged, they are only written again LZ encoded
+  ConvertModel(4, 217);
+  EXPECT_EQ(eeFs.files[FILE_MODEL(4)].typ, FILE_TYP_MODEL|FILE_TYP_LZ);
+  MODEL_RESET();
+  loadModel(4);
+  EXPECT_EQ(memcmp(&model, &g_model, sizeof(model)), 0);
+}
+
+TEST(EEPROM, lzSize)
+{
+  const int models = 30;
+  uint32_t size[2] = { 0, 0 };
+
+  eepromFile = NULL; // in memory
+
+  for (int lz=0; lz<2; lz++) {
+    eepromFormat();
+    for (int i=0; i<models; i++) {
+      MODEL_RESET();
+      setSampleModel(i);
+      theFile.writeRlc(FILE_MODEL(i), lz ? FILE_TYP_MODEL|FILE_TYP_LZ : FILE_TYP_MODEL, (uint8_t*)&g_model, sizeof(g_model), true);
+      size[lz] += eeModelSize(i);
+    }
+  }
+
+  EXPECT_LT(size[1], size[0]);
+}
+#endif
+
 #endif
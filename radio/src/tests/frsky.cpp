@@ -41,6 +41,7 @@ void frskyDProcessPacket(uint8_t *packet);
 #if defined(FRSKY_SPORT)
 bool checkSportPacket(uint8_t *packet);
 void processSportPacket(uint8_t *packet);
+void processSerialData(uint8_t data);
 bool checkSportPacket(uint8_t *packet);
 void frskyCalculateCellStats(void);
 void displayVoltagesScreen();
@@ -523,4 +524,511 @@ TEST(FrSkySPORT, frskyCurrent)
   EXPECT_EQ(telemetryItems[0].valueMax, 505);
 }
 
+
+extern uint8_t dataState;
+extern uint8_t frskyRxBuffer[];
+extern uint8_t frskyRxBufferCount;
+
+int stuffSportPacket(uint8_t * stream, const uint8_t * packet)
+{
+  int len = 0;
+  stream[len++] = START_STOP;
+  stream[len++] = packet[0];
+  for (int i=1; i<FRSKY_SPORT_PACKET_SIZE; i++) {
+    if (packet[i] == START_STOP || packet[i] == BYTESTUFF) {
+      stream[len++] = BYTESTUFF;
+      stream[len++] = packet[i] ^ STUFF_MASK;
+    }
+    else {
+      stream[len++] = packet[i];
+    }
+  }
+  return len;
+}
+
+// A S.Port capture with VARIO, FAS, FLVSS and RPM sensors, values chosen to
+// exercise the byte stuffing
+int generateSportStream(uint8_t * stream, int count)
+{
+  const uint8_t ids[] = { DATA_ID_VARIO, DATA_ID_FAS, DATA_ID_FLVSS, DATA_ID_RPM };
+  const uint16_t appIds[] = { ALT_FIRST_ID, CURR_FIRST_ID, VFAS_FIRST_ID, RPM_FIRST_ID };
+  uint8_t packet[FRSKY_SPORT_PACKET_SIZE];
+  int len = 0;
+
+  // RSSI first, the sensors are ignored until the link is up
+  packet[0] = 0x98;
+  packet[1] = 0x10; // DATA_FRAME
+  *((uint16_t *)(packet+2)) = RSSI_ID;
+  *((int32_t *)(packet+4)) = 80;
+  setSportPacketCrc(packet);
+  len += stuffSportPacket(stream+len, packet);
+
+  for (int i=0; i<count; i++) {
+    packet[0] = ids[i % 4];
+    packet[1] = 0x10; // DATA_FRAME
+    *((uint16_t *)(packet+2)) = appIds[i % 4];
+    *((int32_t *)(packet+4)) = 0x7D7E + i * 7;
+    setSportPacketCrc(packet);
+    len += stuffSportPacket(stream+len, packet);
+    if (i % 10 == 3) {
+      stream[len++] = 0x42; // noise between packets
+    }
+  }
+  return len;
+}
+
+TEST(FrSkySPORT, processSerialBuffer)
+{
+  uint8_t stream[2000];
+  uint8_t chunk[TELEMETRY_RX_CHUNK_SIZE];
+  int32_t expected[MAX_SENSORS];
+  int len = generateSportStream(stream, 100);
+
+  telemetryProtocol = PROTOCOL_FRSKY_SPORT;
+  allowNewSensors = true;
+
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  dataState = STATE_DATA_IDLE;
+  for (int i=0; i<len; i++) {
+    processSerialData(stream[i]);
+  }
+  int sensors = 0;
+  for (int i=0; i<MAX_SENSORS; i++) {
+    expected[i] = telemetryItems[i].value;
+    if (expected[i] != 0)
+      sensors++;
+  }
+  EXPECT_GE(sensors, 4);
+
+  for (int size=1; size<=TELEMETRY_RX_CHUNK_SIZE; size++) {
+    MODEL_RESET();
+    TELEMETRY_RESET();
+    dataState = STATE_DATA_IDLE;
+    for (int i=0; i<len; i+=size) {
+      int count = min(size, len-i);
+      memcpy(chunk, stream+i, count);
+      processSerialBuffer(chunk, count);
+    }
+    for (int i=0; i<MAX_SENSORS; i++) {
+      EXPECT_EQ(telemetryItems[i].value, expected[i]);
+    }
+  }
+}
+
+// Feeds the same streams, ending on the corner cases of the byte stuffing, to
+// processSerialData() and to processSerialBuffer(), which must end in the same
+// state whatever the chunks size
+TEST(FrSkySPORT, processSerialBufferStates)
+{
+  const uint8_t tails[][6] = {
+    { 3, 0x7E, 0x7E, 0x7D },
+    { 4, 0x7E, 0x7E, 0x7D, 0x5E },
+    { 3, 0x7E, 0x7D, 0x5E },
+    { 2, 0x7E, 0x7D },
+    { 4, 0x7E, 0x98, 0x10, 0x7D },
+    { 5, 0x7E, 0x98, 0x7E, 0x7E, 0x7D },
+    { 1, 0x7E },
+  };
+  uint8_t stream[200];
+  uint8_t chunk[TELEMETRY_RX_CHUNK_SIZE];
+
+  telemetryProtocol = PROTOCOL_FRSKY_SPORT;
+  allowNewSensors = true;
+
+  for (unsigned int t=0; t<DIM(tails); t++) {
+    // a packet with 0x7D as physical ID (never destuffed), the tail, then a whole packet
+    int len = generateSportStream(stream, 1);
+    stream[len++] = START_STOP;
+    stream[len++] = BYTESTUFF;
+    stream[len++] = 0x7E;
+    memcpy(stream+len, &tails[t][1], tails[t][0]);
+    len += tails[t][0];
+    int head = len;
+    len += generateSportStream(stream+len, 2);
+
+    for (int end=head; end<=len; end+=len-head) {
+      MODEL_RESET();
+      TELEMETRY_RESET();
+      dataState = STATE_DATA_IDLE;
+      for (int i=0; i<end; i++) {
+        processSerialData(stream[i]);
+      }
+      uint8_t state = dataState;
+      uint8_t count = frskyRxBufferCount;
+      uint8_t buffer[32];
+      memcpy(buffer, frskyRxBuffer, count);
+      int32_t expected[MAX_SENSORS];
+      for (int i=0; i<MAX_SENSORS; i++) {
+        expected[i] = telemetryItems[i].value;
+      }
+
+      for (int size=1; size<=TELEMETRY_RX_CHUNK_SIZE; size++) {
+        MODEL_RESET();
+        TELEMETRY_RESET();
+        dataState = STATE_DATA_IDLE;
+        for (int i=0; i<end; i+=size) {
+          int n = min(size, end-i);
+          memcpy(chunk, stream+i, n);
+          processSerialBuffer(chunk, n);
+        }
+        EXPECT_EQ(dataState, state) << "tail " << t << " end " << end << " size " << size;
+        if (state != STATE_DATA_IDLE) {
+          EXPECT_EQ(frskyRxBufferCount, count) << "tail " << t << " end " << end << " size " << size;
+          EXPECT_EQ(memcmp(frskyRxBuffer, buffer, count), 0) << "tail " << t << " end " << end << " size " << size;
+        }
+        for (int i=0; i<MAX_SENSORS; i++) {
+          EXPECT_EQ(telemetryItems[i].value, expected[i]) << "tail " << t << " end " << end << " size " << size;
+        }
+      }
+    }
+  }
+}
+
+void setCalculatedSensor(int index, uint8_t formula, int8_t source1, int8_t source2=0)
+{
+  TelemetrySensor & sensor = g_model.telemetrySensors[index];
+  sensor.init("Calc", UNIT_VOLTS, 2);
+  sensor.type = TELEM_TYPE_CALCULATED;
+  sensor.formula = formula;
+  sensor.calc.sources[0] = source1;
+  sensor.calc.sources[1] = source2;
+  telemetrySensorsDirty = true;
+}
+
+TEST(Telemetry, calculatedSensorsOrder)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+
+  g_model.telemetrySensors[1].init("Cell", UNIT_VOLTS, 2);
+  setCalculatedSensor(0, TELEM_FORMULA_ADD, 3);          // uses sensor 2 which comes after
+  setCalculatedSensor(2, TELEM_FORMULA_ADD, 2, 2);
+  setCalculatedSensor(3, TELEM_FORMULA_MAX, 1, -2);      // uses sensor 0 which uses sensor 2
+
+  telemetryItems[1].setValue(g_model.telemetrySensors[1], 1200, UNIT_VOLTS, 2);
+  evalCalculatedSensors();
+  EXPECT_EQ(telemetryItems[2].value, 2400);
+  EXPECT_EQ(telemetryItems[0].value, 2400);
+  EXPECT_EQ(telemetryItems[3].value, 2400);
+
+  // nothing received, nothing evaluated
+  telemetryItems[0].value = 0;
+  evalCalculatedSensors();
+  EXPECT_EQ(telemetryItems[0].value, 0);
+
+  telemetryItems[1].setValue(g_model.telemetrySensors[1], 1300, UNIT_VOLTS, 2);
+  evalCalculatedSensors();
+  EXPECT_EQ(telemetryItems[2].value, 2600);
+  EXPECT_EQ(telemetryItems[0].value, 2600);
+  EXPECT_EQ(telemetryItems[3].value, 2600);
+
+  // the sensors are evaluated again when their config changes
+  g_model.telemetrySensors[2].calc.sources[1] = 0;
+  telemetrySensorsDirty = true;
+  evalCalculatedSensors();
+  EXPECT_EQ(telemetryItems[2].value, 1300);
+  EXPECT_EQ(telemetryItems[0].value, 1300);
+
+  // a source becoming old is propagated
+  telemetryItems[1].setOld();
+  evalCalculatedSensors();
+  EXPECT_TRUE(telemetryItems[2].isOld());
+  EXPECT_TRUE(telemetryItems[0].isOld());
+}
+
+// the unit / precision conversion as it was done before the multiply-shift
+const struct {
+  uint8_t unitFrom;
+  uint8_t unitTo;
+  int16_t multiplier;
+  int16_t divisor;
+} referenceUnitConversionTable[] = {
+  { UNIT_METERS,            UNIT_FEET,             105,   32},
+  { UNIT_METERS_PER_SECOND, UNIT_FEET_PER_SECOND,  105,   32},
+  { UNIT_KTS,               UNIT_KMH,             1852, 1000},
+  { UNIT_KTS,               UNIT_MPH,             1151, 1000},
+  { UNIT_KTS,               UNIT_METERS_PER_SECOND, 1000, 1944},
+  { UNIT_KTS,               UNIT_FEET_PER_SECOND, 1688, 1000},
+  { UNIT_KMH,               UNIT_KTS,             1000, 1852},
+  { UNIT_KMH,               UNIT_MPH,             1000, 1609},
+  { UNIT_KMH,               UNIT_METERS_PER_SECOND,  10,   36},
+  { UNIT_KMH,               UNIT_FEET_PER_SECOND,  911, 1000},
+  { UNIT_MILLILITERS,       UNIT_FLOZ,             100, 2957},
+  { 0, 0, 0, 0}
+};
+
+int32_t referenceConvertTelemetryValue(int32_t value, uint8_t unit, uint8_t prec, uint8_t destUnit, uint8_t destPrec, int64_t & magnitude)
+{
+  magnitude = abs(value);
+
+  for (int i=prec; i<destPrec; i++) {
+    value *= 10;
+    magnitude *= 10;
+  }
+
+  if (unit == UNIT_CELSIUS) {
+    if (destUnit == UNIT_FAHRENHEIT) {
+      value = 32 + (value*18) / 10;
+      magnitude *= 18;
+    }
+  }
+  else {
+    for (int i=0; referenceUnitConversionTable[i].divisor; i++) {
+      if (referenceUnitConversionTable[i].unitFrom == unit && referenceUnitConversionTable[i].unitTo == destUnit) {
+        value = (value * (int32_t)referenceUnitConversionTable[i].multiplier) / (int32_t)referenceUnitConversionTable[i].divisor;
+        magnitude *= referenceUnitConversionTable[i].multiplier;
+        break;
+      }
+    }
+  }
+
+  for (int i=destPrec; i<prec; i++)
+    value /= 10;
+
+  return value;
+}
+
+TEST(Telemetry, convertTelemetryValue)
+{
+  std::vector<int32_t> values;
+  for (int32_t value=-300; value<=300; value++) {
+    values.push_back(value);
+  }
+  for (int64_t value=301; value<0x80000000; value=value*5/4+7) {
+    values.push_back(value);
+    values.push_back(-value);
+  }
+  values.push_back(0x7FFFFFFF);
+  values.push_back(-0x7FFFFFFF);
+
+  int checked = 0;
+  for (int unit=0; unit<=UNIT_MAX; unit++) {
+    for (int destUnit=0; destUnit<=UNIT_MAX; destUnit++) {
+      for (int prec=0; prec<=3; prec++) {
+        for (int destPrec=0; destPrec<=3; destPrec++) {
+          TelemetryConversion conversion;
+          conversion.init(unit, prec, destUnit, destPrec);
+          for (unsigned int i=0; i<values.size(); i++) {
+            int64_t magnitude;
+            int32_t expected = referenceConvertTelemetryValue(values[i], unit, prec, destUnit, destPrec, magnitude);
+            if (magnitude > 0x7FFFFFFF)
+              continue; // overflows the reference
+            ASSERT_EQ(expected, conversion.apply(values[i])) << "value=" << values[i] << " unit=" << unit << "." << prec << " destUnit=" << destUnit << "." << destPrec;
+            ASSERT_EQ(expected, convertTelemetryValue(values[i], unit, prec, destUnit, destPrec));
+            checked++;
+          }
+        }
+      }
+    }
+  }
+  EXPECT_GT(checked, 0);
+}
+
+TEST(Telemetry, sensorConversionUpdate)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+
+  TelemetrySensor & sensor = g_model.telemetrySensors[0];
+  TelemetryItem & item = telemetryItems[0];
+
+  sensor.init("Spd", UNIT_KTS, 0);
+  item.setValue(sensor, 1000, UNIT_KMH, 1);
+  EXPECT_EQ(item.value, 53);
+
+  // the conversion is resolved again when the sensor is changed
+  sensor.unit = UNIT_METERS_PER_SECOND;
+  sensor.prec = 1;
+  item.setValue(sensor, 1000, UNIT_KMH, 1);
+  EXPECT_EQ(item.value, 277);
+
+  // and when the received unit changes
+  item.setValue(sensor, 100, UNIT_KTS, 0);
+  EXPECT_EQ(item.value, 514);
+}
+
+
+static void initTelemetryStream(uint8_t protocol)
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  telemetryProtocol = protocol;
+  dataState = STATE_DATA_IDLE;
+  allowNewSensors = true;
+  telemetryStream.init(protocol);
+}
+
+static int findSensorItem(uint16_t id, uint8_t instance)
+{
+  for (int i=0; i<MAX_SENSORS; i++) {
+    if (isTelemetryFieldAvailable(i) && g_model.telemetrySensors[i].id == id && g_model.telemetrySensors[i].instance == instance)
+      return i;
+  }
+  return -1;
+}
+
+TEST(TelemetryStream, sensors)
+{
+  initTelemetryStream(PROTOCOL_FRSKY_SPORT);
+  telemetryStream.addSensor(RSSI_ID, 0x18, 100, 80);
+  for (int i=0; i<10; i++) {
+    telemetryStream.addSensor(T1_FIRST_ID, i, 100, 20+i, 1);
+  }
+  telemetryStream.run(2000);
+
+  const TelemetryStreamStats & stats = telemetryStream.getStats();
+  EXPECT_EQ(stats.packets, 11*20u);
+  EXPECT_EQ(stats.lost + stats.saturated + stats.overruns, 0u);
+  EXPECT_GE(stats.updates, 11*20u);
+  EXPECT_EQ(stats.latencyCount, 11*20u);
+  // the 11 packets are sent at once, the last one waits for the others on the line
+  EXPECT_LT(stats.latencyMax, 40000u);
+  for (int i=0; i<10; i++) {
+    int index = findSensorItem(T1_FIRST_ID, i+1);
+    ASSERT_GE(index, 0);
+    EXPECT_EQ(telemetryItems[index].value, 20+i+19);
+  }
+}
+
+TEST(TelemetryStream, frskyD)
+{
+  initTelemetryStream(PROTOCOL_FRSKY_D);
+  telemetryStream.addSensor(D_RSSI_ID, 0, 40, 90);
+  telemetryStream.addSensor(D_A1_ID, 0, 40, 120);
+  telemetryStream.addSensor(RPM_ID, 0, 200, 0x5E5D, 1);
+  telemetryStream.addSensor(TEMP1_ID, 0, 200, 30);
+  telemetryStream.run(1000);
+
+  EXPECT_EQ(telemetryStream.getStats().overruns, 0u);
+  int index = findSensorItem(D_RSSI_ID, 0);
+  ASSERT_GE(index, 0);
+  EXPECT_EQ(telemetryItems[index].value, 90);
+  index = findSensorItem(TEMP1_ID, 0);
+  ASSERT_GE(index, 0);
+  EXPECT_EQ(telemetryItems[index].value, 30);
+  EXPECT_EQ(telemetryStream.getStats().latencyCount, 25*2 + 5*2u);
+}
+
+TEST(TelemetryStream, loss)
+{
+  initTelemetryStream(PROTOCOL_FRSKY_SPORT);
+  telemetryStream.addSensor(RSSI_ID, 0x18, 10, 80);
+  telemetryStream.addSensor(T1_FIRST_ID, 0, 10, 20);
+  telemetryStream.setLoss(0xF0000000); // a burst of 4 packets every 32
+  telemetryStream.run(1600);
+
+  const TelemetryStreamStats & stats = telemetryStream.getStats();
+  EXPECT_EQ(stats.lost, 40u);
+  EXPECT_EQ(stats.packets, 280u);
+  // the lost packets don't delay the others
+  EXPECT_LE(stats.latencyMax, 10000u);
+
+  telemetryStream.setLoss(0, 50);
+  telemetryStream.resetStats();
+  telemetryStream.run(10000);
+  EXPECT_NEAR(stats.lost, 1000, 100);
+}
+
+TEST(TelemetryStream, saturation)
+{
+  initTelemetryStream(PROTOCOL_FRSKY_SPORT);
+  telemetryStream.addSensor(RSSI_ID, 0x18, 10, 80);
+  for (int i=0; i<40; i++) {
+    telemetryStream.addSensor(T1_FIRST_ID + i/16, i%16, 10, i);
+  }
+
+  // more than the line can carry, but the receive FIFO is emptied often enough
+  telemetryStream.run(1000, 10);
+  const TelemetryStreamStats & stats = telemetryStream.getStats();
+  EXPECT_GT(stats.saturated, 0u);
+  EXPECT_EQ(stats.overruns, 0u);
+  EXPECT_GT(stats.bytes, 5000u);
+
+  // woken up every 100ms, the radio receives more than its FIFO holds
+  telemetryStream.resetStats();
+  telemetryStream.run(1000, 100);
+  EXPECT_GT(stats.overruns, 0u);
+}
+
+// how many sensors at 100ms the S.Port line carries before the packets are delayed or lost
+TEST(TelemetryStream, sustainedSensors)
+{
+  int sensors;
+  for (sensors=1; sensors<TELEMETRY_STREAM_MAX_SENSORS; sensors++) {
+    initTelemetryStream(PROTOCOL_FRSKY_SPORT);
+    telemetryStream.addSensor(RSSI_ID, 0x18, 100, 80);
+    for (int i=0; i<sensors; i++) {
+      telemetryStream.addSensor(T1_FIRST_ID + i/16, i%16, 100, i);
+    }
+    telemetryStream.run(2000);
+    const TelemetryStreamStats & stats = telemetryStream.getStats();
+    if (stats.saturated > 0 || stats.overruns > 0 || stats.latencyMax > 100000)
+      break;
+  }
+
+  // the line time is simulated, 57600 bauds carry about 570 packets per second, which
+  // makes 56 sensors at 100ms besides the RSSI, a few more fit in the queues during the 2s
+  EXPECT_GE(sensors-1, 50);
+}
+
+TEST(TelemetryStream, captureReplay)
+{
+  char path[] = "/tmp/telemetryXXXXXX";
+  uint8_t packet[FRSKY_SPORT_PACKET_SIZE];
+  uint8_t frame[2*FRSKY_SPORT_PACKET_SIZE];
+  const char * times[] = { "10:00:00.000", "10:00:00.100", "10:00:01.000" };
+  const int32_t values[] = { 80, 42, 0x7E7D };
+
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  FILE * f = fdopen(fd, "w");
+  for (int i=0; i<3; i++) {
+    packet[0] = (i == 0 ? 0x98 : 0x00);
+    packet[1] = 0x10; // DATA_FRAME
+    *((uint16_t *)(packet+2)) = (i == 0 ? RSSI_ID : T1_FIRST_ID);
+    *((int32_t *)(packet+4)) = values[i];
+    setSportPacketCrc(packet);
+    int len = stuffSportPacket(frame, packet);
+    fprintf(f, "\r\n2015-07-14,%s:", times[i]);
+    for (int j=0; j<len; j++) {
+      fprintf(f, " %02X", frame[j]);
+    }
+  }
+  fclose(f);
+
+  initTelemetryStream(PROTOCOL_FRSKY_SPORT);
+  ASSERT_TRUE(telemetryStream.loadCapture(path));
+  telemetryStream.run(500);
+  int index = findSensorItem(T1_FIRST_ID, 1);
+  ASSERT_GE(index, 0);
+  EXPECT_EQ(telemetryItems[index].value, 42);
+  telemetryStream.run(600);
+  EXPECT_EQ(telemetryItems[index].value, 0x7E7D);
+
+  // a raw capture gives the same values as the parser fed directly
+  uint8_t stream[2000];
+  int32_t expected[MAX_SENSORS];
+  int len = generateSportStream(stream, 100);
+  initTelemetryStream(PROTOCOL_FRSKY_SPORT);
+  for (int i=0; i<len; i++) {
+    processSerialData(stream[i]);
+  }
+  for (int i=0; i<MAX_SENSORS; i++) {
+    expected[i] = telemetryItems[i].value;
+  }
+
+  f = fopen(path, "wb");
+  fwrite(stream, 1, len, f);
+  fclose(f);
+  initTelemetryStream(PROTOCOL_FRSKY_SPORT);
+  ASSERT_TRUE(telemetryStream.loadCapture(path));
+  telemetryStream.run(1000);
+  EXPECT_EQ(telemetryStream.getStats().bytes, (uint32_t)len);
+  for (int i=0; i<MAX_SENSORS; i++) {
+    EXPECT_EQ(telemetryItems[i].value, expected[i]);
+  }
+  unlink(path);
+}
+
 #endif  //#if defined(FRSKY_SPORT)
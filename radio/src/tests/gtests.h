@@ -42,7 +42,11 @@ inline void MODEL_RESET()
 
 inline void MIXER_RESET()
 {
+#if defined(CPUARM)
+  memset(channelOutputsBuffers, 0, sizeof(channelOutputsBuffers));
+#else
   memset(channelOutputs, 0, sizeof(channelOutputs));
+#endif
   memset(chans, 0, sizeof(chans));
   memset(ex_chans, 0, sizeof(ex_chans));
   memset(act, 0, sizeof(act));
@@ -66,6 +70,10 @@ inline void TELEMETRY_RESET()
   for (int i=0; i<MAX_SENSORS; i++) {
     telemetryItems[i].clear();
   }
+  telemetrySensorsDirty = true;
+#endif
+#if defined(MAVLINK)
+  MAVLINK_reset(0);
 #endif
 }
 
@@ -35,6 +35,10 @@
  */
 
 #include <math.h>
+#include <string>
+#include <vector>
+#include <utime.h>
+#include <unistd.h>
 #include "gtests.h"
 
 #if defined(LUA)
@@ -182,4 +186,290 @@ TEST(Lua, testModelInputs)
 
 }
 
+// the lookup in the read-only tables as it was done before the index
+static luaR_result linearFindEntry(unsigned idx, const char * key, lu_byte * ptype)
+{
+  *ptype = LUA_TNIL;
+  if (lua_rotable[idx].pfuncs) {
+    for (const luaL_Reg * f=lua_rotable[idx].pfuncs; f->name; f++) {
+      if (!strcmp(f->name, key)) {
+        *ptype = LUA_TLIGHTFUNCTION;
+        return (luaR_result)(size_t)f->func;
+      }
+    }
+  }
+  if (lua_rotable[idx].pvalues) {
+    for (const luaR_value_entry * v=lua_rotable[idx].pvalues; v->name; v++) {
+      if (!strcmp(v->name, key)) {
+        *ptype = LUA_TNUMBER;
+        return v->value;
+      }
+    }
+  }
+  return 0;
+}
+
+static luaR_result linearFindGlobal(const char * name, lu_byte * ptype)
+{
+  *ptype = LUA_TNIL;
+  if (strlen(name) > LUA_MAX_ROTABLE_NAME)
+    return 0;
+  for (unsigned i=0; lua_rotable[i].name; i++) {
+    if (!strcmp(lua_rotable[i].name, name)) {
+      *ptype = LUA_TROTABLE;
+      return i+1;
+    }
+    if (!strncmp(lua_rotable[i].name, "__", 2)) {
+      luaR_result result = linearFindEntry(i, name, ptype);
+      if (result != 0)
+        return result;
+    }
+  }
+  return 0;
+}
+
+static std::vector<std::string> rotableNames()
+{
+  std::vector<std::string> names;
+  for (unsigned i=0; lua_rotable[i].name; i++) {
+    names.push_back(lua_rotable[i].name);
+    for (const luaL_Reg * f=lua_rotable[i].pfuncs; f && f->name; f++)
+      names.push_back(f->name);
+    for (const luaR_value_entry * v=lua_rotable[i].pvalues; v && v->name; v++)
+      names.push_back(v->name);
+  }
+  names.push_back("");
+  names.push_back("unknown");
+  names.push_back("EVT_ENTER");
+  names.push_back("EVT_ENTER_BREAKX");
+  names.push_back("zzz");
+  names.push_back("MIXSRC_FIRST_INPUT_TOO_LONG");
+  return names;
+}
+
+TEST(Lua, rotablesIndex)
+{
+  std::vector<std::string> names = rotableNames();
+  ASSERT_TRUE(luaR_indexready());
+
+  for (unsigned n=0; n<names.size(); n++) {
+    const char * name = names[n].c_str();
+    lu_byte type, expectedType;
+    luaR_result expected = linearFindGlobal(name, &expectedType);
+    luaR_result result = luaR_findglobal(name, &type);
+    EXPECT_EQ(expectedType, type) << name;
+    EXPECT_EQ(expected, result) << name;
+    for (unsigned i=0; lua_rotable[i].name; i++) {
+      expected = linearFindEntry(i, name, &expectedType);
+      result = luaR_findentry((void *)(size_t)(i+1), name, &type);
+      EXPECT_EQ(expectedType, type) << lua_rotable[i].name << "." << name;
+      EXPECT_EQ(expected, result) << lua_rotable[i].name << "." << name;
+    }
+  }
+
+  // the cached lookups, from a script
+  luaExecStr(("if EVT_ENTER_BREAK ~= " + std::to_string(EVT_KEY_BREAK(KEY_ENTER)) + " then error('EVT_ENTER_BREAK') end").c_str());
+  luaExecStr("if lcd.drawText == nil or lcd.unknown ~= nil then error('lcd') end");
+  luaExecStr("if getValue == nil or math.floor == nil or math.unknown ~= nil then error('getValue') end");
+  luaExecStr("myGlobal = 12 if myGlobal ~= 12 or unknownGlobal ~= nil then error('globals') end");
+  luaExecStr(("local t = { } for i=1,300 do t[i] = 'key' .. i end collectgarbage() if VALUE ~= 0 or LCD_W ~= " + std::to_string(LCD_W) + " then error('constants') end").c_str());
+}
+
+TEST(Lua, rotablesBenchmark)
+{
+  const int loops = 2000;
+  std::vector<std::string> names = rotableNames();
+  lu_byte type;
+  clock_t duration[2];
+  volatile luaR_result result = 0;
+
+  clock_t start = clock();
+  for (int i=0; i<loops; i++) {
+    for (unsigned n=0; n<names.size(); n++)
+      result = result + linearFindGlobal(names[n].c_str(), &type);
+  }
+  duration[0] = clock() - start;
+
+  start = clock();
+  for (int i=0; i<loops; i++) {
+    for (unsigned n=0; n<names.size(); n++)
+      result = result + luaR_findglobal(names[n].c_str(), &type);
+  }
+  duration[1] = clock() - start;
+
+  EXPECT_LT(duration[1], duration[0]);
+  printf("Global lookup: %.0fns linear, %.0fns indexed\n",
+         duration[0] * 1e9 / CLOCKS_PER_SEC / loops / names.size(), duration[1] * 1e9 / CLOCKS_PER_SEC / loops / names.size());
+
+  // a script which uses the API constants and functions in a loop
+  start = clock();
+  luaExecStr("local n = 0 "
+             "for i=1,20000 do "
+             "  local f = getValue "
+             "  if i % 7 == 0 then n = n + EVT_ENTER_BREAK + EVT_EXIT_BREAK + MIXSRC_Thr end "
+             "  local d = lcd.drawText "
+             "  myCounter = n "
+             "end");
+  duration[0] = clock() - start;
+  printf("Script with 20000 iterations of 7 global lookups: %.0fus\n", duration[0] * 1e6 / CLOCKS_PER_SEC);
+}
+
+extern int luaLoad(const char * filename, ScriptInternalData & sid, ScriptInputsOutputs * sio);
+
+static size_t luaMemUsed, luaMemPeak;
+
+static void * luaCountingAlloc(void * ud, void * ptr, size_t osize, size_t nsize)
+{
+  if (ptr) {
+    luaMemUsed -= osize;
+  }
+  if (nsize == 0) {
+    free(ptr);
+    return NULL;
+  }
+  luaMemUsed += nsize;
+  if (luaMemUsed > luaMemPeak) {
+    luaMemPeak = luaMemUsed;
+  }
+  return realloc(ptr, nsize);
+}
+
+static void writeTestScript(const char * filename, int version)
+{
+  FILE * f = fopen(filename, "w");
+  fprintf(f, "VERSION = %d\nlocal t = {}\n", version);
+  for (int i=0; i<60; i++) {
+    fprintf(f, "function t.f%d(x)\n  local y = x * %d + math.floor(x / %d)\n  if y > 1000 then return 'big' else return y end\nend\n", i, i, i+1);
+  }
+  fprintf(f, "return { run = function(event) return t.f1(event) end }\n");
+  fclose(f);
+}
+
+static void setFileTime(const char * filename, time_t time)
+{
+  struct utimbuf times = { time, time };
+  utime(filename, &times);
+}
+
+// the script is loaded in a fresh Lua state, as after a model switch
+static int loadTestScript(const char * filename, size_t & peak, clock_t & duration)
+{
+  ScriptInternalData sid;
+  memset(&sid, 0, sizeof(sid));
+  luaClose();
+  luaMemUsed = luaMemPeak = 0;
+  L = lua_newstate(luaCountingAlloc, NULL);
+  luaL_openlibs(L);
+  size_t base = luaMemPeak;
+  clock_t start = clock();
+  EXPECT_EQ(SCRIPT_OK, luaLoad(filename, sid, NULL));
+  duration = clock() - start;
+  peak = luaMemPeak - base;
+  lua_getglobal(L, "VERSION");
+  int version = lua_tointeger(L, -1);
+  luaClose();
+  return version;
+}
+
+TEST(Lua, bytecodeCache)
+{
+  const char * source = "./tests/bytecode.lua";
+  const char * bytecode = "./tests/bytecode.luac";
+  size_t peak[2];
+  clock_t duration[2];
+  time_t now = time(NULL);
+
+  remove(bytecode);
+  writeTestScript(source, 1);
+  setFileTime(source, now - 100);
+
+  // first load: compiled from the source, the bytecode is saved
+  EXPECT_EQ(1, loadTestScript(source, peak[0], duration[0]));
+  FILE * f = fopen(bytecode, "rb");
+  ASSERT_TRUE(f != NULL);
+  EXPECT_EQ(LUA_SIGNATURE[0], fgetc(f));
+  fclose(f);
+
+  // next loads: from the bytecode
+  EXPECT_EQ(1, loadTestScript(source, peak[1], duration[1]));
+  EXPECT_LT(peak[1], peak[0]);
+  printf("Script load after a model switch: source %.0fus %d bytes peak, bytecode %.0fus %d bytes peak\n",
+         duration[0] * 1e6 / CLOCKS_PER_SEC, (int)peak[0], duration[1] * 1e6 / CLOCKS_PER_SEC, (int)peak[1]);
+
+  // the source is newer than the bytecode: compiled again
+  setFileTime(bytecode, now - 200);
+  writeTestScript(source, 2);
+  EXPECT_EQ(2, loadTestScript(source, peak[0], duration[0]));
+
+  // the bytecode (saved again) is used as long as the source date doesn't change
+  writeTestScript(source, 3);
+  setFileTime(source, now - 100);
+  EXPECT_EQ(2, loadTestScript(source, peak[0], duration[0]));
+
+  // truncated bytecode (partial write): the source is used, the bytecode is saved again
+  ASSERT_EQ(0, truncate(bytecode, 100));
+  EXPECT_EQ(3, loadTestScript(source, peak[0], duration[0]));
+  EXPECT_EQ(3, loadTestScript(source, peak[0], duration[0]));
+  f = fopen(bytecode, "rb");
+  fseek(f, 0, SEEK_END);
+  EXPECT_GT(ftell(f), 100);
+  fclose(f);
+
+  remove(source);
+  remove(bytecode);
+}
+
+#if defined(PCBTARANIS)
+static void copyFile(const char * from, const char * to)
+{
+  char buffer[1024];
+  FILE * src = fopen(from, "rb");
+  FILE * dst = fopen(to, "wb");
+  size_t len;
+  while ((len = fread(buffer, 1, sizeof(buffer), src)) > 0) {
+    fwrite(buffer, 1, len, dst);
+  }
+  fclose(src);
+  fclose(dst);
+}
+
+TEST(Lua, bitmapsCache)
+{
+  uint8_t screen[DISPLAY_BUF_SIZE];
+  luaLcdAllowed = true;
+  luaFreeBitmaps();
+
+  lcd_clear();
+  luaExecStr("lcd.drawPixmap(10, 2, './tests/4b_20x20.bmp')");
+  memcpy(screen, displayBuf, sizeof(screen));
+
+  // the same bitmap drawn through a handle
+  lcd_clear();
+  luaExecStr("bitmap = lcd.loadBitmap('./tests/4b_20x20.bmp')");
+  luaExecStr("lcd.drawPixmap(10, 2, bitmap)");
+  EXPECT_EQ(0, memcmp(screen, displayBuf, sizeof(screen)));
+  luaExecStr("if lcd.loadBitmap('./tests/none.bmp') ~= nil then error('loadBitmap()') end");
+
+  // once in the cache, the file is not read anymore
+  copyFile("./tests/4b_20x20.bmp", "./tests/cached.bmp");
+  luaExecStr("lcd.drawPixmap(10, 2, './tests/cached.bmp')");
+  remove("./tests/cached.bmp");
+  lcd_clear();
+  luaExecStr("lcd.drawPixmap(10, 2, './tests/cached.bmp')");
+  EXPECT_EQ(0, memcmp(screen, displayBuf, sizeof(screen)));
+
+  // the handles stay valid when the cache is flushed, the other bitmaps are gone
+  luaFreeBitmaps();
+  lcd_clear();
+  luaExecStr("lcd.drawPixmap(10, 2, bitmap)");
+  EXPECT_EQ(0, memcmp(screen, displayBuf, sizeof(screen)));
+  lcd_clear();
+  luaExecStr("lcd.drawPixmap(10, 2, './tests/cached.bmp')");
+  for (unsigned int i=0; i<sizeof(screen); i++) {
+    ASSERT_EQ(0, displayBuf[i]);
+  }
+  luaExecStr("bitmap = nil");
+}
+#endif
+
 #endif   // #if defined(LUA)
@@ -0,0 +1,211 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include "gtests.h"
+
+#if defined(MAVLINK)
+
+// Synthetic ArduCopter-like stream, hand-built with the MAVLink 1.0 framing and
+// CRC_EXTRA values (not a recorded log). The ATTITUDE, RAW_IMU and PARAM_VALUE
+// messages are not used by the radio
+const uint8_t mavlinkCapture[] = {
+  // HEARTBEAT
+  0xFE, 0x09, 0x00, 0x01, 0x01, 0x00, 0x05, 0x00, 0x00, 0x00, 0x02, 0x03, 0x81, 0x04, 0x03, 0xBE,
+  0xB9,
+  // SYS_STATUS
+  0xFE, 0x1F, 0x01, 0x01, 0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0xF4, 0x01, 0x38, 0x31, 0xF0, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x4C, 0xE0, 0x65,
+  // ATTITUDE (not subscribed)
+  0xFE, 0x1C, 0x02, 0x01, 0x01, 0x1E, 0x40, 0xE2, 0x01, 0x00, 0xCD, 0xCC, 0xCC, 0x3D, 0xCD, 0xCC,
+  0x4C, 0xBE, 0x00, 0x00, 0xC0, 0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x9D, 0x64,
+  // GPS_RAW_INT
+  0xFE, 0x1E, 0x03, 0x01, 0x01, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x33,
+  0x1F, 0x1D, 0xE8, 0x1C, 0x5E, 0x01, 0xB8, 0x88, 0x00, 0x00, 0x78, 0x00, 0xFF, 0xFF, 0xC2, 0x01,
+  0x28, 0x23, 0x03, 0x09, 0xF2, 0xF7,
+  // VFR_HUD
+  0xFE, 0x14, 0x04, 0x01, 0x01, 0x4A, 0x00, 0x00, 0xA0, 0x40, 0x00, 0x00, 0x90, 0x40, 0x00, 0x00,
+  0x48, 0x41, 0xCD, 0xCC, 0x4C, 0x3E, 0x0E, 0x01, 0x28, 0x00, 0xD2, 0xD0,
+  // RAW_IMU (not subscribed)
+  0xFE, 0x1A, 0x05, 0x01, 0x01, 0x1B, 0x40, 0xE2, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00,
+  0x02, 0x00, 0x03, 0x00, 0x04, 0x00, 0x05, 0x00, 0x06, 0x00, 0x07, 0x00, 0x08, 0x00, 0x09, 0x00,
+  0x7A, 0x7A,
+  // NAV_CONTROLLER_OUTPUT
+  0xFE, 0x1A, 0x06, 0x01, 0x01, 0x3E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x87, 0x00, 0x0A, 0x00,
+  0x35, 0x11,
+  // RC_CHANNELS_RAW
+  0xFE, 0x16, 0x07, 0x01, 0x01, 0x23, 0x00, 0x00, 0x00, 0x00, 0xDC, 0x05, 0xDC, 0x05, 0x4C, 0x04,
+  0xDC, 0x05, 0xE8, 0x03, 0xE8, 0x03, 0xE8, 0x03, 0xE8, 0x03, 0x00, 0xC8, 0x0B, 0xEC,
+  // STATUSTEXT
+  0xFE, 0x33, 0x08, 0x01, 0x01, 0xFD, 0x06, 0x41, 0x52, 0x4D, 0x49, 0x4E, 0x47, 0x20, 0x4D, 0x4F,
+  0x54, 0x4F, 0x52, 0x53, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x8D, 0xFB,
+  // PARAM_VALUE (not subscribed)
+  0xFE, 0x19, 0x09, 0x01, 0x01, 0x16, 0xCD, 0xCC, 0x4C, 0x3E, 0x2C, 0x01, 0x01, 0x00, 0x52, 0x41,
+  0x54, 0x45, 0x5F, 0x59, 0x41, 0x57, 0x5F, 0x50, 0x00, 0x50, 0x41, 0x52, 0x41, 0x4D, 0x09, 0xBF,
+  0x73,
+};
+
+#define MAVLINK_CAPTURE_SYS_STATUS  17
+#define MAVLINK_CAPTURE_ATTITUDE    56
+#define MAVLINK_CAPTURE_GPS_RAW_INT 92
+
+void mavlinkReplay(const uint8_t * data, int size, int bytesPer10ms)
+{
+  for (int i=0; i<size; i++) {
+    MAVLINK_rxhandler(data[i]);
+    if (i % bytesPer10ms == bytesPer10ms - 1) {
+      g_tmr10ms++;
+      telemetryWakeup();
+    }
+  }
+  g_tmr10ms++;
+  telemetryWakeup();
+}
+
+void mavlinkInit()
+{
+  MODEL_RESET();
+  TELEMETRY_RESET();
+  g_model.mavlink.rc_rssi_scale = 15;
+}
+
+TEST(Mavlink, capture)
+{
+  mavlinkInit();
+  mavlinkReplay(mavlinkCapture, sizeof(mavlinkCapture), 57); // 57600 bauds
+  EXPECT_EQ(mavlink_stats.bytes, sizeof(mavlinkCapture));
+  EXPECT_EQ(mavlink_stats.messages, 7);
+  EXPECT_EQ(mavlink_stats.dropped, 3);
+  EXPECT_EQ(mavlink_stats.errors, 0);
+  EXPECT_EQ(mavlink_stats.overruns, 0);
+  EXPECT_EQ(telemetry_data.type_autopilot, MAVLINK_ARDUCOPTER);
+  EXPECT_EQ(telemetry_data.custom_mode, 5u);
+  EXPECT_TRUE(telemetry_data.active);
+  EXPECT_EQ(telemetry_data.vbat, 126);
+  EXPECT_EQ(telemetry_data.ibat, 152);
+  EXPECT_EQ(telemetry_data.rem_bat, 76);
+  EXPECT_EQ(telemetry_data.fix_type, 3);
+  EXPECT_EQ(telemetry_data.satellites_visible, 9);
+  EXPECT_NEAR(telemetry_data.loc_current.lat, 48.8584, 0.0001);
+  EXPECT_NEAR(telemetry_data.loc_current.lon, 2.2945, 0.0001);
+  EXPECT_EQ(telemetry_data.course, 90);
+  EXPECT_EQ(telemetry_data.heading, 270);
+  EXPECT_FLOAT_EQ(telemetry_data.loc_current.rel_alt, 12.5);
+  EXPECT_EQ(telemetry_data.bearing, 135);
+  EXPECT_EQ(telemetry_data.rc_rssi, 78);
+}
+
+TEST(Mavlink, droppedWithoutChecksum)
+{
+  uint8_t data[MAVLINK_CAPTURE_GPS_RAW_INT - MAVLINK_CAPTURE_ATTITUDE + MAVLINK_CAPTURE_SYS_STATUS];
+  memcpy(data, &mavlinkCapture[MAVLINK_CAPTURE_ATTITUDE], MAVLINK_CAPTURE_GPS_RAW_INT - MAVLINK_CAPTURE_ATTITUDE);
+  memcpy(&data[MAVLINK_CAPTURE_GPS_RAW_INT - MAVLINK_CAPTURE_ATTITUDE], mavlinkCapture, MAVLINK_CAPTURE_SYS_STATUS);
+  // the ATTITUDE checksum and payload are not even read
+  data[MAVLINK_CAPTURE_GPS_RAW_INT - MAVLINK_CAPTURE_ATTITUDE - 1] ^= 0xFF;
+  data[10] = MAVLINK_STX;
+
+  mavlinkInit();
+  mavlinkReplay(data, sizeof(data), 57);
+  EXPECT_EQ(mavlink_stats.dropped, 1);
+  EXPECT_EQ(mavlink_stats.errors, 0);
+  EXPECT_EQ(mavlink_stats.messages, 1);
+  EXPECT_EQ(telemetry_data.type_autopilot, MAVLINK_ARDUCOPTER);
+}
+
+TEST(Mavlink, checksumError)
+{
+  uint8_t data[MAVLINK_CAPTURE_ATTITUDE];
+  memcpy(data, &mavlinkCapture[MAVLINK_CAPTURE_SYS_STATUS], MAVLINK_CAPTURE_ATTITUDE - MAVLINK_CAPTURE_SYS_STATUS);
+  memcpy(&data[MAVLINK_CAPTURE_ATTITUDE - MAVLINK_CAPTURE_SYS_STATUS], mavlinkCapture, MAVLINK_CAPTURE_SYS_STATUS);
+  data[20] ^= 0x01; // battery voltage
+
+  mavlinkInit();
+  mavlinkReplay(data, sizeof(data), 57);
+  EXPECT_EQ(mavlink_stats.errors, 1);
+  EXPECT_EQ(mavlink_stats.messages, 1);
+  EXPECT_EQ(telemetry_data.vbat, 0);
+  EXPECT_EQ(telemetry_data.type_autopilot, MAVLINK_ARDUCOPTER);
+}
+
+TEST(Mavlink, overrun)
+{
+  mavlinkInit();
+  mavlinkReplay(mavlinkCapture, sizeof(mavlinkCapture), sizeof(mavlinkCapture));
+  // HEARTBEAT and STATUSTEXT don't wait in the ring, NAV_CONTROLLER_OUTPUT and RC_CHANNELS_RAW are lost
+  EXPECT_EQ(mavlink_stats.messages, 5);
+  EXPECT_EQ(mavlink_stats.overruns, 2);
+  EXPECT_EQ(telemetry_data.type_autopilot, MAVLINK_ARDUCOPTER);
+  EXPECT_EQ(telemetry_data.vbat, 126);
+  EXPECT_EQ(telemetry_data.satellites_visible, 9);
+  EXPECT_EQ(telemetry_data.heading, 270);
+  EXPECT_EQ(telemetry_data.bearing, 0);
+  EXPECT_EQ(telemetry_data.rc_rssi, 0);
+}
+
+TEST(Mavlink, heartbeats)
+{
+  uint8_t data[2*MAVLINK_CAPTURE_SYS_STATUS];
+  memcpy(data, mavlinkCapture, MAVLINK_CAPTURE_SYS_STATUS);
+  memcpy(&data[MAVLINK_CAPTURE_SYS_STATUS], mavlinkCapture, MAVLINK_CAPTURE_SYS_STATUS);
+
+  // the second one goes to the ring while the first one is not handled
+  mavlinkInit();
+  mavlinkReplay(data, sizeof(data), sizeof(data));
+  EXPECT_EQ(mavlink_stats.messages, 2);
+  EXPECT_EQ(mavlink_stats.overruns, 0);
+  EXPECT_EQ(telemetry_data.type_autopilot, MAVLINK_ARDUCOPTER);
+}
+
+TEST(Mavlink, highRate)
+{
+  mavlinkInit();
+  for (int i=0; i<100; i++) {
+    mavlinkReplay(mavlinkCapture, sizeof(mavlinkCapture), 115); // 115200 bauds
+  }
+  EXPECT_EQ(mavlink_stats.bytes, 100 * sizeof(mavlinkCapture));
+  EXPECT_EQ(mavlink_stats.messages, 700);
+  EXPECT_EQ(mavlink_stats.dropped, 300);
+  EXPECT_EQ(mavlink_stats.errors, 0);
+  EXPECT_EQ(mavlink_stats.overruns, 0);
+  EXPECT_EQ(telemetry_data.type_autopilot, MAVLINK_ARDUCOPTER);
+}
+
+#endif // MAVLINK
@@ -752,6 +752,176 @@ TEST(Mixer, SlowOnSwitchAndPhase)
 }
 #endif
 
+#if defined(CPUARM)
+void setFadingModel(int lines)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+  lastFlightMode = 255; // the first evaluation activates the current flight mode
+  g_model.flightModeData[0].fadeIn = g_model.flightModeData[0].fadeOut = 10;
+  g_model.logicalSw[0].func = LS_FUNC_VPOS;
+  g_model.logicalSw[0].v1 = MIXSRC_Ele;
+  g_model.flightModeData[1].swtch = SWSRC_SW1;
+  g_model.flightModeData[1].fadeIn = g_model.flightModeData[1].fadeOut = 10;
+#if defined(GVARS)
+  g_model.flightModeData[0].gvars[0] = 20;
+  g_model.flightModeData[1].gvars[0] = 80;
+#endif
+
+  MixData * md = g_model.mixData;
+  for (int i=0; i<lines; i++, md++) {
+    md->destCh = i % 8;
+    md->weight = 100 - i;
+    switch (i % 8) {
+      case 0:
+        md->srcRaw = MIXSRC_MAX;
+        md->offset = 10;
+        break;
+      case 1:
+        md->srcRaw = MIXSRC_FIRST_POT;
+        break;
+      case 2:
+        md->srcRaw = MIXSRC_Thr;
+        break;
+      case 3:
+        md->srcRaw = MIXSRC_Ail;
+        md->carryTrim = TRIM_OFF;
+        md->swtch = TR(SWSRC_THR, SWSRC_SA0);
+        break;
+      case 4:
+        md->srcRaw = MIXSRC_MAX;
+        md->flightModes = 0x02; // disabled in FM1
+        break;
+      case 5:
+#if defined(GVARS)
+        md->srcRaw = MIXSRC_MAX;
+        md->weight = GV1_LARGE; // GV1
+#else
+        md->srcRaw = MIXSRC_Ele;
+#endif
+        break;
+      case 6:
+        md->srcRaw = MIXSRC_CH1;
+        break;
+      case 7:
+        md->srcRaw = MIXSRC_FIRST_POT;
+        md->mltpx = MLTPX_MUL;
+        md->destCh = 6;
+        break;
+    }
+  }
+}
+
+void runFadingModel(int16_t outputs[][NUM_CHNOUT], int cycles)
+{
+  // FM1 is selected by the elevator stick, let any fade left by a previous test finish in FM0
+  anaInValues[ELE_STICK] = -1024;
+  for (int i=0; i<200; i++) {
+    evalMixes(1);
+  }
+  for (int i=0; i<cycles; i++) {
+    // two flight mode changes, the second one during the fade
+    if (i == 10)
+      anaInValues[ELE_STICK] = 1024;
+    else if (i == 60)
+      anaInValues[ELE_STICK] = -1024;
+    anaInValues[THR_STICK] = 2*i;
+    anaInValues[AIL_STICK] = -i;
+    anaInValues[NUM_STICKS] = 3*i;
+    evalMixes(1);
+    memcpy(outputs[i], channelOutputs, sizeof(outputs[i]));
+  }
+}
+
+TEST(FlightModes, fadeSharedMixes)
+{
+  const int cycles = 200;
+  static int16_t full[cycles][NUM_CHNOUT], shared[cycles][NUM_CHNOUT];
+
+  setFadingModel(16);
+  flightModesFadeSharing = false;
+  runFadingModel(full, cycles);
+
+  setFadingModel(16);
+  flightModesFadeSharing = true;
+  runFadingModel(shared, cycles);
+
+  for (int i=0; i<cycles; i++) {
+    for (int ch=0; ch<NUM_CHNOUT; ch++) {
+      EXPECT_EQ(shared[i][ch], full[i][ch]) << "cycle " << i << " channel " << ch;
+    }
+  }
+
+  // CH5 goes from 100% to 0% (disabled in FM1), it must be somewhere in between during the fade
+  EXPECT_GT(full[30][4], 0);
+  EXPECT_LT(full[30][4], full[9][4]);
+}
+
+void setRandomLimits()
+{
+  for (int i=0; i<NUM_CHNOUT; i++) {
+    LimitData * lim = limitAddress(i);
+#if defined(PCBTARANIS)
+    lim->min = rand() % 1001 - 500;
+    lim->max = rand() % 1001 - 500;
+    lim->curve = rand() % 3 - 1; // the first curve (no need to load the curves)
+#else
+    lim->min = rand() % 201 - 100;
+    lim->max = rand() % 201 - 100;
+#endif
+    lim->offset = rand() % 2001 - 1000;
+    lim->symetrical = rand() & 1;
+    lim->revert = rand() & 1;
+    safetyCh[i] = (rand() % 8 == 0 ? rand() % 201 - 100 : OVERRIDE_CHANNEL_UNDEFINED);
+  }
+}
+
+void resetOverrides()
+{
+  for (int i=0; i<NUM_CHNOUT; i++) {
+    safetyCh[i] = OVERRIDE_CHANNEL_UNDEFINED;
+  }
+}
+
+TEST(Limits, blockEqualsScalar)
+{
+  MODEL_RESET();
+  srand(42);
+  for (int n=0; n<2000; n++) {
+    setRandomLimits();
+    int32_t values[NUM_CHNOUT], inputs[NUM_CHNOUT];
+    for (int i=0; i<NUM_CHNOUT; i++) {
+      // up to twice the 1024*256 range to check the clipping
+      values[i] = inputs[i] = (rand() % (4*RESX+1) - 2*RESX) * 256 + rand() % 256;
+    }
+    int16_t outputs[NUM_CHNOUT];
+    evalLimits(values, outputs);
+    for (int i=0; i<NUM_CHNOUT; i++) {
+      EXPECT_EQ(outputs[i], applyLimits(i, inputs[i])) << "run " << n << " channel " << i;
+    }
+  }
+  resetOverrides();
+}
+
+TEST(Limits, outputsSwappedAtOnce)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+  g_model.mixData[0].destCh = 0;
+  g_model.mixData[0].srcRaw = MIXSRC_Thr;
+  g_model.mixData[0].weight = 100;
+  anaInValues[THR_STICK] = 512;
+  const int16_t * previous = channelOutputs;
+  evalMixes(1);
+  EXPECT_NE(channelOutputs, previous);
+  EXPECT_EQ(channelOutputs[0], 512);
+  EXPECT_EQ(previous[0], 0);
+  evalMixes(1);
+  EXPECT_EQ(channelOutputs, previous);
+  EXPECT_EQ(channelOutputs[0], 512);
+}
+#endif
+
 TEST(Mixer, SlowOnSwitchSource)
 {
   MODEL_RESET();
@@ -1024,3 +1194,59 @@ TEST(Trainer, UnpluggedTest)
   ppmInput[0] = 1024;
   CHECK_DELAY(0, 5000);
 }
+
+#if defined(CPUARM)
+TEST(Profiler, stages)
+{
+  MODEL_RESET();
+  MIXER_RESET();
+  mixerProfiler.reset();
+
+  for (int i=0; i<100; i++) {
+    doMixerCalculations();
+  }
+
+  EXPECT_EQ(mixerProfiler.getCycles(), 100u);
+  for (int i=0; i<PROFILE_STAGES_COUNT; i++) {
+    EXPECT_LE(mixerProfiler.getPercentile(i, 50), mixerProfiler.getPercentile(i, 99));
+    EXPECT_LE(mixerProfiler.getPercentile(i, 99), mixerProfiler.getMax(i));
+  }
+
+  // stages run outside of a mixer cycle are not profiled
+  PROFILE_ENTER(PROFILE_INPUTS);
+  evalInputs(e_perout_mode_notrainer);
+  PROFILE_LEAVE();
+  EXPECT_EQ(mixerProfiler.getCycles(), 100u);
+}
+#endif
+
+#if defined(DEBUG_TRACE_BUFFER)
+TEST(TraceBuffer, ring)
+{
+  clearTraceBuffer();
+  EXPECT_EQ(getTraceCount(), 0);
+  EXPECT_EQ(getTraceElement(0), (const struct TraceElement *)NULL);
+
+  for (uint32_t i=0; i<TRACE_BUFFER_LEN+10; i++) {
+    TRACE_BEGIN(task_mixer);
+    trace_event(trace_start, i);
+    TRACE_END(task_mixer);
+  }
+
+  // the ring keeps the most recent events, oldest first
+  EXPECT_EQ(getTraceCount(), TRACE_BUFFER_LEN);
+  const struct TraceElement * first = getTraceElement(0);
+  const struct TraceElement * last = getTraceElement(TRACE_BUFFER_LEN-1);
+  ASSERT_NE(first, (const struct TraceElement *)NULL);
+  ASSERT_NE(last, (const struct TraceElement *)NULL);
+  EXPECT_EQ(last->event, task_mixer | TRACE_PHASE_END);
+  EXPECT_EQ(getTraceElement(TRACE_BUFFER_LEN-2)->data, (uint32_t)TRACE_BUFFER_LEN+9);
+  EXPECT_LE(first->time, last->time);
+  // 3 * (TRACE_BUFFER_LEN+10) events, the oldest one is in the third lap
+  EXPECT_EQ(first->seq, 3);
+  EXPECT_EQ(last->seq, 4);
+  EXPECT_STREQ(getTraceEventName(last->event), "task_mixer");
+  EXPECT_STREQ(getTraceEventName(trace_start), "trace_start");
+  EXPECT_EQ(getTraceElement(TRACE_BUFFER_LEN), (const struct TraceElement *)NULL);
+}
+#endif
@@ -0,0 +1,159 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include "gtests.h"
+
+#if defined(SBUS)
+#define SBUS_FRAME_SIZE 25
+
+void createSbusFrame(uint8_t * frame, uint16_t value, uint8_t flags=0)
+{
+  uint32_t bits = 0;
+  uint32_t bitsavailable = 0;
+  uint8_t * p = frame;
+
+  memclear(frame, SBUS_FRAME_SIZE);
+  *p++ = 0x0F;
+  for (int i=0; i<16; i++) {
+    bits |= (value & 0x7FF) << bitsavailable;
+    bitsavailable += 11;
+    while (bitsavailable >= 8) {
+      *p++ = bits;
+      bits >>= 8;
+      bitsavailable -= 8;
+    }
+  }
+  frame[23] = flags;
+}
+
+void sendSbusFrame(const uint8_t * frame, int size)
+{
+  for (int i=0; i<size; i++) {
+    sbusRxByte(frame[i]);
+  }
+  sbusRxIdle();
+}
+
+TEST(Sbus, validFrame)
+{
+  uint8_t frame[SBUS_FRAME_SIZE];
+  memclear(ppmInput, sizeof(ppmInput));
+  sbusResetStatistics();
+  createSbusFrame(frame, 0x3E0 + 800);
+  sendSbusFrame(frame, SBUS_FRAME_SIZE);
+  EXPECT_EQ(sbusStatistics.frames, 1U);
+  EXPECT_EQ(sbusStatistics.badFrames, 0U);
+  for (int i=0; i<NUM_TRAINER; i++) {
+    EXPECT_EQ(ppmInput[i], 500);
+  }
+}
+
+TEST(Sbus, lostFrame)
+{
+  uint8_t frame[SBUS_FRAME_SIZE];
+  memclear(ppmInput, sizeof(ppmInput));
+  sbusResetStatistics();
+  createSbusFrame(frame, 0x3E0 + 800, 1 << 2);
+  sendSbusFrame(frame, SBUS_FRAME_SIZE);
+  createSbusFrame(frame, 0x3E0 + 800, 1 << 3);
+  sendSbusFrame(frame, SBUS_FRAME_SIZE);
+  EXPECT_EQ(sbusStatistics.frames, 0U);
+  EXPECT_EQ(sbusStatistics.lostFrames, 2U);
+  EXPECT_EQ(ppmInput[0], 0);
+}
+
+TEST(Sbus, gapInsideFrame)
+{
+  uint8_t frame[SBUS_FRAME_SIZE];
+  memclear(ppmInput, sizeof(ppmInput));
+  sbusResetStatistics();
+  createSbusFrame(frame, 0x3E0 + 800);
+  sendSbusFrame(frame, 10);
+  sendSbusFrame(frame+10, SBUS_FRAME_SIZE-10);
+  EXPECT_EQ(sbusStatistics.frames, 0U);
+  EXPECT_EQ(sbusStatistics.badFrames, 2U);
+  EXPECT_EQ(ppmInput[0], 0);
+
+  // the next complete frame is decoded
+  sendSbusFrame(frame, SBUS_FRAME_SIZE);
+  EXPECT_EQ(sbusStatistics.frames, 1U);
+  EXPECT_EQ(ppmInput[0], 500);
+}
+
+TEST(Sbus, missingGap)
+{
+  uint8_t frames[2*SBUS_FRAME_SIZE];
+  memclear(ppmInput, sizeof(ppmInput));
+  sbusResetStatistics();
+  createSbusFrame(frames, 0x3E0 + 800);
+  createSbusFrame(frames+SBUS_FRAME_SIZE, 0x3E0 - 800);
+  sendSbusFrame(frames, 2*SBUS_FRAME_SIZE);
+  EXPECT_EQ(sbusStatistics.frames, 0U);
+  EXPECT_EQ(sbusStatistics.badFrames, 1U);
+  EXPECT_EQ(ppmInput[0], 0);
+}
+
+TEST(Sbus, rxError)
+{
+  uint8_t frame[SBUS_FRAME_SIZE];
+  memclear(ppmInput, sizeof(ppmInput));
+  sbusResetStatistics();
+  createSbusFrame(frame, 0x3E0 + 800);
+  for (int i=0; i<SBUS_FRAME_SIZE; i++) {
+    if (i == 5)
+      sbusRxError();
+    else
+      sbusRxByte(frame[i]);
+  }
+  sbusRxIdle();
+  EXPECT_EQ(sbusStatistics.badFrames, 1U);
+  EXPECT_EQ(ppmInput[0], 0);
+}
+
+TEST(Sbus, doubleBuffer)
+{
+  uint8_t frame[SBUS_FRAME_SIZE];
+  memclear(ppmInput, sizeof(ppmInput));
+  sbusResetStatistics();
+  for (int i=0; i<10; i++) {
+    createSbusFrame(frame, 0x3E0 + (i & 1 ? -800 : 800));
+    sendSbusFrame(frame, SBUS_FRAME_SIZE);
+    EXPECT_EQ(ppmInput[NUM_TRAINER-1], i & 1 ? -500 : 500);
+  }
+  EXPECT_EQ(sbusStatistics.frames, 10U);
+}
+#endif
@@ -0,0 +1,389 @@
+/*
+ * Authors (alphabetical order)
+ * - Andre Bernet <bernet.andre@gmail.com>
+ * - Andreas Weitl
+ * - Bertrand Songis <bsongis@gmail.com>
+ * - Bryan J. Rentoul (Gruvin) <gruvin@gmail.com>
+ * - Cameron Weeks <th9xer@gmail.com>
+ * - Erez Raviv
+ * - Gabriel Birkus
+ * - Jean-Pierre Parisy
+ * - Karl Szmutny
+ * - Michael Blandford
+ * - Michal Hlavinka
+ * - Pat Mackenzie
+ * - Philip Moss
+ * - Rob Thomson
+ * - Romolo Manfredini <romolo.manfredini@gmail.com>
+ * - Thomas Husterer
+ *
+ * opentx is based on code named
+ * gruvin9x by Bryan J. Rentoul: http://code.google.com/p/gruvin9x/,
+ * er9x by Erez Raviv: http://code.google.com/p/er9x/,
+ * and the original (and ongoing) project by
+ * Thomas Husterer, th9x: http://code.google.com/p/th9x/
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ */
+
+
+#include <pthread.h>
+#include <unistd.h>
+#include "gtests.h"
+
+#if defined(PCBTARANIS)
+
+// The card model of the simulations, in us
+static const SdIoLatency readLatency = { 500, 200 };
+static const SdIoLatency writeLatency = { 1500, 200 };
+
+// One task per class, each one holds the volume during one transfer, then
+// thinks until its next request
+struct SdIoTask {
+  uint32_t period;       // us between two requests
+  uint32_t hold;         // us
+  uint32_t nextRequest;
+  uint32_t requestTime;
+  bool     waiting;
+  uint32_t served;
+  uint32_t maxWait;
+};
+
+// The reference, the volume is granted in the requests order
+class FifoScheduler
+{
+  public:
+    FifoScheduler():
+      busy(false),
+      count(0)
+    {
+    }
+
+    bool request(uint8_t cls, uint32_t now)
+    {
+      if (!busy) {
+        busy = true;
+        return true;
+      }
+      queue[count++] = cls;
+      return false;
+    }
+
+    int release(uint32_t now)
+    {
+      if (count == 0) {
+        busy = false;
+        return -1;
+      }
+      int cls = queue[0];
+      memmove(&queue[0], &queue[1], --count);
+      return cls;
+    }
+
+  protected:
+    bool busy;
+    uint8_t count;
+    uint8_t queue[SDIO_CLASSES_COUNT];
+};
+
+template <class Scheduler>
+void simulateSdIo(Scheduler & scheduler, SdIoTask * tasks, uint32_t duration)
+{
+  int holder = -1;
+  uint32_t holdEnd = 0;
+  uint32_t now = 0;
+
+  while (now < duration) {
+    // the next event
+    uint32_t next = (holder >= 0 ? holdEnd : UINT32_MAX);
+    for (int i=0; i<SDIO_CLASSES_COUNT; i++) {
+      if (!tasks[i].waiting && i != holder && tasks[i].nextRequest < next)
+        next = tasks[i].nextRequest;
+    }
+    now = next;
+
+    if (holder >= 0 && now == holdEnd) {
+      SdIoTask & task = tasks[holder];
+      task.nextRequest = now + task.period;
+      holder = scheduler.release(now);
+      if (holder >= 0) {
+        SdIoTask & woken = tasks[holder];
+        woken.waiting = false;
+        woken.served++;
+        woken.maxWait = max(woken.maxWait, now - woken.requestTime);
+        holdEnd = now + woken.hold;
+      }
+    }
+
+    for (int i=0; i<SDIO_CLASSES_COUNT; i++) {
+      SdIoTask & task = tasks[i];
+      if (!task.waiting && i != holder && task.nextRequest == now) {
+        task.requestTime = now;
+        if (scheduler.request(i, now)) {
+          holder = i;
+          holdEnd = now + task.hold;
+          task.served++;
+        }
+        else {
+          task.waiting = true;
+        }
+      }
+    }
+  }
+}
+
+static void initSdIoTasks(SdIoTask * tasks)
+{
+  memclear(tasks, SDIO_CLASSES_COUNT * sizeof(SdIoTask));
+  // 1kB of audio read ahead every 10ms
+  tasks[SDIO_AUDIO].period = 10000;
+  tasks[SDIO_AUDIO].hold = readLatency.get(2);
+  // a model or a bitmap loaded sector by sector
+  tasks[SDIO_INTERACTIVE].period = 300;
+  tasks[SDIO_INTERACTIVE].hold = readLatency.get(1);
+  tasks[SDIO_INTERACTIVE].nextRequest = 100;
+  // the logs written sector by sector
+  tasks[SDIO_BACKGROUND].period = 200;
+  tasks[SDIO_BACKGROUND].hold = writeLatency.get(1);
+  tasks[SDIO_BACKGROUND].nextRequest = 50;
+}
+
+TEST(SdIo, priority)
+{
+  SdIoTask fifoTasks[SDIO_CLASSES_COUNT];
+  initSdIoTasks(fifoTasks);
+  FifoScheduler fifo;
+  simulateSdIo(fifo, fifoTasks, 1000000);
+
+  SdIoTask tasks[SDIO_CLASSES_COUNT];
+  initSdIoTasks(tasks);
+  SdIoScheduler scheduler;
+  scheduler.reset();
+  simulateSdIo(scheduler, tasks, 1000000);
+
+  printf("Audio max wait: %dus in requests order, %dus by priority\n", fifoTasks[SDIO_AUDIO].maxWait, tasks[SDIO_AUDIO].maxWait);
+
+  // the audio only waits for the end of the current transfer
+  EXPECT_LE(tasks[SDIO_AUDIO].maxWait, writeLatency.get(1));
+  EXPECT_GT(fifoTasks[SDIO_AUDIO].maxWait, writeLatency.get(1));
+  EXPECT_EQ(tasks[SDIO_AUDIO].maxWait, scheduler.getStats(SDIO_AUDIO).maxWait);
+  EXPECT_GT(tasks[SDIO_AUDIO].served, 80u);
+
+  // the others still get the volume
+  EXPECT_GT(tasks[SDIO_INTERACTIVE].served, 100u);
+  EXPECT_GT(tasks[SDIO_BACKGROUND].served, 100u);
+  for (int i=0; i<SDIO_CLASSES_COUNT; i++) {
+    EXPECT_EQ(tasks[i].served, scheduler.getStats(i).requests - scheduler.getStats(i).depth);
+    EXPECT_LE(scheduler.getStats(i).maxDepth, 1);
+  }
+}
+
+TEST(SdIo, aging)
+{
+  SdIoScheduler scheduler;
+  scheduler.reset();
+
+  // two interactive tasks always waiting, a log write waits behind them
+  EXPECT_TRUE(scheduler.request(SDIO_INTERACTIVE, 0));
+  EXPECT_FALSE(scheduler.request(SDIO_INTERACTIVE, 0));
+  EXPECT_FALSE(scheduler.request(SDIO_BACKGROUND, 0));
+
+  uint32_t now = 0;
+  while (1) {
+    now += 1000;
+    int cls = scheduler.release(now);
+    if (cls == SDIO_BACKGROUND)
+      break;
+    EXPECT_EQ(SDIO_INTERACTIVE, cls);
+    EXPECT_FALSE(scheduler.request(SDIO_INTERACTIVE, now));
+  }
+  EXPECT_EQ(SDIO_MAX_AGE, now);
+  EXPECT_EQ(SDIO_MAX_AGE, scheduler.getStats(SDIO_BACKGROUND).maxWait);
+
+  // an old log write still waits for the audio
+  EXPECT_FALSE(scheduler.request(SDIO_BACKGROUND, now));
+  EXPECT_FALSE(scheduler.request(SDIO_AUDIO, now + SDIO_MAX_AGE));
+  EXPECT_EQ(SDIO_AUDIO, scheduler.release(now + SDIO_MAX_AGE));
+  EXPECT_EQ(SDIO_BACKGROUND, scheduler.release(now + SDIO_MAX_AGE));
+  EXPECT_EQ(SDIO_INTERACTIVE, scheduler.release(now + SDIO_MAX_AGE));
+  EXPECT_EQ(-1, scheduler.release(now + SDIO_MAX_AGE));
+}
+
+#define TEST_DISK_SECTORS   64
+
+static uint8_t testDisk[TEST_DISK_SECTORS*512];
+static int testDiskCommands;
+static bool testDiskError;
+
+static int8_t testDiskWrite(const uint8_t * buff, uint32_t sector, uint32_t count)
+{
+  if (testDiskError) {
+    testDiskCommands++;
+    return -1;
+  }
+  memcpy(&testDisk[sector*512], buff, count*512);
+  testDiskCommands++;
+  return 0;
+}
+
+TEST(SdIo, writeBatch)
+{
+  uint8_t disk[TEST_DISK_SECTORS*512];
+  uint8_t sector[512];
+  SdIoWriteBatch batch(testDiskWrite);
+
+  memclear(testDisk, sizeof(testDisk));
+  memclear(disk, sizeof(disk));
+  testDiskCommands = 0;
+
+  // a log file written sector by sector
+  for (int i=10; i<30; i++) {
+    memset(sector, i, sizeof(sector));
+    memcpy(&disk[i*512], sector, sizeof(sector));
+    EXPECT_EQ(0, batch.write(sector, i, 1));
+  }
+  EXPECT_EQ(5, testDiskCommands);
+  EXPECT_EQ(0u, batch.pending());
+
+  // the FAT and the directory entry
+  memset(sector, 0xF0, sizeof(sector));
+  memcpy(&disk[1*512], sector, sizeof(sector));
+  EXPECT_EQ(0, batch.write(sector, 1, 1));
+  memset(sector, 0xD0, sizeof(sector));
+  memcpy(&disk[2*512], sector, sizeof(sector));
+  EXPECT_EQ(0, batch.write(sector, 2, 1));
+  EXPECT_EQ(5, testDiskCommands);
+  EXPECT_EQ(2u, batch.pending());
+
+  // a non consecutive sector flushes the batch
+  memset(sector, 0x33, sizeof(sector));
+  memcpy(&disk[33*512], sector, sizeof(sector));
+  EXPECT_EQ(0, batch.write(sector, 33, 1));
+  EXPECT_EQ(6, testDiskCommands);
+  EXPECT_EQ(1u, batch.pending());
+
+  // a large write isn't copied
+  uint8_t large[8*512];
+  memset(large, 0x40, sizeof(large));
+  memcpy(&disk[40*512], large, sizeof(large));
+  EXPECT_EQ(0, batch.write(large, 40, 8));
+  EXPECT_EQ(8, testDiskCommands);
+  EXPECT_EQ(0u, batch.pending());
+
+  EXPECT_EQ(0, batch.flush());
+  EXPECT_EQ(8, testDiskCommands);
+  EXPECT_EQ(0, memcmp(disk, testDisk, sizeof(disk)));
+}
+
+TEST(SdIo, writeBatchError)
+{
+  uint8_t sector[512];
+  SdIoWriteBatch batch(testDiskWrite);
+
+  memclear(testDisk, sizeof(testDisk));
+  testDiskCommands = 0;
+
+  memset(sector, 0x55, sizeof(sector));
+  EXPECT_EQ(0, batch.write(sector, 10, 1));
+  EXPECT_EQ(0, batch.write(sector, 11, 1));
+
+  // the failed batch is kept and its error returned until it is written
+  testDiskError = true;
+  EXPECT_NE(0, batch.flush());
+  EXPECT_EQ(2u, batch.pending());
+  EXPECT_NE(0, batch.write(sector, 20, 1));
+  EXPECT_EQ(2u, batch.pending());
+  testDiskError = false;
+  EXPECT_EQ(0, batch.flush());
+  EXPECT_EQ(0u, batch.pending());
+  EXPECT_EQ(0x55, testDisk[10*512]);
+  EXPECT_EQ(0x55, testDisk[11*512+511]);
+  EXPECT_EQ(3, testDiskCommands);
+}
+
+TEST(SdIo, writeBatchSectors)
+{
+  uint8_t sector[512];
+  SdIoWriteBatch batch(testDiskWrite);
+
+  memclear(testDisk, sizeof(testDisk));
+  testDiskCommands = 0;
+
+  memset(sector, 0x66, sizeof(sector));
+  EXPECT_EQ(0, batch.write(sector, 10, 1));
+  EXPECT_EQ(0, batch.write(sector, 11, 1));
+
+  // the other sectors don't wait for the batch
+  EXPECT_EQ(0, batch.flush(12, 4));
+  EXPECT_EQ(0, batch.flush(0, 10));
+  memset(sector, 0x77, sizeof(sector));
+  EXPECT_EQ(0, batch.writeThrough(sector, 30, 1));
+  EXPECT_EQ(1, testDiskCommands);
+  EXPECT_EQ(2u, batch.pending());
+
+  // the same sectors are written in order
+  EXPECT_EQ(0, batch.writeThrough(sector, 11, 1));
+  EXPECT_EQ(3, testDiskCommands);
+  EXPECT_EQ(0u, batch.pending());
+  EXPECT_EQ(0x66, testDisk[10*512]);
+  EXPECT_EQ(0x77, testDisk[11*512]);
+
+  EXPECT_EQ(0, batch.write(sector, 20, 1));
+  EXPECT_EQ(0, batch.flush(15, 6));
+  EXPECT_EQ(4, testDiskCommands);
+  EXPECT_EQ(0u, batch.pending());
+}
+
+#define SDIO_THREAD_REQUESTS  50
+
+static volatile int sdIoHolders;
+static volatile bool sdIoOverlap;
+
+static void * sdIoThread(void * param)
+{
+  sdIoSetTaskClass((uint8_t)(size_t)param);
+  for (int i=0; i<SDIO_THREAD_REQUESTS; i++) {
+    sdIoRequest();
+    if (++sdIoHolders > 1)
+      sdIoOverlap = true;
+    usleep(100);
+    sdIoHolders--;
+    sdIoRelease();
+  }
+  return NULL;
+}
+
+TEST(SdIo, threads)
+{
+  pthread_t threads[SDIO_CLASSES_COUNT];
+
+  sdIoInit();
+  sdIoHolders = 0;
+  sdIoOverlap = false;
+
+  for (int i=0; i<SDIO_CLASSES_COUNT; i++) {
+    pthread_create(&threads[i], NULL, sdIoThread, (void *)(size_t)i);
+  }
+  for (int i=0; i<SDIO_CLASSES_COUNT; i++) {
+    pthread_join(threads[i], NULL);
+  }
+
+  EXPECT_FALSE(sdIoOverlap);
+  for (int i=0; i<SDIO_CLASSES_COUNT; i++) {
+    const SdIoStats & stats = sdIoScheduler.getStats(i);
+    EXPECT_EQ(SDIO_THREAD_REQUESTS, stats.requests);
+    EXPECT_EQ(0, stats.depth);
+    EXPECT_LE(stats.maxDepth, 1);
+  }
+  EXPECT_EQ(SDIO_INTERACTIVE, sdIoGetTaskClass());
+}
+
+#endif // #if defined(PCBTARANIS)
@@ -9,6 +9,19 @@
 #define LUAR_FINDFUNCTION     0
 #define LUAR_FINDVALUE        1
 
+/* The entries of the sorted indexes, they also give the lookup priority */
+#define LUAR_KIND_TABLE       0
+#define LUAR_KIND_FUNCTION    1
+#define LUAR_KIND_VALUE       2
+#define LUAR_ID(table, kind, entry)   (((table) << 10) | ((kind) << 8) | (entry))
+#define LUAR_ID_TABLE(id)     ((id) >> 10)
+#define LUAR_ID_KIND(id)      (((id) >> 8) & 3)
+#define LUAR_ID_ENTRY(id)     ((id) & 0xFF)
+
+#define LUAR_INDEX_SIZE       512
+#define LUAR_MAX_TABLES       16
+#define LUAR_CACHE_SIZE       32   /* must be a power of 2 */
+
 /* Utility function: find a key in a given table (of functions or constants) */
 static luaR_result luaR_findkey(const void *where, const char *key, int type, int *found) {
   const char *pname;
@@ -30,12 +43,132 @@ static luaR_result luaR_findkey(const void *where, const char *key, int type, in
   return 0;
 }
 
+/*
+** Sorted indexes of the read-only tables, built at the first lookup. The global index holds
+** the tables names and the entries of the "__" tables, each table has its own index of
+** functions and values. The names are binary searched, when a name is found several times,
+** the entry with the lowest id wins, as it did when the tables were scanned in order
+*/
+static unsigned short luaR_index[LUAR_INDEX_SIZE];
+static unsigned short luaR_tablestart[LUAR_MAX_TABLES+1];  /* the global index is the last one */
+static unsigned short luaR_tablecount[LUAR_MAX_TABLES+1];
+static int luaR_indexstate = 0;  /* 0: not built, 1: built, -1: too small, the tables are scanned */
+
+static const char *luaR_idname(unsigned id) {
+  const luaR_table *t = &lua_rotable[LUAR_ID_TABLE(id)];
+  switch (LUAR_ID_KIND(id)) {
+    case LUAR_KIND_FUNCTION:
+      return t->pfuncs[LUAR_ID_ENTRY(id)].name;
+    case LUAR_KIND_VALUE:
+      return t->pvalues[LUAR_ID_ENTRY(id)].name;
+    default:
+      return t->name;
+  }
+}
+
+static int luaR_compare(unsigned id1, unsigned id2) {
+  int result = strcmp(luaR_idname(id1), luaR_idname(id2));
+  return result ? result : (int)id1 - (int)id2;
+}
+
+static int luaR_addentries(unsigned *count, unsigned table) {
+  const luaR_table *t = &lua_rotable[table];
+  unsigned i;
+  if (t->pfuncs) {
+    for (i=0; t->pfuncs[i].name; i++) {
+      if (*count >= LUAR_INDEX_SIZE || i > 0xFF) return 0;
+      luaR_index[(*count)++] = LUAR_ID(table, LUAR_KIND_FUNCTION, i);
+    }
+  }
+  if (t->pvalues) {
+    for (i=0; t->pvalues[i].name; i++) {
+      if (*count >= LUAR_INDEX_SIZE || i > 0xFF) return 0;
+      luaR_index[(*count)++] = LUAR_ID(table, LUAR_KIND_VALUE, i);
+    }
+  }
+  return 1;
+}
+
+static void luaR_sort(unsigned short *ids, unsigned count) {
+  /* insertion sort, only done once */
+  unsigned i, j;
+  for (i=1; i<count; i++) {
+    unsigned short id = ids[i];
+    for (j=i; j>0 && luaR_compare(ids[j-1], id) > 0; j--) {
+      ids[j] = ids[j-1];
+    }
+    ids[j] = id;
+  }
+}
+
+static int luaR_buildindex(void) {
+  unsigned count = 0, tables, i;
+
+  for (tables=0; lua_rotable[tables].name; tables++) {
+    if (tables >= LUAR_MAX_TABLES) return 0;
+    luaR_tablestart[tables] = count;
+    if (!luaR_addentries(&count, tables)) return 0;
+    luaR_tablecount[tables] = count - luaR_tablestart[tables];
+    luaR_sort(luaR_index + luaR_tablestart[tables], luaR_tablecount[tables]);
+  }
+
+  luaR_tablestart[LUAR_MAX_TABLES] = count;
+  for (i=0; i<tables; i++) {
+    if (count >= LUAR_INDEX_SIZE) return 0;
+    luaR_index[count++] = LUAR_ID(i, LUAR_KIND_TABLE, 0);
+    if (!strncmp(lua_rotable[i].name, "__", 2) && !luaR_addentries(&count, i)) return 0;
+  }
+  luaR_tablecount[LUAR_MAX_TABLES] = count - luaR_tablestart[LUAR_MAX_TABLES];
+  luaR_sort(luaR_index + luaR_tablestart[LUAR_MAX_TABLES], luaR_tablecount[LUAR_MAX_TABLES]);
+
+  return 1;
+}
+
+int luaR_indexready(void) {
+  if (luaR_indexstate == 0) {
+    luaR_indexstate = luaR_buildindex() ? 1 : -1;
+  }
+  return luaR_indexstate > 0;
+}
+
+static luaR_result luaR_findindexed(unsigned index, const char *key, lu_byte *ptype) {
+  const unsigned short *ids = luaR_index + luaR_tablestart[index];
+  unsigned low = 0, high = luaR_tablecount[index];
+  *ptype = LUA_TNIL;
+  /* lower bound, the first of the equal names has the priority */
+  while (low < high) {
+    unsigned middle = (low + high) / 2;
+    if (strcmp(luaR_idname(ids[middle]), key) < 0)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  if (low < luaR_tablecount[index] && !strcmp(luaR_idname(ids[low]), key)) {
+    unsigned id = ids[low];
+    const luaR_table *t = &lua_rotable[LUAR_ID_TABLE(id)];
+    switch (LUAR_ID_KIND(id)) {
+      case LUAR_KIND_FUNCTION:
+        *ptype = LUA_TLIGHTFUNCTION;
+        return (luaR_result)(size_t)t->pfuncs[LUAR_ID_ENTRY(id)].func;
+      case LUAR_KIND_VALUE:
+        *ptype = LUA_TNUMBER;
+        return t->pvalues[LUAR_ID_ENTRY(id)].value;
+      default:
+        *ptype = LUA_TROTABLE;
+        return LUAR_ID_TABLE(id) + 1;
+    }
+  }
+  return 0;
+}
+
 /* Find a global "read only table" in the constant lua_rotable array */
 luaR_result luaR_findglobal(const char *name, lu_byte *ptype) {
-  unsigned i;    
+  unsigned i;
   *ptype = LUA_TNIL;
   if (strlen(name) > LUA_MAX_ROTABLE_NAME)
     return 0;
+  if (luaR_indexready())
+    return luaR_findindexed(LUAR_MAX_TABLES, name, ptype);
   for (i=0; lua_rotable[i].name; i++) {
     if (!strcmp(lua_rotable[i].name, name)) {
       *ptype = LUA_TROTABLE;
@@ -60,14 +193,16 @@ int luaR_findfunction(lua_State *L, const luaL_Reg *ptable) {
     lua_pushlightfunction(L, (void*)(size_t)res);
   else
     lua_pushnil(L);
-  return 1; 
+  return 1;
 }
 
 luaR_result luaR_findentry(void *data, const char *key, lu_byte *ptype) {
   int found;
   unsigned idx = (unsigned)(size_t)data - 1;
-  luaR_result res;   
+  luaR_result res;
   *ptype = LUA_TNIL;
+  if (luaR_indexready())
+    return luaR_findindexed(idx, key, ptype);
   /* First look at the functions */
   res = luaR_findkey(lua_rotable[idx].pfuncs, key, LUAR_FINDFUNCTION, &found);
   if (found) {
@@ -84,3 +219,51 @@ luaR_result luaR_findentry(void *data, const char *key, lu_byte *ptype) {
   }
   return 0;
 }
+
+/*
+** Cache of the last lookups, keyed by the (interned) string of the key, so that the same
+** global or field in a loop is only searched once. The misses are cached too. An entry is
+** forgotten when its string is collected, another string could get the same address
+*/
+typedef struct {
+  const TString *key;
+  luaR_result result;
+  unsigned short table;  /* 0 for the globals, the table index + 1 otherwise */
+  lu_byte type;
+} luaR_cache_entry;
+
+static luaR_cache_entry luaR_cache[LUAR_CACHE_SIZE];
+
+static luaR_result luaR_findcached(unsigned table, const TString *key, lu_byte *ptype) {
+  luaR_cache_entry *entry;
+  /* the names which are too long can't be found (only short strings are cached) */
+  if (key->tsv.len + 1 > LUA_MAX_ROTABLE_NAME) {
+    *ptype = LUA_TNIL;
+    return 0;
+  }
+  entry = &luaR_cache[key->tsv.hash & (LUAR_CACHE_SIZE-1)];
+  if (entry->key != key || entry->table != table) {
+    char keyname[LUA_MAX_ROTABLE_NAME + 1];
+    memcpy(keyname, getstr(key), key->tsv.len);
+    keyname[key->tsv.len] = '\0';
+    entry->result = table ? luaR_findentry((void *)(size_t)table, keyname, &entry->type) : luaR_findglobal(keyname, &entry->type);
+    entry->key = key;
+    entry->table = table;
+  }
+  *ptype = entry->type;
+  return entry->result;
+}
+
+luaR_result luaR_findglobalstr(const TString *key, lu_byte *ptype) {
+  return luaR_findcached(0, key, ptype);
+}
+
+luaR_result luaR_findentrystr(void *data, const TString *key, lu_byte *ptype) {
+  return luaR_findcached((unsigned)(size_t)data, key, ptype);
+}
+
+void luaR_forgetstring(const TString *key) {
+  luaR_cache_entry *entry = &luaR_cache[key->tsv.hash & (LUAR_CACHE_SIZE-1)];
+  if (entry->key == key)
+    entry->key = NULL;
+}
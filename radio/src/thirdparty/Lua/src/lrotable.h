@@ -6,6 +6,7 @@
 #include "lua.h"
 #include "llimits.h"
 #include "lauxlib.h"
+#include "lobject.h"
 
 typedef lua_Number luaR_result;
 
@@ -33,5 +34,11 @@ extern const luaR_table lua_rotable[];
 luaR_result luaR_findglobal(const char *key, lu_byte *ptype);
 int luaR_findfunction(lua_State *L, const luaL_Reg *ptable);
 luaR_result luaR_findentry(void *data, const char *key, lu_byte *ptype);
+int luaR_indexready(void);
+
+// Cached lookups by interned string, the strings must be forgotten when collected
+luaR_result luaR_findglobalstr(const TString *key, lu_byte *ptype);
+luaR_result luaR_findentrystr(void *data, const TString *key, lu_byte *ptype);
+void luaR_forgetstring(const TString *key);
 
 #endif
@@ -106,25 +106,13 @@ static void callTM (lua_State *L, const TValue *f, const TValue *p1,
   }
 }
 
-static void lua_getcstr(char *dest, const TString *src, size_t maxsize) {
-  if (src->tsv.len+1 > maxsize)
-    dest[0] = '\0';
-  else {
-    memcpy(dest, getstr(src), src->tsv.len);
-    dest[src->tsv.len] = '\0';
-  }
-}
-
 void luaV_gettable (lua_State *L, const TValue *t, TValue *key, StkId val) {
   int loop;
   if (ttisrotable(t)) {
     setnilvalue(val);
     if (ttisstring(key)) {
-      char keyname[LUA_MAX_ROTABLE_NAME + 1];
       lu_byte keytype;
-      lua_getcstr(keyname, rawtsvalue(key), LUA_MAX_ROTABLE_NAME);
-      // TRACE("luaV_gettable(key=%s)", keyname);
-      luaR_result res = luaR_findentry(rvalue(t), keyname, &keytype);
+      luaR_result res = luaR_findentrystr(rvalue(t), rawtsvalue(key), &keytype);
       if (keytype == LUA_TLIGHTFUNCTION)
         setlfvalue(val, (void*)(size_t)res)
       else if (keytype == LUA_TNUMBER)
@@ -627,10 +615,8 @@ void luaV_execute (lua_State *L) {
       {
         int b = GETARG_B(i);
         if (ttisstring(RKC(i))) {
-          char keyname[LUA_MAX_ROTABLE_NAME + 1];
           lu_byte keytype;
-          lua_getcstr(keyname, rawtsvalue(RKC(i)), LUA_MAX_ROTABLE_NAME);
-          luaR_result res = luaR_findglobal(keyname, &keytype);
+          luaR_result res = luaR_findglobalstr(rawtsvalue(RKC(i)), &keytype);
           if (keytype == LUA_TROTABLE) {
             setrvalue(ra, (void*)(size_t)res)
           }
@@ -629,6 +629,8 @@ const pm_char STR_MENU_LOGICAL_SWITCHES[] PROGMEM = TR_MENU_LOGICAL_SWITCHES;
 const pm_char STR_MENU_OTHER[] PROGMEM = TR_MENU_OTHER;
 const pm_char STR_MENU_INVERT[] PROGMEM = TR_MENU_INVERT;
 const pm_char STR_JITTER_FILTER[] PROGMEM = TR_JITTER_FILTER;
+const pm_char STR_ANALOG_FILTER[] PROGMEM = TR_ANALOG_FILTER;
+const pm_char STR_ANALOG_FILTERS[] PROGMEM = TR_ANALOG_FILTERS;
 #endif
 
 #if MENUS_LOCK == 1
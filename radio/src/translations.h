@@ -848,6 +848,8 @@ extern const pm_char STR_BLCOLOR[];
   extern const pm_char STR_MENU_OTHER[];
   extern const pm_char STR_MENU_INVERT[];
   extern const pm_char STR_JITTER_FILTER[];
+  extern const pm_char STR_ANALOG_FILTER[];
+  extern const pm_char STR_ANALOG_FILTERS[];
 #endif
 
 #if MENUS_LOCK == 1
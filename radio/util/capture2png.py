@@ -0,0 +1,38 @@
+#!/usr/bin/env python
+
+# Converts a frames capture (.otc) recorded by the radio or the simulator
+# into one PNG per frame, named after its time in ms:
+#   capture2png.py capture-2015-01-01-123540.otc frames/capture
+
+from __future__ import division, print_function
+
+import sys
+import struct
+from PyQt4 import QtGui
+
+with open(sys.argv[1], "rb") as f:
+    data = f.read()
+
+magic, version, depth, width, height, blocksize = struct.unpack("<4sBBHHH", data[:12])
+if magic != b"OTXC" or version != 1 or depth != 4:
+    sys.exit("Unsupported capture file")
+
+# the blocks are made of the display buffer, each byte holds 2 rows of one column
+screen = bytearray(width * height // 2)
+offset = 12
+while offset < len(data):
+    time, count = struct.unpack("<IB", data[offset:offset+5])
+    offset += 5
+    for i in range(count):
+        block = bytearray(data[offset:offset+1])[0]
+        screen[block*blocksize:(block+1)*blocksize] = data[offset+1:offset+1+blocksize]
+        offset += 1 + blocksize
+
+    image = QtGui.QImage(width, height, QtGui.QImage.Format_RGB32)
+    for y in range(height):
+        for x in range(width):
+            value = screen[(y // 2) * width + x]
+            value = (value >> 4) if (y & 1) else (value & 0x0F)
+            grey = 255 - value * 17
+            image.setPixel(x, y, QtGui.qRgb(grey, grey, grey))
+    image.save("%s-%08d.png" % (sys.argv[2], time * 10))
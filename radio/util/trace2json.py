@@ -0,0 +1,117 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# This program converts a trace buffer dump (TRACE.BIN from the SD card, or the
+# text printed by the "tracebuf dump" CLI command / debug output) to the Chrome
+# trace event JSON format, to be loaded in chrome://tracing
+
+from __future__ import division, print_function
+
+import sys
+import struct
+import json
+
+
+TRACE_FILE_MAGIC = b'OTXT'
+TRACE_FILE_VERSION = 1
+
+TRACE_PHASE_BEGIN = 0x4000
+TRACE_PHASE_END = 0x8000
+TRACE_PHASE_MASK = 0xC000
+
+TRACE_CONTEXT_ISR = 0xFF
+
+
+def phaseChar(event):
+    if event & TRACE_PHASE_MASK == TRACE_PHASE_BEGIN:
+        return 'B'
+    elif event & TRACE_PHASE_MASK == TRACE_PHASE_END:
+        return 'E'
+    else:
+        return 'i'
+
+
+def parseBinary(data):
+    magic, version, elementSize, namesCount, frequency, count, lost = struct.unpack_from('<4sBBHIII', data, 0)
+    if version != TRACE_FILE_VERSION:
+        raise Exception("Unsupported trace file version %d" % version)
+    offset = struct.calcsize('<4sBBHIII')
+    names = {}
+    for i in range(namesCount):
+        id, length = struct.unpack_from('<HB', data, offset)
+        offset += 3
+        names[id] = data[offset:offset+length].decode('ascii')
+        offset += length
+    events = []
+    for i in range(count):
+        time, arg, event, context, seq = struct.unpack_from('<IIHBB', data, offset)
+        offset += elementSize
+        events.append((time, context, phaseChar(event), names.get(event & ~TRACE_PHASE_MASK, "event_%d" % (event & ~TRACE_PHASE_MASK)), arg))
+    return frequency, lost, events
+
+
+def parseText(lines):
+    frequency, lost, events = 1000000, 0, []
+    for line in lines:
+        fields = line.split()
+        if len(fields) == 8 and fields[0] == '#' and fields[7] == 'Hz':
+            # "# <count> events, <lost> lost, <frequency> Hz"
+            lost, frequency = int(fields[3]), int(fields[6])
+        elif len(fields) == 5 and fields[0].isdigit():
+            events.append((int(fields[0]), int(fields[1]), fields[2], fields[3], int(fields[4], 16)))
+    return frequency, lost, events
+
+
+def convert(frequency, events):
+    result = []
+    contexts = set()
+    high = 0
+    last = None
+    for time, context, phase, name, arg in events:
+        # the timestamp counter wraps around, events are stored in order
+        if last is not None and time < last and last - time > 0x80000000:
+            high += 0x100000000
+        last = time
+        event = {
+            "name": name,
+            "ph": phase,
+            "ts": (high + time) * 1000000.0 / frequency,
+            "pid": 0,
+            "tid": context,
+            "args": {"data": "0x%08x" % arg},
+        }
+        if phase == 'i':
+            event["s"] = "t"
+        result.append(event)
+        contexts.add(context)
+    for context in sorted(contexts):
+        result.append({
+            "name": "thread_name",
+            "ph": "M",
+            "pid": 0,
+            "tid": context,
+            "args": {"name": "ISR" if context == TRACE_CONTEXT_ISR else "Task %d" % context},
+        })
+    return {"traceEvents": result, "displayTimeUnit": "ns"}
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("Usage: %s <TRACE.BIN | dump.txt> [output.json]" % sys.argv[0])
+        sys.exit(1)
+
+    data = open(sys.argv[1], "rb").read()
+    if data[:4] == TRACE_FILE_MAGIC:
+        frequency, lost, events = parseBinary(data)
+    else:
+        frequency, lost, events = parseText(data.decode('ascii', 'replace').splitlines())
+
+    if lost:
+        print("%d events were lost while the buffer was dumped" % lost, file=sys.stderr)
+
+    output = open(sys.argv[2], "w") if len(sys.argv) > 2 else sys.stdout
+    json.dump(convert(frequency, events), output, indent=1)
+
+
+if __name__ == "__main__":
+    main()